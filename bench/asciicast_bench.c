@@ -0,0 +1,133 @@
+/*! \file
+ * \brief Measures the cost of asciicast recording on #cixl_game_tick: the same workload is run with recording off and on.
+ * usage: libcixl-bench-asciicast [ticks] [cast file]
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WITH_INTERNALS_VISIBLE
+#include "../src/libcixl.h"
+#include "../src/libcixl/std/cixl_stdtime.h"
+
+#define SCREEN_WIDTH 80
+#define SCREEN_HEIGHT 25
+#define SPRITE_COUNT 16
+
+static unsigned long BYTES_WRITTEN = 0;
+static int           SPRITE_X[SPRITE_COUNT];
+static int           SPRITE_Y[SPRITE_COUNT];
+static unsigned long TICK_COUNT    = 0;
+
+/*! the terminal, discards the output */
+static size_t null_write(const char *bytes, const size_t size)
+{
+    (void) bytes;
+    BYTES_WRITTEN += size;
+    return size;
+}
+
+/*! a HUD line, a few moving sprites and a couple of changing cells per tick */
+static void update(const CIXL_GameTime *game_time, void *shared_state)
+{
+    char hud[64];
+    int  i;
+    (void) game_time;
+    (void) shared_state;
+
+    sprintf(hud, "[tick:%lu][hp:%lu]", TICK_COUNT, (TICK_COUNT * 7) % 100);
+    cixl_print(0, 0, hud, CIXL_Color_White_Bright, CIXL_Color_Blue, 0);
+
+    for (i = 0; i < SPRITE_COUNT; ++i)
+    {
+        CIXL_Cxl sprite = {'@', 0, CIXL_Color_Black, 0};
+        sprite.fg_color = (CIXL_Color) (1 + (i % 15));
+
+        cixl_clear(SPRITE_X[i], SPRITE_Y[i]);
+        SPRITE_X[i] = (SPRITE_X[i] + 1 + (rand() % 2)) % SCREEN_WIDTH;
+        SPRITE_Y[i] = 1 + ((SPRITE_Y[i] + (rand() % 3)) % (SCREEN_HEIGHT - 1));
+        cixl_put(SPRITE_X[i], SPRITE_Y[i], sprite);
+    }
+
+    for (i = 0; i < 8; ++i)
+    {
+        CIXL_Cxl noise = {'.', CIXL_Color_Green, CIXL_Color_Black, 0};
+        noise.char_value = (char) ('a' + (rand() % 26));
+        cixl_put(rand() % SCREEN_WIDTH, 1 + (rand() % (SCREEN_HEIGHT - 1)), noise);
+    }
+    ++TICK_COUNT;
+}
+
+static void draw(const CIXL_GameTime *game_time, void *shared_state)
+{
+    (void) game_time;
+    (void) shared_state;
+    cixl_render();
+}
+
+/*! \return the average nanoseconds per tick */
+static double run_ticks(const unsigned long ticks)
+{
+    bool          should_exit = false;
+    unsigned long i;
+    uint64_t      start;
+
+    srand(42);
+    TICK_COUNT = 0;
+    for (i = 0; i < SPRITE_COUNT; ++i)
+    {
+        SPRITE_X[i] = (int) (i * 5);
+        SPRITE_Y[i] = 1 + (int) i;
+    }
+    cixl_init_screen_buffer(SCREEN_WIDTH, SCREEN_HEIGHT, cixl_vt_device(null_write));
+
+    start = cixl_monotonic_ns();
+    for (i = 0; i < ticks; ++i)
+    {
+        cixl_game_tick(&CURRENT_GAME_TIME, NULL, &should_exit);
+    }
+    return (double) (cixl_monotonic_ns() - start) / (double) ticks;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long ticks     = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    const char    *cast     = argc > 2 ? argv[2] : "bench_recording.cast";
+    CIXL_Game     *game     = cixl_game_create();
+    double        off_ns;
+    double        on_ns;
+    unsigned long off_bytes;
+
+    game->is_fixed_time_step = false;
+    game->f_update_game      = update;
+    game->f_draw_game        = draw;
+    cixl_game_init(NULL);
+
+    //warm up
+    run_ticks(ticks / 10 + 1);
+
+    BYTES_WRITTEN = 0;
+    off_ns        = run_ticks(ticks);
+    off_bytes     = BYTES_WRITTEN;
+
+    if (!cixl_asciicast_start(cast, SCREEN_WIDTH, SCREEN_HEIGHT))
+    {
+        fprintf(stderr, "could not create %s\n", cast);
+        return 1;
+    }
+    cixl_vt_set_tap(cixl_asciicast_write);
+    on_ns = run_ticks(ticks);
+    cixl_vt_set_tap(NULL);
+    cixl_asciicast_stop();
+
+    cixl_free_screen_buffer();
+
+    printf("asciicast overhead, %lu ticks, %lu vt bytes per tick\n", ticks, off_bytes / ticks);
+    printf("  recording off: %10.1f ns/tick\n", off_ns);
+    printf("  recording on:  %10.1f ns/tick\n", on_ns);
+    printf("  overhead:      %10.1f ns/tick (%.2f%% of a 60 fps frame)\n", on_ns - off_ns,
+           ((on_ns - off_ns) / 16666666.7) * 100.0);
+    return 0;
+}
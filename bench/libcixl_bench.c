@@ -0,0 +1,755 @@
+/*! \file
+ * \brief libcixl benchmark harness. Runs standard workloads on the headless counting device at several screen sizes
+ * and reports the nanoseconds per cell of the writes (#cixl_put or #cixl_print) and of #cixl_render.
+ *
+ * usage: libcixl-bench [--json] [--vt] [--term name] [--perf] [--workload name] [--size WIDTHxHEIGHT] [--frames n]
+ *                      [--replay recording]
+ *  --json      write the results as a JSON array (for regression tracking) instead of a table
+ *  --vt        render with the VT device into a #CIXL_VtModel instead of the counting device, reports the real terminal
+ *              bytes, cursor moves and SGR changes per frame, and checks the model equals the screen after every frame
+ *  --term      with --vt: let the VT device use the capabilities of this terminal (see #cixl_vt_caps_profile), for
+ *              example xterm for REP and ECH, by default it uses none
+ *  --perf      also report the hardware performance counters (see perf_counters.h) per cell of the writes and the
+ *              render: instructions, cache misses and branch misses, and the instructions per cycle. Ignored with a
+ *              warning when the counters are not available (not Linux, containers, virtual machines)
+ *  --workload  only run the workload with this name
+ *  --size      only run at this size
+ *  --frames    the number of frames per run, by default this scales with the screen area
+ *  --replay    also run a recording made with #cixl_record_start as workload, at its recorded size
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/libcixl.h"
+#include "../src/libcixl/std/cixl_stdtime.h"
+
+/* Each run touches about this many cells (frames * area), so all sizes take about the same time */
+#define BENCH_CELLS_PER_RUN 20000000UL
+#define BENCH_MIN_FRAMES 100
+#define BENCH_WARMUP_FRAMES 10
+
+typedef struct BenchSize
+{
+    int width;
+    int height;
+} BenchSize;
+
+static const BenchSize BENCH_SIZES[] = {{80,  25},
+                                        {132, 43},
+                                        {250, 100},
+                                        {500, 200}};
+
+#define BENCH_SIZE_COUNT (sizeof(BENCH_SIZES) / sizeof(BENCH_SIZES[0]))
+
+typedef struct BenchWorkload
+{
+    const char *name;
+
+    /*! \brief The write function that is measured, "cixl_put" or "cixl_print"*/
+    const char *write_api;
+
+    void (*f_setup)(const int width, const int height);
+
+    /*! \brief Optional, work for the next frame that should not be measured*/
+    void (*f_prepare)(const unsigned long frame);
+
+    /*! \brief Writes a frame, returns the number of cells that were written*/
+    unsigned long (*f_frame)(const unsigned long frame);
+} BenchWorkload;
+
+typedef struct BenchResult
+{
+    const BenchWorkload *workload;
+    int                 width;
+    int                 height;
+    unsigned long       frames;
+    uint64_t            write_ns;
+    uint64_t            render_ns;
+    uint64_t            cells_written;
+    CIXL_DeviceCounters counters;
+    CIXL_VtModelStats   vt_stats;
+    CIXL_PerfCounters   write_perf;
+    CIXL_PerfCounters   render_perf;
+
+    /*! \brief Frames after which the VT model did not equal the screen buffer, should always be 0*/
+    unsigned long vt_mismatched_frames;
+} BenchResult;
+
+static int WIDTH;
+static int HEIGHT;
+
+static bool         BENCH_VT          = false;
+static bool         BENCH_PERF        = false;
+static unsigned int BENCH_VT_CAPS     = CIXL_VT_CAPS_NONE;
+static CIXL_VtModel *VT_MODEL          = NULL;
+static bool         VT_MISMATCH_FOUND = false;
+
+static size_t bench_vt_write(const char *bytes, const size_t size)
+{
+    cixl_vt_model_feed(VT_MODEL, bytes, size);
+    return size;
+}
+
+/* xorshift, so the workloads are the same on every platform */
+static uint32_t RANDOM_STATE = 2463534242UL;
+
+static inline uint32_t bench_random()
+{
+    RANDOM_STATE ^= RANDOM_STATE << 13;
+    RANDOM_STATE ^= RANDOM_STATE >> 17;
+    RANDOM_STATE ^= RANDOM_STATE << 5;
+    return RANDOM_STATE;
+}
+
+static void setup_nothing(const int width, const int height)
+{
+    (void) width;
+    (void) height;
+}
+
+/* sparse sprite movement: a few sprites that move around, the rest of the screen does not change */
+
+#define MAX_SPRITE_COUNT 1000
+
+static int SPRITE_X[MAX_SPRITE_COUNT];
+static int SPRITE_Y[MAX_SPRITE_COUNT];
+static int SPRITE_COUNT;
+
+static void sprites_setup(const int width, const int height)
+{
+    int i;
+    SPRITE_COUNT = (width * height) / 100;
+    if (SPRITE_COUNT > MAX_SPRITE_COUNT)
+    {
+        SPRITE_COUNT = MAX_SPRITE_COUNT;
+    }
+
+    for (i = 0; i < SPRITE_COUNT; ++i)
+    {
+        SPRITE_X[i] = (int) (bench_random() % (uint32_t) width);
+        SPRITE_Y[i] = (int) (bench_random() % (uint32_t) height);
+    }
+}
+
+static unsigned long sprites_frame(const unsigned long frame)
+{
+    int i;
+    (void) frame;
+
+    for (i = 0; i < SPRITE_COUNT; ++i)
+    {
+        CIXL_Cxl sprite = {'@', 0, CIXL_Color_Black, 0};
+        sprite.fg_color = (CIXL_Color) (1 + (i % 15));
+
+        cixl_clear(SPRITE_X[i], SPRITE_Y[i]);
+        SPRITE_X[i] = (SPRITE_X[i] + WIDTH + (int) (bench_random() % 3) - 1) % WIDTH;
+        SPRITE_Y[i] = (SPRITE_Y[i] + HEIGHT + (int) (bench_random() % 3) - 1) % HEIGHT;
+        cixl_put(SPRITE_X[i], SPRITE_Y[i], sprite);
+    }
+    return (unsigned long) SPRITE_COUNT * 2;
+}
+
+/* full screen noise: every cell gets a random char and colors */
+
+static unsigned long noise_frame(const unsigned long frame)
+{
+    int x;
+    int y;
+    (void) frame;
+
+    for (y = 0; y < HEIGHT; ++y)
+    {
+        for (x = 0; x < WIDTH; ++x)
+        {
+            uint32_t r    = bench_random();
+            CIXL_Cxl cell = {0, 0, 0, 0};
+            cell.char_value = (char) ('!' + (r % 94));
+            cell.fg_color   = (CIXL_Color) ((r >> 8) & 0x0F);
+            cell.bg_color   = (CIXL_Color) ((r >> 12) & 0x0F);
+            cixl_put(x, y, cell);
+        }
+    }
+    return (unsigned long) WIDTH * HEIGHT;
+}
+
+/* scrolling text: each frame all text moves up one line */
+
+static const char SCROLL_TEXT[] = "The quick brown fox jumps over the lazy dog. Lorem ipsum dolor sit amet, consectetur "
+                                  "adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. ";
+
+static char *SCROLL_LINES = NULL;
+static int  SCROLL_LINE_COUNT;
+
+static void scroll_setup(const int width, const int height)
+{
+    int line;
+    int x;
+
+    SCROLL_LINE_COUNT = height * 2;
+    SCROLL_LINES      = realloc(SCROLL_LINES, (size_t) SCROLL_LINE_COUNT * (size_t) (width + 1));
+
+    for (line = 0; line < SCROLL_LINE_COUNT; ++line)
+    {
+        char *dst   = &SCROLL_LINES[line * (width + 1)];
+        int  length = width / 2 + (int) (bench_random() % (uint32_t) (width / 2));
+        int  offset = (int) (bench_random() % (sizeof(SCROLL_TEXT) - 1));
+
+        for (x = 0; x < width; ++x)
+        {
+            dst[x] = x < length ? SCROLL_TEXT[(offset + x) % (sizeof(SCROLL_TEXT) - 1)] : ' ';
+        }
+        dst[width] = '\0';
+    }
+}
+
+static unsigned long scroll_frame(const unsigned long frame)
+{
+    int y;
+
+    for (y = 0; y < HEIGHT; ++y)
+    {
+        const char *line = &SCROLL_LINES[((y + (int) frame) % SCROLL_LINE_COUNT) * (WIDTH + 1)];
+        cixl_print(0, y, line, CIXL_Color_Grey, CIXL_Color_Black, 0);
+    }
+    return (unsigned long) WIDTH * HEIGHT;
+}
+
+/* HUD counters: a status line at the top and bottom with counters that change every frame */
+
+static unsigned long hud_frame(const unsigned long frame)
+{
+    char          status[128];
+    unsigned long cells;
+
+    sprintf(status, "HP:%3lu/100 MP:%3lu/50 GOLD:%7lu TURN:%7lu", (frame * 7) % 101, (frame * 3) % 51, frame * 13,
+            frame);
+    cixl_print(0, 0, status, CIXL_Color_White_Bright, CIXL_Color_Blue, 0);
+    cells = (unsigned long) strlen(status);
+
+    sprintf(status, "FPS:%3lu DRAW:%6lu X:%4lu Y:%4lu", frame % 61, frame * 17 % 100000, frame % (unsigned long) WIDTH,
+            frame % (unsigned long) HEIGHT);
+    cixl_print(0, HEIGHT - 1, status, CIXL_Color_Yellow_Bright, CIXL_Color_Black, bold);
+    return cells + (unsigned long) strlen(status);
+}
+
+/* colour block churn: the screen is divided in blocks, each frame a quarter of the blocks changes its background */
+
+#define BLOCK_WIDTH 8
+#define BLOCK_HEIGHT 4
+
+static unsigned long blocks_frame(const unsigned long frame)
+{
+    unsigned long cells = 0;
+    int           block_x;
+    int           block_y;
+    (void) frame;
+
+    for (block_y = 0; block_y < HEIGHT; block_y += BLOCK_HEIGHT)
+    {
+        for (block_x = 0; block_x < WIDTH; block_x += BLOCK_WIDTH)
+        {
+            uint32_t r = bench_random();
+            if ((r & 3) == 0)
+            {
+                CIXL_Cxl block = {' ', 0, 0, 0};
+                int      x;
+                int      y;
+                block.bg_color = (CIXL_Color) ((r >> 4) & 0x0F);
+
+                for (y = block_y; y < block_y + BLOCK_HEIGHT && y < HEIGHT; ++y)
+                {
+                    for (x = block_x; x < block_x + BLOCK_WIDTH && x < WIDTH; ++x)
+                    {
+                        cixl_put(x, y, block);
+                        ++cells;
+                    }
+                }
+            }
+        }
+    }
+    return cells;
+}
+
+/* dungeon map: a map of rooms (walls, floor and empty space between them) that scrolls one column each frame, like a
+ * roguelike following the player, and every few frames the player takes the stairs to another level */
+
+#define DUNGEON_ROOM_COUNT 40
+#define DUNGEON_LEVEL_COUNT 4
+#define DUNGEON_FRAMES_PER_LEVEL 8
+
+static char *DUNGEON = NULL;
+static int  DUNGEON_WIDTH;
+
+static void dungeon_setup(const int width, const int height)
+{
+    int room;
+    int x;
+    int y;
+
+    DUNGEON_WIDTH = width * 2;
+    DUNGEON       = realloc(DUNGEON, (size_t) DUNGEON_WIDTH * (size_t) height * DUNGEON_LEVEL_COUNT);
+    memset(DUNGEON, ' ', (size_t) DUNGEON_WIDTH * (size_t) height * DUNGEON_LEVEL_COUNT);
+
+    //the levels are below each other
+    for (room = 0; room < DUNGEON_ROOM_COUNT * DUNGEON_LEVEL_COUNT; ++room)
+    {
+        int room_width  = 6 + (int) (bench_random() % 20);
+        int room_height = 4 + (int) (bench_random() % 8);
+        int room_x      = (int) (bench_random() % (uint32_t) DUNGEON_WIDTH);
+        int level       = room / DUNGEON_ROOM_COUNT;
+        int room_y      = level * height + (int) (bench_random() % (uint32_t) height);
+
+        for (y = room_y; y < room_y + room_height && y < (level + 1) * height; ++y)
+        {
+            for (x = room_x; x < room_x + room_width && x < DUNGEON_WIDTH; ++x)
+            {
+                bool is_wall = y == room_y || y == room_y + room_height - 1 || x == room_x ||
+                               x == room_x + room_width - 1;
+                DUNGEON[y * DUNGEON_WIDTH + x] = is_wall ? '#' : '.';
+            }
+        }
+    }
+}
+
+static unsigned long dungeon_frame(const unsigned long frame)
+{
+    int offset = (int) (frame % (unsigned long) DUNGEON_WIDTH);
+    int level  = (int) ((frame / DUNGEON_FRAMES_PER_LEVEL) % DUNGEON_LEVEL_COUNT);
+    int x;
+    int y;
+
+    for (y = 0; y < HEIGHT; ++y)
+    {
+        for (x = 0; x < WIDTH; ++x)
+        {
+            CIXL_Cxl cell = {0, CIXL_Color_Grey, CIXL_Color_Black, 0};
+            cell.char_value = DUNGEON[(level * HEIGHT + y) * DUNGEON_WIDTH + ((x + offset) % DUNGEON_WIDTH)];
+            if (cell.char_value == '#')
+            {
+                cell.fg_color = CIXL_Color_Yellow;
+            }
+            cixl_put(x, y, cell);
+        }
+    }
+    return (unsigned long) WIDTH * HEIGHT;
+}
+
+/* replay: a recording of a real session */
+
+static CIXL_Replay *REPLAY = NULL;
+
+static void replay_prepare(const unsigned long frame)
+{
+    (void) frame;
+    if (!cixl_replay_next(REPLAY))
+    {
+        cixl_replay_seek(REPLAY, 0);
+    }
+}
+
+static unsigned long replay_frame(const unsigned long frame)
+{
+    (void) frame;
+    return (unsigned long) cixl_replay_put_frame(REPLAY);
+}
+
+static const BenchWorkload WORKLOADS[] = {{"sparse_sprites", "cixl_put",   sprites_setup, NULL, sprites_frame},
+                                          {"full_noise",     "cixl_put",   setup_nothing, NULL, noise_frame},
+                                          {"scrolling_text", "cixl_print", scroll_setup,  NULL, scroll_frame},
+                                          {"hud_counters",   "cixl_print", setup_nothing, NULL, hud_frame},
+                                          {"color_blocks",   "cixl_put",   setup_nothing, NULL, blocks_frame},
+                                          {"dungeon_map",    "cixl_put",   dungeon_setup, NULL, dungeon_frame}};
+
+#define WORKLOAD_COUNT (sizeof(WORKLOADS) / sizeof(WORKLOADS[0]))
+
+static const BenchWorkload REPLAY_WORKLOAD = {"replay", "cixl_put", setup_nothing, replay_prepare, replay_frame};
+
+static BenchResult bench_run(const BenchWorkload *workload, const int width, const int height, unsigned long frames)
+{
+    BenchResult   result;
+    unsigned long frame;
+
+    memset(&result, 0, sizeof(result));
+    result.workload = workload;
+    result.width    = width;
+    result.height   = height;
+
+    if (frames == 0)
+    {
+        frames = BENCH_CELLS_PER_RUN / ((unsigned long) width * (unsigned long) height);
+        if (frames < BENCH_MIN_FRAMES)
+        {
+            frames = BENCH_MIN_FRAMES;
+        }
+    }
+    result.frames = frames;
+
+    WIDTH        = width;
+    HEIGHT       = height;
+    RANDOM_STATE = 2463534242UL;
+    if (BENCH_VT)
+    {
+        VT_MODEL = cixl_vt_model_create(width, height);
+        cixl_init_screen_buffer(width, height, cixl_vt_device(bench_vt_write));
+        cixl_vt_set_capabilities(BENCH_VT_CAPS);
+    }
+    else
+    {
+        cixl_init_screen_buffer(width, height, cixl_counting_device());
+    }
+    workload->f_setup(width, height);
+
+    for (frame = 0; frame < BENCH_WARMUP_FRAMES + frames; ++frame)
+    {
+        uint64_t          start;
+        uint64_t          written;
+        uint64_t          rendered;
+        CIXL_PerfCounters perf_start;
+        CIXL_PerfCounters perf_written;
+        CIXL_PerfCounters perf_rendered;
+
+        if (frame == BENCH_WARMUP_FRAMES)
+        {
+            cixl_counting_device_reset();
+            if (VT_MODEL != NULL)
+            {
+                memset(&VT_MODEL->stats, 0, sizeof(VT_MODEL->stats));
+            }
+            result.write_ns      = 0;
+            result.render_ns     = 0;
+            result.cells_written = 0;
+            memset(&result.write_perf, 0, sizeof(result.write_perf));
+            memset(&result.render_perf, 0, sizeof(result.render_perf));
+        }
+
+        if (workload->f_prepare != NULL)
+        {
+            workload->f_prepare(frame);
+        }
+
+        if (BENCH_PERF)
+        {
+            perf_start = cixl_perf_read();
+        }
+        start = cixl_monotonic_ns();
+        result.cells_written += workload->f_frame(frame);
+        written = cixl_monotonic_ns();
+        if (BENCH_PERF)
+        {
+            perf_written = cixl_perf_read();
+        }
+        cixl_render();
+        rendered = cixl_monotonic_ns();
+        if (BENCH_PERF)
+        {
+            perf_rendered = cixl_perf_read();
+            cixl_perf_add_delta(&result.write_perf, &perf_start, &perf_written);
+            cixl_perf_add_delta(&result.render_perf, &perf_written, &perf_rendered);
+        }
+
+        result.write_ns += written - start;
+        result.render_ns += rendered - written;
+
+        if (VT_MODEL != NULL && cixl_vt_model_compare_screen(VT_MODEL, NULL) != 0)
+        {
+            ++result.vt_mismatched_frames;
+        }
+    }
+
+    result.counters = cixl_counting_device_counters();
+    if (VT_MODEL != NULL)
+    {
+        result.vt_stats = VT_MODEL->stats;
+        cixl_vt_model_free(VT_MODEL);
+        VT_MODEL = NULL;
+    }
+    cixl_free_screen_buffer();
+    return result;
+}
+
+static double per(const uint64_t value, const uint64_t count)
+{
+    return count == 0 ? 0.0 : (double) value / (double) count;
+}
+
+/* The perf columns and fields, only with --perf: per cell of the writes and of the screen (like the ns per cell) */
+static void print_perf_table_header()
+{
+    printf(" %10s %10s %10s %10s %10s %10s %8s", "w instr/c", "w cmiss/c", "w bmiss/c", "r instr/c", "r cmiss/c",
+           "r bmiss/c", "r ipc");
+}
+
+static void print_perf_table_row(const BenchResult *result)
+{
+    const uint64_t area = (uint64_t) result->width * (uint64_t) result->height * result->frames;
+
+    printf(" %10.2f %10.4f %10.4f %10.2f %10.4f %10.4f %8.2f",
+           per(result->write_perf.values[CIXL_PERF_INSTRUCTIONS], result->cells_written),
+           per(result->write_perf.values[CIXL_PERF_CACHE_MISSES], result->cells_written),
+           per(result->write_perf.values[CIXL_PERF_BRANCH_MISSES], result->cells_written),
+           per(result->render_perf.values[CIXL_PERF_INSTRUCTIONS], area),
+           per(result->render_perf.values[CIXL_PERF_CACHE_MISSES], area),
+           per(result->render_perf.values[CIXL_PERF_BRANCH_MISSES], area),
+           per(result->render_perf.values[CIXL_PERF_INSTRUCTIONS], result->render_perf.values[CIXL_PERF_CYCLES]));
+}
+
+static void print_perf_json(const BenchResult *result)
+{
+    const uint64_t area = (uint64_t) result->width * (uint64_t) result->height * result->frames;
+    int            counter;
+
+    printf(", \"perf\": {");
+    for (counter = 0; counter < CIXL_PERF_COUNTER_COUNT; ++counter)
+    {
+        //null for the counters that are not available, so they are not mistaken for 0
+        if (cixl_perf_available() & CIXL_PERF_BIT(counter))
+        {
+            printf("%s\"write_%s_per_cell\": %.4f, \"render_%s_per_cell\": %.4f", counter == 0 ? "" : ", ",
+                   cixl_perf_counter_name(counter), per(result->write_perf.values[counter], result->cells_written),
+                   cixl_perf_counter_name(counter), per(result->render_perf.values[counter], area));
+        }
+        else
+        {
+            printf("%s\"write_%s_per_cell\": null, \"render_%s_per_cell\": null", counter == 0 ? "" : ", ",
+                   cixl_perf_counter_name(counter), cixl_perf_counter_name(counter));
+        }
+    }
+    printf("}");
+}
+
+static void print_table_header()
+{
+    if (BENCH_VT)
+    {
+        printf("%-16s %9s %8s %-11s %12s %14s %12s %12s %12s %10s %10s", "workload", "size", "frames", "write_api",
+               "write ns/cell", "render ns/cell", "written/frm", "vt bytes/frm", "printed/frm", "cup/frm", "sgr/frm");
+    }
+    else
+    {
+        printf("%-16s %9s %8s %-11s %12s %14s %12s %12s %12s", "workload", "size", "frames", "write_api",
+               "write ns/cell", "render ns/cell", "written/frm", "drawn/frm", "calls/frm");
+    }
+    if (BENCH_PERF)
+    {
+        print_perf_table_header();
+    }
+    printf("\n");
+}
+
+static void print_table_row(const BenchResult *result)
+{
+    char           size[24];
+    const uint64_t area = (uint64_t) result->width * (uint64_t) result->height;
+
+    sprintf(size, "%ix%i", result->width, result->height);
+    if (BENCH_VT)
+    {
+        printf("%-16s %9s %8lu %-11s %12.2f %14.2f %12.1f %12.1f %12.1f %10.1f %10.1f", result->workload->name,
+               size, result->frames, result->workload->write_api, per(result->write_ns, result->cells_written),
+               per(result->render_ns, area * result->frames), per(result->cells_written, result->frames),
+               per(result->vt_stats.bytes, result->frames), per(result->vt_stats.printed_bytes, result->frames),
+               per(result->vt_stats.cursor_moves, result->frames), per(result->vt_stats.sgr_changes, result->frames));
+    }
+    else
+    {
+        printf("%-16s %9s %8lu %-11s %12.2f %14.2f %12.1f %12.1f %12.1f", result->workload->name, size,
+               result->frames, result->workload->write_api, per(result->write_ns, result->cells_written),
+               per(result->render_ns, area * result->frames), per(result->cells_written, result->frames),
+               per(result->counters.cells, result->frames),
+               per(result->counters.draw_cxl_calls + result->counters.draw_horiz_s_calls, result->frames));
+    }
+    if (BENCH_PERF)
+    {
+        print_perf_table_row(result);
+    }
+    printf("%s\n", result->vt_mismatched_frames > 0 ? " MISMATCH" : "");
+}
+
+static void print_json(const BenchResult *result, const bool is_first)
+{
+    const uint64_t area = (uint64_t) result->width * (uint64_t) result->height;
+
+    if (BENCH_VT)
+    {
+        printf("%s\n  {\"workload\": \"%s\", \"width\": %i, \"height\": %i, \"frames\": %lu, \"device\": \"vt\", "
+               "\"%s_ns_per_cell\": %.3f, \"cixl_render_ns_per_cell\": %.3f, \"cells_written_per_frame\": %.1f, "
+               "\"bytes_per_frame\": %.1f, \"printed_bytes_per_frame\": %.1f, \"cursor_moves_per_frame\": %.1f, "
+               "\"sgr_changes_per_frame\": %.1f, \"mismatched_frames\": %lu",
+               is_first ? "" : ",", result->workload->name, result->width, result->height, result->frames,
+               result->workload->write_api, per(result->write_ns, result->cells_written),
+               per(result->render_ns, area * result->frames), per(result->cells_written, result->frames),
+               per(result->vt_stats.bytes, result->frames), per(result->vt_stats.printed_bytes, result->frames),
+               per(result->vt_stats.cursor_moves, result->frames), per(result->vt_stats.sgr_changes, result->frames),
+               result->vt_mismatched_frames);
+    }
+    else
+    {
+        printf("%s\n  {\"workload\": \"%s\", \"width\": %i, \"height\": %i, \"frames\": %lu, "
+               "\"%s_ns_per_cell\": %.3f, \"cixl_render_ns_per_cell\": %.3f, "
+               "\"cells_written_per_frame\": %.1f, \"cells_drawn_per_frame\": %.1f, \"draw_calls_per_frame\": %.1f, "
+               "\"bytes_per_frame\": %.1f",
+               is_first ? "" : ",", result->workload->name, result->width, result->height, result->frames,
+               result->workload->write_api, per(result->write_ns, result->cells_written),
+               per(result->render_ns, area * result->frames), per(result->cells_written, result->frames),
+               per(result->counters.cells, result->frames),
+               per(result->counters.draw_cxl_calls + result->counters.draw_horiz_s_calls, result->frames),
+               per(result->counters.bytes, result->frames));
+    }
+    if (BENCH_PERF)
+    {
+        print_perf_json(result);
+    }
+    printf("}");
+}
+
+static void report(const BenchResult *result, const bool as_json, int *report_count)
+{
+    if (as_json)
+    {
+        print_json(result, *report_count == 0);
+    }
+    else
+    {
+        print_table_row(result);
+    }
+    if (result->vt_mismatched_frames > 0)
+    {
+        VT_MISMATCH_FOUND = true;
+    }
+    ++(*report_count);
+}
+
+static int print_usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [--json] [--vt] [--term name] [--perf] [--workload name] [--size WIDTHxHEIGHT] "
+                    "[--frames n] [--replay recording]\n", program);
+    return 2;
+}
+
+int main(int argc, char **argv)
+{
+    bool          as_json      = false;
+    const char    *only_name   = NULL;
+    const char    *replay_path = NULL;
+    int           only_width   = 0;
+    int           only_height  = 0;
+    unsigned long frames       = 0;
+    int           report_count = 0;
+    unsigned int  w;
+    unsigned int  s;
+    int           i;
+
+    for (i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--json") == 0)
+        {
+            as_json = true;
+        }
+        else if (strcmp(argv[i], "--vt") == 0)
+        {
+            BENCH_VT = true;
+        }
+        else if (strcmp(argv[i], "--term") == 0 && i + 1 < argc)
+        {
+            BENCH_VT_CAPS = cixl_vt_caps_profile(argv[++i], NULL);
+        }
+        else if (strcmp(argv[i], "--perf") == 0)
+        {
+            BENCH_PERF = true;
+        }
+        else if (strcmp(argv[i], "--workload") == 0 && i + 1 < argc)
+        {
+            only_name = argv[++i];
+        }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%ix%i", &only_width, &only_height) != 2)
+            {
+                return print_usage(argv[0]);
+            }
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            frames = strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            replay_path = argv[++i];
+        }
+        else
+        {
+            return print_usage(argv[0]);
+        }
+    }
+
+    if (BENCH_PERF && cixl_perf_open() == 0)
+    {
+        fprintf(stderr, "hardware performance counters are not available, running without them\n");
+        BENCH_PERF = false;
+    }
+
+    if (as_json)
+    {
+        printf("[");
+    }
+    else
+    {
+        print_table_header();
+    }
+
+    for (w = 0; w < WORKLOAD_COUNT; ++w)
+    {
+        if (only_name != NULL && strcmp(only_name, WORKLOADS[w].name) != 0)
+        {
+            continue;
+        }
+
+        for (s = 0; s < BENCH_SIZE_COUNT; ++s)
+        {
+            BenchResult result;
+
+            if (only_width > 0 && (BENCH_SIZES[s].width != only_width || BENCH_SIZES[s].height != only_height))
+            {
+                continue;
+            }
+
+            result = bench_run(&WORKLOADS[w], BENCH_SIZES[s].width, BENCH_SIZES[s].height, frames);
+            report(&result, as_json, &report_count);
+        }
+    }
+
+    if (replay_path != NULL && (only_name == NULL || strcmp(only_name, REPLAY_WORKLOAD.name) == 0))
+    {
+        BenchResult result;
+
+        REPLAY = cixl_replay_open(replay_path);
+        if (REPLAY == NULL || REPLAY->frame_count == 0)
+        {
+            fprintf(stderr, "could not read recording %s\n", replay_path);
+            return 1;
+        }
+
+        result = bench_run(&REPLAY_WORKLOAD, REPLAY->width, REPLAY->height,
+                           frames > 0 ? frames : (unsigned long) REPLAY->frame_count);
+        report(&result, as_json, &report_count);
+        cixl_replay_close(REPLAY);
+    }
+
+    if (as_json)
+    {
+        printf("\n]\n");
+    }
+
+    free(SCROLL_LINES);
+    cixl_perf_close();
+    if (VT_MISMATCH_FOUND)
+    {
+        fprintf(stderr, "the vt output did not produce the same screen as the screen buffer\n");
+        return 1;
+    }
+    return 0;
+}
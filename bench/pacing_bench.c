@@ -0,0 +1,105 @@
+/*! \file
+ * \brief Measures the frame pacing: runs frames at a target rate and reports how far from their deadline the frames
+ * are and the jitter of the frame intervals, for the pacing engine and for a plain millisecond sleep. The processor time
+ * shows that the pacing does not spin the whole frame.
+ * usage: libcixl-bench-pacing [frames] [frames per second]
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../src/libcixl.h"
+#include "../src/libcixl/std/cixl_stdtime.h"
+#include "../src/libcixl/std/cixl_sleep.h"
+
+/*! plain sleep, how the game loop waited before the pacing engine */
+static void sleep_until(const uint64_t deadline_ns)
+{
+    uint64_t now = cixl_monotonic_ns();
+    if (deadline_ns > now)
+    {
+        unsigned int ms = (unsigned int) ((deadline_ns - now) / 1000000u);
+        cixl_sleep_ms(ms > 0 ? ms : 1);
+    }
+}
+
+static int compare_u64(const void *left, const void *right)
+{
+    uint64_t l = *(const uint64_t *) left;
+    uint64_t r = *(const uint64_t *) right;
+    return l < r ? -1 : (l > r ? 1 : 0);
+}
+
+static void run(const char *name, const unsigned long frames, const uint64_t interval_ns, const int use_pacing)
+{
+    CIXL_PacingStats stats;
+    uint64_t         deadline   = cixl_monotonic_ns();
+    uint64_t         *late      = malloc(frames * sizeof(uint64_t));
+    clock_t          cpu_start  = clock();
+    uint64_t         wall_start = cixl_monotonic_ns();
+    double           cpu_percentage;
+    unsigned long    i;
+
+    if (late == NULL)
+    {
+        return;
+    }
+
+    cixl_pacing_reset_stats();
+    for (i = 0; i < frames; ++i)
+    {
+        uint64_t now;
+
+        deadline += interval_ns;
+        if (use_pacing)
+        {
+            cixl_pacing_wait_until_ns(deadline);
+        }
+        else
+        {
+            sleep_until(deadline);
+        }
+
+        now = cixl_monotonic_ns();
+        late[i] = now > deadline ? now - deadline : deadline - now;
+        cixl_pacing_frame_mark();
+    }
+
+    cpu_percentage = 100.0 * ((double) (clock() - cpu_start) / CLOCKS_PER_SEC) /
+                     ((double) (cixl_monotonic_ns() - wall_start) / 1e9);
+    stats          = cixl_pacing_stats();
+    qsort(late, frames, sizeof(uint64_t), compare_u64);
+
+    printf("%-8s error p50 %8.1f us  p99 %8.1f us  max %8.1f us | interval %8.1f us  jitter %7.1f us | cpu %5.1f%%\n",
+           name, (double) late[frames / 2] / 1000.0, (double) late[(frames * 99) / 100] / 1000.0,
+           (double) late[frames - 1] / 1000.0,
+           (double) stats.frame_interval_mean_ns / 1000.0, (double) stats.frame_jitter_ns / 1000.0, cpu_percentage);
+    if (use_pacing)
+    {
+        printf("         overshoot estimate %.1f us, slept %.1f%%, spun %.1f%%\n",
+               (double) stats.overshoot_estimate_ns / 1000.0,
+               100.0 * (double) stats.sleep_ns / (double) (interval_ns * frames),
+               100.0 * (double) stats.spin_ns / (double) (interval_ns * frames));
+    }
+    free(late);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long frames = argc > 1 ? strtoul(argv[1], NULL, 10) : 300;
+    unsigned long fps    = argc > 2 ? strtoul(argv[2], NULL, 10) : 60;
+
+    if (frames == 0 || fps == 0)
+    {
+        fprintf(stderr, "usage: %s [frames] [frames per second]\n", argv[0]);
+        return 2;
+    }
+
+    printf("pacing %lu frames at %lu fps\n", frames, fps);
+    run("sleep", frames, 1000000000u / fps, 0);
+    run("pacing", frames, 1000000000u / fps, 1);
+    return 0;
+}
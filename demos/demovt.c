@@ -119,7 +119,7 @@ void draw_cixl_s(const int start_x, const int start_y, char *str, unsigned const
     puts(str);
 }
 
-static CIXL_RenderDevice VT_RENDER_DEVICE = {draw_cixl, draw_cixl_s};
+static CIXL_RenderDevice VT_RENDER_DEVICE = {draw_cixl, draw_cixl_s, NULL, NULL, NULL};
 static const char        HEADER_S[44]     = "[Ruzzie Termlib ANSI VT Demo & Test program]";
 static const char        INFO_LINE_S[27]  = "            press x to exit";
 
@@ -151,7 +151,7 @@ void update(const CIXL_GameTime *game_time, int *shared_state)
     }
 
     sprintf(STATS_PER_SECONDS_S, "[%u](s:%i)|[elms:%lu][t_ticks:%lu][lag:%i][step:%i]", game_time->current_fps,
-            (game_time->is_running_slowly), game_time->elapsed_game_time_ms, game_time->total_game_time_ticks,
+            (game_time->is_running_slowly), game_time->elapsed_game_time_ms, (unsigned long) game_time->total_game_time_ticks,
             game_time->frame_lag, game_time->step_count);
 
     cixl_print(0, 0, STATS_PER_SECONDS_S, 0, CIXL_Color_Grey, 0);
@@ -172,7 +172,7 @@ int main(void)
 {
     char clock_info_s[48];
 
-    GAME = cixl_game_create(CLOCKS_PER_SEC);
+    GAME = cixl_game_create();
     #ifdef __DOS__
     //For now since custom interrupt timers are not (yet?) implemented, set dos to a target time rate of 18 fps
     GAME->is_fixed_time_step         = true;
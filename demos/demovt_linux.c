@@ -0,0 +1,172 @@
+/*! \file
+ * \brief Demo VT Console for Linux that uses libcixl with the native Linux terminal backend (see linux_term.h).
+ * Move the @ with the arrow keys or the mouse, paste text, resize the terminal, press x to exit.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * document with https://www.doxygen.nl/manual/docblocks.html#cppblock
+ * */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+struct DemoState;
+#define CIXL_GAME_STATE_TYPE struct DemoState
+
+#include "../src/libcixl.h"
+
+typedef struct DemoState
+{
+    int  player_x;
+    int  player_y;
+    int  width;
+    int  height;
+    bool needs_full_draw;
+    char last_input_s[64];
+} DemoState;
+
+static const char HEADER_S[]    = "[Ruzzie Termlib ANSI VT Demo & Test program - Linux]";
+static const char INFO_LINE_S[] = "arrows or mouse to move, paste some text, press x to exit";
+
+static CIXL_Cxl  PLAYER = {'@', CIXL_Color_White_Bright, CIXL_Color_Black, 0};
+static CIXL_Game *GAME;
+static char      STATS_PER_SECONDS_S[96];
+
+static int clamp(const int value, const int min, const int max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+static void handle_input(const CIXL_GameTime *game_time, DemoState *state)
+{
+    CIXL_InputEvent event;
+    char            pasted[21]; //the start of a paste, fits in last_input_s
+    size_t          pasted_size;
+
+    cixl_linux_term_poll(0);
+    while (cixl_input_poll(game_time, &event))
+    {
+        switch (event.type)
+        {
+            case CIXL_INPUT_KEY:
+                if (event.code == 'x' || (event.code == 'c' && (event.modifiers & CIXL_MOD_CTRL)))
+                {
+                    GAME->f_exit_game();
+                }
+                else if (event.code == CIXL_KEY_UP)
+                {
+                    --state->player_y;
+                }
+                else if (event.code == CIXL_KEY_DOWN)
+                {
+                    ++state->player_y;
+                }
+                else if (event.code == CIXL_KEY_LEFT)
+                {
+                    --state->player_x;
+                }
+                else if (event.code == CIXL_KEY_RIGHT)
+                {
+                    ++state->player_x;
+                }
+                snprintf(state->last_input_s, sizeof(state->last_input_s), "key: %lu mod: %u", (unsigned long) event.code,
+                         event.modifiers);
+                break;
+            case CIXL_INPUT_MOUSE:
+                if ((event.code & CIXL_MOUSE_RELEASED) == 0 && (event.code & 3u) == CIXL_MOUSE_LEFT)
+                {
+                    state->player_x = event.x;
+                    state->player_y = event.y;
+                }
+                snprintf(state->last_input_s, sizeof(state->last_input_s), "mouse: %lu at %li,%li",
+                         (unsigned long) event.code, (long) event.x, (long) event.y);
+                break;
+            case CIXL_INPUT_PASTE:
+                pasted_size = cixl_input_paste(pasted, sizeof(pasted) - 1);
+                pasted[pasted_size] = '\0';
+                snprintf(state->last_input_s, sizeof(state->last_input_s), "paste: %lu bytes '%s'",
+                         (unsigned long) event.code, pasted);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void update(const CIXL_GameTime *game_time, DemoState *state)
+{
+    int previous_x = state->player_x;
+    int previous_y = state->player_y;
+
+    if (cixl_linux_term_check_resize())
+    {
+        cixl_linux_term_size(&state->width, &state->height);
+        state->needs_full_draw = true;
+    }
+
+    handle_input(game_time, state);
+    state->player_x = clamp(state->player_x, 0, state->width - 1);
+    state->player_y = clamp(state->player_y, 4, state->height - 1);
+
+    if (state->needs_full_draw)
+    {
+        cixl_print(0, 1, HEADER_S, CIXL_Color_White_Bright, CIXL_Color_Black, 0);
+        cixl_print(0, 2, INFO_LINE_S, CIXL_Color_White_Bright, CIXL_Color_Black, 0);
+        state->needs_full_draw = false;
+    }
+    else if (previous_x != state->player_x || previous_y != state->player_y)
+    {
+        cixl_clear(previous_x, previous_y);
+    }
+    cixl_put(state->player_x, state->player_y, PLAYER);
+
+    snprintf(STATS_PER_SECONDS_S, sizeof(STATS_PER_SECONDS_S), "[%u](s:%i)|[elms:%lu][lag:%i][step:%i][%ix%i]",
+             game_time->current_fps, game_time->is_running_slowly, game_time->elapsed_game_time_ms,
+             game_time->frame_lag, game_time->step_count, state->width, state->height);
+    cixl_clear_area(0, 0, state->width, 1);
+    cixl_print(0, 0, STATS_PER_SECONDS_S, 0, CIXL_Color_Grey, 0);
+    cixl_clear_area(0, 3, state->width, 1);
+    cixl_print(0, 3, state->last_input_s, CIXL_Color_Magenta, CIXL_Color_Black, 0);
+}
+
+void draw(const CIXL_GameTime *game_time, DemoState *state)
+{
+    (void) game_time;
+    (void) state;
+    cixl_render();
+}
+
+int main(void)
+{
+    DemoState state;
+
+    if (!cixl_linux_term_start(STDIN_FILENO, STDOUT_FILENO, CIXL_TERM_INPUT_MOUSE | CIXL_TERM_INPUT_PASTE |
+                                                            CIXL_TERM_INPUT_NO_SIGNALS))
+    {
+        fprintf(stderr, "could not set up the terminal\n");
+        return 1;
+    }
+
+    cixl_linux_term_probe(200);
+
+    memset(&state, 0, sizeof(state));
+    cixl_linux_term_size(&state.width, &state.height);
+    state.player_x        = state.width / 2;
+    state.player_y        = state.height / 2;
+    state.needs_full_draw = true;
+    strcpy(state.last_input_s, "no input yet");
+
+    GAME = cixl_game_create();
+    GAME->is_fixed_time_step         = true;
+    GAME->target_elapsed_time_millis = 16;//60fps
+    GAME->max_elapsed_time_millis    = 500;
+    GAME->f_update_game              = update;
+    GAME->f_draw_game                = draw;
+
+    cixl_game_init(&state);
+    cixl_game_run();//Run the gameloop
+
+    //Cleanup
+    cixl_linux_term_stop();
+    return 0;
+}
@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifdef CIXL_WITH_PTHREADS
+#include <errno.h>
+#include <pthread.h>
+#endif
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdlib.h"
+#include "std/cixl_stdtime.h"
+#include "asciicast.h"
+#include "trace.h"
+
+/* Worst case a byte is escaped as \u00XX */
+#define MAX_ESCAPED_BYTE_SIZE 6
+
+/* Everything of an event except the escaped data: [seconds.micros, "o", ""]\n */
+#define MAX_EVENT_OVERHEAD 48
+
+/* Larger outputs are split into multiple events with the same time, so an event always fits in a buffer */
+#define MAX_EVENT_DATA_SIZE ((CIXL_ASCIICAST_BUFFER_SIZE - MAX_EVENT_OVERHEAD) / MAX_ESCAPED_BYTE_SIZE)
+
+typedef struct CIXL_AsciicastBuffer
+{
+    char   *bytes;
+    size_t size;
+} CIXL_AsciicastBuffer;
+
+static FILE     *CAST_FILE        = NULL;
+static bool     CAST_IS_RECORDING = false;
+static uint64_t CAST_START_NS     = 0;
+
+static CIXL_AsciicastBuffer CAST_BUFFERS[2];
+
+/*The buffer that events are appended to*/
+static CIXL_AsciicastBuffer *CAST_ACTIVE = NULL;
+
+/*The buffer that is handed to the writer, NULL when the writer is idle*/
+static CIXL_AsciicastBuffer *CAST_PENDING = NULL;
+
+/*A single escaped event, before it is appended*/
+static char *CAST_EVENT = NULL;
+
+static const char HEX_DIGITS[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
+
+/*! JSON-escapes the data into dst. Bytes >= 0x80 are written as the code point with the same value (latin-1), since
+ * the output of the vt device is not UTF-8 encoded.
+ * \return the size of the escaped data */
+static size_t asciicast_escape(char *dst, const char *data, const size_t size)
+{
+    size_t i;
+    char   *out = dst;
+
+    for (i = 0; i < size; ++i)
+    {
+        unsigned char c = (unsigned char) data[i];
+
+        if (c >= 0x20 && c < 0x7F && c != '"' && c != '\\')
+        {
+            *out++ = (char) c;
+        }
+        else if (c == '"' || c == '\\')
+        {
+            *out++ = '\\';
+            *out++ = (char) c;
+        }
+        else if (c == '\n')
+        {
+            *out++ = '\\';
+            *out++ = 'n';
+        }
+        else if (c == '\r')
+        {
+            *out++ = '\\';
+            *out++ = 'r';
+        }
+        else
+        {
+            *out++ = '\\';
+            *out++ = 'u';
+            *out++ = '0';
+            *out++ = '0';
+            *out++ = HEX_DIGITS[c >> 4];
+            *out++ = HEX_DIGITS[c & 0x0F];
+        }
+    }
+
+    return (size_t) (out - dst);
+}
+
+static void asciicast_write_buffer(CIXL_AsciicastBuffer *buffer)
+{
+    fwrite(buffer->bytes, 1, buffer->size, CAST_FILE);
+    fflush(CAST_FILE);
+    buffer->size = 0;
+}
+
+static void asciicast_swap_buffers()
+{
+    CAST_PENDING = CAST_ACTIVE;
+    CAST_ACTIVE  = CAST_ACTIVE == &CAST_BUFFERS[0] ? &CAST_BUFFERS[1] : &CAST_BUFFERS[0];
+}
+
+#ifdef CIXL_WITH_PTHREADS
+static pthread_t       CAST_WRITER;
+static pthread_mutex_t CAST_LOCK               = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  CAST_WORK_AVAILABLE     = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  CAST_WORK_DONE          = PTHREAD_COND_INITIALIZER;
+static bool            CAST_WRITER_SHOULD_STOP = false;
+
+static void *asciicast_writer(void *unused)
+{
+    (void) unused;
+    pthread_mutex_lock(&CAST_LOCK);
+    while (true)
+    {
+        if (CAST_PENDING == NULL && !CAST_WRITER_SHOULD_STOP)
+        {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += CIXL_ASCIICAST_FLUSH_INTERVAL_MS / 1000;
+            deadline.tv_nsec += (CIXL_ASCIICAST_FLUSH_INTERVAL_MS % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_nsec -= 1000000000L;
+                ++deadline.tv_sec;
+            }
+
+            if (pthread_cond_timedwait(&CAST_WORK_AVAILABLE, &CAST_LOCK, &deadline) == ETIMEDOUT &&
+                CAST_PENDING == NULL && CAST_ACTIVE->size > 0)
+            {
+                //Nothing was handed over for a while, take what is there
+                asciicast_swap_buffers();
+            }
+        }
+
+        if (CAST_PENDING != NULL)
+        {
+            CIXL_AsciicastBuffer *buffer = CAST_PENDING;
+
+            pthread_mutex_unlock(&CAST_LOCK);
+            cixl_trace_thread_name("asciicast writer");
+            cixl_trace_begin("asciicast write");
+            asciicast_write_buffer(buffer);
+            cixl_trace_end();
+            pthread_mutex_lock(&CAST_LOCK);
+
+            CAST_PENDING = NULL;
+            pthread_cond_broadcast(&CAST_WORK_DONE);
+        }
+        else if (CAST_WRITER_SHOULD_STOP)
+        {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&CAST_LOCK);
+    return NULL;
+}
+
+static void asciicast_append(const char *event, const size_t size)
+{
+    pthread_mutex_lock(&CAST_LOCK);
+    if (CAST_ACTIVE->size + size > CIXL_ASCIICAST_BUFFER_SIZE)
+    {
+        //Only blocks when the writer did not finish the previous buffer yet
+        while (CAST_PENDING != NULL)
+        {
+            pthread_cond_wait(&CAST_WORK_DONE, &CAST_LOCK);
+        }
+        asciicast_swap_buffers();
+        pthread_cond_signal(&CAST_WORK_AVAILABLE);
+    }
+    memcpy(&CAST_ACTIVE->bytes[CAST_ACTIVE->size], event, size);
+    CAST_ACTIVE->size += size;
+    pthread_mutex_unlock(&CAST_LOCK);
+}
+
+static bool asciicast_start_writer()
+{
+    CAST_WRITER_SHOULD_STOP = false;
+    return pthread_create(&CAST_WRITER, NULL, asciicast_writer, NULL) == 0;
+}
+
+static void asciicast_stop_writer()
+{
+    pthread_mutex_lock(&CAST_LOCK);
+    CAST_WRITER_SHOULD_STOP = true;
+    pthread_cond_signal(&CAST_WORK_AVAILABLE);
+    pthread_mutex_unlock(&CAST_LOCK);
+    pthread_join(CAST_WRITER, NULL);
+}
+#else
+static void asciicast_append(const char *event, const size_t size)
+{
+    if (CAST_ACTIVE->size + size > CIXL_ASCIICAST_BUFFER_SIZE)
+    {
+        asciicast_write_buffer(CAST_ACTIVE);
+    }
+    memcpy(&CAST_ACTIVE->bytes[CAST_ACTIVE->size], event, size);
+    CAST_ACTIVE->size += size;
+}
+
+static bool asciicast_start_writer()
+{
+    return true;
+}
+
+static void asciicast_stop_writer()
+{
+}
+#endif
+
+static void asciicast_free_buffers()
+{
+    cixl_mem_free(CAST_BUFFERS[0].bytes);
+    cixl_mem_free(CAST_BUFFERS[1].bytes);
+    cixl_mem_free(CAST_EVENT);
+    CAST_BUFFERS[0].bytes = NULL;
+    CAST_BUFFERS[1].bytes = NULL;
+    CAST_EVENT            = NULL;
+}
+
+bool cixl_asciicast_start(const char *file_path, const int width, const int height)
+{
+    if (CAST_IS_RECORDING)
+    {
+        return false;
+    }
+
+    CAST_BUFFERS[0].bytes = cixl_mem_alloc(CIXL_ASCIICAST_BUFFER_SIZE, sizeof(char));
+    CAST_BUFFERS[1].bytes = cixl_mem_alloc(CIXL_ASCIICAST_BUFFER_SIZE, sizeof(char));
+    CAST_EVENT            = cixl_mem_alloc(CIXL_ASCIICAST_BUFFER_SIZE, sizeof(char));
+    CAST_BUFFERS[0].size  = 0;
+    CAST_BUFFERS[1].size  = 0;
+    CAST_ACTIVE           = &CAST_BUFFERS[0];
+    CAST_PENDING          = NULL;
+
+    if (CAST_BUFFERS[0].bytes == NULL || CAST_BUFFERS[1].bytes == NULL || CAST_EVENT == NULL)
+    {
+        asciicast_free_buffers();
+        return false;
+    }
+
+    CAST_FILE = fopen(file_path, "wb");
+    if (CAST_FILE == NULL)
+    {
+        asciicast_free_buffers();
+        return false;
+    }
+
+    fprintf(CAST_FILE, "{\"version\": 2, \"width\": %i, \"height\": %i, \"timestamp\": %lu, "
+                       "\"env\": {\"TERM\": \"xterm-256color\"}}\n", width, height, (unsigned long) time(NULL));
+
+    if (!asciicast_start_writer())
+    {
+        fclose(CAST_FILE);
+        asciicast_free_buffers();
+        return false;
+    }
+
+    CAST_START_NS     = cixl_monotonic_ns();
+    CAST_IS_RECORDING = true;
+    return true;
+}
+
+size_t cixl_asciicast_write(const char *bytes, const size_t size)
+{
+    uint64_t      elapsed_us;
+    unsigned long seconds;
+    unsigned long micros;
+    size_t        offset = 0;
+
+    if (!CAST_IS_RECORDING)
+    {
+        return 0;
+    }
+
+    elapsed_us = (cixl_monotonic_ns() - CAST_START_NS) / 1000u;
+    seconds    = (unsigned long) (elapsed_us / 1000000u);
+    micros     = (unsigned long) (elapsed_us % 1000000u);
+
+    while (offset < size)
+    {
+        size_t data_size  = size - offset > MAX_EVENT_DATA_SIZE ? MAX_EVENT_DATA_SIZE : size - offset;
+        size_t event_size = (size_t) sprintf(CAST_EVENT, "[%lu.%06lu, \"o\", \"", seconds, micros);
+
+        event_size += asciicast_escape(&CAST_EVENT[event_size], &bytes[offset], data_size);
+        CAST_EVENT[event_size++] = '"';
+        CAST_EVENT[event_size++] = ']';
+        CAST_EVENT[event_size++] = '\n';
+
+        asciicast_append(CAST_EVENT, event_size);
+        offset += data_size;
+    }
+
+    return size;
+}
+
+bool cixl_asciicast_stop()
+{
+    if (!CAST_IS_RECORDING)
+    {
+        return false;
+    }
+
+    asciicast_stop_writer();
+    if (CAST_ACTIVE->size > 0)
+    {
+        asciicast_write_buffer(CAST_ACTIVE);
+    }
+
+    fclose(CAST_FILE);
+    asciicast_free_buffers();
+    CAST_FILE         = NULL;
+    CAST_IS_RECORDING = false;
+    return true;
+}
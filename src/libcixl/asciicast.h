@@ -0,0 +1,54 @@
+/*! \file
+ * \brief asciicast v2 session recorder (https://github.com/asciinema/asciinema/blob/develop/doc/asciicast-v2.md).
+ * Appends the VT output of each frame as an output event, so a session can be played back with asciinema and other
+ * standard tooling. Set #cixl_asciicast_write as tap on the VT device with #cixl_vt_set_tap.
+ *
+ * Recording is meant to be cheap for the game loop: events are JSON-escaped into preallocated buffers, and full buffers
+ * are written to the file by a background thread (when built with CIXL_WITH_PTHREADS, otherwise on the calling thread).
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_ASCIICAST_H
+#define LIBCIXL_ASCIICAST_H
+
+#include <stddef.h>
+#include "std/cixl_stdbool.h"
+#include "config.h"
+
+/*! \brief The size of each of the two event buffers. A buffer is handed to the writer when it is full.*/
+#ifndef CIXL_ASCIICAST_BUFFER_SIZE
+#define CIXL_ASCIICAST_BUFFER_SIZE 262144
+#endif
+
+/*! \brief Interval in milliseconds in which the writer writes a partially filled buffer, so a recording is never far
+ * behind.*/
+#ifndef CIXL_ASCIICAST_FLUSH_INTERVAL_MS
+#define CIXL_ASCIICAST_FLUSH_INTERVAL_MS 1000
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Creates the asciicast file, writes the header and starts the writer. Only one recording can be active.
+ * \return false when the file could not be created or a recording is already active.*/
+CIXLLIB_API bool cixl_asciicast_start(const char *file_path, const int width, const int height);
+
+/*! \brief Appends the given terminal output as an output event, timestamped relative to the start of the recording.
+ * This has the #CIXL_VtWrite signature so it can be used as a tap. Returns the number of bytes recorded.*/
+CIXLLIB_API size_t cixl_asciicast_write(const char *bytes, const size_t size);
+
+/*! \brief Writes all pending events, stops the writer and closes the file.*/
+CIXLLIB_API bool cixl_asciicast_stop();
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_ASCIICAST_H
+
+#pragma clang diagnostic pop
@@ -1,4 +1,7 @@
 #include "colors.h"
+#include "screen_buffer.h"
+
+#define COLOR_TABLE_SIZE 256
 
 const CIXL_Color Black          = CIXL_Color_Black;
 const CIXL_Color Red            = CIXL_Color_Red;
@@ -17,7 +20,7 @@ const CIXL_Color Magenta_Bright = CIXL_Color_Magenta_Bright;
 const CIXL_Color Cyan_Bright    = CIXL_Color_Cyan_Bright;
 const CIXL_Color White_Bright   = CIXL_Color_White_Bright;
 
-/*const CIXL_Color Grey_0  = 232;
+const CIXL_Color Grey_0  = 232;
 const CIXL_Color Grey_1  = 233;
 const CIXL_Color Grey_2  = 234;
 const CIXL_Color Grey_3  = 235;
@@ -40,4 +43,161 @@ const CIXL_Color Grey_19 = 251;
 const CIXL_Color Grey_20 = 252;
 const CIXL_Color Grey_21 = 253;
 const CIXL_Color Grey_22 = 254;
-const CIXL_Color Grey_23 = 255;*/
+const CIXL_Color Grey_23 = 255;
+
+static const uint8_t VGA_COLORS[16][3] = {
+        {0x00, 0x00, 0x00}, {0xAA, 0x00, 0x00}, {0x00, 0xAA, 0x00}, {0xAA, 0x55, 0x00},
+        {0x00, 0x00, 0xAA}, {0xAA, 0x00, 0xAA}, {0x00, 0xAA, 0xAA}, {0xAA, 0xAA, 0xAA},
+        {0x55, 0x55, 0x55}, {0xFF, 0x55, 0x55}, {0x55, 0xFF, 0x55}, {0xFF, 0xFF, 0x55},
+        {0x55, 0x55, 0xFF}, {0xFF, 0x55, 0xFF}, {0x55, 0xFF, 0xFF}, {0xFF, 0xFF, 0xFF}
+};
+
+static const uint8_t XTERM_CUBE_LEVELS[6] = {0, 95, 135, 175, 215, 255};
+
+static uint8_t  COLOR_TABLE[COLOR_TABLE_SIZE][3];
+static bool     COLOR_IS_CUSTOM[COLOR_TABLE_SIZE];
+static bool     COLOR_TABLE_IS_SET  = false;
+static uint32_t COLOR_TABLE_VERSION = 0;
+
+/*! the red, green and blue of a color of the xterm palette */
+static void color_xterm_rgb(const int color, uint8_t *rgb)
+{
+    if (color < 16)
+    {
+        rgb[0] = VGA_COLORS[color][0];
+        rgb[1] = VGA_COLORS[color][1];
+        rgb[2] = VGA_COLORS[color][2];
+    }
+    else if (color < 232)
+    {
+        rgb[0] = XTERM_CUBE_LEVELS[(color - 16) / 36];
+        rgb[1] = XTERM_CUBE_LEVELS[((color - 16) / 6) % 6];
+        rgb[2] = XTERM_CUBE_LEVELS[(color - 16) % 6];
+    }
+    else
+    {
+        rgb[0] = (uint8_t) (8 + (color - 232) * 10);
+        rgb[1] = rgb[0];
+        rgb[2] = rgb[0];
+    }
+}
+
+static void color_ensure_table()
+{
+    int i;
+
+    if (COLOR_TABLE_IS_SET)
+    {
+        return;
+    }
+
+    for (i = 0; i < COLOR_TABLE_SIZE; ++i)
+    {
+        color_xterm_rgb(i, COLOR_TABLE[i]);
+        COLOR_IS_CUSTOM[i] = false;
+    }
+    COLOR_TABLE_IS_SET = true;
+}
+
+void cixl_color_set_rgb(const CIXL_Color color, const uint8_t red, const uint8_t green, const uint8_t blue)
+{
+    color_ensure_table();
+
+    COLOR_TABLE[color][0]  = red;
+    COLOR_TABLE[color][1]  = green;
+    COLOR_TABLE[color][2]  = blue;
+    COLOR_IS_CUSTOM[color] = true;
+    ++COLOR_TABLE_VERSION;
+
+    screen_buffer_redraw_color(color);
+}
+
+void cixl_color_rgb(const CIXL_Color color, uint8_t *red, uint8_t *green, uint8_t *blue)
+{
+    color_ensure_table();
+
+    *red   = COLOR_TABLE[color][0];
+    *green = COLOR_TABLE[color][1];
+    *blue  = COLOR_TABLE[color][2];
+}
+
+bool cixl_color_is_custom(const CIXL_Color color)
+{
+    return COLOR_TABLE_IS_SET && COLOR_IS_CUSTOM[color];
+}
+
+void cixl_color_reset_table()
+{
+    int i;
+
+    color_ensure_table();
+
+    for (i = 0; i < COLOR_TABLE_SIZE; ++i)
+    {
+        if (COLOR_IS_CUSTOM[i])
+        {
+            color_xterm_rgb(i, COLOR_TABLE[i]);
+            COLOR_IS_CUSTOM[i] = false;
+            screen_buffer_redraw_color((CIXL_Color) i);
+        }
+    }
+    ++COLOR_TABLE_VERSION;
+}
+
+CIXL_Color cixl_color_nearest(const uint8_t red, const uint8_t green, const uint8_t blue, const int palette_size)
+{
+    const int first         = palette_size > 16 ? 16 : 0;
+    const int last          = palette_size > 16 ? COLOR_TABLE_SIZE : 16;
+    int       nearest       = first;
+    long      best_distance = -1;
+    int       i;
+
+    for (i = first; i < last; ++i)
+    {
+        uint8_t rgb[3];
+        long    dr;
+        long    dg;
+        long    db;
+        long    distance;
+
+        color_xterm_rgb(i, rgb);
+        dr       = (long) red - rgb[0];
+        dg       = (long) green - rgb[1];
+        db       = (long) blue - rgb[2];
+        //the eye is the most sensitive to green and the least to blue
+        distance = 2 * dr * dr + 4 * dg * dg + 3 * db * db;
+        if (best_distance < 0 || distance < best_distance)
+        {
+            nearest       = i;
+            best_distance = distance;
+        }
+    }
+    return (CIXL_Color) nearest;
+}
+
+bool cixl_color_find_rgb(const uint8_t red, const uint8_t green, const uint8_t blue, CIXL_Color *out_color)
+{
+    int pass;
+    int i;
+
+    color_ensure_table();
+
+    for (pass = 0; pass < 2; ++pass)
+    {
+        for (i = 0; i < COLOR_TABLE_SIZE; ++i)
+        {
+            if (COLOR_IS_CUSTOM[i] == (pass == 0) && COLOR_TABLE[i][0] == red && COLOR_TABLE[i][1] == green &&
+                COLOR_TABLE[i][2] == blue)
+            {
+                *out_color = (CIXL_Color) i;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t colors_table_version()
+{
+    return COLOR_TABLE_VERSION;
+}
@@ -2,8 +2,12 @@
 #define LIBCIXL_COLORS_H
 
 #include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
 #include "config.h"
 
+/*! \brief An index in the color table. The table starts as the 256 color palette of xterm: the 16 basic colors (as the
+ * VGA colors), a 6x6x6 color cube and 24 greys. Any entry can be given a 24 bit color with #cixl_color_set_rgb, cells
+ * keep storing the small index so comparing cells stays fast.*/
 typedef uint8_t CIXL_Color;
 
 #define CIXL_Color_Black 0
@@ -41,35 +45,62 @@ extern CIXLLIB_API const CIXL_Color Magenta_Bright;
 extern CIXLLIB_API const CIXL_Color Cyan_Bright;
 extern CIXLLIB_API const CIXL_Color White_Bright;
 
-/*extern const CIXL_Color Grey_0;
-extern const CIXL_Color Grey_1;
-extern const CIXL_Color Grey_2;
-extern const CIXL_Color Grey_3;
-extern const CIXL_Color Grey_4;
-extern const CIXL_Color Grey_5;
-extern const CIXL_Color Grey_6;
-extern const CIXL_Color Grey_7;
-extern const CIXL_Color Grey_8;
-extern const CIXL_Color Grey_9;
-extern const CIXL_Color Grey_10;
-extern const CIXL_Color Grey_11;
-extern const CIXL_Color Grey_12;
-extern const CIXL_Color Grey_13;
-extern const CIXL_Color Grey_14;
-extern const CIXL_Color Grey_15;
-extern const CIXL_Color Grey_16;
-extern const CIXL_Color Grey_17;
-extern const CIXL_Color Grey_18;
-extern const CIXL_Color Grey_19;
-extern const CIXL_Color Grey_20;
-extern const CIXL_Color Grey_21;
-extern const CIXL_Color Grey_22;
-extern const CIXL_Color Grey_23;*/
+extern CIXLLIB_API const CIXL_Color Grey_0;
+extern CIXLLIB_API const CIXL_Color Grey_1;
+extern CIXLLIB_API const CIXL_Color Grey_2;
+extern CIXLLIB_API const CIXL_Color Grey_3;
+extern CIXLLIB_API const CIXL_Color Grey_4;
+extern CIXLLIB_API const CIXL_Color Grey_5;
+extern CIXLLIB_API const CIXL_Color Grey_6;
+extern CIXLLIB_API const CIXL_Color Grey_7;
+extern CIXLLIB_API const CIXL_Color Grey_8;
+extern CIXLLIB_API const CIXL_Color Grey_9;
+extern CIXLLIB_API const CIXL_Color Grey_10;
+extern CIXLLIB_API const CIXL_Color Grey_11;
+extern CIXLLIB_API const CIXL_Color Grey_12;
+extern CIXLLIB_API const CIXL_Color Grey_13;
+extern CIXLLIB_API const CIXL_Color Grey_14;
+extern CIXLLIB_API const CIXL_Color Grey_15;
+extern CIXLLIB_API const CIXL_Color Grey_16;
+extern CIXLLIB_API const CIXL_Color Grey_17;
+extern CIXLLIB_API const CIXL_Color Grey_18;
+extern CIXLLIB_API const CIXL_Color Grey_19;
+extern CIXLLIB_API const CIXL_Color Grey_20;
+extern CIXLLIB_API const CIXL_Color Grey_21;
+extern CIXLLIB_API const CIXL_Color Grey_22;
+extern CIXLLIB_API const CIXL_Color Grey_23;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*! \brief Gives a color of the table a 24 bit color. The cells with this color are drawn again by the next
+ * #cixl_render. The VT render device writes it as a 24 bit color when the terminal supports it, otherwise as the
+ * nearest color of the 256 or 16 color palette.*/
+CIXLLIB_API void cixl_color_set_rgb(const CIXL_Color color, const uint8_t red, const uint8_t green, const uint8_t blue);
+
+/*! \brief The red, green and blue of a color of the table.*/
+CIXLLIB_API void cixl_color_rgb(const CIXL_Color color, uint8_t *red, uint8_t *green, uint8_t *blue);
+
+/*! \brief True when the color was given a 24 bit color with #cixl_color_set_rgb.*/
+CIXLLIB_API bool cixl_color_is_custom(const CIXL_Color color);
+
+/*! \brief Sets all colors of the table back to the xterm palette.*/
+CIXLLIB_API void cixl_color_reset_table();
+
+/*! \brief The color of the xterm palette that looks the most like the given color.
+ * \param palette_size 16 for the basic colors, 256 for the color cube and the greys (the basic colors are skipped,
+ * terminals often change those)*/
+CIXLLIB_API CIXL_Color
+cixl_color_nearest(const uint8_t red, const uint8_t green, const uint8_t blue, const int palette_size);
+
+/*! \brief Finds the color of the table with exactly the given red, green and blue, the colors set with
+ * #cixl_color_set_rgb first.
+ * \return false when no color of the table has it.*/
+CIXLLIB_API bool cixl_color_find_rgb(const uint8_t red, const uint8_t green, const uint8_t blue, CIXL_Color *out_color);
+
+/*! changes every time a color of the table changes, so cached conversions of the table can be renewed */
+uint32_t colors_table_version();
 
 #ifdef __cplusplus
 } /* End of extern "C" */
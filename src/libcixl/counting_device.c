@@ -0,0 +1,124 @@
+#include "counting_device.h"
+
+static CIXL_DeviceCounters COUNTERS = {0, 0, 0, 0, 0};
+
+/*! SGR parameter of each style bit, the same codes a vt terminal gets */
+static const unsigned int STYLE_SGR_MAP[8] = {1, 2, 3, 4, 7, 9, 20, 21};
+
+//The attributes of the previous run, -1 when unknown
+static int LAST_FG    = -1;
+static int LAST_BG    = -1;
+static int LAST_STYLE = -1;
+
+/*! the number of decimal digits of a (small) non negative number */
+static inline unsigned int counting_digits(unsigned int value)
+{
+    unsigned int count = 1;
+
+    while (value >= 10)
+    {
+        value /= 10;
+        ++count;
+    }
+    return count;
+}
+
+/*! the size of the SGR parameters of a color: 30 + n or 90 + n for the 16 basic colors, 38;5;n for the others */
+static inline unsigned int counting_color_size(const CIXL_Color color)
+{
+    return color < 16 ? 2 : 5 + counting_digits((unsigned int) color);
+}
+
+/*! adds the size of the SGR sequence a vt terminal needs to switch to the given attributes, like the vt device
+ * writes it: a full reset when the style changes, otherwise only the colors that changed */
+static void counting_set_style(const CIXL_Color fg_color, const CIXL_Color bg_color, const CIXL_StyleOpts decoration)
+{
+    uint64_t size = 0;
+
+    if (decoration != LAST_STYLE)
+    {
+        int bit;
+        // ESC [ 0 ; fg ; bg m
+        size = 6 + counting_color_size(fg_color) + counting_color_size(bg_color);
+        for (bit = 0; bit < 8; ++bit)
+        {
+            if (decoration & (1 << bit))
+            {
+                size += 1 + counting_digits(STYLE_SGR_MAP[bit]);
+            }
+        }
+    }
+    else if (fg_color != LAST_FG || bg_color != LAST_BG)
+    {
+        // ESC [ m
+        size = 3;
+        if (fg_color != LAST_FG)
+        {
+            size += counting_color_size(fg_color);
+        }
+        if (fg_color != LAST_FG && bg_color != LAST_BG)
+        {
+            ++size;
+        }
+        if (bg_color != LAST_BG)
+        {
+            size += counting_color_size(bg_color);
+        }
+    }
+
+    COUNTERS.bytes += size;
+    LAST_FG    = fg_color;
+    LAST_BG    = bg_color;
+    LAST_STYLE = decoration;
+}
+
+static void counting_draw_cxl(const int start_x, const int start_y, const CIXL_Cxl cxl)
+{
+    (void) start_x;
+    (void) start_y;
+
+    counting_set_style(cxl.fg_color, cxl.bg_color, cxl.style_opts);
+    ++COUNTERS.draw_cxl_calls;
+    ++COUNTERS.cells;
+    ++COUNTERS.bytes;
+}
+
+static void counting_draw_horiz_s(const int start_x, const int start_y, char *str, const unsigned int size,
+                                  const CIXL_Color fg_color, const CIXL_Color bg_color,
+                                  const CIXL_StyleOpts decoration)
+{
+    (void) start_x;
+    (void) start_y;
+    (void) str;
+
+    counting_set_style(fg_color, bg_color, decoration);
+    ++COUNTERS.draw_horiz_s_calls;
+    COUNTERS.cells += size;
+    COUNTERS.bytes += size;
+}
+
+static void counting_end_frame()
+{
+    ++COUNTERS.frames;
+}
+
+static CIXL_RenderDevice COUNTING_DEVICE = {counting_draw_cxl, counting_draw_horiz_s, counting_end_frame, NULL, NULL};
+
+CIXL_RenderDevice *cixl_counting_device()
+{
+    return &COUNTING_DEVICE;
+}
+
+CIXL_DeviceCounters cixl_counting_device_counters()
+{
+    return COUNTERS;
+}
+
+void cixl_counting_device_reset()
+{
+    static const CIXL_DeviceCounters zero = {0, 0, 0, 0, 0};
+    COUNTERS   = zero;
+    LAST_FG    = -1;
+    LAST_BG    = -1;
+    LAST_STYLE = -1;
+}
@@ -0,0 +1,56 @@
+/*! \file
+ * \brief Headless counting render device. A #CIXL_RenderDevice that does not draw anything, but counts the draw calls,
+ * the cxls and the bytes it receives. Useful for benchmarks and tests, and to run a game without a terminal.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_COUNTING_DEVICE_H
+#define LIBCIXL_COUNTING_DEVICE_H
+
+#include "std/cixl_stdint.h"
+#include "config.h"
+#include "screen_buffer.h"
+
+typedef struct CIXL_DeviceCounters
+{
+    /*! \brief Number of f_draw_cxl calls.*/
+    uint64_t draw_cxl_calls;
+
+    /*! \brief Number of f_draw_horiz_s calls.*/
+    uint64_t draw_horiz_s_calls;
+
+    /*! \brief Number of f_end_frame calls, the number of rendered frames that had changes.*/
+    uint64_t frames;
+
+    /*! \brief Number of cxls that were drawn.*/
+    uint64_t cells;
+
+    /*! \brief Number of bytes a vt terminal would get for the drawn cxls: the character data plus an SGR sequence each
+     * time the colors or the style change between draw calls, sized like the #cixl_vt_device writes it with the 16
+     * basic colors. Cursor moves are not counted.*/
+    uint64_t bytes;
+} CIXL_DeviceCounters;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Returns the counting render device, pass it to #cixl_init_screen_buffer.*/
+CIXLLIB_API CIXL_RenderDevice *cixl_counting_device();
+
+/*! \brief Returns the counters since the last #cixl_counting_device_reset.*/
+CIXLLIB_API CIXL_DeviceCounters cixl_counting_device_counters();
+
+CIXLLIB_API void cixl_counting_device_reset();
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_COUNTING_DEVICE_H
+
+#pragma clang diagnostic pop
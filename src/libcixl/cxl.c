@@ -6,21 +6,21 @@ const CIXL_Cxl CXL_EMPTY = {0, 8, 0, 0};
 
 int32_t cixl_pack_cxl(const CIXL_Cxl *cxl)
 {
-    int32_t value = (unsigned char) cxl->char_value;
-    value |= (cxl->fg_color) << 8;
-    value |= (cxl->bg_color) << 12;
-    value |= (((int32_t) cxl->style_opts) << 16);
+    uint32_t value = (unsigned char) cxl->char_value;
+    value |= ((uint32_t) cxl->fg_color) << 8;
+    value |= ((uint32_t) cxl->bg_color) << 16;
+    value |= ((uint32_t) cxl->style_opts) << 24;
 
-    return value;
+    return (int32_t) value;
 }
 
 CIXL_Cxl cixl_unpack_cxl(const int32_t *cxl_ptr)
 {
-    int32_t              int_val = *cxl_ptr;
-    const char           cv      = (char) (int_val & 0x0000FF);
-    const CIXL_Color     fg      = (uint8_t) ((int_val & 0x000F00) >> 8);
-    const CIXL_Color     bg      = (uint8_t) ((int_val & 0x00F000) >> 12);
-    const CIXL_StyleOpts st      = (uint8_t) ((int_val & 0xFF0000) >> 16);
+    uint32_t             int_val = (uint32_t) *cxl_ptr;
+    const char           cv      = (char) (int_val & 0x000000FF);
+    const CIXL_Color     fg      = (uint8_t) ((int_val & 0x0000FF00) >> 8);
+    const CIXL_Color     bg      = (uint8_t) ((int_val & 0x00FF0000) >> 16);
+    const CIXL_StyleOpts st      = (uint8_t) ((int_val & 0xFF000000) >> 24);
 
     const CIXL_Cxl cxl = { cv,fg, bg, st};
     return cxl;
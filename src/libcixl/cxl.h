@@ -1,6 +1,7 @@
 /*! \file
  * \brief Cxl module.
- * A Cxl is a character pixel, with a foreground, background color and some style_opts options.
+ * A Cxl is a character pixel, with a foreground, background color and some style_opts options. The colors are indexes
+ * in the color table (see colors.h), so a Cxl stays 32 bits with 256 or 24 bit colors.
  * \author Dorus Verhoeckx
  * \date 2020
  * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
@@ -16,8 +17,8 @@
 typedef struct CIXL_Cxl
 {
     char           char_value: 8;
-    CIXL_Color     fg_color: 4;
-    CIXL_Color     bg_color: 4;
+    CIXL_Color     fg_color: 8;
+    CIXL_Color     bg_color: 8;
     CIXL_StyleOpts style_opts: 8;
 } CIXL_Cxl;
 
@@ -31,6 +32,8 @@ const CIXL_Cxl CXL_EMPTY{0, 0, 0, 0};
 extern const struct CIXL_Cxl CXL_EMPTY;
 #endif
 
+/*! \brief Packs a Cxl into an int: the char in the lowest byte, then the foreground color, the background color and
+ * the style in the highest byte.*/
 CIXLLIB_API int32_t cixl_pack_cxl(const CIXL_Cxl *cxl);
 
 CIXLLIB_API CIXL_Cxl cixl_unpack_cxl(const int32_t *cxl_ptr);
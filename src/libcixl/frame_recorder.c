@@ -0,0 +1,551 @@
+#include <string.h>
+#include "std/cixl_stdlib.h"
+#include "std/cixl_stdtime.h"
+#include "frame_recorder.h"
+
+#define RECORDING_HEADER_SIZE 16
+#define FRAME_HEADER_SIZE 9
+#define RUN_HEADER_SIZE 9
+#define RECORD_WRITE_BUFFER_SIZE 65536
+
+#define FRAME_KIND_KEYFRAME 'K'
+#define FRAME_KIND_DELTA 'D'
+
+static const char RECORDING_MAGIC[7] = {'C', 'I', 'X', 'L', 'R', 'E', 'C'};
+
+static inline void write_u16(uint8_t *dst, const unsigned int value)
+{
+    dst[0] = (uint8_t) (value & 0xFF);
+    dst[1] = (uint8_t) ((value >> 8) & 0xFF);
+}
+
+static inline void write_u32(uint8_t *dst, const uint32_t value)
+{
+    dst[0] = (uint8_t) (value & 0xFF);
+    dst[1] = (uint8_t) ((value >> 8) & 0xFF);
+    dst[2] = (uint8_t) ((value >> 16) & 0xFF);
+    dst[3] = (uint8_t) ((value >> 24) & 0xFF);
+}
+
+static inline unsigned int read_u16(const uint8_t *src)
+{
+    return (unsigned int) src[0] | ((unsigned int) src[1] << 8);
+}
+
+static inline uint32_t read_u32(const uint8_t *src)
+{
+    return (uint32_t) src[0] | ((uint32_t) src[1] << 8) | ((uint32_t) src[2] << 16) | ((uint32_t) src[3] << 24);
+}
+
+/* Recording */
+
+typedef struct CIXL_Recording
+{
+    FILE              *file;
+    CIXL_RenderDevice *target;
+    int               width;
+    int               height;
+    unsigned int      keyframe_interval;
+    unsigned long     frame_count;
+    uint64_t          start_ns;
+
+    /*! \brief What the screen looks like after the recorded frames, keyframes are written from this.*/
+    CIXL_Cxl *shadow;
+
+    /*! \brief The runs of the frame that is being rendered.*/
+    uint8_t *frame;
+    size_t  frame_size;
+
+    /*! \brief Writes are collected here and written to the file in large blocks.*/
+    uint8_t *write_buffer;
+    size_t  write_buffer_size;
+} CIXL_Recording;
+
+static CIXL_Recording RECORDING;
+static bool           IS_RECORDING = false;
+
+static void record_flush_write_buffer()
+{
+    if (RECORDING.write_buffer_size > 0)
+    {
+        fwrite(RECORDING.write_buffer, 1, RECORDING.write_buffer_size, RECORDING.file);
+        RECORDING.write_buffer_size = 0;
+    }
+}
+
+static void record_write(const uint8_t *bytes, const size_t size)
+{
+    if (RECORDING.write_buffer_size + size > RECORD_WRITE_BUFFER_SIZE)
+    {
+        record_flush_write_buffer();
+    }
+
+    if (size > RECORD_WRITE_BUFFER_SIZE)
+    {
+        //Too large to buffer, write it directly
+        fwrite(bytes, 1, size, RECORDING.file);
+    }
+    else
+    {
+        memcpy(&RECORDING.write_buffer[RECORDING.write_buffer_size], bytes, size);
+        RECORDING.write_buffer_size += size;
+    }
+}
+
+/*! appends the header of a run to the frame that is being recorded
+ * \return where the chars of the run should be written */
+static uint8_t *record_append_run_header(const int x, const int y, const unsigned int size, const CIXL_Color fg_color,
+                                         const CIXL_Color bg_color, const CIXL_StyleOpts decoration)
+{
+    uint8_t *run = &RECORDING.frame[RECORDING.frame_size];
+
+    write_u16(&run[0], (unsigned int) x);
+    write_u16(&run[2], (unsigned int) y);
+    write_u16(&run[4], size);
+    run[6] = fg_color;
+    run[7] = bg_color;
+    run[8] = decoration;
+
+    RECORDING.frame_size += RUN_HEADER_SIZE + size;
+    return &run[RUN_HEADER_SIZE];
+}
+
+static void record_update_shadow(const int x, const int y, const char *str, const unsigned int size,
+                                 const CIXL_Color fg_color, const CIXL_Color bg_color, const CIXL_StyleOpts decoration)
+{
+    CIXL_Cxl     *cell = &RECORDING.shadow[(y * RECORDING.width) + x];
+    unsigned int i;
+
+    for (i = 0; i < size; ++i)
+    {
+        cell[i].char_value = str[i];
+        cell[i].fg_color   = fg_color;
+        cell[i].bg_color   = bg_color;
+        cell[i].style_opts = decoration;
+    }
+}
+
+static void record_run(const int x, const int y, const char *str, const unsigned int size,
+                       const CIXL_Color fg_color, const CIXL_Color bg_color, const CIXL_StyleOpts decoration)
+{
+    if (x < 0 || y < 0 || y >= RECORDING.height || (x + (int) size) > RECORDING.width)
+    {
+        return;
+    }
+
+    memcpy(record_append_run_header(x, y, size, fg_color, bg_color, decoration), str, size);
+    record_update_shadow(x, y, str, size, fg_color, bg_color, decoration);
+}
+
+/*! replaces the runs of the current frame with the whole shadow screen, one run per row segment with the same style */
+static void record_build_keyframe()
+{
+    int y;
+
+    RECORDING.frame_size = 0;
+
+    for (y = 0; y < RECORDING.height; ++y)
+    {
+        const CIXL_Cxl *row      = &RECORDING.shadow[y * RECORDING.width];
+        int            run_start = 0;
+        int            x;
+
+        for (x = 1; x <= RECORDING.width; ++x)
+        {
+            if (x == RECORDING.width || row[x].fg_color != row[run_start].fg_color ||
+                row[x].bg_color != row[run_start].bg_color || row[x].style_opts != row[run_start].style_opts)
+            {
+                const CIXL_Cxl *first = &row[run_start];
+                uint8_t        *chars = record_append_run_header(run_start, y, (unsigned int) (x - run_start),
+                                                                 first->fg_color, first->bg_color, first->style_opts);
+                int            i;
+
+                for (i = 0; i < x - run_start; ++i)
+                {
+                    chars[i] = (uint8_t) first[i].char_value;
+                }
+                run_start = x;
+            }
+        }
+    }
+}
+
+static void record_draw_cxl(const int start_x, const int start_y, const CIXL_Cxl cxl)
+{
+    char c = cxl.char_value;
+    record_run(start_x, start_y, &c, 1, cxl.fg_color, cxl.bg_color, cxl.style_opts);
+
+    if (RECORDING.target != NULL)
+    {
+        RECORDING.target->f_draw_cxl(start_x, start_y, cxl);
+    }
+}
+
+static void record_draw_horiz_s(const int start_x, const int start_y, char *str, const unsigned int size,
+                                const CIXL_Color fg_color, const CIXL_Color bg_color, const CIXL_StyleOpts decoration)
+{
+    record_run(start_x, start_y, str, size, fg_color, bg_color, decoration);
+
+    if (RECORDING.target != NULL)
+    {
+        RECORDING.target->f_draw_horiz_s(start_x, start_y, str, size, fg_color, bg_color, decoration);
+    }
+}
+
+static void record_end_frame()
+{
+    bool is_keyframe = (RECORDING.frame_count % RECORDING.keyframe_interval) == 0;
+
+    if (RECORDING.frame_size > 0 || is_keyframe)
+    {
+        uint8_t header[FRAME_HEADER_SIZE];
+
+        if (is_keyframe)
+        {
+            record_build_keyframe();
+        }
+
+        header[0] = is_keyframe ? FRAME_KIND_KEYFRAME : FRAME_KIND_DELTA;
+        write_u32(&header[1], (uint32_t) ((cixl_monotonic_ns() - RECORDING.start_ns) / 1000000u));
+        write_u32(&header[5], (uint32_t) RECORDING.frame_size);
+
+        record_write(header, FRAME_HEADER_SIZE);
+        record_write(RECORDING.frame, RECORDING.frame_size);
+
+        RECORDING.frame_size = 0;
+        ++RECORDING.frame_count;
+    }
+
+    if (RECORDING.target != NULL && RECORDING.target->f_end_frame != NULL)
+    {
+        RECORDING.target->f_end_frame();
+    }
+}
+
+static void record_frame_stats(CIXL_RenderStats *stats)
+{
+    if (RECORDING.target != NULL && RECORDING.target->f_frame_stats != NULL)
+    {
+        RECORDING.target->f_frame_stats(stats);
+    }
+}
+
+static CIXL_RenderDevice RECORD_DEVICE = {record_draw_cxl, record_draw_horiz_s, record_end_frame, record_frame_stats,
+                                          NULL};
+
+static void record_free_buffers()
+{
+    cixl_mem_free(RECORDING.shadow);
+    cixl_mem_free(RECORDING.frame);
+    cixl_mem_free(RECORDING.write_buffer);
+}
+
+CIXL_RenderDevice *cixl_record_start(const char *file_path, const int width, const int height,
+                                     const unsigned int keyframe_interval, CIXL_RenderDevice *device)
+{
+    int     i;
+    int     area = width * height;
+    uint8_t header[RECORDING_HEADER_SIZE];
+
+    if (IS_RECORDING || width <= 1 || height <= 1 || width > 0xFFFF || height > 0xFFFF)
+    {
+        return NULL;
+    }
+
+    RECORDING.file = fopen(file_path, "wb");
+    if (RECORDING.file == NULL)
+    {
+        return NULL;
+    }
+
+    RECORDING.target            = device;
+    RECORDING.width             = width;
+    RECORDING.height            = height;
+    RECORDING.keyframe_interval = keyframe_interval > 0 ? keyframe_interval : CIXL_RECORDING_DEFAULT_KEYFRAME_INTERVAL;
+    RECORDING.frame_count       = 0;
+    RECORDING.frame_size        = 0;
+    RECORDING.write_buffer_size = 0;
+
+    //worst case: every cxl is a run of its own
+    RECORDING.shadow       = cixl_mem_alloc(area, sizeof(CIXL_Cxl));
+    RECORDING.frame        = cixl_mem_alloc(area, RUN_HEADER_SIZE + 1);
+    RECORDING.write_buffer = cixl_mem_alloc(RECORD_WRITE_BUFFER_SIZE, sizeof(uint8_t));
+
+    if (RECORDING.shadow == NULL || RECORDING.frame == NULL || RECORDING.write_buffer == NULL)
+    {
+        record_free_buffers();
+        fclose(RECORDING.file);
+        return NULL;
+    }
+
+    for (i = 0; i < area; ++i)
+    {
+        RECORDING.shadow[i] = CXL_EMPTY;
+    }
+
+    memcpy(header, RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    header[7] = CIXL_RECORDING_VERSION;
+    write_u16(&header[8], (unsigned int) width);
+    write_u16(&header[10], (unsigned int) height);
+    write_u16(&header[12], RECORDING.keyframe_interval);
+    write_u16(&header[14], 0);
+    record_write(header, RECORDING_HEADER_SIZE);
+
+    RECORDING.start_ns = cixl_monotonic_ns();
+    IS_RECORDING = true;
+    return &RECORD_DEVICE;
+}
+
+bool cixl_record_stop()
+{
+    if (!IS_RECORDING)
+    {
+        return false;
+    }
+
+    record_flush_write_buffer();
+    fclose(RECORDING.file);
+    record_free_buffers();
+    IS_RECORDING = false;
+    return true;
+}
+
+/* Replay */
+
+static bool replay_read_index(CIXL_Replay *replay)
+{
+    uint8_t header[FRAME_HEADER_SIZE];
+    int     capacity = 0;
+
+    replay->frame_count = 0;
+    replay->payload_size = 0;
+
+    while (fread(header, 1, FRAME_HEADER_SIZE, replay->file) == FRAME_HEADER_SIZE)
+    {
+        CIXL_ReplayFrame *frame;
+
+        if (header[0] != FRAME_KIND_KEYFRAME && header[0] != FRAME_KIND_DELTA)
+        {
+            return false;
+        }
+
+        if (replay->frame_count == capacity)
+        {
+            CIXL_ReplayFrame *frames;
+            capacity = capacity == 0 ? 256 : capacity * 2;
+            frames   = cixl_mem_realloc(replay->frames, capacity * sizeof(CIXL_ReplayFrame));
+            if (frames == NULL)
+            {
+                return false;
+            }
+            replay->frames = frames;
+        }
+
+        frame = &replay->frames[replay->frame_count++];
+        frame->is_keyframe  = header[0] == FRAME_KIND_KEYFRAME;
+        frame->timestamp_ms = read_u32(&header[1]);
+        frame->payload_size = read_u32(&header[5]);
+        frame->file_offset  = ftell(replay->file);
+
+        if (frame->payload_size > replay->payload_size)
+        {
+            replay->payload_size = frame->payload_size;
+        }
+
+        if (fseek(replay->file, (long) frame->payload_size, SEEK_CUR) != 0)
+        {
+            return false;
+        }
+    }
+
+    return replay->frame_count == 0 || replay->frames[0].is_keyframe;
+}
+
+CIXL_Replay *cixl_replay_open(const char *file_path)
+{
+    CIXL_Replay *replay;
+    uint8_t     header[RECORDING_HEADER_SIZE];
+    int         i;
+
+    replay = cixl_mem_alloc(1, sizeof(CIXL_Replay));
+    if (replay == NULL)
+    {
+        return NULL;
+    }
+
+    replay->current_frame = -1;
+    replay->file          = fopen(file_path, "rb");
+
+    if (replay->file == NULL || fread(header, 1, RECORDING_HEADER_SIZE, replay->file) != RECORDING_HEADER_SIZE ||
+        memcmp(header, RECORDING_MAGIC, sizeof(RECORDING_MAGIC)) != 0 || header[7] != CIXL_RECORDING_VERSION)
+    {
+        cixl_replay_close(replay);
+        return NULL;
+    }
+
+    replay->width  = (int) read_u16(&header[8]);
+    replay->height = (int) read_u16(&header[10]);
+
+    if (!replay_read_index(replay))
+    {
+        cixl_replay_close(replay);
+        return NULL;
+    }
+
+    replay->cells   = cixl_mem_alloc(replay->width * replay->height, sizeof(CIXL_Cxl));
+    replay->payload = cixl_mem_alloc(replay->payload_size + 1, sizeof(uint8_t));
+    if (replay->cells == NULL || replay->payload == NULL)
+    {
+        cixl_replay_close(replay);
+        return NULL;
+    }
+
+    for (i = 0; i < replay->width * replay->height; ++i)
+    {
+        replay->cells[i] = CXL_EMPTY;
+    }
+
+    return replay;
+}
+
+void cixl_replay_close(CIXL_Replay *replay)
+{
+    if (replay == NULL)
+    {
+        return;
+    }
+
+    if (replay->file != NULL)
+    {
+        fclose(replay->file);
+    }
+    cixl_mem_free(replay->frames);
+    cixl_mem_free(replay->cells);
+    cixl_mem_free(replay->payload);
+    cixl_mem_free(replay);
+}
+
+/*! reads the payload of the given frame and applies its runs to the cells */
+static bool replay_apply_frame(CIXL_Replay *replay, const int frame_index)
+{
+    const CIXL_ReplayFrame *frame = &replay->frames[frame_index];
+    uint32_t               offset = 0;
+
+    if (fseek(replay->file, frame->file_offset, SEEK_SET) != 0 ||
+        fread(replay->payload, 1, frame->payload_size, replay->file) != frame->payload_size)
+    {
+        return false;
+    }
+
+    while (offset + RUN_HEADER_SIZE <= frame->payload_size)
+    {
+        const uint8_t *run  = &replay->payload[offset];
+        int           x     = (int) read_u16(&run[0]);
+        int           y     = (int) read_u16(&run[2]);
+        unsigned int  size  = read_u16(&run[4]);
+        unsigned int  i;
+
+        if (y >= replay->height || x + (int) size > replay->width ||
+            offset + RUN_HEADER_SIZE + size > frame->payload_size)
+        {
+            return false;
+        }
+
+        for (i = 0; i < size; ++i)
+        {
+            CIXL_Cxl *cell = &replay->cells[(y * replay->width) + x + (int) i];
+            cell->char_value = (char) run[RUN_HEADER_SIZE + i];
+            cell->fg_color   = run[6];
+            cell->bg_color   = run[7];
+            cell->style_opts = run[8];
+        }
+
+        offset += RUN_HEADER_SIZE + size;
+    }
+
+    replay->current_frame = frame_index;
+    replay->timestamp_ms  = frame->timestamp_ms;
+    return true;
+}
+
+bool cixl_replay_seek(CIXL_Replay *replay, const int frame_index)
+{
+    int start;
+    int i;
+
+    if (replay == NULL || frame_index < 0 || frame_index >= replay->frame_count)
+    {
+        return false;
+    }
+
+    //find the nearest keyframe
+    start = frame_index;
+    while (start > 0 && !replay->frames[start].is_keyframe)
+    {
+        --start;
+    }
+
+    //continuing from the current frame is cheaper when there is no keyframe in between
+    if (replay->current_frame >= start && replay->current_frame <= frame_index)
+    {
+        start = replay->current_frame + 1;
+    }
+
+    for (i = start; i <= frame_index; ++i)
+    {
+        if (!replay_apply_frame(replay, i))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool cixl_replay_next(CIXL_Replay *replay)
+{
+    return cixl_replay_seek(replay, replay->current_frame + 1);
+}
+
+CIXL_Cxl cixl_replay_pick(const CIXL_Replay *replay, const int x, const int y)
+{
+    if (x < 0 || y < 0 || x >= replay->width || y >= replay->height)
+    {
+        return CXL_EMPTY;
+    }
+    else
+    {
+        return replay->cells[(y * replay->width) + x];
+    }
+}
+
+int cixl_replay_put_frame(const CIXL_Replay *replay)
+{
+    uint32_t offset    = 0;
+    int      put_count = 0;
+
+    if (replay->current_frame < 0)
+    {
+        return 0;
+    }
+
+    //the payload buffer still holds the runs of the current frame
+    while (offset + RUN_HEADER_SIZE <= replay->frames[replay->current_frame].payload_size)
+    {
+        const uint8_t *run = &replay->payload[offset];
+        int           x    = (int) read_u16(&run[0]);
+        int           y    = (int) read_u16(&run[2]);
+        unsigned int  size = read_u16(&run[4]);
+        unsigned int  i;
+
+        for (i = 0; i < size; ++i)
+        {
+            cixl_put(x + (int) i, y, replay->cells[(y * replay->width) + x + (int) i]);
+            ++put_count;
+        }
+
+        offset += RUN_HEADER_SIZE + size;
+    }
+
+    return put_count;
+}
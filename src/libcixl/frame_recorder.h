@@ -0,0 +1,108 @@
+/*! \file
+ * \brief Frame recorder and replayer.
+ * Records the delta of each #cixl_render (the runs that are sent to the render device) with a timestamp to a compact
+ * binary file, with a full keyframe every n frames. A recording can be replayed, and any frame can be reconstructed by
+ * seeking to the nearest keyframe before it and applying the deltas from there.
+ *
+ * File format (all numbers are little endian):
+ *  - header: "CIXLREC" + version (u8), width (u16), height (u16), keyframe interval (u16), reserved (u16)
+ *  - frames: kind (u8: 'K' keyframe or 'D' delta), timestamp in ms since the start (u32), payload size (u32), payload
+ *  - payload: a list of runs: x (u16), y (u16), length (u16), fg (u8), bg (u8), style (u8), followed by length chars.
+ *    A keyframe payload covers the whole screen.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_FRAME_RECORDER_H
+#define LIBCIXL_FRAME_RECORDER_H
+
+#include <stdio.h>
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+#include "cxl.h"
+#include "screen_buffer.h"
+
+#define CIXL_RECORDING_VERSION 2
+
+/*! \brief The default number of frames between two keyframes.*/
+#define CIXL_RECORDING_DEFAULT_KEYFRAME_INTERVAL 60
+
+typedef struct CIXL_ReplayFrame
+{
+    long     file_offset;
+    uint32_t timestamp_ms;
+    uint32_t payload_size;
+    bool     is_keyframe;
+} CIXL_ReplayFrame;
+
+typedef struct CIXL_Replay
+{
+    /*! \brief The width of the recorded screen.*/
+    int width;
+
+    /*! \brief The height of the recorded screen.*/
+    int height;
+
+    /*! \brief The number of recorded frames.*/
+    int frame_count;
+
+    /*! \brief The index of the frame that is reconstructed in #cells, -1 when no frame was read yet.*/
+    int current_frame;
+
+    /*! \brief The time in milliseconds since the start of the recording of the current frame.*/
+    uint32_t timestamp_ms;
+
+    /*! \brief The reconstructed screen of the current frame, row by row (width * height).*/
+    CIXL_Cxl *cells;
+
+    FILE             *file;
+    CIXL_ReplayFrame *frames;
+    uint8_t          *payload;
+    uint32_t         payload_size;
+} CIXL_Replay;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Starts recording to the given file. Returns a render device that records all draw calls and forwards them to
+ * the given device, pass it to #cixl_init_screen_buffer. Only one recording can be active at a time.
+ * \param device the device to forward to, can be NULL to only record.
+ * \param keyframe_interval the number of frames between two keyframes, 0 for the default.
+ * \return NULL when the file could not be opened or a recording is already active.
+ * */
+CIXLLIB_API CIXL_RenderDevice *cixl_record_start(const char *file_path, const int width, const int height,
+                                                 const unsigned int keyframe_interval, CIXL_RenderDevice *device);
+
+/*! \brief Flushes and closes the active recording. The device returned by #cixl_record_start should not be used after this.*/
+CIXLLIB_API bool cixl_record_stop();
+
+/*! \brief Opens a recording for replay. Returns NULL when the file could not be read or is not a valid recording.*/
+CIXLLIB_API CIXL_Replay *cixl_replay_open(const char *file_path);
+
+CIXLLIB_API void cixl_replay_close(CIXL_Replay *replay);
+
+/*! \brief Reconstructs the given frame in replay->cells, starting from the nearest keyframe before it
+ * (or from the current frame when that is closer).*/
+CIXLLIB_API bool cixl_replay_seek(CIXL_Replay *replay, const int frame_index);
+
+/*! \brief Advances to the next frame. Returns false at the end of the recording.*/
+CIXLLIB_API bool cixl_replay_next(CIXL_Replay *replay);
+
+CIXLLIB_API CIXL_Cxl cixl_replay_pick(const CIXL_Replay *replay, const int x, const int y);
+
+/*! \brief Puts the runs of the current frame into the screen buffer with #cixl_put, as the game did when it was recorded.
+ * This can be used to replay a recording as a render workload. Returns the number of cxls that were put.*/
+CIXLLIB_API int cixl_replay_put_frame(const CIXL_Replay *replay);
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_FRAME_RECORDER_H
+
+#pragma clang diagnostic pop
@@ -1,8 +1,11 @@
 #include "std/cixl_stdtime.h"
 #include "std/cixl_stdbool.h"
-#include "std/cixl_sleep.h"
 #include "std/cixl_math.h"
 #include "game.h"
+#include "pacing.h"
+#include "idle.h"
+#include "trace.h"
+#include "input_log_internal.h"
 
 #include "screen_buffer.h"
 
@@ -14,195 +17,538 @@ int cixl_game_exit()
     return 1;
 }
 
-CIXL_Game INITIAL_GAME  = {true, 16, 500, CLOCKS_PER_SEC, cixl_game_exit, NULL, NULL};
+CIXL_Ticks cixl_time_monotonic()
+{
+    return cixl_monotonic_ns();
+}
+
+CIXL_Ticks cixl_time_clock()
+{
+    return (CIXL_Ticks) clock();
+}
+
+static CIXL_Ticks VIRTUAL_TIME_TICKS = 0;
+
+CIXL_Ticks cixl_time_virtual()
+{
+    return VIRTUAL_TIME_TICKS;
+}
+
+void cixl_time_virtual_set(const CIXL_Ticks ticks)
+{
+    VIRTUAL_TIME_TICKS = ticks;
+}
+
+void cixl_time_virtual_advance(const CIXL_Ticks ticks)
+{
+    VIRTUAL_TIME_TICKS += ticks;
+}
+
+CIXL_Game INITIAL_GAME  = {true, 16, 500, CLOCKS_PER_SEC, cixl_game_exit, NULL, NULL, false, 0, NULL,
+                           cixl_time_monotonic, CIXL_MONOTONIC_TICKS_PER_SECOND};
 CIXL_Game *CURRENT_GAME = &INITIAL_GAME;
 
 #ifndef __cplusplus
-CIXL_GameTime CURRENT_GAME_TIME = {0, 0, 0, false, 0, 0, 0};
+CIXL_GameTime CURRENT_GAME_TIME = {0, 0, 0, false, 0, 0, 0, 0, 0.0f, 0};
 #endif
 
-/// Reference to the shared game state. This is passed through to the update and draw methods.
-CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, SHARED_GAME_STATE_PTR) = NULL;
+/// The state of the game loop of cixl_game_run. The shared game state is passed through to the update and draw methods.
+static CIXL_GameContext GAME_CONTEXT;
 
-bool    GAME_IS_INITIALIZED            = false;
-clock_t PREVIOUS_TICKS                 = 0;
-clock_t ACCUMULATED_ELAPSED_TIME_TICKS = 0;
-clock_t TARGET_ELAPSED_TIME_TICKS      = 16;
-clock_t MAX_ELAPSED_TIME_TICKS         = 500;
-int     UPDATE_FRAME_LAG               = 0;
+bool GAME_IS_INITIALIZED = false;
+
+inline CIXL_Ticks ms_to_ticks(const uint32_t ms, const CIXL_Ticks ticks_per_second)
+{
+    return ((CIXL_Ticks) ms * ticks_per_second) / 1000u;
+}
+
+inline CIXL_Ticks ticks_to_ms(const CIXL_Ticks ticks, const CIXL_Ticks ticks_per_second)
+{
+    //split in whole seconds and the remainder, so ticks * 1000 can not overflow with nanosecond ticks
+    return ((ticks / ticks_per_second) * 1000u) + (((ticks % ticks_per_second) * 1000u) / ticks_per_second);
+}
 
-inline clock_t ms_to_ticks(const unsigned int ms, const clock_t clocks_per_second)
+static inline uint64_t ticks_to_ns(const CIXL_Ticks ticks, const CIXL_Ticks ticks_per_second)
 {
-    return (clock_t) ((ms / 1000.0) * clocks_per_second);
+    return ((ticks / ticks_per_second) * 1000000000u) +
+           (((ticks % ticks_per_second) * 1000000000u) / ticks_per_second);
 }
 
-inline unsigned int ticks_to_ms(const clock_t ticks, const clock_t clocks_per_second)
+CIXL_Game *cixl_game_create()
 {
-    return (ticks * 1000) / clocks_per_second;
+    return CURRENT_GAME;
 }
 
-CIXL_Game *cixl_game_create(clock_t clocks_per_second)
+CIXL_Game *cixl_game_create_with_clock(const clock_t clocks_per_second)
 {
     CURRENT_GAME->clocks_per_second = clocks_per_second;
+    cixl_game_set_time_source(cixl_time_clock, clocks_per_second > 0 ? (CIXL_Ticks) clocks_per_second : CLOCKS_PER_SEC);
     return CURRENT_GAME;
 }
 
-int cixl_game_init(void *shared_state_ptr)
+void cixl_game_set_time_source(const CIXL_TimeSource f_time_source, const CIXL_Ticks ticks_per_second)
 {
-    if (CURRENT_GAME == NULL)
+    if (f_time_source != NULL && ticks_per_second > 0)
     {
-        return -2;
+        CURRENT_GAME->f_time_source    = f_time_source;
+        CURRENT_GAME->ticks_per_second = ticks_per_second;
     }
+}
 
-    if (CURRENT_GAME->target_elapsed_time_millis > 0)
+int cixl_game_init_ctx(CIXL_GameContext *ctx, CIXL_Game *game,
+                       CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state_ptr))
+{
+    CIXL_GameTime start_time = {0, 0, 0, false, 0, 0, 0, 0, 0.0f, 0};
+
+    if (ctx == NULL || game == NULL)
     {
-        TARGET_ELAPSED_TIME_TICKS = ms_to_ticks(CURRENT_GAME->target_elapsed_time_millis,
-                                                CURRENT_GAME->clocks_per_second);
+        return -2;
     }
 
-    if (CURRENT_GAME->max_elapsed_time_millis > 0)
+    if (game->f_time_source == NULL)
     {
-        MAX_ELAPSED_TIME_TICKS = ms_to_ticks(CURRENT_GAME->max_elapsed_time_millis, CURRENT_GAME->clocks_per_second);
+        //a game set up without a time source, as before version 0.2.0
+        game->f_time_source    = cixl_time_clock;
+        game->ticks_per_second = game->clocks_per_second > 0 ? (CIXL_Ticks) game->clocks_per_second : CLOCKS_PER_SEC;
     }
-    SHARED_GAME_STATE_PTR = shared_state_ptr;
-    GAME_IS_INITIALIZED   = true;
+
+    ctx->game                           = game;
+    ctx->game_time                      = start_time;
+    ctx->shared_state_ptr               = shared_state_ptr;
+    ctx->should_exit                    = false;
+    ctx->accumulated_elapsed_time_ticks = 0;
+    ctx->update_frame_lag               = 0;
+    ctx->frames_counter                 = 0;
+    ctx->fps_timer_ticks                = 0;
+    ctx->target_elapsed_time_ticks      = ms_to_ticks(game->target_elapsed_time_millis > 0
+                                                      ? game->target_elapsed_time_millis : 16,
+                                                      game->ticks_per_second);
+    ctx->max_elapsed_time_ticks         = ms_to_ticks(game->max_elapsed_time_millis > 0
+                                                      ? game->max_elapsed_time_millis : 500,
+                                                      game->ticks_per_second);
+    ctx->target_draw_time_ticks         = ms_to_ticks(game->target_draw_time_millis, game->ticks_per_second);
+    ctx->accumulated_draw_time_ticks    = ctx->target_draw_time_ticks; //the first tick always draws
+    ctx->draw_time_ticks                = ctx->target_draw_time_ticks;
+    ctx->load_percent_x8                = 0;
+    ctx->frame_times                    = NULL;
+    ctx->drawn_last_tick                = false;
+    ctx->previous_ticks                 = game->f_time_source();
     return 1;
 }
 
-static unsigned int FRAMES_COUNTER  = 0;
-static clock_t      FPS_TIMER_TICKS = 0;
+int cixl_game_init(void *shared_state_ptr)
+{
+    if (cixl_game_init_ctx(&GAME_CONTEXT, CURRENT_GAME, shared_state_ptr) != 1)
+    {
+        return -2;
+    }
+    //start the game time from 0, so a replay sees the same game time as the recording
+    CURRENT_GAME_TIME   = GAME_CONTEXT.game_time;
+    GAME_SHOULD_EXIT    = false;
+    GAME_IS_INITIALIZED = true;
+    return 1;
+}
 
-static inline void fps_counter_update(CIXL_GameTime *game_time)
+static inline void fps_counter_update(CIXL_GameContext *ctx, CIXL_GameTime *game_time)
 {
-    FPS_TIMER_TICKS += game_time->elapsed_game_time_ticks;
+    ctx->fps_timer_ticks += game_time->elapsed_game_time_ticks;
 
-    if (FPS_TIMER_TICKS > CURRENT_GAME->clocks_per_second) // Reset after 1 second
+    if (ctx->fps_timer_ticks > ctx->game->ticks_per_second) // Reset after 1 second
     {
-        game_time->current_fps = FRAMES_COUNTER;
-        FRAMES_COUNTER = 0;
-        FPS_TIMER_TICKS -= CURRENT_GAME->clocks_per_second;
+        game_time->current_fps = ctx->frames_counter;
+        ctx->frames_counter = 0;
+        ctx->fps_timer_ticks -= ctx->game->ticks_per_second;
     }
 }
 
-static void cixl_game_do_update(CIXL_GameTime *game_time, CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state))
+static void cixl_game_do_update(CIXL_GameContext *ctx, CIXL_GameTime *game_time,
+                                CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state))
 {
-    fps_counter_update(game_time);
+    fps_counter_update(ctx, game_time);
 
-    if (CURRENT_GAME->f_update_game != NULL)
+    if (ctx->game->f_update_game != NULL)
     {
-        CURRENT_GAME->f_update_game(game_time, shared_state);
+        cixl_trace_begin("update");
+        if (ctx->frame_times != NULL)
+        {
+            uint64_t start_ns = cixl_monotonic_ns();
+            ctx->game->f_update_game(game_time, shared_state);
+            cixl_histogram_record(&ctx->frame_times->update_ns, cixl_monotonic_ns() - start_ns);
+        }
+        else
+        {
+            ctx->game->f_update_game(game_time, shared_state);
+        }
+        cixl_trace_end();
     }
 }
 
-static void cixl_game_do_draw(CIXL_GameTime *game_time, CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state))
+static void cixl_game_do_draw(CIXL_GameContext *ctx, CIXL_GameTime *game_time,
+                              CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state))
 {
-    ++FRAMES_COUNTER;
+    ++ctx->frames_counter;
 
-    if (CURRENT_GAME->f_draw_game != NULL)
+    if (ctx->game->f_draw_game != NULL)
     {
-        CURRENT_GAME->f_draw_game(game_time, shared_state);
+        cixl_trace_begin("draw");
+        if (ctx->frame_times != NULL)
+        {
+            uint64_t start_ns       = cixl_monotonic_ns();
+            uint64_t rendered_count = cixl_render_frame_count();
+
+            ctx->game->f_draw_game(game_time, shared_state);
+            cixl_histogram_record(&ctx->frame_times->draw_ns, cixl_monotonic_ns() - start_ns);
+            if (cixl_render_frame_count() != rendered_count)
+            {
+                cixl_histogram_record(&ctx->frame_times->render_ns, cixl_render_stats().total_ns);
+            }
+        }
+        else
+        {
+            ctx->game->f_draw_game(game_time, shared_state);
+        }
+        cixl_trace_end();
     }
 }
 
-int cixl_game_tick(CIXL_GameTime *game_time, CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state), const bool *should_exit)
+/* Measures the load of the tick that started at start_ticks and covered step_count updates, and applies the slow policy
+ * of the game */
+static void game_apply_slow_policy(CIXL_GameContext *ctx, CIXL_GameTime *game_time,
+                                   CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state),
+                                   const CIXL_Ticks start_ticks, const int step_count)
 {
-    //Inspired by MonoGame Tick (https://github.com/MonoGame/MonoGame/blob/develop/MonoGame.Framework/Game.cs)
+    const CIXL_SlowPolicy *policy       = ctx->game->slow_policy;
+    CIXL_Ticks            work_ticks    = ctx->game->f_time_source() - start_ticks;
+    CIXL_Ticks            covered_ticks = ctx->game->is_fixed_time_step
+                                          ? ctx->target_elapsed_time_ticks * (CIXL_Ticks) step_count
+                                          : game_time->elapsed_game_time_ticks;
+    bool                  was_slow      = game_time->is_running_slowly;
+
+    if (covered_ticks > 0)
+    {
+        int64_t load = (int64_t) ((work_ticks * 100u) / covered_ticks);
+
+        //smoothed (kept times 8 so it converges in integers), so a single slow tick does not change the policy
+        ctx->load_percent_x8 += load - (ctx->load_percent_x8 / 8);
+        game_time->load_percent = (unsigned int) (ctx->load_percent_x8 / 8);
+    }
 
-    goto RetryTick;
-    RetryTick:
+    if (!was_slow && game_time->load_percent >= policy->slow_load_percent)
     {
-        clock_t current_ticks = clock();//Current Ticks
+        game_time->is_running_slowly = true;
+    }
+    else if (was_slow && game_time->load_percent < policy->recover_load_percent)
+    {
+        game_time->is_running_slowly = false;
+    }
 
-        // Advance the accumulated elapsed time.
-        ACCUMULATED_ELAPSED_TIME_TICKS += current_ticks - PREVIOUS_TICKS;
-        PREVIOUS_TICKS        = current_ticks;
+    if (ctx->drawn_last_tick && policy->max_draw_time_millis > 0)
+    {
+        //lower the draw rate progressively while slow, and raise it back progressively after
+        CIXL_Ticks max_draw_ticks = ms_to_ticks(policy->max_draw_time_millis, ctx->game->ticks_per_second);
 
-        if ((CURRENT_GAME->is_fixed_time_step == true) && ACCUMULATED_ELAPSED_TIME_TICKS < TARGET_ELAPSED_TIME_TICKS)
+        if (game_time->is_running_slowly)
+        {
+            ctx->draw_time_ticks = ctx->draw_time_ticks > 0 ? ctx->draw_time_ticks * 2
+                                                            : ctx->target_elapsed_time_ticks;
+            if (ctx->draw_time_ticks > max_draw_ticks)
+            {
+                ctx->draw_time_ticks = max_draw_ticks;
+            }
+        }
+        else if (ctx->draw_time_ticks > ctx->target_draw_time_ticks)
         {
-            // Sleep for as long as possible without overshooting the update time.
-            // We may overshoot a bit. TODO: Tweak sleep time
-            clock_t sleep_time = ticks_to_ms(TARGET_ELAPSED_TIME_TICKS - ACCUMULATED_ELAPSED_TIME_TICKS,
-                                             CURRENT_GAME->clocks_per_second);
-            cixl_sleep_ms(cixl_max(1, sleep_time));
+            ctx->draw_time_ticks /= 2;
+            if (ctx->draw_time_ticks < ctx->target_draw_time_ticks)
+            {
+                ctx->draw_time_ticks = ctx->target_draw_time_ticks;
+            }
+        }
+    }
 
-            // Keep looping until it's time to perform the next update
-            goto RetryTick;
+    if (was_slow != game_time->is_running_slowly)
+    {
+        if (policy->render_cell_budget > 0)
+        {
+            cixl_render_set_cell_budget(game_time->is_running_slowly ? policy->render_cell_budget : 0);
+        }
+        if (policy->f_running_slowly_changed != NULL)
+        {
+            policy->f_running_slowly_changed(game_time, shared_state);
         }
     }
+}
+
+/* One tick of the game loop of the context, returns 0 without doing anything when a fixed time step is not due yet */
+static int game_tick(CIXL_GameContext *ctx, CIXL_GameTime *game_time,
+                     CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state), const bool *should_exit)
+{
+    //Inspired by MonoGame Tick (https://github.com/MonoGame/MonoGame/blob/develop/MonoGame.Framework/Game.cs)
+    CIXL_Game  *game          = ctx->game;
+    CIXL_Ticks current_ticks = game->f_time_source();//Current Ticks
+    int        step_count    = 1;
+    bool       skip_draw;
+
+    // Advance the accumulated elapsed time.
+    ctx->accumulated_elapsed_time_ticks += current_ticks - ctx->previous_ticks;
+    ctx->accumulated_draw_time_ticks += current_ticks - ctx->previous_ticks;
+    ctx->previous_ticks = current_ticks;
+
+    if ((game->is_fixed_time_step == true) && ctx->accumulated_elapsed_time_ticks < ctx->target_elapsed_time_ticks)
+    {
+        // Not time for the next update yet
+        return 0;
+    }
 
-    // Do not allow any update to take longer than our maximum (MAX_ELAPSED_TIME_TICKS).
-    if (ACCUMULATED_ELAPSED_TIME_TICKS > MAX_ELAPSED_TIME_TICKS)
+    // Do not allow any update to take longer than our maximum (max_elapsed_time_ticks).
+    if (ctx->accumulated_elapsed_time_ticks > ctx->max_elapsed_time_ticks)
     {
-        ACCUMULATED_ELAPSED_TIME_TICKS = MAX_ELAPSED_TIME_TICKS;
+        ctx->accumulated_elapsed_time_ticks = ctx->max_elapsed_time_ticks;
     }
 
-    if (CURRENT_GAME->is_fixed_time_step)
+    if (game->is_fixed_time_step)
     {
-        int step_count;
         step_count = 0;
-        game_time->elapsed_game_time_ticks = TARGET_ELAPSED_TIME_TICKS;
-        game_time->elapsed_game_time_ms    = ticks_to_ms(TARGET_ELAPSED_TIME_TICKS, CURRENT_GAME->clocks_per_second);
+        game_time->elapsed_game_time_ticks = ctx->target_elapsed_time_ticks;
+        game_time->elapsed_game_time_ms    = (unsigned long) ticks_to_ms(ctx->target_elapsed_time_ticks,
+                                                                         game->ticks_per_second);
 
         // Perform as many full fixed length time steps as we can.
-        while (ACCUMULATED_ELAPSED_TIME_TICKS >= TARGET_ELAPSED_TIME_TICKS && ((*should_exit) != true))
+        while (ctx->accumulated_elapsed_time_ticks >= ctx->target_elapsed_time_ticks && ((*should_exit) != true))
         {
-            game_time->total_game_time_ticks += TARGET_ELAPSED_TIME_TICKS;
-            ACCUMULATED_ELAPSED_TIME_TICKS -= TARGET_ELAPSED_TIME_TICKS;
+            game_time->total_game_time_ticks += ctx->target_elapsed_time_ticks;
+            ctx->accumulated_elapsed_time_ticks -= ctx->target_elapsed_time_ticks;
             ++step_count;
 
             game_time->step_count = step_count;
-            cixl_game_do_update(game_time, shared_state);
+            cixl_game_do_update(ctx, game_time, shared_state);
         }
 
         //Every update after the first accumulates lag
-        UPDATE_FRAME_LAG += cixl_max(0, step_count - 1);
+        ctx->update_frame_lag += cixl_max(0, step_count - 1);
 
-        //If we think we are running slowly, wait until the lag clears before resetting it
-        if (game_time->is_running_slowly == true)
+        //Without a slow policy (which uses the measured load): if we think we are running slowly, wait until the lag
+        //clears before resetting it
+        if (game->slow_policy == NULL)
         {
-            if (UPDATE_FRAME_LAG == 0)
+            if (game_time->is_running_slowly == true)
             {
-                game_time->is_running_slowly = false;
+                if (ctx->update_frame_lag == 0)
+                {
+                    game_time->is_running_slowly = false;
+                }
+            }
+            else if (ctx->update_frame_lag >= 5)
+            {
+                //If we lag more than 5 frames, start thinking we are running slowly
+                game_time->is_running_slowly = true;
             }
-        }
-        else if (UPDATE_FRAME_LAG >= 5)
-        {
-            //If we lag more than 5 frames, start thinking we are running slowly
-            game_time->is_running_slowly = true;
         }
 
         //Every time we just do one update and one draw, then we are not running slowly, so decrease the lag
-        if (step_count == 1 && UPDATE_FRAME_LAG > 0)
+        if (step_count == 1 && ctx->update_frame_lag > 0)
         {
-            --UPDATE_FRAME_LAG;
+            --ctx->update_frame_lag;
         }
 
         // Draw needs to know the total elapsed time
         // that occurred for the fixed length updates.
-        game_time->elapsed_game_time_ticks = TARGET_ELAPSED_TIME_TICKS * step_count;
-        game_time->elapsed_game_time_ms    = ticks_to_ms(game_time->elapsed_game_time_ticks,
-                                                         CURRENT_GAME->clocks_per_second);
-        game_time->frame_lag               = UPDATE_FRAME_LAG;
+        game_time->elapsed_game_time_ticks = ctx->target_elapsed_time_ticks * step_count;
+        game_time->elapsed_game_time_ms    = (unsigned long) ticks_to_ms(game_time->elapsed_game_time_ticks,
+                                                                         game->ticks_per_second);
+        game_time->frame_lag               = ctx->update_frame_lag;
+        game_time->interpolation_alpha     = (float) ctx->accumulated_elapsed_time_ticks /
+                                             (float) ctx->target_elapsed_time_ticks;
     }
     else
     {
         // Perform a single variable length update aka. as fast as possible
-        game_time->elapsed_game_time_ticks = ACCUMULATED_ELAPSED_TIME_TICKS;
-        game_time->elapsed_game_time_ms    = ticks_to_ms(ACCUMULATED_ELAPSED_TIME_TICKS,
-                                                         CURRENT_GAME->clocks_per_second);
+        game_time->elapsed_game_time_ticks = ctx->accumulated_elapsed_time_ticks;
+        game_time->elapsed_game_time_ms    = (unsigned long) ticks_to_ms(ctx->accumulated_elapsed_time_ticks,
+                                                                         game->ticks_per_second);
+
+        game_time->total_game_time_ticks += ctx->accumulated_elapsed_time_ticks;
+
+        ctx->accumulated_elapsed_time_ticks = 0;
+        game_time->interpolation_alpha      = 1.0f;
 
-        game_time->total_game_time_ticks += ACCUMULATED_ELAPSED_TIME_TICKS;
+        cixl_game_do_update(ctx, game_time, shared_state);
+    }
 
-        ACCUMULATED_ELAPSED_TIME_TICKS = 0;
+    //Skip the draw when the policy says so, while catching up, but not for longer than the maximum elapsed time
+    skip_draw = game->slow_policy != NULL && game->slow_policy->skip_draws && game_time->is_running_slowly &&
+                step_count > 1 && ctx->accumulated_draw_time_ticks < ctx->max_elapsed_time_ticks;
 
-        cixl_game_do_update(game_time, shared_state);
+    //Do Draw, when it is time for the next one
+    ctx->drawn_last_tick = !skip_draw && ctx->accumulated_draw_time_ticks >= ctx->draw_time_ticks;
+    if (ctx->drawn_last_tick)
+    {
+        if (ctx->draw_time_ticks > 0)
+        {
+            //keep the phase, but do not build up draws after a stall
+            ctx->accumulated_draw_time_ticks %= ctx->draw_time_ticks;
+        }
+        else
+        {
+            //no draw interval: the accumulated time is the time since the last draw, for the skip above
+            ctx->accumulated_draw_time_ticks = 0;
+        }
+        cixl_game_do_draw(ctx, game_time, shared_state);
     }
 
-    //Do Draw
-    cixl_game_do_draw(game_time, shared_state);
+    if (game->slow_policy != NULL)
+    {
+        game_apply_slow_policy(ctx, game_time, shared_state, current_ticks, step_count);
+    }
     return 1;
 }
 
+int cixl_game_tick_ctx(CIXL_GameContext *ctx)
+{
+    if (ctx == NULL || ctx->game == NULL)
+    {
+        return -2;
+    }
+    if (ctx->should_exit)
+    {
+        return 0;
+    }
+    return game_tick(ctx, &ctx->game_time, ctx->shared_state_ptr, &ctx->should_exit);
+}
+
+CIXL_Ticks cixl_game_next_tick_ctx(const CIXL_GameContext *ctx)
+{
+    if (ctx->game->is_fixed_time_step == false ||
+        ctx->accumulated_elapsed_time_ticks >= ctx->target_elapsed_time_ticks)
+    {
+        return ctx->previous_ticks;
+    }
+    return ctx->previous_ticks + (ctx->target_elapsed_time_ticks - ctx->accumulated_elapsed_time_ticks);
+}
+
+void cixl_game_exit_ctx(CIXL_GameContext *ctx)
+{
+    ctx->should_exit = true;
+}
+
+void cixl_game_set_frame_times(CIXL_FrameTimes *frame_times)
+{
+    GAME_CONTEXT.frame_times = frame_times;
+}
+
+void cixl_game_set_frame_times_ctx(CIXL_GameContext *ctx, CIXL_FrameTimes *frame_times)
+{
+    ctx->frame_times = frame_times;
+}
+
+int cixl_game_tick(CIXL_GameTime *game_time, CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state), const bool *should_exit)
+{
+    CIXL_Ticks from_ticks = GAME_CONTEXT.previous_ticks;
+
+    if (INPUT_LOG_REPLAYING)
+    {
+        CIXL_Ticks to_ticks;
+
+        //the recorded tick: the time it started from and, on the virtual clock, the time it is done at
+        if (!input_log_replay_tick(&from_ticks, &to_ticks))
+        {
+            cixl_game_exit();
+            return 0;
+        }
+        GAME_CONTEXT.previous_ticks = from_ticks;
+        cixl_time_virtual_set(to_ticks);
+    }
+
+    while (game_tick(&GAME_CONTEXT, game_time, shared_state, should_exit) == 0)
+    {
+        if (CURRENT_GAME->f_time_source == cixl_time_virtual)
+        {
+            //nothing to wait for on the virtual clock, skip ahead to the next update
+            cixl_time_virtual_set(cixl_game_next_tick_ctx(&GAME_CONTEXT));
+            continue;
+        }
+        // Wait until the update time, the pacing sleeps for the bulk and spins for the last part so it does not
+        // overshoot. Keep looping until it's time to perform the next update
+        cixl_pacing_wait_ns(ticks_to_ns(GAME_CONTEXT.target_elapsed_time_ticks -
+                                        GAME_CONTEXT.accumulated_elapsed_time_ticks,
+                                        CURRENT_GAME->ticks_per_second));
+    }
+    if (GAME_CONTEXT.drawn_last_tick)
+    {
+        cixl_pacing_frame_mark();
+    }
+    if (INPUT_LOG_RECORDING)
+    {
+        input_log_record_tick(from_ticks, GAME_CONTEXT.previous_ticks);
+    }
+    return 1;
+}
+
+/* Does the given number of fixed time step updates back to back, see cixl_game_simulate_ctx */
+static int game_simulate(CIXL_GameContext *ctx, CIXL_GameTime *game_time,
+                         CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state), const bool *should_exit,
+                         const uint64_t updates, const unsigned int draw_every, CIXL_SimulationStats *stats)
+{
+    uint64_t     start_ns   = cixl_monotonic_ns();
+    uint64_t     update_count;
+    uint64_t     draw_count = 0;
+    unsigned int since_draw = 0;
+
+    game_time->elapsed_game_time_ticks = ctx->target_elapsed_time_ticks;
+    game_time->elapsed_game_time_ms    = (unsigned long) ticks_to_ms(ctx->target_elapsed_time_ticks,
+                                                                     ctx->game->ticks_per_second);
+    game_time->step_count              = 1;
+    game_time->frame_lag               = 0;
+    game_time->is_running_slowly       = false;
+    game_time->interpolation_alpha     = 0.0f;
+
+    for (update_count = 0; update_count < updates && ((*should_exit) != true); ++update_count)
+    {
+        game_time->total_game_time_ticks += ctx->target_elapsed_time_ticks;
+        cixl_game_do_update(ctx, game_time, shared_state);
+
+        if (draw_every > 0 && ++since_draw >= draw_every)
+        {
+            since_draw = 0;
+            ++draw_count;
+            cixl_game_do_draw(ctx, game_time, shared_state);
+        }
+    }
+
+    //continue in real time from here, instead of catching up on the time the simulation took
+    ctx->previous_ticks = ctx->game->f_time_source();
+
+    if (stats != NULL)
+    {
+        stats->updates            = update_count;
+        stats->draws              = draw_count;
+        stats->elapsed_ns         = cixl_monotonic_ns() - start_ns;
+        stats->updates_per_second = stats->elapsed_ns > 0 ? ((double) update_count * 1000000000.0) /
+                                                            (double) stats->elapsed_ns : 0.0;
+    }
+    return (*should_exit) ? 0 : 1;
+}
+
+int cixl_game_simulate_ctx(CIXL_GameContext *ctx, const uint64_t updates, const unsigned int draw_every,
+                           CIXL_SimulationStats *stats)
+{
+    if (ctx == NULL || ctx->game == NULL)
+    {
+        return -2;
+    }
+    return game_simulate(ctx, &ctx->game_time, ctx->shared_state_ptr, &ctx->should_exit, updates, draw_every, stats);
+}
+
+int cixl_game_simulate(const uint64_t updates, const unsigned int draw_every, CIXL_SimulationStats *stats)
+{
+    if (!GAME_IS_INITIALIZED)
+    {
+        return -2;
+    }
+    return game_simulate(&GAME_CONTEXT, &CURRENT_GAME_TIME, GAME_CONTEXT.shared_state_ptr, &GAME_SHOULD_EXIT,
+                         updates, draw_every, stats);
+}
+
 int cixl_game_run()
 {
     if (!GAME_IS_INITIALIZED)
@@ -210,13 +556,33 @@ int cixl_game_run()
         return -2;
     }
 
-    PREVIOUS_TICKS = clock();//INITIALIZE TO CURRENT TIME;
+    GAME_CONTEXT.previous_ticks = CURRENT_GAME->f_time_source();//INITIALIZE TO CURRENT TIME;
+
+    if (CURRENT_GAME->is_event_driven)
+    {
+        //always run the first frame, so there is something on the screen
+        cixl_idle_request_frame();
+    }
 
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wfor-loop-analysis"
     while (!GAME_SHOULD_EXIT)
     {
-        cixl_game_tick(&CURRENT_GAME_TIME, SHARED_GAME_STATE_PTR, &GAME_SHOULD_EXIT);
+        if (CURRENT_GAME->is_event_driven)
+        {
+            unsigned int wake_events = cixl_idle_wait();
+
+            //nothing to wait for (or no way to block) returns 0, then the tick is paced like in a normal game
+            if (wake_events != 0 && (wake_events & CIXL_WAKE_FRAME) == 0)
+            {
+                //woken up after being idle: do a single update now, instead of catching up on the idle time
+                GAME_CONTEXT.previous_ticks                 = CURRENT_GAME->f_time_source();
+                GAME_CONTEXT.accumulated_elapsed_time_ticks = GAME_CONTEXT.target_elapsed_time_ticks;
+                GAME_CONTEXT.accumulated_draw_time_ticks    = GAME_CONTEXT.draw_time_ticks;
+            }
+            CURRENT_GAME_TIME.wake_events = wake_events;
+        }
+        cixl_game_tick(&CURRENT_GAME_TIME, GAME_CONTEXT.shared_state_ptr, &GAME_SHOULD_EXIT);
     }
     return 1;
 #pragma clang diagnostic pop
@@ -7,15 +7,31 @@
 #define LIBCIXL_GAME_H
 
 #include "std/cixl_stdtime.h"
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
 #include "config.h"
+#include "histogram.h"
+
+/*! \brief A point in time or a duration, in ticks of the time source of the game.*/
+typedef uint64_t CIXL_Ticks;
+
+/*! \brief A clock the game loop measures time with, returns the current time in ticks. Only the difference between two
+ * calls is used, so the starting point does not matter. Must be monotonic.*/
+typedef CIXL_Ticks (*CIXL_TimeSource)(void);
+
+/*! \brief The ticks per second of #cixl_time_monotonic.*/
+#define CIXL_MONOTONIC_TICKS_PER_SECOND 1000000000u
+
+/*! \brief The ticks per second of #cixl_time_virtual, nanoseconds like the monotonic clock.*/
+#define CIXL_VIRTUAL_TICKS_PER_SECOND 1000000000u
 
 typedef struct CIXL_GameTime
 {
-    /*! \brief Total accumulated time in (clocks) Ticks that the game is running.*/
-    unsigned long total_game_time_ticks;
+    /*! \brief Total accumulated time in Ticks that the game is running.*/
+    CIXL_Ticks total_game_time_ticks;
 
-    /*! \brief Elapsed time in (clocks) Ticks since last update.*/
-    unsigned long elapsed_game_time_ticks;
+    /*! \brief Elapsed time in Ticks since last update.*/
+    CIXL_Ticks elapsed_game_time_ticks;
 
     /*! \brief Elapsed time in milliseconds since last update.*/
     unsigned long elapsed_game_time_ms;
@@ -28,6 +44,19 @@ typedef struct CIXL_GameTime
 
     int frame_lag;
     int step_count;
+
+    /*! \brief For an event driven game (see CIXL_Game.is_event_driven): what woke the game for this update, see
+     * #CIXL_WAKE_INPUT, #CIXL_WAKE_TIMER and #CIXL_WAKE_FRAME. 0 otherwise.*/
+    unsigned int wake_events;
+
+    /*! \brief How far the game time is between the last fixed update and the next one, from 0 up to (not including) 1.
+     * The draw method can use this to interpolate between the previous and the current state, when it draws less often
+     * than the game updates (see CIXL_Game.target_draw_time_millis). Always 1 for a variable time step.*/
+    float interpolation_alpha;
+
+    /*! \brief With a #CIXL_SlowPolicy: the smoothed time the updates and draw of a tick take, as percentage of the game
+     * time they cover. Above 100 the game can not keep up. 0 without a policy.*/
+    unsigned int load_percent;
 } CIXL_GameTime;
 
 
@@ -41,6 +70,34 @@ typedef struct CIXL_GameTime
 #define CIXL_TYPED_GAME_STATE(state_type, name) \
 state_type *name                                \
 
+/*! \brief How the game loop degrades when it can not keep up, see CIXL_Game.slow_policy. The game is running slowly
+ * when the measured load (CIXL_GameTime.load_percent) reaches slow_load_percent, until it drops below
+ * recover_load_percent. All actions are optional, zero (or NULL) disables them.*/
+typedef struct CIXL_SlowPolicy
+{
+    /*! \brief The load at which the game is running slowly, for example 90.*/
+    unsigned int slow_load_percent;
+
+    /*! \brief The load below which the game no longer runs slowly, lower than slow_load_percent, for example 70.*/
+    unsigned int recover_load_percent;
+
+    /*! \brief Skip the draw of a tick that had to catch up with multiple updates while running slowly. A draw is never
+     * skipped for longer than CIXL_Game.max_elapsed_time_millis.*/
+    bool skip_draws;
+
+    /*! \brief While running slowly the time between draws doubles on every draw, up to this many millis, and it halves
+     * back to CIXL_Game.target_draw_time_millis after recovering.*/
+    unsigned int max_draw_time_millis;
+
+    /*! \brief The cell budget of the renderer while running slowly (see #cixl_render_set_cell_budget), it is set back
+     * to no limit after recovering. Note that the renderer is global.*/
+    uint32_t render_cell_budget;
+
+    /*! \brief Called when the game starts (game_time->is_running_slowly is true) or stops running slowly.*/
+    void (*f_running_slowly_changed)(const CIXL_GameTime *game_time,
+                                     CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state_ptr));
+} CIXL_SlowPolicy;
+
 typedef struct CIXL_Game
 {
     /*! \brief Whether to advance the game at a fixed or variable(as fast as possible)..*/
@@ -54,6 +111,8 @@ typedef struct CIXL_Game
     /*! \brief The maximum amount of time we will frame-skip over and only perform Update calls with no Draw calls.*/
     unsigned int max_elapsed_time_millis;
 
+    /*! \brief Deprecated, kept so initializers of before version 0.2.0 still fit. Only used when f_time_source is NULL:
+     * the game loop then measures time with #cixl_time_clock at this many ticks per second (CLOCKS_PER_SEC when 0).*/
     clock_t clocks_per_second;
 
     /*! \brief To signal exit to the game this method can be called. This should call #cixl_game_exit. When created with #cixl_game_create, it is automatically set to that.*/
@@ -66,8 +125,98 @@ typedef struct CIXL_Game
     /*! \brief This method is called multiple times per second, and is used to update drawing logic. At the end of each draw, the screen buffer will be rendered to the screen.*/
     void (*f_draw_game)(const CIXL_GameTime *game_time, CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state_ptr));
 
+    /*! \brief Instead of updating and drawing every tick, #cixl_game_run blocks until there is input, a timer fires or
+     * a frame is requested, see idle.h. The first frame is always run. Request a frame with #cixl_idle_request_frame
+     * in every update for as long as something animates. The time that the game was idle is not caught up: after
+     * waking up a single update is done.*/
+    bool is_event_driven;
+
+    /*! \brief The minimum time between two draws in millis, to draw (and output to the terminal) at a lower rate than
+     * the game updates, for example 33 to draw at 30 frames per second while updating at 120. Draws happen on ticks
+     * with an update, so a rate higher than the update rate has no effect. 0 draws after every tick.*/
+    unsigned int target_draw_time_millis;
+
+    /*! \brief Optional, decides when the game is running slowly from the measured load and what to do about it. When
+     * NULL the game is running slowly when it lags 5 updates behind, and nothing else is done.*/
+    const CIXL_SlowPolicy *slow_policy;
+
+    /*! \brief The clock of the game loop, by default #cixl_time_monotonic. Set with #cixl_game_set_time_source. When
+     * NULL, #cixl_game_init sets it to #cixl_time_clock with clocks_per_second.*/
+    CIXL_TimeSource f_time_source;
+
+    /*! \brief The ticks per second of f_time_source.*/
+    CIXL_Ticks ticks_per_second;
+
 } CIXL_Game;
 
+/*! \brief Telemetry of the game loop: the durations (in nanoseconds of #cixl_time_monotonic, whatever the time source
+ * of the game) of every update, every draw and every #cixl_render done during a draw. Owned by the caller, see
+ * #cixl_game_set_frame_times. The game loop is the only writer, a metrics thread can take snapshots of the histograms
+ * (#cixl_histogram_snapshot) at any time.*/
+typedef struct CIXL_FrameTimes
+{
+    CIXL_Histogram update_ns;
+
+    /*! \brief The draw method, including the render.*/
+    CIXL_Histogram draw_ns;
+
+    CIXL_Histogram render_ns;
+} CIXL_FrameTimes;
+
+/*! \brief The state of one game loop. #cixl_game_run runs a single game with global state, to run many independent
+ * games (sessions) in one process give each one its own context and step them with #cixl_game_tick_ctx, for example
+ * from a thread pool. Contexts do not share state, so different contexts can be ticked on different threads at the
+ * same time, as long as their update and draw methods do not share state either. Note that the screen buffer is
+ * global, only one of the games can draw to it.*/
+typedef struct CIXL_GameContext
+{
+    /*! \brief The settings and methods of the game, multiple contexts can share one #CIXL_Game.*/
+    CIXL_Game *game;
+
+    CIXL_GameTime game_time;
+
+    /*! \brief Passed through to the update and draw methods.*/
+    CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state_ptr);
+
+    /*! \brief When true the context is not ticked anymore, see #cixl_game_exit_ctx.*/
+    bool should_exit;
+
+    CIXL_Ticks   previous_ticks;
+    CIXL_Ticks   accumulated_elapsed_time_ticks;
+    CIXL_Ticks   target_elapsed_time_ticks;
+    CIXL_Ticks   max_elapsed_time_ticks;
+    int          update_frame_lag;
+    unsigned int frames_counter;
+    CIXL_Ticks   fps_timer_ticks;
+    CIXL_Ticks   target_draw_time_ticks;
+    CIXL_Ticks   accumulated_draw_time_ticks;
+
+    /*! \brief The time between draws, target_draw_time_ticks unless changed by the slow policy.*/
+    CIXL_Ticks   draw_time_ticks;
+    int64_t      load_percent_x8;
+
+    /*! \brief Optional, where the durations are recorded, see #cixl_game_set_frame_times_ctx.*/
+    CIXL_FrameTimes *frame_times;
+
+    /*! \brief Whether the last tick that updated the game also drew it.*/
+    bool drawn_last_tick;
+} CIXL_GameContext;
+
+/*! \brief The result of a headless simulation, see #cixl_game_simulate_ctx.*/
+typedef struct CIXL_SimulationStats
+{
+    /*! \brief The number of updates done, less than requested when the game exited.*/
+    uint64_t updates;
+
+    uint64_t draws;
+
+    /*! \brief The wall clock time the simulation took.*/
+    uint64_t elapsed_ns;
+
+    /*! \brief The update throughput, updates (and their draws) per second of wall clock time.*/
+    double updates_per_second;
+} CIXL_SimulationStats;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -77,17 +226,46 @@ extern "C" {
 int cixl_game_tick(CIXL_GameTime *game_time, CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state),
                    const bool *should_exit);
 
-clock_t ms_to_ticks(const unsigned int ms, const clock_t clocks_per_second);
+CIXL_Ticks ms_to_ticks(const uint32_t ms, const CIXL_Ticks ticks_per_second);
 
-unsigned int ticks_to_ms(const clock_t ticks, const clock_t clocks_per_second);
+CIXL_Ticks ticks_to_ms(const CIXL_Ticks ticks, const CIXL_Ticks ticks_per_second);
 
 extern struct CIXL_GameTime CURRENT_GAME_TIME;
 #endif
 
-/*! \brief returns the default #CIXL_GAME
- *! \param clocks_per_second the clocks per second for your system.
- * */
-CIXLLIB_API CIXL_Game *cixl_game_create(clock_t clocks_per_second);
+/*! \brief Nanoseconds of the monotonic clock (clock_gettime(CLOCK_MONOTONIC)), the default time source. Platforms
+ * without a monotonic clock (Dos) fall back to clock(), converted to nanoseconds.*/
+CIXLLIB_API CIXL_Ticks cixl_time_monotonic();
+
+/*! \brief clock() as time source, with CLOCKS_PER_SEC ticks per second. Note that on most systems this is the processor
+ * time of the process, which does not advance while it sleeps.*/
+CIXLLIB_API CIXL_Ticks cixl_time_clock();
+
+/*! \brief A virtual clock as time source, with #CIXL_VIRTUAL_TICKS_PER_SECOND ticks per second. It only moves when it
+ * is set or advanced, so a game loop on it is deterministic (for tests and replays). #cixl_game_tick and
+ * #cixl_game_run do not sleep on the virtual clock: when the next update is not due yet the clock is advanced to it,
+ * so the game runs as fast as it can. The virtual clock is global.*/
+CIXLLIB_API CIXL_Ticks cixl_time_virtual();
+
+/*! \brief Sets the time of #cixl_time_virtual. Setting it back in time is not supported by the game loop.*/
+CIXLLIB_API void cixl_time_virtual_set(const CIXL_Ticks ticks);
+
+/*! \brief Advances the time of #cixl_time_virtual by the given number of ticks (nanoseconds).*/
+CIXLLIB_API void cixl_time_virtual_advance(const CIXL_Ticks ticks);
+
+/*! \brief returns the default #CIXL_GAME, which uses #cixl_time_monotonic as time source.
+ * Since version 0.2.0 this takes no arguments, it used to take the clocks per second of clock(). Use
+ * #cixl_game_create_with_clock to keep measuring time with clock().*/
+CIXLLIB_API CIXL_Game *cixl_game_create();
+
+/*! \brief returns the default #CIXL_GAME with #cixl_time_clock as time source, like #cixl_game_create did before version
+ * 0.2.0. Note that clock() is the processor time of the process on most systems, see #cixl_time_clock.
+ *! \param clocks_per_second the clocks per second for your system, CLOCKS_PER_SEC.*/
+CIXLLIB_API CIXL_Game *cixl_game_create_with_clock(const clock_t clocks_per_second);
+
+/*! \brief Sets the clock of the game loop. Call this before #cixl_game_init.
+ *! \param ticks_per_second the resolution of the time source, for example CLOCKS_PER_SEC for #cixl_time_clock.*/
+CIXLLIB_API void cixl_game_set_time_source(const CIXL_TimeSource f_time_source, const CIXL_Ticks ticks_per_second);
 
 /*! \brief initializes the game loop state. Call this before #cixl_game_run.
  *! \param shared_state_ptr A pointer to your shared game state. This is passed through to the update and draw methods so they can access this.*/
@@ -99,6 +277,54 @@ CIXLLIB_API int cixl_game_run();
 /*! \brief stops the game loop. This method is called by default via the #CIXL_GAME.f_exit_game method. You can call this method from the update or draw method directly. */
 CIXLLIB_API int cixl_game_exit();
 
+/*! \brief initializes a game loop context, see #CIXL_GameContext. The context is owned by the caller.
+ *! \param game the settings and methods of the game, this must stay valid while the context is used. A copy of the
+ * default game can be made with *#cixl_game_create().
+ *! \return 1 on success, -2 when ctx or game is NULL*/
+CIXLLIB_API int cixl_game_init_ctx(CIXL_GameContext *ctx, CIXL_Game *game,
+                                   CIXL_TYPED_GAME_STATE(CIXL_GAME_STATE_TYPE, shared_state_ptr));
+
+/*! \brief Does one tick of the game loop of the context: the updates that are due and one draw (when a draw is due,
+ * see CIXL_Game.target_draw_time_millis). Unlike #cixl_game_run
+ * this never waits, so an external scheduler can drive it, when a fixed time step game is not due yet nothing is done
+ * (see #cixl_game_next_tick_ctx for when to come back).
+ *! \return 1 when the game was updated, with or without a draw (a draw is not due every update, and a slow policy can
+ * skip draws, see CIXL_GameContext.drawn_last_tick), 0 when it was not due yet or exited, -2 when ctx is not
+ * initialized*/
+CIXLLIB_API int cixl_game_tick_ctx(CIXL_GameContext *ctx);
+
+/*! \brief The time (of the time source of the game) at which the next update of the context is due. A variable time
+ * step game is always due.*/
+CIXLLIB_API CIXL_Ticks cixl_game_next_tick_ctx(const CIXL_GameContext *ctx);
+
+/*! \brief Stops the game loop of the context, #cixl_game_tick_ctx does nothing after this. */
+CIXLLIB_API void cixl_game_exit_ctx(CIXL_GameContext *ctx);
+
+/*! \brief Records the durations of the updates, draws and renders of the game loop of #cixl_game_run in frame_times,
+ * NULL (the default) stops recording. Call this after #cixl_game_init. The frame times must stay valid while recording.*/
+CIXLLIB_API void cixl_game_set_frame_times(CIXL_FrameTimes *frame_times);
+
+/*! \brief Records the durations of the updates, draws and renders of the context in frame_times, NULL (the default)
+ * stops recording. Note that renders are counted by frame number, which is global: a render by another thread during
+ * a draw of this context is attributed to it.*/
+CIXLLIB_API void cixl_game_set_frame_times_ctx(CIXL_GameContext *ctx, CIXL_FrameTimes *frame_times);
+
+/*! \brief Runs the game of the context headless at maximum speed: does the given number of fixed time step updates
+ * back to back, without reading the time source and without sleeping. Useful to fast forward a game, for soak tests
+ * and to benchmark the update throughput. The game time advances with CIXL_Game.target_elapsed_time_millis per update,
+ * also for a variable time step game. The slow policy and the draw rate of the game are not applied.
+ *! \param updates the number of updates, the simulation stops earlier when the game exits.
+ *! \param draw_every draw after every this many updates (for example 1 to draw after every update), 0 to never draw.
+ *! \param stats optional (can be NULL), the number of updates and draws and the throughput.
+ *! \return 1 on success, 0 when the game exited, -2 when ctx is not initialized*/
+CIXLLIB_API int cixl_game_simulate_ctx(CIXL_GameContext *ctx, const uint64_t updates, const unsigned int draw_every,
+                                       CIXL_SimulationStats *stats);
+
+/*! \brief Runs the game of #cixl_game_init headless at maximum speed, see #cixl_game_simulate_ctx. The game can be
+ * continued with #cixl_game_run afterwards.*/
+CIXLLIB_API int cixl_game_simulate(const uint64_t updates, const unsigned int draw_every,
+                                   CIXL_SimulationStats *stats);
+
 #ifdef __cplusplus
 } /* End of extern "C" */
 #endif
@@ -0,0 +1,122 @@
+#include <string.h>
+#include "std/cixl_atomic.h"
+#include "histogram.h"
+
+#define LINEAR_LIMIT (2u * CIXL_HISTOGRAM_SUB_BUCKETS)
+
+static inline unsigned int highest_bit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return 63u - (unsigned int) __builtin_clzll(value);
+#else
+    unsigned int bit = 0;
+    while (value >>= 1u)
+    {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+/* Values below 2 * SUB_BUCKETS get a bucket each, above that each power of two gets SUB_BUCKETS buckets */
+static inline unsigned int bucket_index(const uint64_t value)
+{
+    unsigned int shift;
+
+    if (value < LINEAR_LIMIT)
+    {
+        return (unsigned int) value;
+    }
+    shift = highest_bit(value) - CIXL_HISTOGRAM_SUB_BUCKET_BITS;
+    return (shift * CIXL_HISTOGRAM_SUB_BUCKETS) + (unsigned int) (value >> shift);
+}
+
+/* The highest value that is recorded in the bucket */
+static inline uint64_t bucket_highest_value(const unsigned int index)
+{
+    unsigned int shift;
+    uint64_t     top;
+
+    if (index < LINEAR_LIMIT)
+    {
+        return index;
+    }
+    shift = (index / CIXL_HISTOGRAM_SUB_BUCKETS) - 1u;
+    top   = (index % CIXL_HISTOGRAM_SUB_BUCKETS) + CIXL_HISTOGRAM_SUB_BUCKETS;
+    return ((top + 1u) << shift) - 1u;
+}
+
+void cixl_histogram_record(CIXL_Histogram *histogram, const uint64_t value)
+{
+    unsigned int index = bucket_index(value);
+
+    //the snapshot readers access the counters atomically: each counter only grows, so a snapshot never sees a torn or
+    //decreasing value. There is a single writer: read, add and store does not need an atomic increment
+    CIXL_ATOMIC_STORE(&histogram->counts[index], CIXL_ATOMIC_LOAD(&histogram->counts[index]) + 1u);
+    CIXL_ATOMIC_STORE(&histogram->sum, CIXL_ATOMIC_LOAD(&histogram->sum) + value);
+    if (value > CIXL_ATOMIC_LOAD(&histogram->max))
+    {
+        CIXL_ATOMIC_STORE(&histogram->max, value);
+    }
+    CIXL_ATOMIC_STORE(&histogram->total_count, CIXL_ATOMIC_LOAD(&histogram->total_count) + 1u);
+}
+
+void cixl_histogram_snapshot(const CIXL_Histogram *histogram, CIXL_Histogram *out_snapshot)
+{
+    unsigned int i;
+    uint64_t     total = 0;
+
+    for (i = 0; i < CIXL_HISTOGRAM_BUCKETS; ++i)
+    {
+        out_snapshot->counts[i] = CIXL_ATOMIC_LOAD(&histogram->counts[i]);
+        total += out_snapshot->counts[i];
+    }
+    //the total of the copied counts, so the percentiles of the snapshot are consistent
+    out_snapshot->total_count = total;
+    out_snapshot->sum         = CIXL_ATOMIC_LOAD(&histogram->sum);
+    out_snapshot->max         = CIXL_ATOMIC_LOAD(&histogram->max);
+}
+
+uint64_t cixl_histogram_percentile(const CIXL_Histogram *histogram, const double percentile)
+{
+    uint64_t     rank;
+    uint64_t     seen = 0;
+    unsigned int i;
+
+    if (histogram->total_count == 0)
+    {
+        return 0;
+    }
+    if (percentile >= 100.0)
+    {
+        return histogram->max;
+    }
+
+    //the rank of the value, rounded to the nearest and at least the first value
+    rank = (uint64_t) ((percentile / 100.0) * (double) histogram->total_count + 0.5);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    for (i = 0; i < CIXL_HISTOGRAM_BUCKETS; ++i)
+    {
+        seen += histogram->counts[i];
+        if (seen >= rank)
+        {
+            uint64_t value = bucket_highest_value(i);
+            return value < histogram->max ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+uint64_t cixl_histogram_mean(const CIXL_Histogram *histogram)
+{
+    return histogram->total_count == 0 ? 0 : histogram->sum / histogram->total_count;
+}
+
+void cixl_histogram_reset(CIXL_Histogram *histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+}
@@ -0,0 +1,71 @@
+/*! \file
+ * \brief Histograms of durations (or any other 64 bit value) with HDR style log-linear buckets: every power of two is
+ * split in #CIXL_HISTOGRAM_SUB_BUCKETS linear buckets, so a value is recorded with a relative precision of about 3%,
+ * from 1 up to the full 64 bit range, in a fixed amount of memory and without allocations.
+ *
+ * A histogram has a single writer (the thread that records), any other thread can take a snapshot at any time without
+ * locking or blocking the writer, for example a metrics thread. Each counter of the snapshot is read atomically, a
+ * snapshot that is taken while a value is recorded may or may not include that value.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_HISTOGRAM_H
+#define LIBCIXL_HISTOGRAM_H
+
+#include "std/cixl_stdint.h"
+#include "config.h"
+
+/*! \brief Log2 of the number of linear buckets per power of two.*/
+#define CIXL_HISTOGRAM_SUB_BUCKET_BITS 5
+
+#define CIXL_HISTOGRAM_SUB_BUCKETS (1u << CIXL_HISTOGRAM_SUB_BUCKET_BITS)
+
+/*! \brief The number of buckets to cover all 64 bit values.*/
+#define CIXL_HISTOGRAM_BUCKETS ((64u - CIXL_HISTOGRAM_SUB_BUCKET_BITS + 1u) * CIXL_HISTOGRAM_SUB_BUCKETS)
+
+typedef struct CIXL_Histogram
+{
+    uint64_t counts[CIXL_HISTOGRAM_BUCKETS];
+
+    /*! \brief The number of recorded values.*/
+    uint64_t total_count;
+
+    /*! \brief The sum of the recorded values, for the mean.*/
+    uint64_t sum;
+
+    /*! \brief The exact largest recorded value.*/
+    uint64_t max;
+} CIXL_Histogram;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Records a value. Only one thread may record in a histogram.*/
+CIXLLIB_API void cixl_histogram_record(CIXL_Histogram *histogram, const uint64_t value);
+
+/*! \brief Copies the histogram, this can be called from any thread while the writer records.*/
+CIXLLIB_API void cixl_histogram_snapshot(const CIXL_Histogram *histogram, CIXL_Histogram *out_snapshot);
+
+/*! \brief The value below which the given percentage of the recorded values is, for example 99.0 for p99. Values are
+ * reported as the highest value of their bucket, never more than the max. 0 when nothing was recorded.
+ * Take a snapshot first when the histogram is recorded on another thread.*/
+CIXLLIB_API uint64_t cixl_histogram_percentile(const CIXL_Histogram *histogram, const double percentile);
+
+/*! \brief The mean of the recorded values, 0 when nothing was recorded.*/
+CIXLLIB_API uint64_t cixl_histogram_mean(const CIXL_Histogram *histogram);
+
+/*! \brief Clears all counts. Only the writer may reset the histogram.*/
+CIXLLIB_API void cixl_histogram_reset(CIXL_Histogram *histogram);
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_HISTOGRAM_H
+
+#pragma clang diagnostic pop
@@ -0,0 +1,331 @@
+#include "std/cixl_stdtime.h"
+#include "idle.h"
+
+#if defined(__linux__)
+#define IDLE_WITH_EPOLL
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#elif defined(__unix__)
+#define IDLE_WITH_POLL
+#include <errno.h>
+#include <poll.h>
+#endif
+
+static int      IDLE_FDS[CIXL_IDLE_MAX_FDS];
+static int      IDLE_FD_COUNT        = 0;
+static bool     IDLE_FRAME_REQUESTED = false;
+static uint64_t IDLE_TIMER_NS        = 0; /* 0 is no timer */
+
+static CIXL_IdleStats IDLE_STATS;
+
+static inline bool idle_timer_is_due(const uint64_t now)
+{
+    return IDLE_TIMER_NS != 0 && now >= IDLE_TIMER_NS;
+}
+
+#if defined(IDLE_WITH_EPOLL)
+
+static int IDLE_EPOLL_FD = -1;
+static int IDLE_TIMER_FD = -1;
+
+static bool idle_init()
+{
+    struct epoll_event event;
+
+    if (IDLE_EPOLL_FD >= 0)
+    {
+        return true;
+    }
+
+    IDLE_EPOLL_FD = epoll_create1(EPOLL_CLOEXEC);
+    IDLE_TIMER_FD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (IDLE_EPOLL_FD < 0 || IDLE_TIMER_FD < 0)
+    {
+        cixl_idle_reset();
+        return false;
+    }
+
+    event.events  = EPOLLIN;
+    event.data.fd = IDLE_TIMER_FD;
+    if (epoll_ctl(IDLE_EPOLL_FD, EPOLL_CTL_ADD, IDLE_TIMER_FD, &event) != 0)
+    {
+        cixl_idle_reset();
+        return false;
+    }
+    return true;
+}
+
+static bool idle_add_fd(const int fd)
+{
+    struct epoll_event event;
+
+    if (!idle_init())
+    {
+        return false;
+    }
+    event.events  = EPOLLIN;
+    event.data.fd = fd;
+    return epoll_ctl(IDLE_EPOLL_FD, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+static void idle_remove_fd(const int fd)
+{
+    if (IDLE_EPOLL_FD >= 0)
+    {
+        epoll_ctl(IDLE_EPOLL_FD, EPOLL_CTL_DEL, fd, NULL);
+    }
+}
+
+static void idle_arm_timer()
+{
+    struct itimerspec timer;
+    uint64_t          expirations;
+
+    if (!idle_init())
+    {
+        return;
+    }
+
+    //all zero (no timer) disarms
+    timer.it_interval.tv_sec  = 0;
+    timer.it_interval.tv_nsec = 0;
+    timer.it_value.tv_sec     = (time_t) (IDLE_TIMER_NS / 1000000000u);
+    timer.it_value.tv_nsec    = (long) (IDLE_TIMER_NS % 1000000000u);
+    timerfd_settime(IDLE_TIMER_FD, TFD_TIMER_ABSTIME, &timer, NULL);
+
+    //drop an expiration that was not read yet, so it does not wake the next wait
+    if (read(IDLE_TIMER_FD, &expirations, sizeof(expirations)) < 0)
+    {
+        expirations = 0;
+    }
+}
+
+static unsigned int idle_block()
+{
+    struct epoll_event events[CIXL_IDLE_MAX_FDS + 1];
+    unsigned int       wake_events = 0;
+    int                count;
+    int                i;
+
+    if (!idle_init())
+    {
+        return 0;
+    }
+
+    do
+    {
+        count = epoll_wait(IDLE_EPOLL_FD, events, CIXL_IDLE_MAX_FDS + 1, -1);
+    } while (count < 0 && errno == EINTR);
+
+    for (i = 0; i < count; ++i)
+    {
+        if (events[i].data.fd == IDLE_TIMER_FD)
+        {
+            uint64_t expirations;
+            if (read(IDLE_TIMER_FD, &expirations, sizeof(expirations)) > 0)
+            {
+                wake_events |= CIXL_WAKE_TIMER;
+            }
+        }
+        else
+        {
+            wake_events |= CIXL_WAKE_INPUT;
+        }
+    }
+    return wake_events;
+}
+
+static void idle_free()
+{
+    if (IDLE_TIMER_FD >= 0)
+    {
+        close(IDLE_TIMER_FD);
+    }
+    if (IDLE_EPOLL_FD >= 0)
+    {
+        close(IDLE_EPOLL_FD);
+    }
+    IDLE_TIMER_FD = -1;
+    IDLE_EPOLL_FD = -1;
+}
+
+#elif defined(IDLE_WITH_POLL)
+
+static bool idle_add_fd(const int fd)
+{
+    (void) fd;
+    return true;
+}
+
+static void idle_remove_fd(const int fd)
+{
+    (void) fd;
+}
+
+static void idle_arm_timer()
+{
+}
+
+static unsigned int idle_block()
+{
+    struct pollfd fds[CIXL_IDLE_MAX_FDS];
+    unsigned int  wake_events = 0;
+    int           timeout_ms  = -1;
+    int           count;
+    int           i;
+
+    for (i = 0; i < IDLE_FD_COUNT; ++i)
+    {
+        fds[i].fd      = IDLE_FDS[i];
+        fds[i].events  = POLLIN;
+        fds[i].revents = 0;
+    }
+
+    if (IDLE_TIMER_NS != 0)
+    {
+        uint64_t now = cixl_monotonic_ns();
+        //round up, so the wait does not end just before the timer is due
+        timeout_ms = IDLE_TIMER_NS > now ? (int) (((IDLE_TIMER_NS - now) + 999999u) / 1000000u) : 0;
+    }
+
+    do
+    {
+        count = poll(fds, (nfds_t) IDLE_FD_COUNT, timeout_ms);
+    } while (count < 0 && errno == EINTR);
+
+    for (i = 0; i < IDLE_FD_COUNT && count > 0; ++i)
+    {
+        if (fds[i].revents != 0)
+        {
+            wake_events |= CIXL_WAKE_INPUT;
+        }
+    }
+
+    if (idle_timer_is_due(cixl_monotonic_ns()))
+    {
+        wake_events |= CIXL_WAKE_TIMER;
+    }
+    return wake_events;
+}
+
+static void idle_free()
+{
+}
+
+#else
+
+static bool idle_add_fd(const int fd)
+{
+    (void) fd;
+    return false;
+}
+
+static void idle_remove_fd(const int fd)
+{
+    (void) fd;
+}
+
+static void idle_arm_timer()
+{
+}
+
+static unsigned int idle_block()
+{
+    return 0;
+}
+
+static void idle_free()
+{
+}
+
+#endif
+
+bool cixl_idle_watch_fd(const int fd)
+{
+    if (IDLE_FD_COUNT >= CIXL_IDLE_MAX_FDS || !idle_add_fd(fd))
+    {
+        return false;
+    }
+    IDLE_FDS[IDLE_FD_COUNT++] = fd;
+    return true;
+}
+
+void cixl_idle_unwatch_fd(const int fd)
+{
+    int i;
+
+    for (i = 0; i < IDLE_FD_COUNT; ++i)
+    {
+        if (IDLE_FDS[i] == fd)
+        {
+            idle_remove_fd(fd);
+            IDLE_FDS[i] = IDLE_FDS[--IDLE_FD_COUNT];
+            return;
+        }
+    }
+}
+
+void cixl_idle_schedule_ms(const uint32_t ms)
+{
+    uint64_t wake_ns = cixl_monotonic_ns() + ((uint64_t) ms * 1000000u);
+
+    if (IDLE_TIMER_NS == 0 || wake_ns < IDLE_TIMER_NS)
+    {
+        IDLE_TIMER_NS = wake_ns;
+        idle_arm_timer();
+    }
+}
+
+void cixl_idle_request_frame()
+{
+    IDLE_FRAME_REQUESTED = true;
+}
+
+unsigned int cixl_idle_wait()
+{
+    unsigned int wake_events = 0;
+    uint64_t     now         = cixl_monotonic_ns();
+
+    if (IDLE_FRAME_REQUESTED)
+    {
+        wake_events |= CIXL_WAKE_FRAME;
+    }
+    if (idle_timer_is_due(now))
+    {
+        wake_events |= CIXL_WAKE_TIMER;
+    }
+
+    if (wake_events == 0 && (IDLE_FD_COUNT > 0 || IDLE_TIMER_NS != 0))
+    {
+        ++IDLE_STATS.blocks;
+        wake_events = idle_block();
+        IDLE_STATS.blocked_ns += cixl_monotonic_ns() - now;
+    }
+
+    if (wake_events & CIXL_WAKE_TIMER)
+    {
+        IDLE_TIMER_NS = 0;
+        idle_arm_timer();
+    }
+    IDLE_FRAME_REQUESTED = false;
+    ++IDLE_STATS.wakes;
+    return wake_events;
+}
+
+CIXL_IdleStats cixl_idle_stats()
+{
+    return IDLE_STATS;
+}
+
+void cixl_idle_reset()
+{
+    CIXL_IdleStats empty = {0, 0, 0};
+
+    idle_free();
+    IDLE_FD_COUNT        = 0;
+    IDLE_FRAME_REQUESTED = false;
+    IDLE_TIMER_NS        = 0;
+    IDLE_STATS           = empty;
+}
@@ -0,0 +1,82 @@
+/*! \file
+ * \brief Event driven idle waiting. Instead of waking up every tick, an event driven game loop (see
+ * CIXL_Game.is_event_driven) blocks until one of the watched file descriptors has input, a scheduled timer fires or a
+ * frame is requested (for example by an animation). An idle game does not use the processor at all.
+ *
+ * Uses epoll and timerfd on Linux and poll on other unix systems. On other platforms #cixl_idle_wait does not block,
+ * so an event driven game runs like a normal one.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_IDLE_H
+#define LIBCIXL_IDLE_H
+
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+
+/*! \brief The maximum number of watched file descriptors.*/
+#ifndef CIXL_IDLE_MAX_FDS
+#define CIXL_IDLE_MAX_FDS 16
+#endif
+
+/*! \brief Wake event: a watched file descriptor has input.*/
+#define CIXL_WAKE_INPUT 1u
+
+/*! \brief Wake event: a timer scheduled with #cixl_idle_schedule_ms fired.*/
+#define CIXL_WAKE_TIMER 2u
+
+/*! \brief Wake event: a frame was requested with #cixl_idle_request_frame.*/
+#define CIXL_WAKE_FRAME 4u
+
+typedef struct CIXL_IdleStats
+{
+    /*! \brief The number of times #cixl_idle_wait returned.*/
+    uint64_t wakes;
+
+    /*! \brief The number of times #cixl_idle_wait blocked.*/
+    uint64_t blocks;
+
+    /*! \brief Total time spent blocked.*/
+    uint64_t blocked_ns;
+} CIXL_IdleStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Wakes the idle wait when the file descriptor has input (for example stdin). The input must be read, otherwise
+ * the next wait returns immediately again.
+ * \return false when the maximum number of watched file descriptors is reached or the descriptor can not be watched.*/
+CIXLLIB_API bool cixl_idle_watch_fd(const int fd);
+
+CIXLLIB_API void cixl_idle_unwatch_fd(const int fd);
+
+/*! \brief Wakes the idle wait after the given number of milliseconds. When multiple wakes are scheduled, the earliest
+ * one is kept, schedule again after it fired for a later one.*/
+CIXLLIB_API void cixl_idle_schedule_ms(const uint32_t ms);
+
+/*! \brief The next wait returns immediately. Call this every update while something animates.*/
+CIXLLIB_API void cixl_idle_request_frame();
+
+/*! \brief Blocks until there is input on a watched file descriptor, the scheduled timer fires or a frame was requested.
+ * \return the wake events (#CIXL_WAKE_INPUT, #CIXL_WAKE_TIMER, #CIXL_WAKE_FRAME), 0 when waiting is not supported or
+ * there is nothing to wait for.*/
+CIXLLIB_API unsigned int cixl_idle_wait();
+
+CIXLLIB_API CIXL_IdleStats cixl_idle_stats();
+
+/*! \brief Stops watching all file descriptors, clears the timer and requested frame and frees the resources.*/
+CIXLLIB_API void cixl_idle_reset();
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_IDLE_H
+
+#pragma clang diagnostic pop
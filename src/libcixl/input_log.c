@@ -0,0 +1,502 @@
+#include <stdio.h>
+#include <string.h>
+#include "std/cixl_stdlib.h"
+#include "input_log_internal.h"
+
+#define INPUT_LOG_HEADER_SIZE 24
+
+/* A record is at most a kind and 6 varints of up to 10 bytes */
+#define INPUT_LOG_MAX_RECORD_SIZE 61
+
+#define RECORD_KIND_TICK 'T'
+#define RECORD_KIND_INPUT 'I'
+
+static const char INPUT_LOG_MAGIC[7] = {'C', 'I', 'X', 'L', 'I', 'N', 'P'};
+
+bool INPUT_LOG_RECORDING = false;
+bool INPUT_LOG_REPLAYING = false;
+
+static CIXL_InputLogStats INPUT_LOG_STATS;
+
+/* The game time of the last recorded or replayed input, the inputs are stored relative to it */
+static CIXL_Ticks INPUT_LOG_LAST_INPUT_TICKS = 0;
+
+/* The time the last tick was done, the ticks are stored relative to it */
+static CIXL_Ticks INPUT_LOG_LAST_TICK_TICKS = 0;
+
+/* Random */
+
+static uint64_t RANDOM_STATE = UINT64_C(0x853c49e6748fea9b);
+
+void cixl_random_seed(const uint64_t seed)
+{
+    RANDOM_STATE = 0;
+    cixl_random();
+    RANDOM_STATE += seed;
+    cixl_random();
+}
+
+uint32_t cixl_random()
+{
+    uint64_t old_state = RANDOM_STATE;
+    uint32_t xorshifted;
+    uint32_t rotation;
+
+    RANDOM_STATE = old_state * UINT64_C(6364136223846793005) + UINT64_C(1442695040888963407);
+    xorshifted   = (uint32_t) (((old_state >> 18u) ^ old_state) >> 27u);
+    rotation     = (uint32_t) (old_state >> 59u);
+    return (xorshifted >> rotation) | (xorshifted << ((32u - rotation) & 31u));
+}
+
+/* Queue */
+
+static CIXL_InputEvent INPUT_QUEUE[CIXL_INPUT_QUEUE_SIZE];
+static unsigned int    INPUT_QUEUE_HEAD  = 0;
+static unsigned int    INPUT_QUEUE_COUNT = 0;
+
+/* The text of the queued paste events, in the order of the events */
+static char   INPUT_PASTE_QUEUE[CIXL_INPUT_PASTE_QUEUE_SIZE];
+static size_t INPUT_PASTE_QUEUE_HEAD  = 0;
+static size_t INPUT_PASTE_QUEUE_COUNT = 0;
+
+/* The text of the last polled paste event, and how much of it was copied */
+static char   INPUT_PASTE_TEXT[CIXL_INPUT_MAX_PASTE_SIZE];
+static size_t INPUT_PASTE_SIZE = 0;
+static size_t INPUT_PASTE_READ = 0;
+
+static void input_queue_add(const CIXL_InputEvent *event)
+{
+    INPUT_QUEUE[(INPUT_QUEUE_HEAD + INPUT_QUEUE_COUNT) % CIXL_INPUT_QUEUE_SIZE] = *event;
+    ++INPUT_QUEUE_COUNT;
+}
+
+bool cixl_input_push(const CIXL_InputEvent *event)
+{
+    if (INPUT_LOG_REPLAYING || INPUT_QUEUE_COUNT >= CIXL_INPUT_QUEUE_SIZE || event->type == CIXL_INPUT_PASTE)
+    {
+        return false;
+    }
+    input_queue_add(event);
+    return true;
+}
+
+bool cixl_input_push_paste(const char *text, const size_t size)
+{
+    CIXL_InputEvent event;
+    size_t          i;
+
+    if (INPUT_LOG_REPLAYING || INPUT_QUEUE_COUNT >= CIXL_INPUT_QUEUE_SIZE || size > CIXL_INPUT_MAX_PASTE_SIZE ||
+        INPUT_PASTE_QUEUE_COUNT + size > CIXL_INPUT_PASTE_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    for (i = 0; i < size; ++i)
+    {
+        INPUT_PASTE_QUEUE[(INPUT_PASTE_QUEUE_HEAD + INPUT_PASTE_QUEUE_COUNT + i) % CIXL_INPUT_PASTE_QUEUE_SIZE] = text[i];
+    }
+    INPUT_PASTE_QUEUE_COUNT += size;
+
+    event.type      = CIXL_INPUT_PASTE;
+    event.modifiers = 0;
+    event.code      = (uint32_t) size;
+    event.x         = 0;
+    event.y         = 0;
+    input_queue_add(&event);
+    return true;
+}
+
+/* Takes the text of the paste event that was taken from the queue, it becomes the text of #cixl_input_paste */
+static void input_paste_take(const size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; ++i)
+    {
+        INPUT_PASTE_TEXT[i] = INPUT_PASTE_QUEUE[(INPUT_PASTE_QUEUE_HEAD + i) % CIXL_INPUT_PASTE_QUEUE_SIZE];
+    }
+    INPUT_PASTE_QUEUE_HEAD = (INPUT_PASTE_QUEUE_HEAD + size) % CIXL_INPUT_PASTE_QUEUE_SIZE;
+    INPUT_PASTE_QUEUE_COUNT -= size;
+    INPUT_PASTE_SIZE = size;
+    INPUT_PASTE_READ = 0;
+}
+
+/* Encoding */
+
+static inline size_t write_varint(uint8_t *dst, uint64_t value)
+{
+    size_t size = 0;
+
+    while (value >= 0x80)
+    {
+        dst[size++] = (uint8_t) ((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    dst[size++] = (uint8_t) value;
+    return size;
+}
+
+static inline uint64_t zigzag_encode(const int32_t value)
+{
+    return value < 0 ? ((uint64_t) (-(int64_t) value) * 2u) - 1u : (uint64_t) value * 2u;
+}
+
+static inline int32_t zigzag_decode(const uint64_t value)
+{
+    return (value & 1u) ? (int32_t) (-(int64_t) ((value + 1u) / 2u)) : (int32_t) (value / 2u);
+}
+
+static inline void write_u64(uint8_t *dst, const uint64_t value)
+{
+    int i;
+
+    for (i = 0; i < 8; ++i)
+    {
+        dst[i] = (uint8_t) ((value >> (8 * i)) & 0xFF);
+    }
+}
+
+static inline uint64_t read_u64(const uint8_t *src)
+{
+    uint64_t value = 0;
+    int      i;
+
+    for (i = 7; i >= 0; --i)
+    {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+/* Recording */
+
+static FILE    *INPUT_LOG_FILE = NULL;
+
+/* The inputs polled during the current tick, they are written after the tick */
+static uint8_t *INPUT_LOG_PENDING          = NULL;
+static size_t  INPUT_LOG_PENDING_SIZE     = 0;
+static size_t  INPUT_LOG_PENDING_CAPACITY = 0;
+
+static void record_input(const CIXL_Ticks game_ticks, const CIXL_InputEvent *event)
+{
+    const size_t text_size = event->type == CIXL_INPUT_PASTE ? INPUT_PASTE_SIZE : 0;
+    uint8_t      *record;
+
+    if (INPUT_LOG_PENDING_SIZE + INPUT_LOG_MAX_RECORD_SIZE + text_size > INPUT_LOG_PENDING_CAPACITY)
+    {
+        size_t  capacity = INPUT_LOG_PENDING_CAPACITY > 0 ? INPUT_LOG_PENDING_CAPACITY * 2 : 1024;
+        uint8_t *pending;
+
+        while (INPUT_LOG_PENDING_SIZE + INPUT_LOG_MAX_RECORD_SIZE + text_size > capacity)
+        {
+            capacity *= 2;
+        }
+        pending = cixl_mem_realloc(INPUT_LOG_PENDING, capacity);
+        if (pending == NULL)
+        {
+            return;
+        }
+        INPUT_LOG_PENDING          = pending;
+        INPUT_LOG_PENDING_CAPACITY = capacity;
+    }
+
+    record = &INPUT_LOG_PENDING[INPUT_LOG_PENDING_SIZE];
+    record[0] = RECORD_KIND_INPUT;
+    INPUT_LOG_PENDING_SIZE += 1;
+    INPUT_LOG_PENDING_SIZE += write_varint(&INPUT_LOG_PENDING[INPUT_LOG_PENDING_SIZE],
+                                           game_ticks - INPUT_LOG_LAST_INPUT_TICKS);
+    INPUT_LOG_PENDING_SIZE += write_varint(&INPUT_LOG_PENDING[INPUT_LOG_PENDING_SIZE], event->type);
+    INPUT_LOG_PENDING_SIZE += write_varint(&INPUT_LOG_PENDING[INPUT_LOG_PENDING_SIZE], event->modifiers);
+    INPUT_LOG_PENDING_SIZE += write_varint(&INPUT_LOG_PENDING[INPUT_LOG_PENDING_SIZE], event->code);
+    INPUT_LOG_PENDING_SIZE += write_varint(&INPUT_LOG_PENDING[INPUT_LOG_PENDING_SIZE], zigzag_encode(event->x));
+    INPUT_LOG_PENDING_SIZE += write_varint(&INPUT_LOG_PENDING[INPUT_LOG_PENDING_SIZE], zigzag_encode(event->y));
+    memcpy(&INPUT_LOG_PENDING[INPUT_LOG_PENDING_SIZE], INPUT_PASTE_TEXT, text_size);
+    INPUT_LOG_PENDING_SIZE += text_size;
+
+    INPUT_LOG_LAST_INPUT_TICKS = game_ticks;
+    ++INPUT_LOG_STATS.events;
+}
+
+void input_log_record_tick(const CIXL_Ticks from_ticks, const CIXL_Ticks to_ticks)
+{
+    uint8_t record[INPUT_LOG_MAX_RECORD_SIZE];
+    size_t  size = 1;
+
+    record[0] = RECORD_KIND_TICK;
+    size += write_varint(&record[size], from_ticks - INPUT_LOG_LAST_TICK_TICKS);
+    size += write_varint(&record[size], to_ticks - from_ticks);
+    fwrite(record, 1, size, INPUT_LOG_FILE);
+    if (INPUT_LOG_PENDING_SIZE > 0)
+    {
+        fwrite(INPUT_LOG_PENDING, 1, INPUT_LOG_PENDING_SIZE, INPUT_LOG_FILE);
+        INPUT_LOG_PENDING_SIZE = 0;
+    }
+
+    INPUT_LOG_LAST_TICK_TICKS = to_ticks;
+    ++INPUT_LOG_STATS.ticks;
+}
+
+static void input_log_reset()
+{
+    CIXL_InputLogStats empty = {0, 0};
+
+    INPUT_LOG_STATS            = empty;
+    INPUT_LOG_LAST_INPUT_TICKS = 0;
+    INPUT_LOG_LAST_TICK_TICKS  = 0;
+    INPUT_QUEUE_HEAD           = 0;
+    INPUT_QUEUE_COUNT          = 0;
+    INPUT_PASTE_QUEUE_HEAD     = 0;
+    INPUT_PASTE_QUEUE_COUNT    = 0;
+    INPUT_PASTE_SIZE           = 0;
+    INPUT_PASTE_READ           = 0;
+}
+
+bool cixl_input_record_start(const char *file_path, const uint64_t seed)
+{
+    uint8_t header[INPUT_LOG_HEADER_SIZE];
+
+    if (INPUT_LOG_RECORDING || INPUT_LOG_REPLAYING)
+    {
+        return false;
+    }
+
+    INPUT_LOG_FILE = fopen(file_path, "wb");
+    if (INPUT_LOG_FILE == NULL)
+    {
+        return false;
+    }
+
+    memcpy(header, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC));
+    header[7] = CIXL_INPUT_LOG_VERSION;
+    write_u64(&header[8], seed);
+    write_u64(&header[16], cixl_game_create()->ticks_per_second);
+    fwrite(header, 1, INPUT_LOG_HEADER_SIZE, INPUT_LOG_FILE);
+
+    input_log_reset();
+    INPUT_LOG_PENDING_SIZE = 0;
+    cixl_random_seed(seed);
+    INPUT_LOG_RECORDING = true;
+    return true;
+}
+
+bool cixl_input_record_stop()
+{
+    if (!INPUT_LOG_RECORDING)
+    {
+        return false;
+    }
+
+    fclose(INPUT_LOG_FILE);
+    INPUT_LOG_FILE = NULL;
+    cixl_mem_free(INPUT_LOG_PENDING);
+    INPUT_LOG_PENDING          = NULL;
+    INPUT_LOG_PENDING_SIZE     = 0;
+    INPUT_LOG_PENDING_CAPACITY = 0;
+    INPUT_LOG_RECORDING        = false;
+    return true;
+}
+
+/* Replay */
+
+static uint8_t *REPLAY_DATA     = NULL;
+static size_t  REPLAY_SIZE     = 0;
+static size_t  REPLAY_POSITION = 0;
+
+static bool replay_read_varint(size_t *position, uint64_t *value)
+{
+    unsigned int shift = 0;
+
+    *value = 0;
+    while (*position < REPLAY_SIZE && shift < 64)
+    {
+        uint8_t byte = REPLAY_DATA[(*position)++];
+
+        *value |= (uint64_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+        shift += 7;
+    }
+    return false;
+}
+
+/* Reads the input record at position (after the kind), the text of a paste is at text_position */
+static bool replay_read_input(size_t *position, CIXL_Ticks *game_ticks, CIXL_InputEvent *event, size_t *text_position)
+{
+    uint64_t values[6];
+    int      i;
+
+    for (i = 0; i < 6; ++i)
+    {
+        if (!replay_read_varint(position, &values[i]))
+        {
+            return false;
+        }
+    }
+    *game_ticks       = INPUT_LOG_LAST_INPUT_TICKS + values[0];
+    event->type      = (uint16_t) values[1];
+    event->modifiers = (uint16_t) values[2];
+    event->code      = (uint32_t) values[3];
+    event->x         = zigzag_decode(values[4]);
+    event->y         = zigzag_decode(values[5]);
+
+    *text_position = *position;
+    if (event->type == CIXL_INPUT_PASTE)
+    {
+        if (event->code > CIXL_INPUT_MAX_PASTE_SIZE || REPLAY_SIZE - *position < event->code)
+        {
+            return false;
+        }
+        *position += event->code;
+    }
+    return true;
+}
+
+bool input_log_replay_tick(CIXL_Ticks *from_ticks, CIXL_Ticks *to_ticks)
+{
+    uint64_t        since_last;
+    uint64_t        duration;
+    CIXL_InputEvent skipped;
+    CIXL_Ticks      skipped_ticks;
+    size_t          skipped_text;
+
+    //skip the inputs of the previous tick the game did not poll
+    while (REPLAY_POSITION < REPLAY_SIZE && REPLAY_DATA[REPLAY_POSITION] == RECORD_KIND_INPUT)
+    {
+        ++REPLAY_POSITION;
+        if (!replay_read_input(&REPLAY_POSITION, &skipped_ticks, &skipped, &skipped_text))
+        {
+            return false;
+        }
+        INPUT_LOG_LAST_INPUT_TICKS = skipped_ticks;
+    }
+
+    if (REPLAY_POSITION >= REPLAY_SIZE || REPLAY_DATA[REPLAY_POSITION] != RECORD_KIND_TICK)
+    {
+        return false;
+    }
+    ++REPLAY_POSITION;
+    if (!replay_read_varint(&REPLAY_POSITION, &since_last) || !replay_read_varint(&REPLAY_POSITION, &duration))
+    {
+        return false;
+    }
+
+    *from_ticks = INPUT_LOG_LAST_TICK_TICKS + since_last;
+    *to_ticks   = *from_ticks + duration;
+
+    INPUT_LOG_LAST_TICK_TICKS = *to_ticks;
+    ++INPUT_LOG_STATS.ticks;
+    return true;
+}
+
+bool cixl_input_replay_start(const char *file_path)
+{
+    FILE *file;
+    long file_size;
+
+    if (INPUT_LOG_RECORDING || INPUT_LOG_REPLAYING)
+    {
+        return false;
+    }
+
+    file = fopen(file_path, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    REPLAY_DATA = file_size >= INPUT_LOG_HEADER_SIZE ? cixl_mem_alloc((size_t) file_size, sizeof(uint8_t)) : NULL;
+    if (REPLAY_DATA == NULL || fread(REPLAY_DATA, 1, (size_t) file_size, file) != (size_t) file_size ||
+        memcmp(REPLAY_DATA, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC)) != 0 ||
+        REPLAY_DATA[7] != CIXL_INPUT_LOG_VERSION || read_u64(&REPLAY_DATA[16]) == 0)
+    {
+        fclose(file);
+        cixl_mem_free(REPLAY_DATA);
+        REPLAY_DATA = NULL;
+        return false;
+    }
+    fclose(file);
+
+    input_log_reset();
+    REPLAY_SIZE     = (size_t) file_size;
+    REPLAY_POSITION = INPUT_LOG_HEADER_SIZE;
+    cixl_random_seed(read_u64(&REPLAY_DATA[8]));
+    cixl_time_virtual_set(0);
+    cixl_game_set_time_source(cixl_time_virtual, read_u64(&REPLAY_DATA[16]));
+    INPUT_LOG_REPLAYING = true;
+    return true;
+}
+
+void cixl_input_replay_stop()
+{
+    cixl_mem_free(REPLAY_DATA);
+    REPLAY_DATA         = NULL;
+    REPLAY_SIZE         = 0;
+    REPLAY_POSITION     = 0;
+    INPUT_LOG_REPLAYING = false;
+}
+
+bool cixl_input_poll(const CIXL_GameTime *game_time, CIXL_InputEvent *event)
+{
+    if (INPUT_LOG_REPLAYING)
+    {
+        size_t     position = REPLAY_POSITION + 1;
+        size_t     text_position;
+        CIXL_Ticks game_ticks;
+
+        if (REPLAY_POSITION >= REPLAY_SIZE || REPLAY_DATA[REPLAY_POSITION] != RECORD_KIND_INPUT ||
+            !replay_read_input(&position, &game_ticks, event, &text_position) ||
+            game_ticks != game_time->total_game_time_ticks)
+        {
+            return false;
+        }
+        if (event->type == CIXL_INPUT_PASTE)
+        {
+            memcpy(INPUT_PASTE_TEXT, &REPLAY_DATA[text_position], event->code);
+            INPUT_PASTE_SIZE = event->code;
+            INPUT_PASTE_READ = 0;
+        }
+        REPLAY_POSITION            = position;
+        INPUT_LOG_LAST_INPUT_TICKS = game_ticks;
+        ++INPUT_LOG_STATS.events;
+        return true;
+    }
+
+    if (INPUT_QUEUE_COUNT == 0)
+    {
+        return false;
+    }
+    *event = INPUT_QUEUE[INPUT_QUEUE_HEAD];
+    INPUT_QUEUE_HEAD = (INPUT_QUEUE_HEAD + 1) % CIXL_INPUT_QUEUE_SIZE;
+    --INPUT_QUEUE_COUNT;
+    if (event->type == CIXL_INPUT_PASTE)
+    {
+        input_paste_take(event->code);
+    }
+
+    if (INPUT_LOG_RECORDING)
+    {
+        record_input(game_time->total_game_time_ticks, event);
+    }
+    return true;
+}
+
+size_t cixl_input_paste(char *dst, const size_t size)
+{
+    size_t count = INPUT_PASTE_SIZE - INPUT_PASTE_READ;
+
+    count = size < count ? size : count;
+    memcpy(dst, &INPUT_PASTE_TEXT[INPUT_PASTE_READ], count);
+    INPUT_PASTE_READ += count;
+    return count;
+}
+
+CIXL_InputLogStats cixl_input_log_stats()
+{
+    return INPUT_LOG_STATS;
+}
@@ -0,0 +1,141 @@
+/*! \file
+ * \brief Input recording and deterministic replay of the game loop of #cixl_game_run.
+ * The game gets its input from #cixl_input_poll in its update method, the platform (or the game itself) queues the
+ * input with #cixl_input_push. While recording, the time of every tick and every polled input event is logged,
+ * together with the seed of the random generator (#cixl_random). A replay feeds the same ticks through the game loop on
+ * the virtual clock (#cixl_time_virtual): the game does the same updates and draws with the same input, as fast as it
+ * can. Replaying a recorded session is a reproducible benchmark of the updates and renders of a real session.
+ *
+ * The game must only use #cixl_random for randomness and must not read the time itself. The slow policy measures
+ * time, so it does not act the same during a replay. Event driven games (CIXL_Game.is_event_driven) can not be
+ * replayed, since they wait for live input.
+ *
+ * File format (all fixed size numbers are little endian, varints are LEB128):
+ *  - header: "CIXLINP" + version (u8), seed (u64), ticks per second of the time source (u64)
+ *  - tick: 'T', the time since the previous tick (varint), the time the tick covers (varint)
+ *  - input: 'I', game time since the previous input (varint), type (varint), modifiers (varint), code (varint),
+ *    x and y (zigzag varint), and for #CIXL_INPUT_PASTE the code bytes of pasted text. The inputs that were polled
+ *    during a tick follow the tick.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_INPUT_LOG_H
+#define LIBCIXL_INPUT_LOG_H
+
+#include <stddef.h>
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+#include "game.h"
+
+#define CIXL_INPUT_LOG_VERSION 2
+
+/*! \brief The maximum number of input events that are queued and not polled yet.*/
+#ifndef CIXL_INPUT_QUEUE_SIZE
+#define CIXL_INPUT_QUEUE_SIZE 256
+#endif
+
+/*! \brief The number of bytes of pasted text that can be queued and not polled yet.*/
+#ifndef CIXL_INPUT_PASTE_QUEUE_SIZE
+#define CIXL_INPUT_PASTE_QUEUE_SIZE 65536
+#endif
+
+/*! \brief The maximum size of the text of one #CIXL_INPUT_PASTE event.*/
+#define CIXL_INPUT_MAX_PASTE_SIZE 4096
+
+/*! \brief Input event type: a key, code is the character or key code.*/
+#define CIXL_INPUT_KEY 1u
+
+/*! \brief Input event type: a mouse button or movement at x, y.*/
+#define CIXL_INPUT_MOUSE 2u
+
+/*! \brief Input event type: pasted text, code is the number of bytes (see #cixl_input_paste).*/
+#define CIXL_INPUT_PASTE 3u
+
+/*! \brief Input event types from this value up are free to use by the game.*/
+#define CIXL_INPUT_USER 64u
+
+typedef struct CIXL_InputEvent
+{
+    /*! \brief What kind of input, for example #CIXL_INPUT_KEY.*/
+    uint16_t type;
+
+    /*! \brief The modifier keys that were held, a bit mask.*/
+    uint16_t modifiers;
+
+    uint32_t code;
+    int32_t  x;
+    int32_t  y;
+} CIXL_InputEvent;
+
+typedef struct CIXL_InputLogStats
+{
+    /*! \brief The number of recorded or replayed ticks.*/
+    uint64_t ticks;
+
+    /*! \brief The number of recorded or replayed input events.*/
+    uint64_t events;
+} CIXL_InputLogStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Seeds the random generator, the same seed gives the same numbers.*/
+CIXLLIB_API void cixl_random_seed(const uint64_t seed);
+
+/*! \brief The next number of the random generator (pcg32).*/
+CIXLLIB_API uint32_t cixl_random();
+
+/*! \brief Queues an input event for #cixl_input_poll. Ignored during a replay. Pasted text is queued with
+ * #cixl_input_push_paste.
+ * \return false when the queue is full, the event is a #CIXL_INPUT_PASTE or a replay is running.*/
+CIXLLIB_API bool cixl_input_push(const CIXL_InputEvent *event);
+
+/*! \brief Queues a #CIXL_INPUT_PASTE event with the given text (at most #CIXL_INPUT_MAX_PASTE_SIZE bytes) for
+ * #cixl_input_poll. Ignored during a replay.
+ * \return false when the queue is full, the text is too long or a replay is running.*/
+CIXLLIB_API bool cixl_input_push_paste(const char *text, const size_t size);
+
+/*! \brief The next input event for the update at the given game time. Call this from the update method until it
+ * returns false. During a replay these are the recorded events instead of the queued ones.
+ * \return false when there is no more input for this update.*/
+CIXLLIB_API bool cixl_input_poll(const CIXL_GameTime *game_time, CIXL_InputEvent *event);
+
+/*! \brief Copies the text of the #CIXL_INPUT_PASTE event that was polled last, can be called multiple times to copy it
+ * in parts. Text that is not copied is skipped when the next event is polled.
+ * \return the number of bytes copied, 0 when all text of the event was copied.*/
+CIXLLIB_API size_t cixl_input_paste(char *dst, const size_t size);
+
+/*! \brief Starts recording the ticks of #cixl_game_run and the polled input to the given file, and seeds the random
+ * generator. Call this before the first tick.
+ * \return false when the file could not be opened or a recording or replay is active.*/
+CIXLLIB_API bool cixl_input_record_start(const char *file_path, const uint64_t seed);
+
+/*! \brief Stops recording and closes the file.
+ * \return false when nothing was recorded.*/
+CIXLLIB_API bool cixl_input_record_stop();
+
+/*! \brief Starts replaying a recording: seeds the random generator with the recorded seed and sets the time source of
+ * the game to #cixl_time_virtual. Call this before #cixl_game_init, then #cixl_game_run runs the recorded ticks as fast
+ * as it can and exits after the last one. Set the time source back afterwards, see #cixl_game_set_time_source.
+ * \return false when the file could not be read or is not a recording, or a recording or replay is active.*/
+CIXLLIB_API bool cixl_input_replay_start(const char *file_path);
+
+/*! \brief Stops the replay and frees it.*/
+CIXLLIB_API void cixl_input_replay_stop();
+
+/*! \brief The ticks and events that were recorded or replayed so far.*/
+CIXLLIB_API CIXL_InputLogStats cixl_input_log_stats();
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_INPUT_LOG_H
+
+#pragma clang diagnostic pop
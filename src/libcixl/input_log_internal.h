@@ -0,0 +1,38 @@
+/*! \file
+ * \brief The part of the input log (see input_log.h) that the game loop uses, not part of the public api.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_INPUT_LOG_INTERNAL_H
+#define LIBCIXL_INPUT_LOG_INTERNAL_H
+
+#include "std/cixl_stdbool.h"
+#include "input_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Checked by the game loop on every tick.*/
+extern bool INPUT_LOG_RECORDING;
+extern bool INPUT_LOG_REPLAYING;
+
+/*! \brief Logs a tick of the game loop that started at from_ticks (the time of the previous tick) and was done at
+ * to_ticks.*/
+void input_log_record_tick(const CIXL_Ticks from_ticks, const CIXL_Ticks to_ticks);
+
+/*! \brief The next tick of the replay, skips the inputs of the previous tick that were not polled.
+ * \return false when the replay is done.*/
+bool input_log_replay_tick(CIXL_Ticks *from_ticks, CIXL_Ticks *to_ticks);
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_INPUT_LOG_INTERNAL_H
+
+#pragma clang diagnostic pop
@@ -9,6 +9,24 @@
 #include "style_opts.h"
 #include "cxl.h"
 #include "screen_buffer.h"
+#include "render_stats.h"
+#include "overdraw.h"
 #include "game.h"
+#include "pacing.h"
+#include "idle.h"
+#include "histogram.h"
+#include "trace.h"
+#include "perf_counters.h"
+#include "input_log.h"
+#include "term_input.h"
+#include "linux_term.h"
+#include "frame_recorder.h"
+#include "vt_device.h"
+#include "vt_caps.h"
+#include "raster_device.h"
+#include "video_capture.h"
+#include "asciicast.h"
+#include "counting_device.h"
+#include "vt_model.h"
 
 #endif //LIBCIXL_LIBCIXL_H
@@ -0,0 +1,300 @@
+#include "linux_term.h"
+#include "term_input.h"
+#include "vt_device.h"
+#include "vt_caps.h"
+#include "idle.h"
+
+#if defined(__linux__)
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "std/cixl_stdtime.h"
+
+#define LINUX_TERM_PROBE_READ_SIZE 1024
+
+static const char TERM_ENTER[] = "\033[?1049h\033[?25l\033[0m\033[2J";
+static const char TERM_LEAVE[] = "\033[0m\033[?25h\033[?1049l";
+static const char TERM_CLEAR[] = "\033[0m\033[2J";
+
+static bool             LINUX_TERM_STARTED = false;
+static int              LINUX_TERM_IN_FD   = -1;
+static int              LINUX_TERM_OUT_FD  = -1;
+static int              LINUX_TERM_WIDTH   = CIXL_LINUX_TERM_DEFAULT_WIDTH;
+static int              LINUX_TERM_HEIGHT  = CIXL_LINUX_TERM_DEFAULT_HEIGHT;
+static struct sigaction LINUX_TERM_PREVIOUS_SIGWINCH;
+
+static volatile sig_atomic_t LINUX_TERM_RESIZED = 0;
+
+static void linux_term_on_sigwinch(int signal_number)
+{
+    (void) signal_number;
+    LINUX_TERM_RESIZED = 1;
+}
+
+static void linux_term_write_all(const char *bytes, size_t size)
+{
+    ssize_t written;
+
+    while (size > 0)
+    {
+        written = write(LINUX_TERM_OUT_FD, bytes, size);
+        if (written > 0)
+        {
+            bytes += written;
+            size -= (size_t) written;
+        }
+        else if (written < 0 && errno == EAGAIN)
+        {
+            //the input is non blocking, and on a terminal it usually shares the file description with the output
+            struct pollfd out;
+            out.fd     = LINUX_TERM_OUT_FD;
+            out.events = POLLOUT;
+            poll(&out, 1, -1);
+        }
+        else if (written < 0 && errno != EINTR)
+        {
+            return;
+        }
+    }
+}
+
+static size_t linux_term_vt_write(const char *bytes, const size_t size)
+{
+    linux_term_write_all(bytes, size);
+    return size;
+}
+
+static void linux_term_read_size()
+{
+    struct winsize size;
+
+    if (ioctl(LINUX_TERM_OUT_FD, TIOCGWINSZ, &size) == 0 && size.ws_col > 1 && size.ws_row > 1)
+    {
+        LINUX_TERM_WIDTH  = size.ws_col;
+        LINUX_TERM_HEIGHT = size.ws_row;
+    }
+}
+
+bool cixl_linux_term_start(const int in_fd, const int out_fd, const unsigned int input_flags)
+{
+    struct sigaction on_resize;
+
+    if (LINUX_TERM_STARTED || out_fd < 0 || !cixl_term_input_start(in_fd, out_fd, input_flags))
+    {
+        return false;
+    }
+
+    LINUX_TERM_IN_FD   = in_fd;
+    LINUX_TERM_OUT_FD  = out_fd;
+    LINUX_TERM_WIDTH   = CIXL_LINUX_TERM_DEFAULT_WIDTH;
+    LINUX_TERM_HEIGHT  = CIXL_LINUX_TERM_DEFAULT_HEIGHT;
+    LINUX_TERM_RESIZED = 0;
+    linux_term_read_size();
+
+    memset(&on_resize, 0, sizeof(on_resize));
+    on_resize.sa_handler = linux_term_on_sigwinch;
+    sigemptyset(&on_resize.sa_mask);
+    //no SA_RESTART: a resize interrupts the poll of cixl_linux_term_poll
+    sigaction(SIGWINCH, &on_resize, &LINUX_TERM_PREVIOUS_SIGWINCH);
+
+    linux_term_write_all(TERM_ENTER, sizeof(TERM_ENTER) - 1);
+    cixl_vt_set_capabilities(cixl_vt_caps_profile_from_env());
+    cixl_init_screen_buffer(LINUX_TERM_WIDTH, LINUX_TERM_HEIGHT, cixl_vt_device(linux_term_vt_write));
+    LINUX_TERM_STARTED = true;
+    return true;
+}
+
+void cixl_linux_term_stop()
+{
+    if (!LINUX_TERM_STARTED)
+    {
+        return;
+    }
+
+    cixl_vt_flush();
+    cixl_vt_set_capabilities(CIXL_VT_CAPS_NONE);
+    linux_term_write_all(TERM_LEAVE, sizeof(TERM_LEAVE) - 1);
+    sigaction(SIGWINCH, &LINUX_TERM_PREVIOUS_SIGWINCH, NULL);
+    cixl_term_input_stop();
+    cixl_free_screen_buffer();
+    LINUX_TERM_IN_FD   = -1;
+    LINUX_TERM_OUT_FD  = -1;
+    LINUX_TERM_STARTED = false;
+}
+
+CIXL_RenderDevice *cixl_linux_term_device()
+{
+    return cixl_vt_device(linux_term_vt_write);
+}
+
+void cixl_linux_term_size(int *width, int *height)
+{
+    *width  = LINUX_TERM_WIDTH;
+    *height = LINUX_TERM_HEIGHT;
+}
+
+bool cixl_linux_term_check_resize()
+{
+    if (!LINUX_TERM_STARTED || !LINUX_TERM_RESIZED)
+    {
+        return false;
+    }
+
+    LINUX_TERM_RESIZED = 0;
+    linux_term_read_size();
+    cixl_init_screen_buffer(LINUX_TERM_WIDTH, LINUX_TERM_HEIGHT, cixl_vt_device(linux_term_vt_write));
+
+    //the terminal reflowed or cut off the old screen, start from a clear screen and an unknown cursor and colors
+    cixl_vt_write_raw(TERM_CLEAR, sizeof(TERM_CLEAR) - 1);
+    cixl_vt_flush();
+    cixl_vt_reset_state();
+    return true;
+}
+
+unsigned int cixl_linux_term_probe(const int timeout_ms)
+{
+    static const char query[] = CIXL_VT_CAPS_QUERY;
+    CIXL_VtCapsProbe  probe;
+    char              buffer[LINUX_TERM_PROBE_READ_SIZE];
+    struct pollfd     in;
+    uint64_t          deadline_ns;
+    uint64_t          now_ns;
+    ssize_t           count;
+    size_t            size    = 0;
+    size_t            partial = 0;
+    size_t            other;
+
+    if (!LINUX_TERM_STARTED)
+    {
+        return CIXL_VT_CAPS_NONE;
+    }
+
+    cixl_vt_caps_probe_init(&probe, cixl_vt_caps_profile_from_env());
+    cixl_vt_flush();
+    linux_term_write_all(query, sizeof(query) - 1);
+
+    deadline_ns = cixl_monotonic_ns() + (uint64_t) timeout_ms * 1000000u;
+    while (!probe.done && (now_ns = cixl_monotonic_ns()) < deadline_ns)
+    {
+        in.fd      = LINUX_TERM_IN_FD;
+        in.events  = POLLIN;
+        in.revents = 0;
+        if (poll(&in, 1, (int) ((deadline_ns - now_ns + 999999u) / 1000000u)) <= 0)
+        {
+            continue;
+        }
+
+        count = read(LINUX_TERM_IN_FD, &buffer[partial], sizeof(buffer) - partial);
+        if (count > 0)
+        {
+            //a reply that is split over reads is kept until the rest arrived, it is not input
+            size    = partial + (size_t) count;
+            partial = cixl_vt_caps_partial_reply(buffer, size);
+            partial = partial < sizeof(buffer) / 2 ? partial : 0;
+
+            //keys the user pressed in the meantime are input like any other
+            other = cixl_vt_caps_parse_reply(&probe, buffer, size - partial);
+            if (other > 0)
+            {
+                cixl_term_input_feed(buffer, other);
+            }
+            memmove(buffer, &buffer[size - partial], partial);
+        }
+    }
+
+    //the rest of the reply did not arrive in time, so it was input after all
+    if (partial > 0)
+    {
+        cixl_term_input_feed(buffer, partial);
+    }
+
+    cixl_vt_set_capabilities(probe.caps);
+    return probe.caps;
+}
+
+size_t cixl_linux_term_poll(const int timeout_ms)
+{
+    struct pollfd in;
+    int           wait_ms = timeout_ms;
+    int           hold_ms = cixl_term_input_hold_ms();
+    size_t        events;
+
+    if (!LINUX_TERM_STARTED)
+    {
+        return 0;
+    }
+
+    if (hold_ms >= 0 && (wait_ms < 0 || hold_ms < wait_ms))
+    {
+        wait_ms = hold_ms;
+    }
+    if (wait_ms != 0 && !LINUX_TERM_RESIZED)
+    {
+        in.fd      = LINUX_TERM_IN_FD;
+        in.events  = POLLIN;
+        in.revents = 0;
+        if (poll(&in, 1, wait_ms) <= 0 && hold_ms < 0)
+        {
+            //timed out, or interrupted by a resize
+            return 0;
+        }
+    }
+    events = cixl_term_input_read();
+    cixl_term_input_dispatch();
+
+    hold_ms = cixl_term_input_hold_ms();
+    if (hold_ms >= 0)
+    {
+        //wake an event driven game to read again when the held escape times out
+        cixl_idle_schedule_ms(hold_ms > 0 ? (uint32_t) hold_ms : 1u);
+    }
+    return events;
+}
+
+#else
+
+bool cixl_linux_term_start(const int in_fd, const int out_fd, const unsigned int input_flags)
+{
+    (void) in_fd;
+    (void) out_fd;
+    (void) input_flags;
+    return false;
+}
+
+void cixl_linux_term_stop()
+{
+}
+
+CIXL_RenderDevice *cixl_linux_term_device()
+{
+    return cixl_vt_device(NULL);
+}
+
+void cixl_linux_term_size(int *width, int *height)
+{
+    *width  = CIXL_LINUX_TERM_DEFAULT_WIDTH;
+    *height = CIXL_LINUX_TERM_DEFAULT_HEIGHT;
+}
+
+bool cixl_linux_term_check_resize()
+{
+    return false;
+}
+
+unsigned int cixl_linux_term_probe(const int timeout_ms)
+{
+    (void) timeout_ms;
+    return CIXL_VT_CAPS_NONE;
+}
+
+size_t cixl_linux_term_poll(const int timeout_ms)
+{
+    (void) timeout_ms;
+    return 0;
+}
+
+#endif
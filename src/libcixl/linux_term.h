@@ -0,0 +1,77 @@
+/*! \file
+ * \brief Native Linux terminal backend. Sets up the terminal for a game and restores it afterwards: raw input (see
+ * term_input.h), the alternate screen with a hidden cursor, and output through the VT render device (see vt_device.h)
+ * directly to the file descriptor. A resize of the terminal (SIGWINCH) is picked up with #cixl_linux_term_check_resize,
+ * which resizes the screen buffer. Input is read with poll, see #cixl_linux_term_poll. The VT device uses the
+ * capabilities of the profile of TERM, #cixl_linux_term_probe asks the terminal itself.
+ *
+ * Typical use: #cixl_linux_term_start with STDIN_FILENO and STDOUT_FILENO, then in the update method
+ * #cixl_linux_term_check_resize and #cixl_linux_term_poll with a timeout of 0 and take the events with
+ * #cixl_input_poll, and #cixl_linux_term_stop at exit.
+ *
+ * Only available on Linux, elsewhere #cixl_linux_term_start returns false.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_LINUX_TERM_H
+#define LIBCIXL_LINUX_TERM_H
+
+#include <stddef.h>
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+#include "screen_buffer.h"
+
+/*! \brief The size that is used when the size of the terminal can not be read (for example a pipe).*/
+#define CIXL_LINUX_TERM_DEFAULT_WIDTH 80
+#define CIXL_LINUX_TERM_DEFAULT_HEIGHT 25
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Starts the backend: raw non blocking input on in_fd, a SIGWINCH handler, the alternate screen and a hidden
+ * cursor on out_fd, and the screen buffer with the size of the terminal and the VT device writing to out_fd.
+ * \param input_flags the flags of #cixl_term_input_start, for example #CIXL_TERM_INPUT_MOUSE.
+ * \return false when not on Linux, the input could not be set up or the backend is already started.*/
+CIXLLIB_API bool cixl_linux_term_start(const int in_fd, const int out_fd, const unsigned int input_flags);
+
+/*! \brief Restores the terminal: leaves the alternate screen, shows the cursor, resets the colors, restores the input
+ * mode and the previous SIGWINCH handler and frees the screen buffer.*/
+CIXLLIB_API void cixl_linux_term_stop();
+
+/*! \brief The render device of the backend, the VT device that writes to the output file descriptor.*/
+CIXLLIB_API CIXL_RenderDevice *cixl_linux_term_device();
+
+/*! \brief The current size of the screen buffer in cells.*/
+CIXLLIB_API void cixl_linux_term_size(int *width, int *height);
+
+/*! \brief When the terminal was resized since the last check: resizes the screen buffer to the new size (which clears
+ * it, the game has to draw everything again) and clears the terminal.
+ * \return true when the terminal was resized.*/
+CIXLLIB_API bool cixl_linux_term_check_resize();
+
+/*! \brief Probes the capabilities of the terminal (see vt_caps.h) and lets the VT device use them. Call it once after
+ * #cixl_linux_term_start, it waits until the terminal answered or at most timeout_ms. Keys that are pressed meanwhile
+ * are kept as input events.
+ * \return the capabilities, the profile of TERM when the terminal did not answer.*/
+CIXLLIB_API unsigned int cixl_linux_term_probe(const int timeout_ms);
+
+/*! \brief Waits at most timeout_ms (0 does not wait, -1 waits until there is input) for input, reads all input that
+ * is available and puts the events in the input queue (see #cixl_term_input_dispatch), take them with #cixl_input_poll.
+ * A resize of the terminal ends the wait early. While an escape is held (see #cixl_term_input_hold_ms) the wait is
+ * shortened and an idle wake is scheduled, so the escape key is not delayed longer than that.
+ * \return the number of new input events.*/
+CIXLLIB_API size_t cixl_linux_term_poll(const int timeout_ms);
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_LINUX_TERM_H
+
+#pragma clang diagnostic pop
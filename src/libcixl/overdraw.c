@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include "std/cixl_stdlib.h"
+#include "screen_buffer.h"
+#include "overdraw.h"
+
+#ifdef CIXL_WITH_OVERDRAW
+
+static CIXL_OverdrawCell *OVERDRAW_CELLS = NULL;
+static int               OVERDRAW_WIDTH  = 0;
+static int               OVERDRAW_HEIGHT = 0;
+static uint32_t          OVERDRAW_FRAMES = 0;
+
+/*Set while the overlay is written, so it is not counted*/
+static bool OVERDRAW_PAUSED = false;
+
+void overdraw_count(const int index, const int kind)
+{
+    if (OVERDRAW_CELLS == NULL || OVERDRAW_PAUSED)
+    {
+        return;
+    }
+
+    switch (kind)
+    {
+        case CIXL_OVERDRAW_PUT:
+            ++OVERDRAW_CELLS[index].puts;
+            break;
+        case CIXL_OVERDRAW_NOOP_PUT:
+            ++OVERDRAW_CELLS[index].noop_puts;
+            break;
+        default:
+            ++OVERDRAW_CELLS[index].changes;
+            break;
+    }
+}
+
+void overdraw_frame_done()
+{
+    if (OVERDRAW_CELLS != NULL)
+    {
+        ++OVERDRAW_FRAMES;
+    }
+}
+
+void overdraw_screen_resized(const int width, const int height)
+{
+    bool was_started = OVERDRAW_CELLS != NULL;
+
+    if (width == OVERDRAW_WIDTH && height == OVERDRAW_HEIGHT)
+    {
+        return;
+    }
+
+    cixl_overdraw_stop();
+    OVERDRAW_WIDTH  = width;
+    OVERDRAW_HEIGHT = height;
+    if (was_started)
+    {
+        cixl_overdraw_start();
+    }
+}
+
+bool cixl_overdraw_available()
+{
+    return true;
+}
+
+bool cixl_overdraw_start()
+{
+    if (OVERDRAW_WIDTH <= 0 || OVERDRAW_HEIGHT <= 0)
+    {
+        return false;
+    }
+
+    cixl_mem_free(OVERDRAW_CELLS);
+    OVERDRAW_CELLS  = cixl_mem_alloc((size_t) OVERDRAW_WIDTH * (size_t) OVERDRAW_HEIGHT, sizeof(CIXL_OverdrawCell));
+    OVERDRAW_FRAMES = 0;
+    return OVERDRAW_CELLS != NULL;
+}
+
+void cixl_overdraw_stop()
+{
+    cixl_mem_free(OVERDRAW_CELLS);
+    OVERDRAW_CELLS  = NULL;
+    OVERDRAW_FRAMES = 0;
+}
+
+void cixl_overdraw_reset()
+{
+    int i;
+
+    if (OVERDRAW_CELLS == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < OVERDRAW_WIDTH * OVERDRAW_HEIGHT; ++i)
+    {
+        OVERDRAW_CELLS[i].puts      = 0;
+        OVERDRAW_CELLS[i].noop_puts = 0;
+        OVERDRAW_CELLS[i].changes   = 0;
+    }
+    OVERDRAW_FRAMES = 0;
+}
+
+CIXL_OverdrawCell cixl_overdraw_pick(const int x, const int y)
+{
+    CIXL_OverdrawCell empty = {0, 0, 0};
+
+    if (OVERDRAW_CELLS == NULL || x < 0 || y < 0 || x >= OVERDRAW_WIDTH || y >= OVERDRAW_HEIGHT)
+    {
+        return empty;
+    }
+    return OVERDRAW_CELLS[(y * OVERDRAW_WIDTH) + x];
+}
+
+uint32_t cixl_overdraw_frames()
+{
+    return OVERDRAW_FRAMES;
+}
+
+static inline uint32_t per_frame(const uint32_t count)
+{
+    return count / (OVERDRAW_FRAMES > 0 ? OVERDRAW_FRAMES : 1);
+}
+
+static char heat_char(const uint32_t count)
+{
+    uint32_t average = per_frame(count);
+
+    if (count == 0)
+    {
+        return ' ';
+    }
+    if (average == 0)
+    {
+        //written, but less than once per frame
+        return '.';
+    }
+    return average > 9 ? '+' : (char) ('0' + average);
+}
+
+static inline uint32_t cell_counter(const CIXL_OverdrawCell *cell, const int kind)
+{
+    return kind == CIXL_OVERDRAW_PUT ? cell->puts : (kind == CIXL_OVERDRAW_NOOP_PUT ? cell->noop_puts : cell->changes);
+}
+
+static void dump_grid(FILE *file, const char *title, const int kind)
+{
+    int x;
+    int y;
+
+    fprintf(file, "%s per frame\n", title);
+    for (y = 0; y < OVERDRAW_HEIGHT; ++y)
+    {
+        for (x = 0; x < OVERDRAW_WIDTH; ++x)
+        {
+            fputc(heat_char(cell_counter(&OVERDRAW_CELLS[(y * OVERDRAW_WIDTH) + x], kind)), file);
+        }
+        fputc('\n', file);
+    }
+    fputc('\n', file);
+}
+
+bool cixl_overdraw_dump(const char *file_path)
+{
+    FILE *file;
+    int  i;
+
+    if (OVERDRAW_CELLS == NULL)
+    {
+        return false;
+    }
+
+    file = fopen(file_path, "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    fprintf(file, "overdraw %ix%i, %lu frames\n\n", OVERDRAW_WIDTH, OVERDRAW_HEIGHT, (unsigned long) OVERDRAW_FRAMES);
+    dump_grid(file, "puts", CIXL_OVERDRAW_PUT);
+    dump_grid(file, "noop_puts", CIXL_OVERDRAW_NOOP_PUT);
+    dump_grid(file, "changes", CIXL_OVERDRAW_CHANGE);
+
+    fprintf(file, "x,y,puts,noop_puts,changes\n");
+    for (i = 0; i < OVERDRAW_WIDTH * OVERDRAW_HEIGHT; ++i)
+    {
+        const CIXL_OverdrawCell *cell = &OVERDRAW_CELLS[i];
+        if (cell->puts > 0)
+        {
+            fprintf(file, "%i,%i,%lu,%lu,%lu\n", i % OVERDRAW_WIDTH, i / OVERDRAW_WIDTH, (unsigned long) cell->puts,
+                    (unsigned long) cell->noop_puts, (unsigned long) cell->changes);
+        }
+    }
+
+    return fclose(file) == 0;
+}
+
+void cixl_overdraw_tint(const uint32_t min_puts_per_frame, const CIXL_Color hot_color)
+{
+    int x;
+    int y;
+
+    if (OVERDRAW_CELLS == NULL)
+    {
+        return;
+    }
+
+    OVERDRAW_PAUSED = true;
+    for (y = 0; y < OVERDRAW_HEIGHT; ++y)
+    {
+        for (x = 0; x < OVERDRAW_WIDTH; ++x)
+        {
+            const uint32_t puts = OVERDRAW_CELLS[(y * OVERDRAW_WIDTH) + x].puts;
+
+            if (puts > 0 && per_frame(puts) >= min_puts_per_frame)
+            {
+                CIXL_Cxl cxl = cixl_pick(x, y);
+                cxl.bg_color = hot_color;
+                cixl_put(x, y, cxl);
+            }
+        }
+    }
+    OVERDRAW_PAUSED = false;
+}
+
+#else
+
+bool cixl_overdraw_available()
+{
+    return false;
+}
+
+bool cixl_overdraw_start()
+{
+    return false;
+}
+
+void cixl_overdraw_stop()
+{
+}
+
+void cixl_overdraw_reset()
+{
+}
+
+CIXL_OverdrawCell cixl_overdraw_pick(const int x, const int y)
+{
+    CIXL_OverdrawCell empty = {0, 0, 0};
+    (void) x;
+    (void) y;
+    return empty;
+}
+
+uint32_t cixl_overdraw_frames()
+{
+    return 0;
+}
+
+bool cixl_overdraw_dump(const char *file_path)
+{
+    (void) file_path;
+    return false;
+}
+
+void cixl_overdraw_tint(const uint32_t min_puts_per_frame, const CIXL_Color hot_color)
+{
+    (void) min_puts_per_frame;
+    (void) hot_color;
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*! \file
+ * \brief Overdraw diagnostics. Counts for each cell how often it is written with #cixl_put (and the functions that use
+ * it), how many of those writes did not change anything, and how many did. This shows the cells that are written
+ * multiple times per frame, which #cixl_put otherwise silently ignores.
+ *
+ * Only available when libcixl is built with CIXL_WITH_OVERDRAW (cmake -DLIBCIXL_WITH_OVERDRAW=ON), without it the
+ * counting is compiled out of #cixl_put and these functions do nothing.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_OVERDRAW_H
+#define LIBCIXL_OVERDRAW_H
+
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+#include "colors.h"
+
+typedef struct CIXL_OverdrawCell
+{
+    /*! \brief All writes to the cell.*/
+    uint32_t puts;
+
+    /*! \brief Writes that did not change what will be rendered.*/
+    uint32_t noop_puts;
+
+    /*! \brief Writes that changed what will be rendered.*/
+    uint32_t changes;
+} CIXL_OverdrawCell;
+
+#define CIXL_OVERDRAW_PUT 0
+#define CIXL_OVERDRAW_NOOP_PUT 1
+#define CIXL_OVERDRAW_CHANGE 2
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CIXL_WITH_OVERDRAW
+/*! \brief Used by the screen buffer, counts a write of the given kind to the cell at index.*/
+void overdraw_count(const int index, const int kind);
+
+/*! \brief Used by the screen buffer when a frame is rendered.*/
+void overdraw_frame_done();
+
+/*! \brief Used by the screen buffer when it is (re)initialized.*/
+void overdraw_screen_resized(const int width, const int height);
+#endif
+
+/*! \brief Returns true when libcixl was built with overdraw diagnostics.*/
+CIXLLIB_API bool cixl_overdraw_available();
+
+/*! \brief Starts counting, with all counters at 0. Call after #cixl_init_screen_buffer.
+ * \return false when overdraw diagnostics are not available or the counters could not be allocated.*/
+CIXLLIB_API bool cixl_overdraw_start();
+
+CIXLLIB_API void cixl_overdraw_stop();
+
+/*! \brief Sets all counters to 0.*/
+CIXLLIB_API void cixl_overdraw_reset();
+
+/*! \brief Returns the counters of a cell, all 0 when the cell is out of the screen or counting is not started.*/
+CIXLLIB_API CIXL_OverdrawCell cixl_overdraw_pick(const int x, const int y);
+
+/*! \brief The number of frames rendered since the counting was started or reset.*/
+CIXLLIB_API uint32_t cixl_overdraw_frames();
+
+/*! \brief Writes the heatmap to a text file: a grid per counter, with a char per cell for the average count per frame
+ * (' ' for 0, '.' for less than once per frame, '1'-'9', '+' for more), followed by the totals of each cell as x,y,puts,noop_puts,changes lines.
+ * \return false when counting is not started or the file could not be written.*/
+CIXLLIB_API bool cixl_overdraw_dump(const char *file_path);
+
+/*! \brief Debug overlay: sets the background of the cells that are written at least min_puts_per_frame times per frame
+ * (on average) to hot_color. Call after drawing a frame and before #cixl_render. The overlay writes are not counted
+ * here, but they are normal puts: they count in the render stats (see render_stats.h) and the tint stays in the
+ * screen buffer until the cell is written again.*/
+CIXLLIB_API void cixl_overdraw_tint(const uint32_t min_puts_per_frame, const CIXL_Color hot_color);
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_OVERDRAW_H
+
+#pragma clang diagnostic pop
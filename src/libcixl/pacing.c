@@ -0,0 +1,166 @@
+#include <time.h>
+#if defined(__unix__)
+#include <errno.h>
+#include <sched.h>
+#endif
+#include "std/cixl_stdtime.h"
+#include "std/cixl_sleep.h"
+#include "pacing.h"
+
+/* Only yield while there is more than this left, the last microseconds are spun since a yield can take longer */
+#define PACING_YIELD_THRESHOLD_NS 20000u
+
+/*Smoothed overshoot of the sleeps and its mean deviation (like the round trip time estimate of TCP)*/
+static int64_t PACING_OVERSHOOT_MEAN_NS      = CIXL_PACING_INITIAL_OVERSHOOT_NS;
+static int64_t PACING_OVERSHOOT_DEVIATION_NS = 0;
+
+static CIXL_PacingStats PACING_STATS;
+static uint64_t         PACING_ERROR_SUM_NS     = 0;
+static uint64_t         PACING_LAST_FRAME_NS    = 0;
+static uint64_t         PACING_LAST_INTERVAL_NS = 0;
+static uint64_t         PACING_INTERVAL_SUM_NS  = 0;
+
+static inline uint64_t overshoot_estimate()
+{
+    int64_t estimate = PACING_OVERSHOOT_MEAN_NS + (2 * PACING_OVERSHOOT_DEVIATION_NS);
+
+    if (estimate < 0)
+    {
+        return 0;
+    }
+    return estimate > CIXL_PACING_MAX_OVERSHOOT_NS ? CIXL_PACING_MAX_OVERSHOOT_NS : (uint64_t) estimate;
+}
+
+static void pacing_update_overshoot(const uint64_t observed_ns)
+{
+    int64_t observed   = (int64_t) (observed_ns > CIXL_PACING_MAX_OVERSHOOT_NS ? CIXL_PACING_MAX_OVERSHOOT_NS
+                                                                               : observed_ns);
+    int64_t difference = observed - PACING_OVERSHOOT_MEAN_NS;
+
+    PACING_OVERSHOOT_MEAN_NS += difference / 8;
+    PACING_OVERSHOOT_DEVIATION_NS += ((difference < 0 ? -difference : difference) - PACING_OVERSHOOT_DEVIATION_NS) / 4;
+}
+
+static void pacing_sleep_until(const uint64_t wake_ns)
+{
+#if defined(__unix__) && defined(CLOCK_MONOTONIC) && defined(TIMER_ABSTIME)
+    //cixl_monotonic_ns reads the same clock, so the absolute wake up time can be used directly
+    struct timespec wake;
+    wake.tv_sec  = (time_t) (wake_ns / 1000000000u);
+    wake.tv_nsec = (long) (wake_ns % 1000000000u);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR)
+    {
+    }
+#else
+    uint64_t now = cixl_monotonic_ns();
+    if (wake_ns > now + 1000000u)
+    {
+        cixl_sleep_ms((unsigned int) ((wake_ns - now) / 1000000u));
+    }
+#endif
+}
+
+static inline void pacing_yield()
+{
+#if defined(__unix__)
+    sched_yield();
+#endif
+}
+
+void cixl_pacing_wait_until_ns(const uint64_t deadline_ns)
+{
+    uint64_t now         = cixl_monotonic_ns();
+    uint64_t early_by_ns = overshoot_estimate() + CIXL_PACING_MIN_SPIN_NS;
+    uint64_t spin_start;
+    uint64_t error;
+
+    if (now < deadline_ns && deadline_ns > early_by_ns)
+    {
+        uint64_t wake_ns = deadline_ns - early_by_ns;
+
+        if (wake_ns > now)
+        {
+            uint64_t sleep_start = now;
+
+            pacing_sleep_until(wake_ns);
+            now = cixl_monotonic_ns();
+            pacing_update_overshoot(now > wake_ns ? now - wake_ns : 0);
+            PACING_STATS.sleep_ns += now - sleep_start;
+        }
+    }
+
+    spin_start = now;
+    while (now < deadline_ns)
+    {
+        if (deadline_ns - now > PACING_YIELD_THRESHOLD_NS)
+        {
+            pacing_yield();
+        }
+        now = cixl_monotonic_ns();
+    }
+
+    error = now - deadline_ns;
+    PACING_STATS.spin_ns += now - spin_start;
+    ++PACING_STATS.waits;
+    PACING_ERROR_SUM_NS += error;
+    PACING_STATS.last_error_ns = error;
+    PACING_STATS.mean_error_ns = PACING_ERROR_SUM_NS / PACING_STATS.waits;
+    if (error > PACING_STATS.max_error_ns)
+    {
+        PACING_STATS.max_error_ns = error;
+    }
+}
+
+void cixl_pacing_wait_ns(const uint64_t duration_ns)
+{
+    cixl_pacing_wait_until_ns(cixl_monotonic_ns() + duration_ns);
+}
+
+void cixl_pacing_frame_mark()
+{
+    uint64_t now = cixl_monotonic_ns();
+
+    if (PACING_STATS.frames > 0)
+    {
+        uint64_t interval = now - PACING_LAST_FRAME_NS;
+
+        PACING_INTERVAL_SUM_NS += interval;
+        PACING_STATS.frame_interval_mean_ns = PACING_INTERVAL_SUM_NS / PACING_STATS.frames;
+
+        if (PACING_STATS.frames > 1)
+        {
+            uint64_t difference = interval > PACING_LAST_INTERVAL_NS ? interval - PACING_LAST_INTERVAL_NS
+                                                                     : PACING_LAST_INTERVAL_NS - interval;
+            int64_t  jitter     = (int64_t) PACING_STATS.frame_jitter_ns;
+
+            jitter += ((int64_t) difference - jitter) / 16;
+            PACING_STATS.frame_jitter_ns = (uint64_t) jitter;
+            if (difference > PACING_STATS.frame_jitter_max_ns)
+            {
+                PACING_STATS.frame_jitter_max_ns = difference;
+            }
+        }
+        PACING_LAST_INTERVAL_NS = interval;
+    }
+
+    PACING_LAST_FRAME_NS = now;
+    ++PACING_STATS.frames;
+}
+
+CIXL_PacingStats cixl_pacing_stats()
+{
+    CIXL_PacingStats stats = PACING_STATS;
+    stats.overshoot_estimate_ns = overshoot_estimate();
+    return stats;
+}
+
+void cixl_pacing_reset_stats()
+{
+    CIXL_PacingStats empty = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+
+    PACING_STATS            = empty;
+    PACING_ERROR_SUM_NS     = 0;
+    PACING_LAST_FRAME_NS    = 0;
+    PACING_LAST_INTERVAL_NS = 0;
+    PACING_INTERVAL_SUM_NS  = 0;
+}
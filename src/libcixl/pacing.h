@@ -0,0 +1,100 @@
+/*! \file
+ * \brief Frame pacing. Waits until a deadline on the monotonic clock as precisely as possible without burning a core:
+ * the bulk of the wait is slept (clock_nanosleep on unix), the last slice is spun, yielding the processor while there
+ * is time left. How far the sleeps overshoot is measured on every wait, and the sleep is ended that much earlier, so
+ * the spin stays short on systems with precise timers and grows on systems where sleeps are late.
+ *
+ * The game loop uses this to wait for the next fixed time step. The stats report how late waits end and the jitter of
+ * the frame intervals (see #cixl_pacing_frame_mark).
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_PACING_H
+#define LIBCIXL_PACING_H
+
+#include "std/cixl_stdint.h"
+#include "config.h"
+
+/*! \brief The minimum time in nanoseconds that is spun at the end of a wait, on top of the expected overshoot.*/
+#ifndef CIXL_PACING_MIN_SPIN_NS
+#define CIXL_PACING_MIN_SPIN_NS 50000u
+#endif
+
+/*! \brief The overshoot estimate is never more than this, so a single very late wake up (a stalled system) does not
+ * turn the following waits into long spins.*/
+#ifndef CIXL_PACING_MAX_OVERSHOOT_NS
+#define CIXL_PACING_MAX_OVERSHOOT_NS 2000000u
+#endif
+
+/*! \brief The overshoot estimate before the first measurement.*/
+#ifndef CIXL_PACING_INITIAL_OVERSHOOT_NS
+#define CIXL_PACING_INITIAL_OVERSHOOT_NS 200000u
+#endif
+
+typedef struct CIXL_PacingStats
+{
+    /*! \brief The number of waits.*/
+    uint64_t waits;
+
+    /*! \brief The current estimate of how late a sleep ends, the sleeps end this much before the deadline.*/
+    uint64_t overshoot_estimate_ns;
+
+    /*! \brief How late the last wait ended after its deadline.*/
+    uint64_t last_error_ns;
+
+    /*! \brief Average of how late the waits ended after their deadline.*/
+    uint64_t mean_error_ns;
+
+    /*! \brief The latest that a wait ended after its deadline.*/
+    uint64_t max_error_ns;
+
+    /*! \brief Total time slept.*/
+    uint64_t sleep_ns;
+
+    /*! \brief Total time spun (including yields) at the end of the waits.*/
+    uint64_t spin_ns;
+
+    /*! \brief The number of frames marked with #cixl_pacing_frame_mark.*/
+    uint64_t frames;
+
+    /*! \brief Average time between two frame marks.*/
+    uint64_t frame_interval_mean_ns;
+
+    /*! \brief Jitter of the frame intervals: smoothed absolute difference between consecutive intervals (like the
+     * interarrival jitter of RTP, RFC 3550).*/
+    uint64_t frame_jitter_ns;
+
+    /*! \brief The largest absolute difference between two consecutive frame intervals.*/
+    uint64_t frame_jitter_max_ns;
+} CIXL_PacingStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Waits until the monotonic clock (see #cixl_time_monotonic) reaches the deadline, returns immediately when it
+ * already passed.*/
+CIXLLIB_API void cixl_pacing_wait_until_ns(const uint64_t deadline_ns);
+
+/*! \brief Waits the given number of nanoseconds, see #cixl_pacing_wait_until_ns.*/
+CIXLLIB_API void cixl_pacing_wait_ns(const uint64_t duration_ns);
+
+/*! \brief Marks that a frame was presented, to measure the frame intervals and their jitter.*/
+CIXLLIB_API void cixl_pacing_frame_mark();
+
+CIXLLIB_API CIXL_PacingStats cixl_pacing_stats();
+
+/*! \brief Clears the stats. The overshoot estimate is kept, since it describes the system and not the measurement.*/
+CIXLLIB_API void cixl_pacing_reset_stats();
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_PACING_H
+
+#pragma clang diagnostic pop
@@ -0,0 +1,219 @@
+#include <string.h>
+#include "perf_counters.h"
+
+#if defined(__linux__)
+#define PERF_WITH_PERF_EVENT
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+bool PERF_SECTIONS_ENABLED = false;
+
+static const char *PERF_COUNTER_NAMES[CIXL_PERF_COUNTER_COUNT] = {"cycles", "instructions", "cache_misses",
+                                                                  "branch_misses"};
+
+static unsigned int      PERF_AVAILABLE = 0;
+static CIXL_PerfSection  PERF_SECTIONS[CIXL_PERF_SECTION_COUNT];
+static CIXL_PerfCounters PERF_SECTION_START;
+
+#if defined(PERF_WITH_PERF_EVENT)
+
+static const uint64_t PERF_EVENT_CONFIGS[CIXL_PERF_COUNTER_COUNT] = {PERF_COUNT_HW_CPU_CYCLES,
+                                                                     PERF_COUNT_HW_INSTRUCTIONS,
+                                                                     PERF_COUNT_HW_CACHE_MISSES,
+                                                                     PERF_COUNT_HW_BRANCH_MISSES};
+
+/*The counters are one group, so they are read with a single system call and are scheduled together. PERF_GROUP_INDEX
+ * maps a counter to its position in the group, -1 when it is not available*/
+static int PERF_GROUP_FD = -1;
+static int PERF_FDS[CIXL_PERF_COUNTER_COUNT]         = {-1, -1, -1, -1};
+static int PERF_GROUP_INDEX[CIXL_PERF_COUNTER_COUNT] = {-1, -1, -1, -1};
+static int PERF_GROUP_SIZE                           = 0;
+
+static int perf_event_open(const uint64_t config, const int group_fd)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = config;
+    attr.disabled       = group_fd == -1 ? 1 : 0; //the group starts when it is complete
+    attr.exclude_kernel = 1;                      //user space only, this is allowed with perf_event_paranoid 2
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+unsigned int cixl_perf_open()
+{
+    int counter;
+
+    if (PERF_GROUP_FD >= 0)
+    {
+        return PERF_AVAILABLE;
+    }
+
+    for (counter = 0; counter < CIXL_PERF_COUNTER_COUNT; ++counter)
+    {
+        int fd = perf_event_open(PERF_EVENT_CONFIGS[counter], PERF_GROUP_FD);
+
+        if (fd < 0)
+        {
+            //not supported here (no PMU, not permitted, not this event), try the others
+            continue;
+        }
+        if (PERF_GROUP_FD < 0)
+        {
+            PERF_GROUP_FD = fd;
+        }
+        PERF_FDS[counter]         = fd;
+        PERF_GROUP_INDEX[counter] = PERF_GROUP_SIZE++;
+        PERF_AVAILABLE |= CIXL_PERF_BIT(counter);
+    }
+
+    if (PERF_GROUP_FD >= 0)
+    {
+        ioctl(PERF_GROUP_FD, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(PERF_GROUP_FD, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    return PERF_AVAILABLE;
+}
+
+void cixl_perf_close()
+{
+    int counter;
+
+    PERF_SECTIONS_ENABLED = false;
+    for (counter = 0; counter < CIXL_PERF_COUNTER_COUNT; ++counter)
+    {
+        if (PERF_FDS[counter] >= 0)
+        {
+            close(PERF_FDS[counter]);
+        }
+        PERF_FDS[counter]         = -1;
+        PERF_GROUP_INDEX[counter] = -1;
+    }
+    PERF_GROUP_FD   = -1;
+    PERF_GROUP_SIZE = 0;
+    PERF_AVAILABLE  = 0;
+}
+
+CIXL_PerfCounters cixl_perf_read()
+{
+    CIXL_PerfCounters counters;
+    /*nr, time_enabled, time_running and the values of the group*/
+    uint64_t          data[3 + CIXL_PERF_COUNTER_COUNT];
+    int               counter;
+
+    memset(&counters, 0, sizeof(counters));
+    if (PERF_GROUP_FD < 0 || read(PERF_GROUP_FD, data, sizeof(data)) < (ssize_t) (3 * sizeof(uint64_t)))
+    {
+        return counters;
+    }
+
+    for (counter = 0; counter < CIXL_PERF_COUNTER_COUNT; ++counter)
+    {
+        if (PERF_GROUP_INDEX[counter] >= 0 && (uint64_t) PERF_GROUP_INDEX[counter] < data[0])
+        {
+            uint64_t value = data[3 + PERF_GROUP_INDEX[counter]];
+
+            //multiplexed: only counted part of the time, scale to the full time
+            if (data[2] > 0 && data[2] < data[1])
+            {
+                value = (uint64_t) ((double) value * ((double) data[1] / (double) data[2]));
+            }
+            counters.values[counter] = value;
+        }
+    }
+    return counters;
+}
+
+#else
+
+unsigned int cixl_perf_open()
+{
+    return 0;
+}
+
+void cixl_perf_close()
+{
+    PERF_SECTIONS_ENABLED = false;
+}
+
+CIXL_PerfCounters cixl_perf_read()
+{
+    CIXL_PerfCounters counters;
+    memset(&counters, 0, sizeof(counters));
+    return counters;
+}
+
+#endif
+
+unsigned int cixl_perf_available()
+{
+    return PERF_AVAILABLE;
+}
+
+void cixl_perf_add_delta(CIXL_PerfCounters *total, const CIXL_PerfCounters *start, const CIXL_PerfCounters *end)
+{
+    int counter;
+
+    for (counter = 0; counter < CIXL_PERF_COUNTER_COUNT; ++counter)
+    {
+        //scaled estimates can go back a little
+        if (end->values[counter] > start->values[counter])
+        {
+            total->values[counter] += end->values[counter] - start->values[counter];
+        }
+    }
+}
+
+const char *cixl_perf_counter_name(const int counter)
+{
+    return counter >= 0 && counter < CIXL_PERF_COUNTER_COUNT ? PERF_COUNTER_NAMES[counter] : "unknown";
+}
+
+void perf_section_begin(const int section)
+{
+    (void) section;
+    PERF_SECTION_START = cixl_perf_read();
+}
+
+void perf_section_end(const int section)
+{
+    CIXL_PerfCounters end = cixl_perf_read();
+
+    ++PERF_SECTIONS[section].calls;
+    cixl_perf_add_delta(&PERF_SECTIONS[section].counters, &PERF_SECTION_START, &end);
+}
+
+bool cixl_perf_sections_start()
+{
+    if (cixl_perf_open() == 0)
+    {
+        return false;
+    }
+    memset(PERF_SECTIONS, 0, sizeof(PERF_SECTIONS));
+    PERF_SECTIONS_ENABLED = true;
+    return true;
+}
+
+void cixl_perf_sections_stop()
+{
+    PERF_SECTIONS_ENABLED = false;
+}
+
+CIXL_PerfSection cixl_perf_section(const int section)
+{
+    CIXL_PerfSection empty;
+
+    if (section < 0 || section >= CIXL_PERF_SECTION_COUNT)
+    {
+        memset(&empty, 0, sizeof(empty));
+        return empty;
+    }
+    return PERF_SECTIONS[section];
+}
@@ -0,0 +1,102 @@
+/*! \file
+ * \brief Hardware performance counters (Linux perf_event_open): processor cycles, instructions, cache misses and branch
+ * misses of the calling thread, in user space. To tune the rendering with more than the wall time, for example the
+ * instructions and cache misses per cell.
+ *
+ * The counters are read with #cixl_perf_read, or accumulated per section (#cixl_put, #cixl_print and #cixl_render) with
+ * #cixl_perf_sections_start. Counters are often not available: on other platforms than Linux, in containers and virtual
+ * machines without a PMU, or when perf_event_paranoid forbids them. Then #cixl_perf_open returns which ones could be
+ * opened (possibly none), and the others stay 0.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_PERF_COUNTERS_H
+#define LIBCIXL_PERF_COUNTERS_H
+
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+
+#define CIXL_PERF_CYCLES 0
+#define CIXL_PERF_INSTRUCTIONS 1
+#define CIXL_PERF_CACHE_MISSES 2
+#define CIXL_PERF_BRANCH_MISSES 3
+#define CIXL_PERF_COUNTER_COUNT 4
+
+/*! \brief The bit of a counter in the available mask, see #cixl_perf_open.*/
+#define CIXL_PERF_BIT(counter) (1u << (counter))
+
+#define CIXL_PERF_SECTION_PUT 0
+#define CIXL_PERF_SECTION_PRINT 1
+#define CIXL_PERF_SECTION_RENDER 2
+#define CIXL_PERF_SECTION_COUNT 3
+
+typedef struct CIXL_PerfCounters
+{
+    /*! \brief The counts, indexed by #CIXL_PERF_CYCLES etc. When the kernel had to share the hardware counters with
+     * other events (multiplexing) the counts are estimates, scaled to the full time.*/
+    uint64_t values[CIXL_PERF_COUNTER_COUNT];
+} CIXL_PerfCounters;
+
+typedef struct CIXL_PerfSection
+{
+    /*! \brief The number of measured calls.*/
+    uint64_t calls;
+
+    /*! \brief The counts of all calls together.*/
+    CIXL_PerfCounters counters;
+} CIXL_PerfSection;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Checked by the sections on every call, see #cixl_perf_sections_start.*/
+extern bool PERF_SECTIONS_ENABLED;
+
+void perf_section_begin(const int section);
+
+void perf_section_end(const int section);
+
+/*! \brief Opens and starts the counters for the calling thread, they only count on that thread.
+ * \return the mask (#CIXL_PERF_BIT) of the counters that are available, 0 when none are.*/
+CIXLLIB_API unsigned int cixl_perf_open();
+
+/*! \brief The mask of the available counters, 0 before #cixl_perf_open.*/
+CIXLLIB_API unsigned int cixl_perf_available();
+
+CIXLLIB_API void cixl_perf_close();
+
+/*! \brief The counts since #cixl_perf_open. Unavailable counters are 0. Reading costs one system call.*/
+CIXLLIB_API CIXL_PerfCounters cixl_perf_read();
+
+/*! \brief Adds the difference between end and start to total.*/
+CIXLLIB_API void cixl_perf_add_delta(CIXL_PerfCounters *total, const CIXL_PerfCounters *start,
+                                     const CIXL_PerfCounters *end);
+
+/*! \brief The name of a counter, for reports.*/
+CIXLLIB_API const char *cixl_perf_counter_name(const int counter);
+
+/*! \brief Starts accumulating the counters of every #cixl_put, #cixl_print and #cixl_render call, opens the counters
+ * when they are not open yet. Each measured call reads the counters twice, the instructions of those system calls that
+ * run in user space are included in the counts of the section, which matters for the short #cixl_put calls.
+ * \return false when no counter is available.*/
+CIXLLIB_API bool cixl_perf_sections_start();
+
+/*! \brief Stops accumulating, the sections are kept until the next start.*/
+CIXLLIB_API void cixl_perf_sections_stop();
+
+/*! \brief The accumulated counts of a section (#CIXL_PERF_SECTION_PUT, ...).*/
+CIXLLIB_API CIXL_PerfSection cixl_perf_section(const int section);
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_PERF_COUNTERS_H
+
+#pragma clang diagnostic pop
@@ -0,0 +1,670 @@
+#include <stdio.h>
+#include <string.h>
+#include "std/cixl_stdlib.h"
+#include "raster_device.h"
+#include "style_opts.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define RASTER_PALETTE_SIZE 256
+
+/* The rows of the glyph that the decorations are drawn on */
+#define RASTER_UNDERLINE_ROW (CIXL_RASTER_GLYPH_HEIGHT - 1)
+#define RASTER_STRIKE_ROW (CIXL_RASTER_GLYPH_HEIGHT / 2 - 1)
+
+/* Deflate: the longest match, and the farthest back a match can start */
+#define DEFLATE_MAX_MATCH 258
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_DISTANCE 32768
+
+#define PNG_FILTER_SUB 1
+
+static uint32_t *RASTER_PIXELS   = NULL;
+static int      RASTER_COLUMNS   = 0;
+static int      RASTER_ROWS      = 0;
+static int      RASTER_WIDTH_PX  = 0;
+static int      RASTER_HEIGHT_PX = 0;
+
+/* The colors of the color table as pixels, for the version of the table they were made for */
+static uint32_t RASTER_PALETTE[RASTER_PALETTE_SIZE];
+static bool     RASTER_PALETTE_IS_SET  = false;
+static uint32_t RASTER_PALETTE_VERSION = 0;
+
+/* The cells drawn since the last call of cixl_raster_dirty_rect, max is exclusive */
+static bool RASTER_DIRTY       = false;
+static int  RASTER_DIRTY_MIN_X = 0;
+static int  RASTER_DIRTY_MIN_Y = 0;
+static int  RASTER_DIRTY_MAX_X = 0;
+static int  RASTER_DIRTY_MAX_Y = 0;
+
+static const uint16_t DEFLATE_LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51,
+                                                 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t  DEFLATE_LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4,
+                                                  4, 5, 5, 5, 5, 0};
+static const uint16_t DEFLATE_DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257,
+                                                   385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289,
+                                                   16385, 24577};
+static const uint8_t  DEFLATE_DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9,
+                                                    10, 10, 11, 11, 12, 12, 13, 13};
+
+static const uint8_t PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+static uint32_t PNG_CRC_TABLE[256];
+static bool     PNG_CRC_TABLE_IS_SET = false;
+
+/*! The deflate output, bits are added from the lowest bit of a byte up */
+typedef struct RasterBitWriter
+{
+    uint8_t  *bytes;
+    size_t   size;
+    size_t   capacity;
+    uint32_t bits;
+    int      bit_count;
+} RasterBitWriter;
+
+/*! a pixel with the bytes red, green, blue and alpha in memory order */
+static uint32_t raster_rgba(const uint8_t red, const uint8_t green, const uint8_t blue)
+{
+    uint8_t  bytes[4];
+    uint32_t pixel;
+
+    bytes[0] = red;
+    bytes[1] = green;
+    bytes[2] = blue;
+    bytes[3] = 0xFF;
+    memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+/*! converts the color table to pixels when it changed */
+static void raster_update_palette()
+{
+    int i;
+
+    if (RASTER_PALETTE_IS_SET && RASTER_PALETTE_VERSION == colors_table_version())
+    {
+        return;
+    }
+
+    for (i = 0; i < RASTER_PALETTE_SIZE; ++i)
+    {
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+
+        cixl_color_rgb((CIXL_Color) i, &red, &green, &blue);
+        RASTER_PALETTE[i] = raster_rgba(red, green, blue);
+    }
+    RASTER_PALETTE_IS_SET  = true;
+    RASTER_PALETTE_VERSION = colors_table_version();
+}
+
+static void raster_fill(uint32_t *pixels, const size_t count, const uint32_t pixel)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+    {
+        pixels[i] = pixel;
+    }
+}
+
+static void raster_mark_dirty(const int x, const int y, const int columns, const int rows)
+{
+    if (!RASTER_DIRTY)
+    {
+        RASTER_DIRTY       = true;
+        RASTER_DIRTY_MIN_X = x;
+        RASTER_DIRTY_MIN_Y = y;
+        RASTER_DIRTY_MAX_X = x + columns;
+        RASTER_DIRTY_MAX_Y = y + rows;
+        return;
+    }
+
+    RASTER_DIRTY_MIN_X = x < RASTER_DIRTY_MIN_X ? x : RASTER_DIRTY_MIN_X;
+    RASTER_DIRTY_MIN_Y = y < RASTER_DIRTY_MIN_Y ? y : RASTER_DIRTY_MIN_Y;
+    RASTER_DIRTY_MAX_X = x + columns > RASTER_DIRTY_MAX_X ? x + columns : RASTER_DIRTY_MAX_X;
+    RASTER_DIRTY_MAX_Y = y + rows > RASTER_DIRTY_MAX_Y ? y + rows : RASTER_DIRTY_MAX_Y;
+}
+
+/*! (re)allocates the framebuffer when the screen buffer has another size, returns false when there is no framebuffer */
+static bool raster_ensure_size()
+{
+    int columns;
+    int rows;
+
+    raster_update_palette();
+
+    cixl_screen_size(&columns, &rows);
+    if (RASTER_PIXELS != NULL && columns == RASTER_COLUMNS && rows == RASTER_ROWS)
+    {
+        return true;
+    }
+
+    cixl_raster_free();
+    if (columns <= 0 || rows <= 0)
+    {
+        return false;
+    }
+
+    RASTER_PIXELS = cixl_mem_alloc((size_t) columns * (size_t) rows * CIXL_RASTER_GLYPH_WIDTH * CIXL_RASTER_GLYPH_HEIGHT,
+                                   sizeof(uint32_t));
+    if (RASTER_PIXELS == NULL)
+    {
+        return false;
+    }
+
+    RASTER_COLUMNS   = columns;
+    RASTER_ROWS      = rows;
+    RASTER_WIDTH_PX  = columns * CIXL_RASTER_GLYPH_WIDTH;
+    RASTER_HEIGHT_PX = rows * CIXL_RASTER_GLYPH_HEIGHT;
+    raster_fill(RASTER_PIXELS, (size_t) RASTER_WIDTH_PX * (size_t) RASTER_HEIGHT_PX, RASTER_PALETTE[CIXL_Color_Black]);
+    raster_mark_dirty(0, 0, columns, rows);
+    return true;
+}
+
+/*! expands the 1 bit rows of a glyph into fg and bg pixels, the lowest bit is the leftmost pixel */
+static void raster_blit_glyph(uint32_t *dst, const int stride_px, const uint8_t *rows, const uint32_t fg,
+                              const uint32_t bg)
+{
+    int row;
+#if defined(__SSE2__)
+    const __m128i low_bits  = _mm_set_epi32(8, 4, 2, 1);
+    const __m128i high_bits = _mm_set_epi32(128, 64, 32, 16);
+    const __m128i fg_pixels = _mm_set1_epi32((int) fg);
+    const __m128i bg_pixels = _mm_set1_epi32((int) bg);
+    __m128i       bits;
+    __m128i       is_fg;
+
+    for (row = 0; row < CIXL_RASTER_GLYPH_HEIGHT; ++row, dst += stride_px)
+    {
+        bits  = _mm_set1_epi32(rows[row]);
+        is_fg = _mm_cmpeq_epi32(_mm_and_si128(bits, low_bits), low_bits);
+        _mm_storeu_si128((__m128i *) dst,
+                         _mm_or_si128(_mm_and_si128(is_fg, fg_pixels), _mm_andnot_si128(is_fg, bg_pixels)));
+        is_fg = _mm_cmpeq_epi32(_mm_and_si128(bits, high_bits), high_bits);
+        _mm_storeu_si128((__m128i *) (dst + 4),
+                         _mm_or_si128(_mm_and_si128(is_fg, fg_pixels), _mm_andnot_si128(is_fg, bg_pixels)));
+    }
+#else
+    int      x;
+    uint32_t is_fg;
+
+    for (row = 0; row < CIXL_RASTER_GLYPH_HEIGHT; ++row, dst += stride_px)
+    {
+        for (x = 0; x < CIXL_RASTER_GLYPH_WIDTH; ++x)
+        {
+            is_fg = 0u - (uint32_t) ((rows[row] >> x) & 1u);
+            dst[x] = (fg & is_fg) | (bg & ~is_fg);
+        }
+    }
+#endif
+}
+
+/*! the glyph with the decorations that change its pixels, returns the rows to draw */
+static const uint8_t *raster_decorate(const uint8_t *glyph, uint8_t *decorated, const CIXL_StyleOpts decoration)
+{
+    int row;
+
+    if ((decoration & (italic | underline | double_underline | crossed_out)) == 0)
+    {
+        return glyph;
+    }
+
+    memcpy(decorated, glyph, CIXL_RASTER_GLYPH_HEIGHT);
+    if (decoration & italic)
+    {
+        //slant: the top half moves one pixel to the right
+        for (row = 0; row < CIXL_RASTER_GLYPH_HEIGHT / 2; ++row)
+        {
+            decorated[row] = (uint8_t) (decorated[row] << 1);
+        }
+    }
+    if (decoration & (underline | double_underline))
+    {
+        decorated[RASTER_UNDERLINE_ROW] = 0xFF;
+    }
+    if (decoration & double_underline)
+    {
+        decorated[RASTER_UNDERLINE_ROW - 2] = 0xFF;
+    }
+    if (decoration & crossed_out)
+    {
+        decorated[RASTER_STRIKE_ROW] = 0xFF;
+    }
+    return decorated;
+}
+
+static void raster_draw_horiz_s(const int start_x, const int start_y, char *str, const unsigned int size,
+                                const CIXL_Color fg_color, const CIXL_Color bg_color, const CIXL_StyleOpts decoration)
+{
+    uint8_t    decorated[CIXL_RASTER_GLYPH_HEIGHT];
+    CIXL_Color fg = fg_color;
+    CIXL_Color bg = bg_color;
+    CIXL_Color swap;
+    uint32_t   *dst;
+    int        count;
+    int        i;
+
+    if (!raster_ensure_size() || start_y < 0 || start_y >= RASTER_ROWS || start_x < 0 || start_x >= RASTER_COLUMNS)
+    {
+        return;
+    }
+
+    count = RASTER_COLUMNS - start_x < (int) size ? RASTER_COLUMNS - start_x : (int) size;
+    if ((decoration & bold) && fg < CIXL_Color_Black_Bright)
+    {
+        fg = (CIXL_Color) (fg + CIXL_Color_Black_Bright);
+    }
+    if (decoration & invert)
+    {
+        swap = fg;
+        fg   = bg;
+        bg   = swap;
+    }
+
+    dst = RASTER_PIXELS + (size_t) start_y * CIXL_RASTER_GLYPH_HEIGHT * (size_t) RASTER_WIDTH_PX +
+          (size_t) start_x * CIXL_RASTER_GLYPH_WIDTH;
+    for (i = 0; i < count; ++i, dst += CIXL_RASTER_GLYPH_WIDTH)
+    {
+        raster_blit_glyph(dst, RASTER_WIDTH_PX,
+                          raster_decorate(CIXL_CP437_FONT[(unsigned char) str[i]], decorated, decoration),
+                          RASTER_PALETTE[fg], RASTER_PALETTE[bg]);
+    }
+    raster_mark_dirty(start_x, start_y, count, 1);
+}
+
+static void raster_draw_cxl(const int start_x, const int start_y, const CIXL_Cxl cxl)
+{
+    char c = cxl.char_value;
+    raster_draw_horiz_s(start_x, start_y, &c, 1, cxl.fg_color, cxl.bg_color, cxl.style_opts);
+}
+
+static void raster_erase(const int start_y, const int line_count, const CIXL_Color bg_color)
+{
+    int rows;
+
+    if (!raster_ensure_size() || start_y < 0 || start_y >= RASTER_ROWS)
+    {
+        return;
+    }
+
+    rows = start_y + line_count > RASTER_ROWS ? RASTER_ROWS - start_y : line_count;
+    raster_fill(RASTER_PIXELS + (size_t) start_y * CIXL_RASTER_GLYPH_HEIGHT * (size_t) RASTER_WIDTH_PX,
+                (size_t) rows * CIXL_RASTER_GLYPH_HEIGHT * (size_t) RASTER_WIDTH_PX, RASTER_PALETTE[bg_color]);
+    raster_mark_dirty(0, start_y, RASTER_COLUMNS, rows);
+}
+
+static CIXL_RenderDevice RASTER_DEVICE = {raster_draw_cxl, raster_draw_horiz_s, NULL, NULL, raster_erase};
+
+CIXL_RenderDevice *cixl_raster_device()
+{
+    return &RASTER_DEVICE;
+}
+
+void cixl_raster_free()
+{
+    cixl_mem_free(RASTER_PIXELS);
+    RASTER_PIXELS      = NULL;
+    RASTER_COLUMNS     = 0;
+    RASTER_ROWS        = 0;
+    RASTER_WIDTH_PX    = 0;
+    RASTER_HEIGHT_PX   = 0;
+    RASTER_DIRTY       = false;
+}
+
+const uint8_t *cixl_raster_pixels(int *width_px, int *height_px)
+{
+    *width_px  = RASTER_WIDTH_PX;
+    *height_px = RASTER_HEIGHT_PX;
+    return (const uint8_t *) RASTER_PIXELS;
+}
+
+bool cixl_raster_dirty_rect(int *x, int *y, int *width, int *height)
+{
+    bool was_dirty = RASTER_DIRTY;
+
+    *x           = was_dirty ? RASTER_DIRTY_MIN_X * CIXL_RASTER_GLYPH_WIDTH : 0;
+    *y           = was_dirty ? RASTER_DIRTY_MIN_Y * CIXL_RASTER_GLYPH_HEIGHT : 0;
+    *width       = was_dirty ? (RASTER_DIRTY_MAX_X - RASTER_DIRTY_MIN_X) * CIXL_RASTER_GLYPH_WIDTH : 0;
+    *height      = was_dirty ? (RASTER_DIRTY_MAX_Y - RASTER_DIRTY_MIN_Y) * CIXL_RASTER_GLYPH_HEIGHT : 0;
+    RASTER_DIRTY = false;
+    return was_dirty;
+}
+
+bool cixl_raster_write_ppm(const char *path)
+{
+    FILE          *file;
+    uint8_t       *row;
+    const uint8_t *pixel;
+    int           x;
+    int           y;
+    bool          is_written;
+
+    if (RASTER_PIXELS == NULL || (file = fopen(path, "wb")) == NULL)
+    {
+        return false;
+    }
+
+    row        = cixl_mem_alloc((size_t) RASTER_WIDTH_PX * 3, sizeof(uint8_t));
+    is_written = row != NULL && fprintf(file, "P6\n%d %d\n255\n", RASTER_WIDTH_PX, RASTER_HEIGHT_PX) > 0;
+    for (y = 0; is_written && y < RASTER_HEIGHT_PX; ++y)
+    {
+        pixel = (const uint8_t *) (RASTER_PIXELS + (size_t) y * (size_t) RASTER_WIDTH_PX);
+        for (x = 0; x < RASTER_WIDTH_PX; ++x, pixel += 4)
+        {
+            row[x * 3]     = pixel[0];
+            row[x * 3 + 1] = pixel[1];
+            row[x * 3 + 2] = pixel[2];
+        }
+        is_written = fwrite(row, 3, (size_t) RASTER_WIDTH_PX, file) == (size_t) RASTER_WIDTH_PX;
+    }
+
+    cixl_mem_free(row);
+    return fclose(file) == 0 && is_written;
+}
+
+static bool deflate_put_byte(RasterBitWriter *writer, const uint8_t byte)
+{
+    uint8_t *grown;
+
+    if (writer->size == writer->capacity)
+    {
+        grown = cixl_mem_realloc(writer->bytes, writer->capacity * 2);
+        if (grown == NULL)
+        {
+            return false;
+        }
+        writer->bytes    = grown;
+        writer->capacity = writer->capacity * 2;
+    }
+    writer->bytes[writer->size++] = byte;
+    return true;
+}
+
+/*! adds count (at most 24) bits of value, lowest bit first */
+static bool deflate_put_bits(RasterBitWriter *writer, const uint32_t value, const int count)
+{
+    writer->bits |= value << writer->bit_count;
+    writer->bit_count += count;
+    while (writer->bit_count >= 8)
+    {
+        if (!deflate_put_byte(writer, (uint8_t) (writer->bits & 0xFFu)))
+        {
+            return false;
+        }
+        writer->bits >>= 8;
+        writer->bit_count -= 8;
+    }
+    return true;
+}
+
+/*! Huffman codes are stored from the highest bit down */
+static bool deflate_put_code(RasterBitWriter *writer, const uint32_t code, const int length)
+{
+    uint32_t reversed = 0;
+    int      i;
+
+    for (i = 0; i < length; ++i)
+    {
+        reversed |= ((code >> i) & 1u) << (length - 1 - i);
+    }
+    return deflate_put_bits(writer, reversed, length);
+}
+
+/*! a literal byte, the end of block (256) or a length (257 - 285) with the fixed Huffman codes */
+static bool deflate_put_symbol(RasterBitWriter *writer, const int symbol)
+{
+    if (symbol <= 143)
+    {
+        return deflate_put_code(writer, (uint32_t) (0x30 + symbol), 8);
+    }
+    if (symbol <= 255)
+    {
+        return deflate_put_code(writer, (uint32_t) (0x190 + symbol - 144), 9);
+    }
+    if (symbol <= 279)
+    {
+        return deflate_put_code(writer, (uint32_t) (symbol - 256), 7);
+    }
+    return deflate_put_code(writer, (uint32_t) (0xC0 + symbol - 280), 8);
+}
+
+static bool deflate_put_match(RasterBitWriter *writer, const int length, const int distance)
+{
+    int length_code   = 28;
+    int distance_code = 29;
+
+    while (DEFLATE_LENGTH_BASE[length_code] > length)
+    {
+        --length_code;
+    }
+    while (DEFLATE_DISTANCE_BASE[distance_code] > distance)
+    {
+        --distance_code;
+    }
+    return deflate_put_symbol(writer, 257 + length_code) &&
+           deflate_put_bits(writer, (uint32_t) (length - DEFLATE_LENGTH_BASE[length_code]),
+                            DEFLATE_LENGTH_EXTRA[length_code]) &&
+           deflate_put_code(writer, (uint32_t) distance_code, 5) &&
+           deflate_put_bits(writer, (uint32_t) (distance - DEFLATE_DISTANCE_BASE[distance_code]),
+                            DEFLATE_DISTANCE_EXTRA[distance_code]);
+}
+
+static int deflate_match_length(const uint8_t *data, const size_t at, const size_t size, const size_t distance)
+{
+    size_t max    = size - at < DEFLATE_MAX_MATCH ? size - at : DEFLATE_MAX_MATCH;
+    size_t length = 0;
+
+    if (distance > at || distance > DEFLATE_MAX_DISTANCE)
+    {
+        return 0;
+    }
+    while (length < max && data[at + length] == data[at + length - distance])
+    {
+        ++length;
+    }
+    return (int) length;
+}
+
+static uint32_t deflate_adler32(const uint8_t *data, const size_t size)
+{
+    uint32_t a = 1;
+    uint32_t b = 0;
+    size_t   i = 0;
+    size_t   end;
+
+    while (i < size)
+    {
+        //5552 bytes is the most that can be summed before b overflows
+        end = size - i > 5552 ? i + 5552 : size;
+        for (; i < end; ++i)
+        {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521u;
+        b %= 65521u;
+    }
+    return (b << 16) | a;
+}
+
+/*! zlib stream with a single fixed Huffman block. Matches are only looked for at the previous byte and the previous
+ * row (row_size back), after the Sub filter those are the repeats in an image of cells. */
+static bool deflate_zlib(RasterBitWriter *writer, const uint8_t *data, const size_t size, const size_t row_size)
+{
+    size_t   at = 0;
+    int      length;
+    int      row_length;
+    uint32_t adler;
+    int      i;
+
+    if (!deflate_put_byte(writer, 0x78) || !deflate_put_byte(writer, 0x01) ||
+        !deflate_put_bits(writer, 1u | (1u << 1), 3))
+    {
+        return false;
+    }
+
+    while (at < size)
+    {
+        length     = deflate_match_length(data, at, size, 1);
+        row_length = deflate_match_length(data, at, size, row_size);
+        if (row_length > length && row_length >= DEFLATE_MIN_MATCH)
+        {
+            if (!deflate_put_match(writer, row_length, (int) row_size))
+            {
+                return false;
+            }
+            at += (size_t) row_length;
+        }
+        else if (length >= DEFLATE_MIN_MATCH)
+        {
+            if (!deflate_put_match(writer, length, 1))
+            {
+                return false;
+            }
+            at += (size_t) length;
+        }
+        else
+        {
+            if (!deflate_put_symbol(writer, data[at]))
+            {
+                return false;
+            }
+            ++at;
+        }
+    }
+
+    if (!deflate_put_symbol(writer, 256) || !deflate_put_bits(writer, 0, (8 - writer->bit_count) & 7))
+    {
+        return false;
+    }
+
+    adler = deflate_adler32(data, size);
+    for (i = 3; i >= 0; --i)
+    {
+        if (!deflate_put_byte(writer, (uint8_t) (adler >> (i * 8))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t png_crc(const uint8_t *data, const size_t size, uint32_t crc)
+{
+    size_t   i;
+    uint32_t value;
+    int      bit;
+
+    if (!PNG_CRC_TABLE_IS_SET)
+    {
+        for (i = 0; i < 256; ++i)
+        {
+            value = (uint32_t) i;
+            for (bit = 0; bit < 8; ++bit)
+            {
+                value = (value & 1u) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            PNG_CRC_TABLE[i] = value;
+        }
+        PNG_CRC_TABLE_IS_SET = true;
+    }
+
+    for (i = 0; i < size; ++i)
+    {
+        crc = PNG_CRC_TABLE[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static void png_put_uint32(uint8_t *dst, const uint32_t value)
+{
+    dst[0] = (uint8_t) (value >> 24);
+    dst[1] = (uint8_t) (value >> 16);
+    dst[2] = (uint8_t) (value >> 8);
+    dst[3] = (uint8_t) value;
+}
+
+static bool png_write_chunk(FILE *file, const char *type, const uint8_t *data, const size_t size)
+{
+    uint8_t  header[8];
+    uint8_t  footer[4];
+    uint32_t crc;
+
+    png_put_uint32(header, (uint32_t) size);
+    memcpy(header + 4, type, 4);
+    crc = png_crc(header + 4, 4, 0xFFFFFFFFu);
+    crc = png_crc(data, size, crc);
+    png_put_uint32(footer, crc ^ 0xFFFFFFFFu);
+
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+           (size == 0 || fwrite(data, 1, size, file) == size) &&
+           fwrite(footer, 1, sizeof(footer), file) == sizeof(footer);
+}
+
+bool cixl_raster_write_png(const char *path)
+{
+    RasterBitWriter writer;
+    FILE            *file;
+    uint8_t         header[13];
+    uint8_t         *filtered;
+    const uint8_t   *pixels  = (const uint8_t *) RASTER_PIXELS;
+    size_t          row_size = (size_t) RASTER_WIDTH_PX * 4 + 1;
+    size_t          size     = row_size * (size_t) RASTER_HEIGHT_PX;
+    size_t          x;
+    int             y;
+    bool            is_written;
+
+    if (RASTER_PIXELS == NULL)
+    {
+        return false;
+    }
+
+    //Sub filter: every byte minus the same byte of the pixel to the left
+    filtered = cixl_mem_alloc(size, sizeof(uint8_t));
+    if (filtered == NULL)
+    {
+        return false;
+    }
+    for (y = 0; y < RASTER_HEIGHT_PX; ++y, pixels += row_size - 1)
+    {
+        filtered[(size_t) y * row_size] = PNG_FILTER_SUB;
+        for (x = 0; x < row_size - 1; ++x)
+        {
+            filtered[(size_t) y * row_size + 1 + x] = (uint8_t) (x < 4 ? pixels[x] : pixels[x] - pixels[x - 4]);
+        }
+    }
+
+    memset(&writer, 0, sizeof(writer));
+    writer.capacity = size / 8 + 64;
+    writer.bytes    = cixl_mem_alloc(writer.capacity, sizeof(uint8_t));
+    is_written      = writer.bytes != NULL && deflate_zlib(&writer, filtered, size, row_size);
+    cixl_mem_free(filtered);
+
+    png_put_uint32(header, (uint32_t) RASTER_WIDTH_PX);
+    png_put_uint32(header + 4, (uint32_t) RASTER_HEIGHT_PX);
+    header[8]  = 8; //bits per channel
+    header[9]  = 6; //RGBA
+    header[10] = 0; //deflate
+    header[11] = 0; //adaptive filters
+    header[12] = 0; //not interlaced
+
+    if (is_written && (file = fopen(path, "wb")) != NULL)
+    {
+        is_written = fwrite(PNG_SIGNATURE, 1, sizeof(PNG_SIGNATURE), file) == sizeof(PNG_SIGNATURE) &&
+                     png_write_chunk(file, "IHDR", header, sizeof(header)) &&
+                     png_write_chunk(file, "IDAT", writer.bytes, writer.size) &&
+                     png_write_chunk(file, "IEND", NULL, 0);
+        is_written = fclose(file) == 0 && is_written;
+    }
+    else
+    {
+        is_written = false;
+    }
+
+    cixl_mem_free(writer.bytes);
+    return is_written;
+}
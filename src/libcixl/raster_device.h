@@ -0,0 +1,62 @@
+/*! \file
+ * \brief Raster render device. A #CIXL_RenderDevice that draws the cells into an RGBA framebuffer with the built in
+ * CP437 font (#CIXL_CP437_FONT), for screenshots, video and thumbnails without a terminal. Each cell is
+ * #CIXL_RASTER_GLYPH_WIDTH by #CIXL_RASTER_GLYPH_HEIGHT pixels, the colors come from the color table (see
+ * #cixl_color_set_rgb).
+ * Only the cells #cixl_render draws are rasterized, #cixl_raster_dirty_rect tells which part of the framebuffer
+ * changed. The framebuffer is written as PPM or PNG without external libraries.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_RASTER_DEVICE_H
+#define LIBCIXL_RASTER_DEVICE_H
+
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+#include "screen_buffer.h"
+
+#define CIXL_RASTER_GLYPH_WIDTH 8
+#define CIXL_RASTER_GLYPH_HEIGHT 8
+
+/*! \brief The font of the raster device: 8 rows per character from top to bottom, the lowest bit is the leftmost pixel.*/
+extern CIXLLIB_API const uint8_t CIXL_CP437_FONT[256][CIXL_RASTER_GLYPH_HEIGHT];
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Returns the raster render device, pass it to #cixl_init_screen_buffer. The framebuffer gets the size of the
+ * screen buffer at the first draw call and again when the screen buffer was resized (which clears it to black).*/
+CIXLLIB_API CIXL_RenderDevice *cixl_raster_device();
+
+/*! \brief Frees the framebuffer.*/
+CIXLLIB_API void cixl_raster_free();
+
+/*! \brief The framebuffer: width_px * height_px pixels of 4 bytes (red, green, blue, alpha) from the top left, row by
+ * row. NULL when nothing was drawn yet.*/
+CIXLLIB_API const uint8_t *cixl_raster_pixels(int *width_px, int *height_px);
+
+/*! \brief The smallest rectangle of pixels that contains everything that was drawn since the previous call, so a
+ * consumer of the framebuffer only has to copy or encode that part.
+ * \return false when nothing was drawn since the previous call.*/
+CIXLLIB_API bool cixl_raster_dirty_rect(int *x, int *y, int *width, int *height);
+
+/*! \brief Writes the framebuffer as a binary PPM (P6) image, without the alpha channel.*/
+CIXLLIB_API bool cixl_raster_write_ppm(const char *path);
+
+/*! \brief Writes the framebuffer as a PNG image (8 bit RGBA). The image data is compressed with fixed Huffman codes
+ * and matches with the previous pixel or the row above, which suits the large areas of the same color well.*/
+CIXLLIB_API bool cixl_raster_write_png(const char *path);
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_RASTER_DEVICE_H
+
+#pragma clang diagnostic pop
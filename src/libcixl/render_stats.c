@@ -0,0 +1,96 @@
+#include "std/cixl_stdlib.h"
+#include "render_stats.h"
+
+static CIXL_RenderStats LAST_STATS;
+static uint64_t         FRAME_COUNT     = 0;
+static bool             DETAILED_TIMING = false;
+
+/*The ring buffer, HISTORY_NEXT is where the next stats are written*/
+static CIXL_RenderStats *HISTORY         = NULL;
+static size_t           HISTORY_CAPACITY = 0;
+static size_t           HISTORY_COUNT    = 0;
+static size_t           HISTORY_NEXT     = 0;
+
+void render_stats_frame_done(const CIXL_RenderStats *stats)
+{
+    LAST_STATS = *stats;
+    ++FRAME_COUNT;
+
+    if (HISTORY != NULL)
+    {
+        HISTORY[HISTORY_NEXT] = *stats;
+        HISTORY_NEXT = (HISTORY_NEXT + 1) % HISTORY_CAPACITY;
+        if (HISTORY_COUNT < HISTORY_CAPACITY)
+        {
+            ++HISTORY_COUNT;
+        }
+    }
+}
+
+CIXL_RenderStats cixl_render_stats()
+{
+    return LAST_STATS;
+}
+
+uint64_t cixl_render_frame_count()
+{
+    return FRAME_COUNT;
+}
+
+void cixl_render_stats_set_detailed_timing(const bool enabled)
+{
+    DETAILED_TIMING = enabled;
+}
+
+bool cixl_render_stats_detailed_timing()
+{
+    return DETAILED_TIMING;
+}
+
+bool cixl_render_stats_history_start(const size_t capacity)
+{
+    cixl_render_stats_history_stop();
+
+    if (capacity == 0)
+    {
+        return false;
+    }
+
+    HISTORY = cixl_mem_alloc(capacity, sizeof(CIXL_RenderStats));
+    if (HISTORY == NULL)
+    {
+        return false;
+    }
+
+    HISTORY_CAPACITY = capacity;
+    return true;
+}
+
+void cixl_render_stats_history_stop()
+{
+    cixl_mem_free(HISTORY);
+    HISTORY          = NULL;
+    HISTORY_CAPACITY = 0;
+    HISTORY_COUNT    = 0;
+    HISTORY_NEXT     = 0;
+}
+
+size_t cixl_render_stats_history(CIXL_RenderStats *out, const size_t max_count)
+{
+    size_t count = max_count < HISTORY_COUNT ? max_count : HISTORY_COUNT;
+    size_t first;
+    size_t i;
+
+    if (HISTORY == NULL)
+    {
+        return 0;
+    }
+
+    //the last count entries, the oldest of those is count entries back from the next write position
+    first = (HISTORY_NEXT + HISTORY_CAPACITY - count) % HISTORY_CAPACITY;
+    for (i = 0; i < count; ++i)
+    {
+        out[i] = HISTORY[(first + i) % HISTORY_CAPACITY];
+    }
+    return count;
+}
@@ -0,0 +1,105 @@
+/*! \file
+ * \brief Per frame render statistics. #cixl_render fills a #CIXL_RenderStats for every frame it renders, also for a
+ * frame without changes (with no cells scanned or drawn), the stats of the last frame are available with
+ * #cixl_render_stats. Optionally the stats of the last n frames are kept in a ring
+ * buffer (see #cixl_render_stats_history_start), so they can be charted or logged to find regressions.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_RENDER_STATS_H
+#define LIBCIXL_RENDER_STATS_H
+
+#include <stddef.h>
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+
+typedef struct CIXL_RenderStats
+{
+    /*! \brief The number of the frame, counts the rendered frames since the first #cixl_render.*/
+    uint64_t frame;
+
+    /*! \brief Cells that were scanned for changes (the screen area), 0 for a frame without changes.*/
+    uint32_t cells_scanned;
+
+    /*! \brief Cells that changed and were drawn.*/
+    uint32_t cells_dirty;
+
+    /*! \brief Draw calls on the render device, each call draws a run of cells with the same style on a line.*/
+    uint32_t runs;
+
+    /*! \brief Erase calls on the render device (see CIXL_RenderDevice.f_erase), for the whole screen or a line.*/
+    uint32_t erases;
+
+    /*! \brief Cells that changed and were drawn by an erase instead of a draw call.*/
+    uint32_t cells_erased;
+
+    /*! \brief Bytes produced by the render device. When the device does not report its output (see
+     * CIXL_RenderDevice.f_frame_stats) this is the number of chars that were drawn.*/
+    uint32_t bytes;
+
+    /*! \brief Cursor moves produced by the render device, 0 when the device does not report them.*/
+    uint32_t cursor_moves;
+
+    /*! \brief Color and style changes (SGR) produced by the render device, 0 when the device does not report them.*/
+    uint32_t sgr_changes;
+
+    /*! \brief Calls to #cixl_put since the previous frame that did not change anything.*/
+    uint32_t redundant_puts;
+
+    /*! \brief Time spent finding the dirty cells. Without detailed timing this includes the encode time.*/
+    uint64_t scan_ns;
+
+    /*! \brief Time spent in the draw calls of the device, only measured with detailed timing
+     * (see #cixl_render_stats_set_detailed_timing), 0 otherwise.*/
+    uint64_t encode_ns;
+
+    /*! \brief Time spent in the end of frame of the device, where devices write their output.*/
+    uint64_t write_ns;
+
+    /*! \brief The time #cixl_render took.*/
+    uint64_t total_ns;
+} CIXL_RenderStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Called by the screen buffer when a frame is rendered, stores the stats as the last stats and in the history
+ * and counts the frame. The frame number of the stats is #cixl_render_frame_count before this call.*/
+void render_stats_frame_done(const CIXL_RenderStats *stats);
+
+/*! \brief Returns the stats of the last rendered frame, all 0 before the first frame.*/
+CIXLLIB_API CIXL_RenderStats cixl_render_stats();
+
+/*! \brief The number of rendered frames.*/
+CIXLLIB_API uint64_t cixl_render_frame_count();
+
+/*! \brief Measures the time spent in each draw call, to split the encode time from the scan time. This costs two clock
+ * reads per draw call, so it is off by default.*/
+CIXLLIB_API void cixl_render_stats_set_detailed_timing(const bool enabled);
+
+CIXLLIB_API bool cixl_render_stats_detailed_timing();
+
+/*! \brief Starts keeping the stats of the last capacity frames. Clears the history when it was already started.
+ * \return false when the history could not be allocated.*/
+CIXLLIB_API bool cixl_render_stats_history_start(const size_t capacity);
+
+CIXLLIB_API void cixl_render_stats_history_stop();
+
+/*! \brief Copies the stats of the last frames in the history, oldest first.
+ * \param out the destination, room for max_count stats
+ * \return the number of copied stats, at most max_count and at most the number of frames in the history.*/
+CIXLLIB_API size_t cixl_render_stats_history(CIXL_RenderStats *out, const size_t max_count);
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_RENDER_STATS_H
+
+#pragma clang diagnostic pop
@@ -1,6 +1,11 @@
+#include <string.h>
 #include "std/cixl_stdint.h"
 #include "std/cixl_stdlib.h"
+#include "std/cixl_stdtime.h"
 #include "screen_buffer.h"
+#include "overdraw.h"
+#include "trace.h"
+#include "perf_counters.h"
 
 #ifndef NULL
 #ifdef __cplusplus
@@ -50,12 +55,41 @@ static int CIXL_TERM_WIDTH;
 static int CIXL_TERM_HEIGHT;
 static int CIXL_TERM_AREA;
 
+/*Stats of the frame that is being rendered, and the counters since the previous frame*/
+static CIXL_RenderStats RENDER_STATS;
+static uint32_t         REDUNDANT_PUTS = 0;
+
+/*Changes to an empty cell since the previous frame in total and per line, the screen or a line is only checked for an
+  erase after enough*/
+static uint32_t BLANK_PUTS       = 0;
+static uint32_t *LINE_BLANK_PUTS = NULL;
+
+/*The minimum number of changed empty cells an erase of a line has to draw, to be worth the erase sequence*/
+#define ERASE_MIN_GAIN 8
+
+/*The maximum number of cells drawn per frame (0 is no limit), and where the next frame continues when it was reached*/
+static uint32_t RENDER_CELL_BUDGET  = 0;
+static int      RENDER_RESUME_INDEX = 0;
+
+/*Overdraw counting, compiled out when not enabled*/
+#ifdef CIXL_WITH_OVERDRAW
+#define OVERDRAW_COUNT(index, kind) overdraw_count(index, kind)
+#define OVERDRAW_FRAME_DONE() overdraw_frame_done()
+#define OVERDRAW_SCREEN_RESIZED(width, height) overdraw_screen_resized(width, height)
+#else
+#define OVERDRAW_COUNT(index, kind)
+#define OVERDRAW_FRAME_DONE()
+#define OVERDRAW_SCREEN_RESIZED(width, height)
+#endif
+
 static void free_buffers()
 {
     cixl_mem_free(LINE_BUFFER);
     cixl_mem_free(SCREEN_BUFFER.buffer_a);
     cixl_mem_free(SCREEN_BUFFER.buffer_b);
     cixl_mem_free(SCREEN_BUFFER.state_buffer);
+    cixl_mem_free(LINE_BLANK_PUTS);
+    LINE_BLANK_PUTS = NULL;
 }
 
 static void allocate_buffers(size_t term_area, size_t term_width)
@@ -64,6 +98,23 @@ static void allocate_buffers(size_t term_area, size_t term_width)
     SCREEN_BUFFER.buffer_a     = cixl_mem_alloc(term_area, sizeof(CIXL_Cxl));
     SCREEN_BUFFER.buffer_b     = cixl_mem_alloc(term_area, sizeof(CIXL_Cxl));
     SCREEN_BUFFER.state_buffer = cixl_mem_alloc(term_area, sizeof(CIXL_CxlState));
+    LINE_BLANK_PUTS            = cixl_mem_alloc(term_area / term_width, sizeof(uint32_t));
+}
+
+CIXL_RenderDevice cixl_render_device(void (*f_draw_cxl)(const int start_x, const int start_y, const CIXL_Cxl cixl),
+                                     void (*f_draw_horiz_s)(const int start_x, const int start_y, char *str,
+                                                            const unsigned int size, const CIXL_Color fg_color,
+                                                            const CIXL_Color bg_color,
+                                                            const CIXL_StyleOpts decoration))
+{
+    CIXL_RenderDevice device;
+
+    device.f_draw_cxl     = f_draw_cxl;
+    device.f_draw_horiz_s = f_draw_horiz_s;
+    device.f_end_frame    = NULL;
+    device.f_frame_stats  = NULL;
+    device.f_erase        = NULL;
+    return device;
 }
 
 bool cixl_init_screen_buffer(const int width, const int height, CIXL_RenderDevice *device)
@@ -101,8 +152,11 @@ bool cixl_init_screen_buffer(const int width, const int height, CIXL_RenderDevic
     CIXL_TERM_HEIGHT = height;
     CIXL_TERM_AREA   = width * height;
 
+    RENDER_RESUME_INDEX = 0;
+    BLANK_PUTS          = 0;
     allocate_buffers(width * height, width);
     INITIALIZED = true;
+    OVERDRAW_SCREEN_RESIZED(width, height);
     return true;
 }
 
@@ -116,6 +170,12 @@ void cixl_free_screen_buffer()
     }
 }
 
+void cixl_screen_size(int *width, int *height)
+{
+    *width  = INITIALIZED ? CIXL_TERM_WIDTH : 0;
+    *height = INITIALIZED ? CIXL_TERM_HEIGHT : 0;
+}
+
 inline bool cxl_is_out_of_drawing_area(const int x, const int y, const int num_chars)
 {
     if (x < 0 || ((x + num_chars) > CIXL_TERM_WIDTH || (x + num_chars) < 0 || y >= CIXL_TERM_HEIGHT || y < 0))
@@ -302,7 +362,7 @@ static inline bool cxl_style_equals(const CIXL_Cxl *left, const CIXL_Cxl *right)
            left->style_opts == right->style_opts;
 }
 
-bool cixl_put(const int x, const int y, const CIXL_Cxl cxl)
+static inline bool screen_buffer_put(const int x, const int y, const CIXL_Cxl cxl)
 {
     if (cxl_is_out_of_drawing_area(x, y, 1) == true)
     {
@@ -320,17 +380,28 @@ bool cixl_put(const int x, const int y, const CIXL_Cxl cxl)
         {
             return false;
         }
+        OVERDRAW_COUNT(index, CIXL_OVERDRAW_PUT);
 
-        if (cxl_equals(&next_cxl, &cxl))
+        if (is_dirty && cxl_equals(&next_cxl, &cxl))
         {
-            /*the next Cxl to be rendered is the same as the given cxl, so do nothing*/
+            /*the next Cxl to be rendered is the same as the given cxl, so do nothing. When the cxl is not dirty the
+              next buffer still holds the cxl of the frame before the last one, the current cxl is checked below*/
+            ++REDUNDANT_PUTS;
+            OVERDRAW_COUNT(index, CIXL_OVERDRAW_NOOP_PUT);
             return false;
         }
 
+        if (cxl.char_value == ' ' || cxl.char_value == '\0')
+        {
+            ++BLANK_PUTS;
+            ++LINE_BLANK_PUTS[y];
+        }
+
         if (is_dirty == true)
         {
             /*The next Cxl to be drawn is already dirty, so just overwrite it*/
             bool res;
+            OVERDRAW_COUNT(index, CIXL_OVERDRAW_CHANGE);
             res = screen_buffer_put_next(index, cxl);
 
             //When the next Cxl was the same as the previous one, clear the is dirty flag
@@ -348,14 +419,32 @@ bool cixl_put(const int x, const int y, const CIXL_Cxl cxl)
         if (cxl_equals(&cxl, &current_cxl)) // extra guard clause, the Cxl is not dirty and is the same....
         {
             screen_buffer_clear_is_dirty(index);
+            ++REDUNDANT_PUTS;
+            OVERDRAW_COUNT(index, CIXL_OVERDRAW_NOOP_PUT);
             return false;
         }
 
         // write the Cxl for the next render cycle
+        OVERDRAW_COUNT(index, CIXL_OVERDRAW_CHANGE);
         return screen_buffer_put_next(index, cxl);
     }
 }
 
+bool cixl_put(const int x, const int y, const CIXL_Cxl cxl)
+{
+    bool result;
+
+    if (!PERF_SECTIONS_ENABLED)
+    {
+        return screen_buffer_put(x, y, cxl);
+    }
+
+    perf_section_begin(CIXL_PERF_SECTION_PUT);
+    result = screen_buffer_put(x, y, cxl);
+    perf_section_end(CIXL_PERF_SECTION_PUT);
+    return result;
+}
+
 bool cixl_puti(const int x, const int y, int32_t *cxl)
 {
     //TODO: refactor, or remove this function
@@ -383,6 +472,11 @@ cixl_print(const int start_x, const int start_y, const char *str, const CIXL_Col
     unsigned   maxsize = CIXL_TERM_WIDTH;
     const char *s;
 
+    if (PERF_SECTIONS_ENABLED)
+    {
+        perf_section_begin(CIXL_PERF_SECTION_PRINT);
+    }
+
     //safe strlen and copy combined
     for (s = str; *s && maxsize--; ++s)
     {
@@ -391,7 +485,12 @@ cixl_print(const int start_x, const int start_y, const char *str, const CIXL_Col
         cxl_to_add.fg_color   = fg_color;
         cxl_to_add.bg_color   = bg_color;
         cxl_to_add.style_opts = decoration;
-        cixl_put(tmp_x++, start_y, cxl_to_add);
+        screen_buffer_put(tmp_x++, start_y, cxl_to_add);
+    }
+
+    if (PERF_SECTIONS_ENABLED)
+    {
+        perf_section_end(CIXL_PERF_SECTION_PRINT);
     }
 }
 
@@ -438,6 +537,28 @@ void cixl_clear_area(const int x, const int y, const int w, const int h)
     }
 }
 
+void screen_buffer_redraw_color(const CIXL_Color color)
+{
+    int i;
+
+    if (!INITIALIZED)
+    {
+        return;
+    }
+
+    for (i = 0; i < CIXL_TERM_AREA; ++i)
+    {
+        if (!state_is_dirty(SCREEN_BUFFER.state_buffer[i]))
+        {
+            CIXL_Cxl current = screen_buffer_pick_current(i);
+            if (current.fg_color == color || current.bg_color == color)
+            {
+                screen_buffer_put_next(i, current);
+            }
+        }
+    }
+}
+
 void cixl_reset()
 {
     int i = 0;
@@ -448,6 +569,15 @@ void cixl_reset()
         SCREEN_BUFFER.buffer_b[i]     = CXL_EMPTY;
         ++i;
     }
+    //the cells that did not fit the cell budget are gone, the next frame starts at the top
+    RENDER_RESUME_INDEX = 0;
+
+    //and so are the changes to empty cells the erase of the next frame would look for
+    BLANK_PUTS = 0;
+    if (LINE_BLANK_PUTS != NULL)
+    {
+        memset(LINE_BLANK_PUTS, 0, (size_t) CIXL_TERM_HEIGHT * sizeof(uint32_t));
+    }
 }
 
 static inline void c_str_terminate(char *src, const unsigned int real_size_plus_one)
@@ -461,14 +591,20 @@ static inline void c_str_terminate(char *src, const unsigned int real_size_plus_
  */
 static inline int render_flush_line_buffer(const int x, const int y, const CIXL_Cxl last_cxl, int *line_buffer_size)
 {
-    int draw_call_count = 0;
+    int      draw_call_count = 0;
+    uint64_t start           = 0;
+
+    if ((*line_buffer_size) > 0 && cixl_render_stats_detailed_timing())
+    {
+        start = cixl_monotonic_ns();
+    }
 
     //check the line buffer and Draw a single cxl, or a str
     if ((*line_buffer_size) == 1)
     {
         RENDER_DEVICE->f_draw_cxl(x, y, last_cxl);
         (*line_buffer_size) = 0;
-        return ++draw_call_count;
+        ++draw_call_count;
     }
 
     if ((*line_buffer_size) > 1)
@@ -478,17 +614,167 @@ static inline int render_flush_line_buffer(const int x, const int y, const CIXL_
         RENDER_DEVICE->f_draw_horiz_s(x, y, &LINE_BUFFER[0], (*line_buffer_size), last_cxl.fg_color, last_cxl.bg_color,
                                       last_cxl.style_opts);
         (*line_buffer_size) = 0;
-        return ++draw_call_count;
+        ++draw_call_count;
+    }
+
+    if (start != 0)
+    {
+        RENDER_STATS.encode_ns += cixl_monotonic_ns() - start;
     }
 
     return draw_call_count;
 }
 
-int cixl_render()
+/*! the cell looks like a cell that was erased with the given background color */
+static inline bool cxl_is_erased(const CIXL_Cxl *cxl, const CIXL_Color bg_color)
+{
+    return (cxl->char_value == ' ' || cxl->char_value == '\0') && cxl->style_opts == 0 && cxl->bg_color == bg_color;
+}
+
+/*! finds the background color of the first changed empty cell in from..to, the color to erase with */
+static bool render_erase_color(const int from, const int to, CIXL_Color *out_bg_color)
+{
+    int i;
+
+    for (i = from; i < to; ++i)
+    {
+        if (state_is_dirty(SCREEN_BUFFER.state_buffer[i]))
+        {
+            CIXL_Cxl next = buffer_pick_next_optimized(i);
+            if (cxl_is_erased(&next, next.bg_color))
+            {
+                *out_bg_color = next.bg_color;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*! the cxl that is on the screen after this frame: the next cxl when it is dirty, otherwise the current one */
+static inline const CIXL_Cxl *render_erase_pick(const int index)
+{
+    CIXL_CxlState state = SCREEN_BUFFER.state_buffer[index];
+    return &(state_a_is_next(state) == state_is_dirty(state) ? SCREEN_BUFFER.buffer_a : SCREEN_BUFFER.buffer_b)[index];
+}
+
+/*! counts for an erase of from..to: the changed empty cells the erase draws, and the cells that have to be drawn
+ * after the erase, the changed other cells and the unchanged cells it wipes. Stops counting when more than a third
+ * has to be drawn, then the erase can not pay off. */
+static void render_erase_count(const int from, const int to, const CIXL_Color bg_color, int *out_erased, int *out_drawn)
+{
+    const int max_drawn = (to - from) / 3;
+    int       i;
+
+    *out_erased = 0;
+    *out_drawn  = 0;
+    for (i = from; i < to && *out_drawn <= max_drawn; ++i)
+    {
+        if (!cxl_is_erased(render_erase_pick(i), bg_color))
+        {
+            ++(*out_drawn);
+        }
+        else if (state_is_dirty(SCREEN_BUFFER.state_buffer[i]))
+        {
+            ++(*out_erased);
+        }
+    }
+}
+
+/*! an erase pays off when it draws enough cells, and the region became mostly empty: otherwise the empty cells are
+ * just gaps between the cells that are drawn anyway, and leaving them out only splits the runs */
+static inline bool render_erase_pays_off(const int erased, const int drawn, const int min_erased)
+{
+    return erased >= min_erased && erased > 2 * drawn;
+}
+
+/*! erases from..to (whole lines) on the device: the changed empty cells are done, the unchanged other cells are marked
+ * dirty to be drawn again */
+static void render_erase(const int from, const int to, const CIXL_Color bg_color)
+{
+    int i;
+
+    RENDER_DEVICE->f_erase(from / CIXL_TERM_WIDTH, (to - from) / CIXL_TERM_WIDTH, bg_color);
+    ++RENDER_STATS.erases;
+
+    for (i = from; i < to; ++i)
+    {
+        if (state_is_dirty(SCREEN_BUFFER.state_buffer[i]))
+        {
+            CIXL_Cxl next = buffer_pick_next_optimized(i);
+            if (cxl_is_erased(&next, bg_color))
+            {
+                screen_buffer_swap_and_clear_is_dirty(i);
+                ++RENDER_STATS.cells_erased;
+            }
+        }
+        else
+        {
+            CIXL_Cxl current = screen_buffer_pick_current(i);
+            if (!cxl_is_erased(&current, bg_color))
+            {
+                screen_buffer_put_next(i, current);
+            }
+        }
+    }
+}
+
+/*! erases the whole screen when most of it became empty, otherwise each line that became mostly empty */
+static void render_erase_empty_regions()
+{
+    CIXL_Color bg_color;
+    int        erased;
+    int        drawn;
+    int        y;
+
+    if (BLANK_PUTS >= (uint32_t) CIXL_TERM_AREA / 4 && render_erase_color(0, CIXL_TERM_AREA, &bg_color))
+    {
+        render_erase_count(0, CIXL_TERM_AREA, bg_color, &erased, &drawn);
+        if (render_erase_pays_off(erased, drawn, CIXL_TERM_AREA / 4))
+        {
+            render_erase(0, CIXL_TERM_AREA, bg_color);
+            return;
+        }
+    }
+
+    for (y = 0; y < CIXL_TERM_HEIGHT; ++y)
+    {
+        const int from = y * CIXL_TERM_WIDTH;
+        const int to   = from + CIXL_TERM_WIDTH;
+
+        if (LINE_BLANK_PUTS[y] >= ERASE_MIN_GAIN && render_erase_color(from, to, &bg_color))
+        {
+            render_erase_count(from, to, bg_color, &erased, &drawn);
+            if (render_erase_pays_off(erased, drawn, ERASE_MIN_GAIN))
+            {
+                render_erase(from, to, bg_color);
+            }
+        }
+    }
+}
+
+/*! a frame without changes draws nothing, but it is still a frame for the render stats and the overdraw averages:
+ * every put since the previous frame was redundant */
+static int screen_buffer_render_clean()
+{
+    uint64_t start_ns = cixl_monotonic_ns();
+
+    memset(&RENDER_STATS, 0, sizeof(RENDER_STATS));
+    RENDER_STATS.frame          = cixl_render_frame_count();
+    RENDER_STATS.redundant_puts = REDUNDANT_PUTS;
+    REDUNDANT_PUTS = 0;
+    RENDER_STATS.total_ns = cixl_monotonic_ns() - start_ns;
+    RENDER_STATS.scan_ns  = RENDER_STATS.total_ns;
+    render_stats_frame_done(&RENDER_STATS);
+    OVERDRAW_FRAME_DONE();
+    return 0;
+}
+
+static int screen_buffer_render()
 {
     if (SCREEN_BUFFER_IS_DIRTY == false)
     {
-        return 0;
+        return INITIALIZED ? screen_buffer_render_clean() : 0;
     }
 
     if (!INITIALIZED)
@@ -496,10 +782,12 @@ int cixl_render()
         return -2;
     }
     {
-        int draw_call_count = 0;
-        int i               = 0;
-        int y               = -1;
-        int x;
+        int  draw_call_count  = 0;
+        int  scanned          = 0;
+        int  i                = RENDER_RESUME_INDEX < CIXL_TERM_AREA ? RENDER_RESUME_INDEX : 0;
+        bool budget_exhausted = false;
+        int  y;
+        int  x;
 
         int prev_written_idx = -2;
         int line_buffer_size = 0;
@@ -508,25 +796,44 @@ int cixl_render()
 
         CIXL_Cxl last_cxl = CXL_EMPTY;
 
-        while (i < CIXL_TERM_AREA)
+        uint64_t start_ns = cixl_monotonic_ns();
+        uint64_t draws_done_ns;
+
+        memset(&RENDER_STATS, 0, sizeof(RENDER_STATS));
+        cixl_trace_begin("render");
+
+        if (RENDER_DEVICE->f_erase != NULL && BLANK_PUTS >= ERASE_MIN_GAIN)
+        {
+            render_erase_empty_regions();
+        }
+        BLANK_PUTS = 0;
+        memset(LINE_BLANK_PUTS, 0, (size_t) CIXL_TERM_HEIGHT * sizeof(uint32_t));
+
+        //starts at the top, or where the previous frame ran out of its cell budget, and wraps around
+        while (scanned < CIXL_TERM_AREA)
         {
             x = i % CIXL_TERM_WIDTH;
-            if (x == 0)
-            {
-                ++y;
-            }
+            y = i / CIXL_TERM_WIDTH;
             {//:{}(for OpenWatcom compatibility)
                 CIXL_CxlState current_state = SCREEN_BUFFER.state_buffer[i];
 
-                bool continuation_on_same_line_has_ended = prev_written_idx != i - 1 && i > 0;
+                bool continuation_on_same_line_has_ended = prev_written_idx != i - 1 && scanned > 0;
 
-                if (continuation_on_same_line_has_ended || line_buffer_size ==
-                                                           CIXL_TERM_WIDTH) //not at start:check if continuation on same line has stopped,or EOL
+                //not at start:check if continuation on same line has stopped, or the line ended: a draw call never wraps
+                if (continuation_on_same_line_has_ended || (x == 0 && line_buffer_size > 0))
                 {
                     draw_call_count += render_flush_line_buffer(draw_x, draw_y, last_cxl, &line_buffer_size);
                 }
 
                 /*When the state IsDirty put cxl in line-buffer to prepare for draw*/
+                if (state_is_dirty(current_state) && RENDER_CELL_BUDGET > 0 &&
+                    RENDER_STATS.cells_dirty >= RENDER_CELL_BUDGET)
+                {
+                    //leave the rest dirty for the next frame
+                    budget_exhausted = true;
+                    break;
+                }
+
                 if (state_is_dirty(current_state))
                 {
                     bool is_continuation_on_same_line = prev_written_idx == i - 1 && i > 0;
@@ -552,10 +859,15 @@ int cixl_render()
                     screen_buffer_swap_and_clear_is_dirty(i);//done with this cxl
 
                     prev_written_idx = i;
+                    ++RENDER_STATS.cells_dirty;
                 }
             }
 
-            ++i;
+            ++scanned;
+            if (++i == CIXL_TERM_AREA)
+            {
+                i = 0;
+            }
         }
 
         if (line_buffer_size > 0)
@@ -563,7 +875,59 @@ int cixl_render()
             draw_call_count += render_flush_line_buffer(draw_x, draw_y, last_cxl, &line_buffer_size);
         }
 
-        SCREEN_BUFFER_IS_DIRTY = false;
+        draws_done_ns = cixl_monotonic_ns();
+        if (RENDER_DEVICE->f_end_frame != NULL)
+        {
+            cixl_trace_begin("end frame");
+            RENDER_DEVICE->f_end_frame();
+            cixl_trace_end();
+        }
+
+        RENDER_STATS.frame          = cixl_render_frame_count();
+        RENDER_STATS.cells_scanned  = (uint32_t) CIXL_TERM_AREA;
+        RENDER_STATS.runs           = (uint32_t) draw_call_count;
+        RENDER_STATS.bytes          = RENDER_STATS.cells_dirty;
+        RENDER_STATS.redundant_puts = REDUNDANT_PUTS;
+        REDUNDANT_PUTS = 0;
+        if (RENDER_DEVICE->f_frame_stats != NULL)
+        {
+            RENDER_DEVICE->f_frame_stats(&RENDER_STATS);
+        }
+        RENDER_STATS.total_ns = cixl_monotonic_ns() - start_ns;
+        RENDER_STATS.write_ns = RENDER_STATS.total_ns - (draws_done_ns - start_ns);
+        RENDER_STATS.scan_ns  = (draws_done_ns - start_ns) - RENDER_STATS.encode_ns;
+        render_stats_frame_done(&RENDER_STATS);
+        OVERDRAW_FRAME_DONE();
+
+        //the next frame continues at the start of the row that did not fit
+        RENDER_RESUME_INDEX    = budget_exhausted ? i - x : 0;
+        SCREEN_BUFFER_IS_DIRTY = budget_exhausted;
+        cixl_trace_end();
         return draw_call_count;
     }
 }
+
+int cixl_render()
+{
+    int result;
+
+    if (!PERF_SECTIONS_ENABLED)
+    {
+        return screen_buffer_render();
+    }
+
+    perf_section_begin(CIXL_PERF_SECTION_RENDER);
+    result = screen_buffer_render();
+    perf_section_end(CIXL_PERF_SECTION_RENDER);
+    return result;
+}
+
+void cixl_render_set_cell_budget(const uint32_t max_cells)
+{
+    RENDER_CELL_BUDGET = max_cells;
+}
+
+uint32_t cixl_render_cell_budget()
+{
+    return RENDER_CELL_BUDGET;
+}
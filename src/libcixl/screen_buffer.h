@@ -11,6 +11,7 @@
 
 #include "cxl.h"
 #include "colors.h"
+#include "render_stats.h"
 
 typedef struct CIXL_RenderDevice
 {
@@ -18,6 +19,18 @@ typedef struct CIXL_RenderDevice
 
     void (*f_draw_horiz_s)(const int start_x, const int start_y, char *str, const unsigned int size,
                            const CIXL_Color fg_color, const CIXL_Color bg_color, const CIXL_StyleOpts decoration);
+
+    /*! \brief Optional, can be NULL. Called by #cixl_render after the last draw call of a frame that had dirty cxls.*/
+    void (*f_end_frame)(void);
+
+    /*! \brief Optional, can be NULL. Called by #cixl_render after f_end_frame, to report the output of the frame: the
+     * device sets the bytes, cursor_moves and sgr_changes of the stats.*/
+    void (*f_frame_stats)(CIXL_RenderStats *stats);
+
+    /*! \brief Optional, can be NULL. Erases line_count whole lines from start_y to spaces with the given background
+     * color and no style (all lines of the screen at once when start_y is 0 and line_count the height). When set,
+     * #cixl_render uses it when the screen or a line became mostly empty, instead of drawing the empty cells.*/
+    void (*f_erase)(const int start_y, const int line_count, const CIXL_Color bg_color);
 } CIXL_RenderDevice;
 
 
@@ -46,6 +59,20 @@ int cxl_index_for_xy(int x, int y);
 
 #endif
 
+/*! \brief Used by the color table, marks the cells that have the given foreground or background color dirty so they
+ * are drawn again with the new color.*/
+void screen_buffer_redraw_color(const CIXL_Color color);
+
+/*! \brief Returns a render device with the two required draw functions and all optional functions NULL. Use it instead of
+ * a partial brace initializer, so the device stays complete when optional functions are added.*/
+CIXLLIB_API CIXL_RenderDevice cixl_render_device(void (*f_draw_cxl)(const int start_x, const int start_y,
+                                                                    const CIXL_Cxl cixl),
+                                                 void (*f_draw_horiz_s)(const int start_x, const int start_y, char *str,
+                                                                        const unsigned int size,
+                                                                        const CIXL_Color fg_color,
+                                                                        const CIXL_Color bg_color,
+                                                                        const CIXL_StyleOpts decoration));
+
 /*! \brief initializes the screen-buffer to the proper size. If already initialized with the same size they will be reset.
  * if the buffers were already initialized with a different size, the old buffers will be cleared and reallocated.
  * */
@@ -53,6 +80,9 @@ CIXLLIB_API bool cixl_init_screen_buffer(const int width, const int height, CIXL
 
 CIXLLIB_API void cixl_free_screen_buffer();
 
+/*! \brief The size of the screen buffer in cells, 0 by 0 when it is not initialized.*/
+CIXLLIB_API void cixl_screen_size(int *width, int *height);
+
 CIXLLIB_API bool cixl_put(const int x, const int y, const CIXL_Cxl cxl);
 
 CIXLLIB_API bool cixl_puti(const int x, const int y, int32_t *cxl);
@@ -70,11 +100,20 @@ CIXLLIB_API void cixl_clear_area(const int x, const int y, const int w, const in
 CIXLLIB_API void cixl_reset();
 
 /*! \brief Renders the next frame.
- * This calls the f_draw_cxl and f_draw_horiz_s of the CIXL_RenderDevice when the content of particular cells are updated.
+ * This calls the f_draw_cxl and f_draw_horiz_s of the CIXL_RenderDevice when the content of particular cells are updated,
+ * followed by f_end_frame (when set). The statistics of the frame are available with #cixl_render_stats.
  * It does not redraw each cixl each frame. The purpose is to manage a stateful terminal screen write calls efficiently
  * since those write calls are slow.  */
 CIXLLIB_API int cixl_render();
 
+/*! \brief Limits the number of cells that #cixl_render draws per frame, to bound the output of a frame (for example
+ * while the game is running slowly, see #CIXL_SlowPolicy). The cells that do not fit stay dirty and are drawn by the
+ * next frames, which continue where the previous one stopped, so the whole screen is updated eventually.
+ *! \param max_cells the maximum, 0 is no limit (the default).*/
+CIXLLIB_API void cixl_render_set_cell_budget(const uint32_t max_cells);
+
+CIXLLIB_API uint32_t cixl_render_cell_budget();
+
 #ifdef __cplusplus
 } /* End of extern "C" */
 #endif
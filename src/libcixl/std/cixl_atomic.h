@@ -0,0 +1,36 @@
+#ifndef LIBCIXL_CIXL_ATOMIC_H
+#define LIBCIXL_CIXL_ATOMIC_H
+
+/* Relaxed (unordered) atomic access, for counters and flags that are shared between threads. Without the GCC/clang
+ * builtins (Dos, old compilers) there are no threads, so plain reads and writes are enough. */
+#if defined(__GNUC__) && defined(__ATOMIC_RELAXED)
+#define CIXL_ATOMIC_LOAD(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#define CIXL_ATOMIC_STORE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELAXED)
+#define CIXL_ATOMIC_FETCH_ADD(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_RELAXED)
+#else
+#define CIXL_ATOMIC_LOAD(ptr) (*(ptr))
+#define CIXL_ATOMIC_STORE(ptr, value) (*(ptr) = (value))
+#define CIXL_ATOMIC_FETCH_ADD(ptr, value) ((*(ptr) += (value)) - (value))
+#endif
+
+/* Acquire and release ordering, to hand data from one thread to another: everything written before a release store is
+ * visible after the acquire load that reads the stored value (for example a single producer single consumer ring). */
+#if defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+#define CIXL_ATOMIC_LOAD_ACQUIRE(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define CIXL_ATOMIC_STORE_RELEASE(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#else
+#define CIXL_ATOMIC_LOAD_ACQUIRE(ptr) (*(ptr))
+#define CIXL_ATOMIC_STORE_RELEASE(ptr, value) (*(ptr) = (value))
+#endif
+
+/* Thread local storage, for per thread state. Without support all threads share the variable, which is only correct on
+ * platforms without threads. */
+#if defined(__GNUC__)
+#define CIXL_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define CIXL_THREAD_LOCAL __declspec(thread)
+#else
+#define CIXL_THREAD_LOCAL
+#endif
+
+#endif //LIBCIXL_CIXL_ATOMIC_H
@@ -3,7 +3,7 @@
 
 #ifdef __WATCOMC__
 #include <i86.h>
-void cixl_sleep_ms(unsigned int milliseconds)
+static inline void cixl_sleep_ms(unsigned int milliseconds)
 {
     delay(milliseconds);
 }
@@ -11,11 +11,22 @@ void cixl_sleep_ms(unsigned int milliseconds)
 
 #ifdef WIN32
 #include <Windows.h>
-void cixl_sleep_ms(unsigned int milliseconds)
+static inline void cixl_sleep_ms(unsigned int milliseconds)
 {
     Sleep(milliseconds);
 }
 #endif
 
+#if defined(__unix__)
+#include <time.h>
+static inline void cixl_sleep_ms(unsigned int milliseconds)
+{
+    struct timespec duration;
+    duration.tv_sec  = milliseconds / 1000;
+    duration.tv_nsec = (long) (milliseconds % 1000) * 1000000L;
+    nanosleep(&duration, NULL);
+}
+#endif
+
 #endif //LIBCIXL_CIXL_SLEEP_H
 
@@ -1,9 +1,11 @@
 #ifndef LIBCIXL_CIXL_STDBOOL_H
 #define LIBCIXL_CIXL_STDBOOL_H
 #ifndef __cplusplus
-typedef enum
+/* _Bool keeps bool the same size as the C++ bool, so structs and bool pointers can be shared with C++ callers */
+typedef _Bool bool;
+enum
 {
     false, true
-} bool;
+};
 #endif
 #endif //LIBCIXL_CIXL_STDBOOL_H
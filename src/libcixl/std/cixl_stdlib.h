@@ -2,12 +2,17 @@
 #define LIBCIXL_CIXL_STDLIB_H
 #include <stdlib.h>
 
-void* cixl_mem_alloc(size_t count, size_t size)
+static inline void* cixl_mem_alloc(size_t count, size_t size)
 {
     return calloc(count, size);
 }
 
-void cixl_mem_free(void* block)
+static inline void* cixl_mem_realloc(void* block, size_t size)
+{
+    return realloc(block, size);
+}
+
+static inline void cixl_mem_free(void* block)
 {
     free(block);
 }
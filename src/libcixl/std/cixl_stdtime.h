@@ -1,5 +1,20 @@
 #ifndef LIBCIXL_CIXL_STDTIME_H
 #define LIBCIXL_CIXL_STDTIME_H
 #include <time.h>
+#include "cixl_stdint.h"
 //TODO: https://stackoverflow.com/questions/11499991/implementing-timeouts-in-ms-dos-freedos-applications
+
+/*! \brief Nanoseconds from a monotonic clock with an arbitrary starting point, only useful to measure intervals.
+ * Falls back to clock() when there is no monotonic clock (Dos), with the resolution of CLOCKS_PER_SEC. */
+static inline uint64_t cixl_monotonic_ns(void)
+{
+#if defined(__unix__) && defined(CLOCK_MONOTONIC)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000u) + (uint64_t) now.tv_nsec;
+#else
+    return (uint64_t) ((clock() * 1000000000.0) / CLOCKS_PER_SEC);
+#endif
+}
+
 #endif //LIBCIXL_CIXL_STDTIME_H
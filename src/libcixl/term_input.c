@@ -0,0 +1,887 @@
+#include <string.h>
+#include "std/cixl_atomic.h"
+#include "std/cixl_stdtime.h"
+#include "term_input.h"
+#include "input_log_internal.h"
+
+#if defined(__unix__)
+#define TERM_INPUT_WITH_TERMIOS
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+#define TERM_INPUT_MAX_PARAMS 8
+#define TERM_INPUT_READ_SIZE 4096
+
+/* Parser states */
+#define STATE_GROUND 0
+#define STATE_ESCAPE 1
+#define STATE_CSI 2
+#define STATE_SS3 3
+#define STATE_PASTE 4
+#define STATE_COUNT 5
+
+/* Byte classes */
+#define CLASS_CONTROL 0      /* C0 controls, except escape */
+#define CLASS_ESCAPE 1
+#define CLASS_DIGIT 2
+#define CLASS_SEPARATOR 3    /* ; and : */
+#define CLASS_PRIVATE 4      /* < = > ? */
+#define CLASS_INTERMEDIATE 5 /* space up to / */
+#define CLASS_BRACKET 6      /* [ */
+#define CLASS_SS3 7          /* O */
+#define CLASS_FINAL 8        /* the other bytes from @ up to ~ */
+#define CLASS_DELETE 9
+#define CLASS_UTF8 10        /* 0x80 and up */
+#define CLASS_COUNT 11
+
+/* Actions */
+#define ACTION_NONE 0
+#define ACTION_PRINT 1
+#define ACTION_CONTROL 2
+#define ACTION_ESCAPE_START 3
+#define ACTION_ALT_PRINT 4
+#define ACTION_ALT_CONTROL 5
+#define ACTION_ESCAPE_KEY 6   /* escape followed by escape: the first one was the escape key */
+#define ACTION_ESCAPE_PRINT 7 /* escape followed by utf-8: the escape key and a character */
+#define ACTION_SEQUENCE_START 8
+#define ACTION_PARAM 9
+#define ACTION_SEPARATOR 10
+#define ACTION_PRIVATE 11
+#define ACTION_CSI_DISPATCH 12
+#define ACTION_SS3_DISPATCH 13
+#define ACTION_PASTE 14
+
+typedef struct TermInputTransition
+{
+    uint8_t next_state;
+    uint8_t action;
+} TermInputTransition;
+
+#define T(state, action) {STATE_##state, ACTION_##action}
+
+/* [state][byte class], the classes in order: control, escape, digit, separator, private, intermediate, bracket, ss3,
+ * final, delete, utf8 */
+static const TermInputTransition TRANSITIONS[STATE_COUNT][CLASS_COUNT] = {
+        /* ground */
+        {T(GROUND, CONTROL), T(ESCAPE, ESCAPE_START), T(GROUND, PRINT), T(GROUND, PRINT), T(GROUND, PRINT),
+         T(GROUND, PRINT), T(GROUND, PRINT), T(GROUND, PRINT), T(GROUND, PRINT), T(GROUND, PRINT), T(GROUND, PRINT)},
+        /* escape */
+        {T(GROUND, ALT_CONTROL), T(ESCAPE, ESCAPE_KEY), T(GROUND, ALT_PRINT), T(GROUND, ALT_PRINT),
+         T(GROUND, ALT_PRINT), T(GROUND, ALT_PRINT), T(CSI, SEQUENCE_START), T(SS3, SEQUENCE_START),
+         T(GROUND, ALT_PRINT), T(GROUND, ALT_PRINT), T(GROUND, ESCAPE_PRINT)},
+        /* csi */
+        {T(CSI, CONTROL), T(ESCAPE, ESCAPE_START), T(CSI, PARAM), T(CSI, SEPARATOR), T(CSI, PRIVATE), T(CSI, NONE),
+         T(GROUND, CSI_DISPATCH), T(GROUND, CSI_DISPATCH), T(GROUND, CSI_DISPATCH), T(CSI, NONE), T(GROUND, PRINT)},
+        /* ss3 */
+        {T(SS3, CONTROL), T(ESCAPE, ESCAPE_START), T(SS3, PARAM), T(SS3, SEPARATOR), T(GROUND, NONE), T(GROUND, NONE),
+         T(GROUND, SS3_DISPATCH), T(GROUND, SS3_DISPATCH), T(GROUND, SS3_DISPATCH), T(GROUND, NONE), T(GROUND, PRINT)},
+        /* paste, the end of the paste is matched by the action */
+        {T(PASTE, PASTE), T(PASTE, PASTE), T(PASTE, PASTE), T(PASTE, PASTE), T(PASTE, PASTE), T(PASTE, PASTE),
+         T(PASTE, PASTE), T(PASTE, PASTE), T(PASTE, PASTE), T(PASTE, PASTE), T(PASTE, PASTE)}
+};
+
+#undef T
+
+static const char PASTE_END[6] = {'\033', '[', '2', '0', '1', '~'};
+
+typedef struct TermInputParser
+{
+    int      state;
+    uint32_t params[TERM_INPUT_MAX_PARAMS];
+    int      param_count;
+    char     private_marker;
+
+    /* the code point that is being decoded and how many continuation bytes it still needs */
+    uint32_t utf8_code_point;
+    int      utf8_remaining;
+    uint16_t utf8_modifiers;
+
+    /* the pasted text that is not put in the ring yet, and how much of the end sequence matched */
+    char         paste_chunk[CIXL_TERM_INPUT_PASTE_CHUNK_SIZE];
+    unsigned int paste_size;
+    unsigned int paste_end_matched;
+} TermInputParser;
+
+static TermInputParser     PARSER;
+static CIXL_TermInputStats TERM_INPUT_STATS;
+
+/* Single producer single consumer rings, the indexes run freely and are masked on access */
+static CIXL_InputEvent EVENT_RING[CIXL_TERM_INPUT_RING_SIZE];
+static uint32_t        EVENT_RING_HEAD = 0; /* written by the producer */
+static uint32_t        EVENT_RING_TAIL = 0; /* written by the consumer */
+
+static char     PASTE_RING[CIXL_TERM_INPUT_PASTE_RING_SIZE];
+static uint32_t PASTE_RING_HEAD = 0;
+static uint32_t PASTE_RING_TAIL = 0;
+
+/* Consumer: the text of the last taken paste event that was not copied yet */
+static uint32_t PASTE_UNREAD = 0;
+
+/* Producer: an escape at the end of a read is held, it can be the start of a sequence that is split over reads */
+static bool     ESCAPE_HELD    = false;
+static uint64_t ESCAPE_HELD_NS = 0;
+
+static inline int byte_class(const unsigned char byte)
+{
+    if (byte == 0x1B)
+    {
+        return CLASS_ESCAPE;
+    }
+    if (byte < 0x20)
+    {
+        return CLASS_CONTROL;
+    }
+    if (byte >= '0' && byte <= '9')
+    {
+        return CLASS_DIGIT;
+    }
+    if (byte == ';' || byte == ':')
+    {
+        return CLASS_SEPARATOR;
+    }
+    if (byte >= '<' && byte <= '?')
+    {
+        return CLASS_PRIVATE;
+    }
+    if (byte < 0x30)
+    {
+        return CLASS_INTERMEDIATE;
+    }
+    if (byte == '[')
+    {
+        return CLASS_BRACKET;
+    }
+    if (byte == 'O')
+    {
+        return CLASS_SS3;
+    }
+    if (byte == 0x7F)
+    {
+        return CLASS_DELETE;
+    }
+    return byte > 0x7F ? CLASS_UTF8 : CLASS_FINAL;
+}
+
+/* Producer side */
+
+static bool push_event(const uint16_t type, const uint16_t modifiers, const uint32_t code, const int32_t x,
+                       const int32_t y)
+{
+    uint32_t        head = EVENT_RING_HEAD;
+    CIXL_InputEvent *event;
+
+    if (head - CIXL_ATOMIC_LOAD_ACQUIRE(&EVENT_RING_TAIL) >= CIXL_TERM_INPUT_RING_SIZE)
+    {
+        ++TERM_INPUT_STATS.dropped;
+        return false;
+    }
+
+    event = &EVENT_RING[head & (CIXL_TERM_INPUT_RING_SIZE - 1)];
+    event->type      = type;
+    event->modifiers = modifiers;
+    event->code      = code;
+    event->x         = x;
+    event->y         = y;
+    CIXL_ATOMIC_STORE_RELEASE(&EVENT_RING_HEAD, head + 1);
+    ++TERM_INPUT_STATS.events;
+    return true;
+}
+
+static inline bool push_key(const uint32_t code, const uint16_t modifiers)
+{
+    return push_event(CIXL_INPUT_KEY, modifiers, code, 0, 0);
+}
+
+static void flush_paste_chunk()
+{
+    uint32_t head = PASTE_RING_HEAD;
+    uint32_t i;
+
+    if (PARSER.paste_size == 0)
+    {
+        return;
+    }
+
+    //the text goes in the ring before the event, so it is there when the event is taken
+    if (CIXL_TERM_INPUT_PASTE_RING_SIZE - (head - CIXL_ATOMIC_LOAD_ACQUIRE(&PASTE_RING_TAIL)) < PARSER.paste_size ||
+        CIXL_TERM_INPUT_RING_SIZE - (EVENT_RING_HEAD - CIXL_ATOMIC_LOAD_ACQUIRE(&EVENT_RING_TAIL)) == 0)
+    {
+        TERM_INPUT_STATS.dropped += PARSER.paste_size;
+        PARSER.paste_size = 0;
+        return;
+    }
+
+    for (i = 0; i < PARSER.paste_size; ++i)
+    {
+        PASTE_RING[(head + i) & (CIXL_TERM_INPUT_PASTE_RING_SIZE - 1)] = PARSER.paste_chunk[i];
+    }
+    CIXL_ATOMIC_STORE_RELEASE(&PASTE_RING_HEAD, head + PARSER.paste_size);
+    push_event(CIXL_INPUT_PASTE, 0, PARSER.paste_size, 0, 0);
+    PARSER.paste_size = 0;
+}
+
+static inline void paste_append(const char byte)
+{
+    if (PARSER.paste_size == CIXL_TERM_INPUT_PASTE_CHUNK_SIZE)
+    {
+        flush_paste_chunk();
+    }
+    PARSER.paste_chunk[PARSER.paste_size++] = byte;
+}
+
+static void paste_byte(const char byte)
+{
+    unsigned int i;
+
+    if (byte == PASTE_END[PARSER.paste_end_matched])
+    {
+        if (++PARSER.paste_end_matched == sizeof(PASTE_END))
+        {
+            flush_paste_chunk();
+            PARSER.paste_end_matched = 0;
+            PARSER.state             = STATE_GROUND;
+        }
+        return;
+    }
+
+    //not the end after all: the bytes that matched so far are text
+    for (i = 0; i < PARSER.paste_end_matched; ++i)
+    {
+        paste_append(PASTE_END[i]);
+    }
+    PARSER.paste_end_matched = 0;
+    if (byte == PASTE_END[0])
+    {
+        PARSER.paste_end_matched = 1;
+    }
+    else
+    {
+        paste_append(byte);
+    }
+}
+
+static void print_byte(const unsigned char byte, const uint16_t modifiers)
+{
+    if (byte < 0x80)
+    {
+        PARSER.utf8_remaining = 0;
+        push_key(byte, modifiers);
+        return;
+    }
+
+    if (byte < 0xC0)
+    {
+        //continuation byte
+        if (PARSER.utf8_remaining == 0)
+        {
+            push_key(0xFFFDu, modifiers);
+            return;
+        }
+        PARSER.utf8_code_point = (PARSER.utf8_code_point << 6) | (byte & 0x3Fu);
+        if (--PARSER.utf8_remaining == 0)
+        {
+            push_key(PARSER.utf8_code_point, PARSER.utf8_modifiers);
+        }
+        return;
+    }
+
+    if (PARSER.utf8_remaining > 0)
+    {
+        //a new character before the last one was complete
+        push_key(0xFFFDu, PARSER.utf8_modifiers);
+    }
+    PARSER.utf8_modifiers = modifiers;
+    if (byte < 0xE0)
+    {
+        PARSER.utf8_code_point = byte & 0x1Fu;
+        PARSER.utf8_remaining  = 1;
+    }
+    else if (byte < 0xF0)
+    {
+        PARSER.utf8_code_point = byte & 0x0Fu;
+        PARSER.utf8_remaining  = 2;
+    }
+    else if (byte < 0xF8)
+    {
+        PARSER.utf8_code_point = byte & 0x07u;
+        PARSER.utf8_remaining  = 3;
+    }
+    else
+    {
+        PARSER.utf8_remaining = 0;
+        push_key(0xFFFDu, modifiers);
+    }
+}
+
+static void control_byte(const unsigned char byte, const uint16_t modifiers)
+{
+    if (byte == '\t' || byte == '\n' || byte == '\r' || byte > 26)
+    {
+        push_key(byte, modifiers);
+    }
+    else if (byte == 0)
+    {
+        push_key(' ', (uint16_t) (modifiers | CIXL_MOD_CTRL));
+    }
+    else
+    {
+        //Ctrl+A is 1 up to Ctrl+Z is 26
+        push_key('a' + byte - 1u, (uint16_t) (modifiers | CIXL_MOD_CTRL));
+    }
+}
+
+/* The modifiers of a key sequence: the parameter is 1 + a bit mask of shift (1), alt (2) and ctrl (4) */
+static inline uint16_t sequence_modifiers(const int param)
+{
+    if (PARSER.param_count <= param || PARSER.params[param] < 2)
+    {
+        return 0;
+    }
+    return (uint16_t) ((PARSER.params[param] - 1u) & (CIXL_MOD_SHIFT | CIXL_MOD_ALT | CIXL_MOD_CTRL));
+}
+
+/* The key of the final byte of a CSI or SS3 sequence (cursor keys and F1 up to F4), 0 when unknown */
+static uint32_t final_key(const unsigned char final)
+{
+    switch (final)
+    {
+        case 'A':
+            return CIXL_KEY_UP;
+        case 'B':
+            return CIXL_KEY_DOWN;
+        case 'C':
+            return CIXL_KEY_RIGHT;
+        case 'D':
+            return CIXL_KEY_LEFT;
+        case 'H':
+            return CIXL_KEY_HOME;
+        case 'F':
+            return CIXL_KEY_END;
+        case 'P':
+        case 'Q':
+        case 'R':
+        case 'S':
+            return CIXL_KEY_F1 + (final - 'P');
+        case 'Z':
+            return CIXL_KEY_BACK_TAB;
+        default:
+            return 0;
+    }
+}
+
+/* The key of CSI number ~, 0 when unknown */
+static uint32_t tilde_key(const uint32_t number)
+{
+    static const uint32_t FUNCTION_KEYS[14] = {11, 12, 13, 14, 15, 17, 18, 19, 20, 21, 23, 24, 0, 0};
+    uint32_t              i;
+
+    switch (number)
+    {
+        case 1:
+        case 7:
+            return CIXL_KEY_HOME;
+        case 2:
+            return CIXL_KEY_INSERT;
+        case 3:
+            return CIXL_KEY_DELETE;
+        case 4:
+        case 8:
+            return CIXL_KEY_END;
+        case 5:
+            return CIXL_KEY_PAGE_UP;
+        case 6:
+            return CIXL_KEY_PAGE_DOWN;
+        default:
+            for (i = 0; i < 12; ++i)
+            {
+                if (FUNCTION_KEYS[i] == number)
+                {
+                    return CIXL_KEY_F1 + i;
+                }
+            }
+            return 0;
+    }
+}
+
+static void csi_dispatch(const unsigned char final)
+{
+    uint32_t key;
+
+    if (PARSER.private_marker == '<' && (final == 'M' || final == 'm'))
+    {
+        //SGR mouse: CSI < button ; x ; y M (pressed or moved) or m (released), x and y are 1 based
+        uint32_t button    = PARSER.params[0];
+        uint16_t modifiers = (uint16_t) (((button & 4u) ? CIXL_MOD_SHIFT : 0u) | ((button & 8u) ? CIXL_MOD_ALT : 0u) |
+                                         ((button & 16u) ? CIXL_MOD_CTRL : 0u));
+        uint32_t code      = (button & ~(4u | 8u | 16u)) | (final == 'm' ? CIXL_MOUSE_RELEASED : 0u);
+
+        if (PARSER.param_count >= 3)
+        {
+            push_event(CIXL_INPUT_MOUSE, modifiers, code, (int32_t) PARSER.params[1] - 1,
+                       (int32_t) PARSER.params[2] - 1);
+        }
+        return;
+    }
+    if (PARSER.private_marker != 0)
+    {
+        //replies to queries, not input
+        return;
+    }
+
+    if (final == '~')
+    {
+        if (PARSER.params[0] == 200)
+        {
+            PARSER.state             = STATE_PASTE;
+            PARSER.paste_size        = 0;
+            PARSER.paste_end_matched = 0;
+            return;
+        }
+        key = tilde_key(PARSER.params[0]);
+    }
+    else
+    {
+        key = final_key(final);
+    }
+
+    if (key != 0)
+    {
+        push_key(key, sequence_modifiers(1));
+    }
+}
+
+static void ss3_dispatch(const unsigned char final)
+{
+    uint32_t key = final_key(final);
+
+    if (key != 0)
+    {
+        push_key(key, sequence_modifiers(0));
+    }
+}
+
+static void parse_byte(const unsigned char byte)
+{
+    const TermInputTransition *transition = &TRANSITIONS[PARSER.state][byte_class(byte)];
+
+    PARSER.state = transition->next_state;
+    switch (transition->action)
+    {
+        case ACTION_PRINT:
+            print_byte(byte, 0);
+            break;
+        case ACTION_CONTROL:
+            control_byte(byte, 0);
+            break;
+        case ACTION_ALT_PRINT:
+            print_byte(byte, CIXL_MOD_ALT);
+            break;
+        case ACTION_ALT_CONTROL:
+            control_byte(byte, CIXL_MOD_ALT);
+            break;
+        case ACTION_ESCAPE_KEY:
+            push_key(0x1B, 0);
+            break;
+        case ACTION_ESCAPE_PRINT:
+            push_key(0x1B, 0);
+            print_byte(byte, 0);
+            break;
+        case ACTION_SEQUENCE_START:
+            memset(PARSER.params, 0, sizeof(PARSER.params));
+            PARSER.param_count    = 0;
+            PARSER.private_marker = 0;
+            break;
+        case ACTION_PARAM:
+            if (PARSER.param_count == 0)
+            {
+                PARSER.param_count = 1;
+            }
+            if (PARSER.param_count <= TERM_INPUT_MAX_PARAMS && PARSER.params[PARSER.param_count - 1] < 100000u)
+            {
+                PARSER.params[PARSER.param_count - 1] = (PARSER.params[PARSER.param_count - 1] * 10u) + (byte - '0');
+            }
+            break;
+        case ACTION_SEPARATOR:
+            //an empty first parameter still counts
+            PARSER.param_count = (PARSER.param_count == 0 ? 1 : PARSER.param_count) + 1;
+            break;
+        case ACTION_PRIVATE:
+            PARSER.private_marker = (char) byte;
+            break;
+        case ACTION_CSI_DISPATCH:
+            csi_dispatch(byte);
+            break;
+        case ACTION_SS3_DISPATCH:
+            ss3_dispatch(byte);
+            break;
+        case ACTION_PASTE:
+            paste_byte((char) byte);
+            break;
+        default:
+            break;
+    }
+}
+
+static size_t parse(const char *bytes, const size_t size)
+{
+    uint64_t events_before = TERM_INPUT_STATS.events;
+    size_t   i;
+
+    for (i = 0; i < size; ++i)
+    {
+        parse_byte((unsigned char) bytes[i]);
+    }
+    return (size_t) (TERM_INPUT_STATS.events - events_before);
+}
+
+/* At the end of the input: a lone escape is the escape key, and a paste is flushed so far */
+static size_t parse_end_of_input()
+{
+    uint64_t events_before = TERM_INPUT_STATS.events;
+
+    if (PARSER.state == STATE_ESCAPE)
+    {
+        push_key(0x1B, 0);
+        PARSER.state = STATE_GROUND;
+    }
+    else if (PARSER.state == STATE_PASTE)
+    {
+        flush_paste_chunk();
+    }
+    return (size_t) (TERM_INPUT_STATS.events - events_before);
+}
+
+size_t cixl_term_input_feed(const char *bytes, const size_t size)
+{
+    size_t events = parse(bytes, size);
+    ESCAPE_HELD = false;
+    return events + parse_end_of_input();
+}
+
+int cixl_term_input_hold_ms()
+{
+    uint64_t held_ms;
+
+    if (!ESCAPE_HELD)
+    {
+        return -1;
+    }
+    held_ms = (cixl_monotonic_ns() - ESCAPE_HELD_NS) / 1000000u;
+    return held_ms >= CIXL_TERM_INPUT_ESCAPE_TIMEOUT_MS ? 0 : (int) (CIXL_TERM_INPUT_ESCAPE_TIMEOUT_MS - held_ms);
+}
+
+/* Consumer side */
+
+bool cixl_term_input_next(CIXL_InputEvent *event)
+{
+    uint32_t tail = EVENT_RING_TAIL;
+
+    if (PASTE_UNREAD > 0)
+    {
+        CIXL_ATOMIC_STORE_RELEASE(&PASTE_RING_TAIL, PASTE_RING_TAIL + PASTE_UNREAD);
+        PASTE_UNREAD = 0;
+    }
+
+    if (tail == CIXL_ATOMIC_LOAD_ACQUIRE(&EVENT_RING_HEAD))
+    {
+        return false;
+    }
+
+    *event = EVENT_RING[tail & (CIXL_TERM_INPUT_RING_SIZE - 1)];
+    CIXL_ATOMIC_STORE_RELEASE(&EVENT_RING_TAIL, tail + 1);
+
+    if (event->type == CIXL_INPUT_PASTE)
+    {
+        PASTE_UNREAD = event->code;
+    }
+    return true;
+}
+
+size_t cixl_term_input_dispatch()
+{
+    static char text[CIXL_TERM_INPUT_PASTE_CHUNK_SIZE];
+    size_t      dispatched = 0;
+
+    if (PASTE_UNREAD > 0)
+    {
+        CIXL_ATOMIC_STORE_RELEASE(&PASTE_RING_TAIL, PASTE_RING_TAIL + PASTE_UNREAD);
+        PASTE_UNREAD = 0;
+    }
+
+    for (;;)
+    {
+        uint32_t        tail = EVENT_RING_TAIL;
+        CIXL_InputEvent event;
+        bool            queued;
+
+        if (tail == CIXL_ATOMIC_LOAD_ACQUIRE(&EVENT_RING_HEAD))
+        {
+            return dispatched;
+        }
+        event = EVENT_RING[tail & (CIXL_TERM_INPUT_RING_SIZE - 1)];
+
+        if (event.type == CIXL_INPUT_PASTE)
+        {
+            uint32_t paste_tail = PASTE_RING_TAIL;
+            uint32_t i;
+
+            for (i = 0; i < event.code; ++i)
+            {
+                text[i] = PASTE_RING[(paste_tail + i) & (CIXL_TERM_INPUT_PASTE_RING_SIZE - 1)];
+            }
+            queued = cixl_input_push_paste(text, event.code);
+        }
+        else
+        {
+            queued = cixl_input_push(&event);
+        }
+
+        //while a replay runs the live input is dropped, otherwise a full queue keeps the rest in the ring
+        if (!queued && !INPUT_LOG_REPLAYING)
+        {
+            return dispatched;
+        }
+        if (event.type == CIXL_INPUT_PASTE)
+        {
+            CIXL_ATOMIC_STORE_RELEASE(&PASTE_RING_TAIL, PASTE_RING_TAIL + event.code);
+        }
+        CIXL_ATOMIC_STORE_RELEASE(&EVENT_RING_TAIL, tail + 1);
+        if (queued)
+        {
+            ++dispatched;
+        }
+    }
+}
+
+size_t cixl_term_input_paste(char *dst, const size_t size)
+{
+    uint32_t tail  = PASTE_RING_TAIL;
+    uint32_t count = size < PASTE_UNREAD ? (uint32_t) size : PASTE_UNREAD;
+    uint32_t i;
+
+    for (i = 0; i < count; ++i)
+    {
+        dst[i] = PASTE_RING[(tail + i) & (CIXL_TERM_INPUT_PASTE_RING_SIZE - 1)];
+    }
+    PASTE_UNREAD -= count;
+    CIXL_ATOMIC_STORE_RELEASE(&PASTE_RING_TAIL, tail + count);
+    return count;
+}
+
+CIXL_TermInputStats cixl_term_input_stats()
+{
+    return TERM_INPUT_STATS;
+}
+
+void cixl_term_input_reset()
+{
+    CIXL_TermInputStats empty = {0, 0, 0, 0};
+
+    memset(&PARSER, 0, sizeof(PARSER));
+    PARSER.state     = STATE_GROUND;
+    TERM_INPUT_STATS = empty;
+    EVENT_RING_HEAD  = 0;
+    EVENT_RING_TAIL  = 0;
+    PASTE_RING_HEAD  = 0;
+    PASTE_RING_TAIL  = 0;
+    PASTE_UNREAD     = 0;
+    ESCAPE_HELD      = false;
+    ESCAPE_HELD_NS   = 0;
+}
+
+/* Terminal */
+
+#if defined(TERM_INPUT_WITH_TERMIOS)
+
+static int            TERM_INPUT_FD       = -1;
+static int            TERM_OUTPUT_FD      = -1;
+static int            TERM_INPUT_FD_FLAGS = 0;
+static unsigned int   TERM_INPUT_FLAGS    = 0;
+static bool           TERM_INPUT_IS_TTY   = false;
+static struct termios TERM_INPUT_ORIGINAL;
+
+static void write_all(const int fd, const char *text)
+{
+    size_t  size = strlen(text);
+    ssize_t written;
+
+    while (size > 0)
+    {
+        written = write(fd, text, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        text += written;
+        size -= (size_t) written;
+    }
+}
+
+bool cixl_term_input_start(const int in_fd, const int out_fd, const unsigned int flags)
+{
+    struct termios raw;
+
+    if (TERM_INPUT_FD >= 0 || in_fd < 0)
+    {
+        return false;
+    }
+
+    TERM_INPUT_FD_FLAGS = fcntl(in_fd, F_GETFL);
+    if (TERM_INPUT_FD_FLAGS < 0 || fcntl(in_fd, F_SETFL, TERM_INPUT_FD_FLAGS | O_NONBLOCK) < 0)
+    {
+        return false;
+    }
+
+    TERM_INPUT_IS_TTY = tcgetattr(in_fd, &TERM_INPUT_ORIGINAL) == 0;
+    if (TERM_INPUT_IS_TTY)
+    {
+        raw = TERM_INPUT_ORIGINAL;
+        raw.c_iflag &= ~(tcflag_t) (BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+        raw.c_lflag &= ~(tcflag_t) (ECHO | ICANON | IEXTEN);
+        if (flags & CIXL_TERM_INPUT_NO_SIGNALS)
+        {
+            raw.c_lflag &= ~(tcflag_t) ISIG;
+        }
+        raw.c_cflag |= CS8;
+        raw.c_cc[VMIN]  = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(in_fd, TCSAFLUSH, &raw);
+    }
+
+    TERM_INPUT_FD    = in_fd;
+    TERM_OUTPUT_FD   = out_fd;
+    TERM_INPUT_FLAGS = flags;
+    if (out_fd >= 0)
+    {
+        //button event tracking (movement only while a button is held) with SGR coordinates
+        if (flags & CIXL_TERM_INPUT_MOUSE)
+        {
+            write_all(out_fd, "\033[?1002h\033[?1006h");
+        }
+        if (flags & CIXL_TERM_INPUT_PASTE)
+        {
+            write_all(out_fd, "\033[?2004h");
+        }
+    }
+    return true;
+}
+
+void cixl_term_input_stop()
+{
+    if (TERM_INPUT_FD < 0)
+    {
+        return;
+    }
+
+    if (TERM_OUTPUT_FD >= 0)
+    {
+        if (TERM_INPUT_FLAGS & CIXL_TERM_INPUT_MOUSE)
+        {
+            write_all(TERM_OUTPUT_FD, "\033[?1006l\033[?1002l");
+        }
+        if (TERM_INPUT_FLAGS & CIXL_TERM_INPUT_PASTE)
+        {
+            write_all(TERM_OUTPUT_FD, "\033[?2004l");
+        }
+    }
+    if (TERM_INPUT_IS_TTY)
+    {
+        tcsetattr(TERM_INPUT_FD, TCSAFLUSH, &TERM_INPUT_ORIGINAL);
+    }
+    fcntl(TERM_INPUT_FD, F_SETFL, TERM_INPUT_FD_FLAGS);
+    TERM_INPUT_FD  = -1;
+    TERM_OUTPUT_FD = -1;
+}
+
+/* At the end of a read: an escape is only the escape key when nothing followed it within the timeout */
+static size_t parse_end_of_read(const bool read_bytes)
+{
+    uint64_t events_before = TERM_INPUT_STATS.events;
+    uint64_t now;
+
+    if (PARSER.state != STATE_ESCAPE)
+    {
+        ESCAPE_HELD = false;
+        if (PARSER.state == STATE_PASTE)
+        {
+            flush_paste_chunk();
+        }
+        return (size_t) (TERM_INPUT_STATS.events - events_before);
+    }
+
+    now = cixl_monotonic_ns();
+    if (read_bytes || !ESCAPE_HELD)
+    {
+        ESCAPE_HELD    = true;
+        ESCAPE_HELD_NS = now;
+    }
+    else if (now - ESCAPE_HELD_NS >= (uint64_t) CIXL_TERM_INPUT_ESCAPE_TIMEOUT_MS * 1000000u)
+    {
+        ESCAPE_HELD = false;
+        return parse_end_of_input();
+    }
+    return 0;
+}
+
+size_t cixl_term_input_read()
+{
+    char    buffer[TERM_INPUT_READ_SIZE];
+    size_t  events     = 0;
+    bool    read_bytes = false;
+    ssize_t count;
+
+    if (TERM_INPUT_FD < 0)
+    {
+        return 0;
+    }
+
+    for (;;)
+    {
+        count = read(TERM_INPUT_FD, buffer, sizeof(buffer));
+        if (count > 0)
+        {
+            ++TERM_INPUT_STATS.reads;
+            TERM_INPUT_STATS.bytes += (uint64_t) count;
+            events += parse(buffer, (size_t) count);
+            read_bytes = true;
+        }
+        else if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            //nothing more to read (EAGAIN) or end of file
+            break;
+        }
+    }
+    return events + parse_end_of_read(read_bytes);
+}
+
+#else
+
+bool cixl_term_input_start(const int in_fd, const int out_fd, const unsigned int flags)
+{
+    (void) in_fd;
+    (void) out_fd;
+    (void) flags;
+    return false;
+}
+
+void cixl_term_input_stop()
+{
+}
+
+size_t cixl_term_input_read()
+{
+    return 0;
+}
+
+#endif
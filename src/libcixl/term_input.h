@@ -0,0 +1,166 @@
+/*! \file
+ * \brief Raw terminal input. Puts the terminal in raw mode (termios), reads everything that is available from a non
+ * blocking file descriptor in bulk and parses it with a table driven state machine into input events (see
+ * #CIXL_InputEvent): keys (including the CSI and SS3 sequences of the cursor, editing and function keys, with
+ * modifiers), SGR mouse reports and bracketed paste. A paste is delivered as a few #CIXL_INPUT_PASTE events with the
+ * text in large chunks, not as one key per character.
+ *
+ * The events are put in a lock free single producer single consumer ring: one thread calls #cixl_term_input_read (or
+ * the update method does it itself) and the update method moves them to the input queue with
+ * #cixl_term_input_dispatch and takes them with #cixl_input_poll, so they are recorded and replayed with the input log
+ * (see input_log.h). To wake an event driven game on input, watch the file descriptor, see #cixl_idle_watch_fd.
+ *
+ * An escape at the end of a read is held until the next read, it can be the start of a sequence that arrived in
+ * parts (over ssh for example). It is the escape key when nothing followed it within
+ * #CIXL_TERM_INPUT_ESCAPE_TIMEOUT_MS, see #cixl_term_input_hold_ms.
+ *
+ * Raw mode needs termios, on other platforms only the parser (#cixl_term_input_feed) is available.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_TERM_INPUT_H
+#define LIBCIXL_TERM_INPUT_H
+
+#include <stddef.h>
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+#include "input_log.h"
+
+/*! \brief The number of events the ring can hold, a power of two. Events that do not fit are dropped.*/
+#ifndef CIXL_TERM_INPUT_RING_SIZE
+#define CIXL_TERM_INPUT_RING_SIZE 1024
+#endif
+
+/*! \brief The number of bytes of pasted text the paste ring can hold, a power of two.*/
+#ifndef CIXL_TERM_INPUT_PASTE_RING_SIZE
+#define CIXL_TERM_INPUT_PASTE_RING_SIZE 65536
+#endif
+
+/*! \brief The maximum size of one #CIXL_INPUT_PASTE event, longer pastes are split.*/
+#define CIXL_TERM_INPUT_PASTE_CHUNK_SIZE CIXL_INPUT_MAX_PASTE_SIZE
+
+/*! \brief How long an escape at the end of a read waits for the rest of a sequence before it is the escape key.*/
+#ifndef CIXL_TERM_INPUT_ESCAPE_TIMEOUT_MS
+#define CIXL_TERM_INPUT_ESCAPE_TIMEOUT_MS 50
+#endif
+
+/*! \brief Start flag: report mouse buttons, wheel and movement while a button is held (SGR mouse mode).*/
+#define CIXL_TERM_INPUT_MOUSE 1u
+
+/*! \brief Start flag: report pasted text as #CIXL_INPUT_PASTE (bracketed paste mode).*/
+#define CIXL_TERM_INPUT_PASTE 2u
+
+/*! \brief Start flag: do not turn Ctrl+C and Ctrl+Z into signals, but report them as keys.*/
+#define CIXL_TERM_INPUT_NO_SIGNALS 4u
+
+/*! \brief Modifier bits of CIXL_InputEvent.modifiers.*/
+#define CIXL_MOD_SHIFT 1u
+#define CIXL_MOD_ALT 2u
+#define CIXL_MOD_CTRL 4u
+
+/*! \brief Key codes of the keys that are not characters, beyond the last unicode code point. Characters are reported
+ * as their unicode code point, enter as '\\r', tab as '\\t', backspace as 127 and escape as 27.*/
+#define CIXL_KEY_UP 0x110001u
+#define CIXL_KEY_DOWN 0x110002u
+#define CIXL_KEY_RIGHT 0x110003u
+#define CIXL_KEY_LEFT 0x110004u
+#define CIXL_KEY_HOME 0x110005u
+#define CIXL_KEY_END 0x110006u
+#define CIXL_KEY_INSERT 0x110007u
+#define CIXL_KEY_DELETE 0x110008u
+#define CIXL_KEY_PAGE_UP 0x110009u
+#define CIXL_KEY_PAGE_DOWN 0x11000Au
+#define CIXL_KEY_BACK_TAB 0x11000Bu
+
+/*! \brief The function keys F1 up to F12 are CIXL_KEY_F1 + 0 up to CIXL_KEY_F1 + 11.*/
+#define CIXL_KEY_F1 0x110010u
+
+/*! \brief Mouse codes (CIXL_InputEvent.code of a #CIXL_INPUT_MOUSE event), x and y are the 0 based cell.*/
+#define CIXL_MOUSE_LEFT 0u
+#define CIXL_MOUSE_MIDDLE 1u
+#define CIXL_MOUSE_RIGHT 2u
+
+/*! \brief Movement without a button (or code 3 in the low bits: no button).*/
+#define CIXL_MOUSE_NONE 3u
+#define CIXL_MOUSE_WHEEL_UP 64u
+#define CIXL_MOUSE_WHEEL_DOWN 65u
+
+/*! \brief Bit of the mouse code: the mouse moved (with the button held).*/
+#define CIXL_MOUSE_MOTION 32u
+
+/*! \brief Bit of the mouse code: the button was released.*/
+#define CIXL_MOUSE_RELEASED 256u
+
+typedef struct CIXL_TermInputStats
+{
+    /*! \brief The number of read calls that returned data.*/
+    uint64_t reads;
+
+    uint64_t bytes;
+    uint64_t events;
+
+    /*! \brief Events (or pasted bytes) that did not fit in the ring.*/
+    uint64_t dropped;
+} CIXL_TermInputStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Puts the terminal in raw mode and makes in_fd non blocking. When in_fd is not a terminal (a pipe) it is only
+ * made non blocking.
+ * \param out_fd where the mouse and paste modes are turned on (and off by #cixl_term_input_stop), -1 for none.
+ * \param flags #CIXL_TERM_INPUT_MOUSE, #CIXL_TERM_INPUT_PASTE and #CIXL_TERM_INPUT_NO_SIGNALS
+ * \return false when raw terminal input is not supported or it is already started.*/
+CIXLLIB_API bool cixl_term_input_start(const int in_fd, const int out_fd, const unsigned int flags);
+
+/*! \brief Restores the terminal and file descriptor as they were before #cixl_term_input_start.*/
+CIXLLIB_API void cixl_term_input_stop();
+
+/*! \brief Reads all input that is available without blocking and parses it into the ring. An escape at the end is
+ * held, read again after #cixl_term_input_hold_ms to get the escape key when nothing followed it.
+ * \return the number of new events.*/
+CIXLLIB_API size_t cixl_term_input_read();
+
+/*! \brief The number of milliseconds until a held escape is the escape key (see #cixl_term_input_read).
+ * \return -1 when no escape is held.*/
+CIXLLIB_API int cixl_term_input_hold_ms();
+
+/*! \brief Parses the given bytes as if they were read from the terminal. Unlike at the end of a read, an escape at
+ * the end is taken as the escape key at once.
+ * \return the number of new events.*/
+CIXLLIB_API size_t cixl_term_input_feed(const char *bytes, const size_t size);
+
+/*! \brief Moves the events from the ring to the input queue (see #cixl_input_push and #cixl_input_push_paste), call it
+ * in the update method before #cixl_input_poll. Events that do not fit in the queue stay in the ring, while an input
+ * log is replayed the events are dropped.
+ * \return the number of events that were queued.*/
+CIXLLIB_API size_t cixl_term_input_dispatch();
+
+/*! \brief Takes the next event from the ring directly, bypassing the input queue and the input log (see
+ * #cixl_term_input_dispatch), call it until it returns false in the update method.
+ * \return false when there are no events.*/
+CIXLLIB_API bool cixl_term_input_next(CIXL_InputEvent *event);
+
+/*! \brief Copies the text of the #CIXL_INPUT_PASTE event that was taken last with #cixl_term_input_next, can be called
+ * multiple times to copy it in parts. Text that is not copied is skipped when the next event is taken.
+ * \return the number of bytes copied, 0 when all text of the event was copied.*/
+CIXLLIB_API size_t cixl_term_input_paste(char *dst, const size_t size);
+
+CIXLLIB_API CIXL_TermInputStats cixl_term_input_stats();
+
+/*! \brief Clears the ring, the parser state and the stats.*/
+CIXLLIB_API void cixl_term_input_reset();
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_TERM_INPUT_H
+
+#pragma clang diagnostic pop
@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include "std/cixl_stdlib.h"
+#include "std/cixl_stdtime.h"
+#include "std/cixl_atomic.h"
+#include "trace.h"
+
+typedef struct TraceEvent
+{
+    const char *name;
+    uint64_t   start_ns;
+    uint64_t   duration_ns;
+} TraceEvent;
+
+/*The events of one thread. Only that thread writes, count is the number of events ever recorded (the ring keeps the
+ * last capacity of them)*/
+typedef struct TraceRing
+{
+    TraceEvent *events;
+    size_t     capacity;
+    size_t     count;
+    int        thread_id;
+    const char *thread_name;
+
+    /*The phases that are begun and not ended yet*/
+    const char *open_names[CIXL_TRACE_MAX_DEPTH];
+    uint64_t   open_starts_ns[CIXL_TRACE_MAX_DEPTH];
+    int        depth;
+} TraceRing;
+
+static TraceRing    *TRACE_RINGS[CIXL_TRACE_MAX_THREADS];
+static unsigned int TRACE_RING_COUNT = 0;
+static size_t       TRACE_CAPACITY   = 0;
+static bool         TRACE_ENABLED    = false;
+static uint64_t     TRACE_START_NS   = 0;
+
+/*Every start gets a new generation, a thread registers a new ring when its ring is from an older generation*/
+static unsigned int TRACE_GENERATION = 0;
+
+static CIXL_THREAD_LOCAL TraceRing    *THREAD_RING           = NULL;
+static CIXL_THREAD_LOCAL unsigned int THREAD_RING_GENERATION = 0;
+
+static TraceRing *trace_thread_ring()
+{
+    unsigned int generation = CIXL_ATOMIC_LOAD(&TRACE_GENERATION);
+    unsigned int slot;
+    TraceRing    *ring;
+
+    if (THREAD_RING_GENERATION == generation)
+    {
+        return THREAD_RING;
+    }
+
+    THREAD_RING            = NULL;
+    THREAD_RING_GENERATION = generation;
+
+    slot = CIXL_ATOMIC_FETCH_ADD(&TRACE_RING_COUNT, 1u);
+    if (slot >= CIXL_TRACE_MAX_THREADS)
+    {
+        return NULL;
+    }
+
+    ring = cixl_mem_alloc(1, sizeof(TraceRing));
+    if (ring == NULL)
+    {
+        return NULL;
+    }
+    ring->events = cixl_mem_alloc(TRACE_CAPACITY, sizeof(TraceEvent));
+    if (ring->events == NULL)
+    {
+        cixl_mem_free(ring);
+        return NULL;
+    }
+    ring->capacity  = TRACE_CAPACITY;
+    ring->thread_id = (int) slot + 1;
+
+    CIXL_ATOMIC_STORE(&TRACE_RINGS[slot], ring);
+    THREAD_RING = ring;
+    return ring;
+}
+
+static void trace_free_rings()
+{
+    unsigned int i;
+
+    for (i = 0; i < CIXL_TRACE_MAX_THREADS; ++i)
+    {
+        if (TRACE_RINGS[i] != NULL)
+        {
+            cixl_mem_free(TRACE_RINGS[i]->events);
+            cixl_mem_free(TRACE_RINGS[i]);
+            TRACE_RINGS[i] = NULL;
+        }
+    }
+    TRACE_RING_COUNT = 0;
+}
+
+bool cixl_trace_start(const size_t events_per_thread)
+{
+    if (events_per_thread == 0)
+    {
+        return false;
+    }
+
+    cixl_trace_free();
+    TRACE_CAPACITY = events_per_thread;
+    TRACE_START_NS = cixl_monotonic_ns();
+    CIXL_ATOMIC_STORE(&TRACE_GENERATION, TRACE_GENERATION + 1u);
+    CIXL_ATOMIC_STORE(&TRACE_ENABLED, true);
+    return true;
+}
+
+void cixl_trace_stop()
+{
+    CIXL_ATOMIC_STORE(&TRACE_ENABLED, false);
+}
+
+bool cixl_trace_is_enabled()
+{
+    return CIXL_ATOMIC_LOAD(&TRACE_ENABLED);
+}
+
+void cixl_trace_begin(const char *name)
+{
+    TraceRing *ring;
+
+    if (!CIXL_ATOMIC_LOAD(&TRACE_ENABLED))
+    {
+        return;
+    }
+
+    ring = trace_thread_ring();
+    if (ring == NULL)
+    {
+        return;
+    }
+    if (ring->depth < CIXL_TRACE_MAX_DEPTH)
+    {
+        ring->open_names[ring->depth]     = name;
+        ring->open_starts_ns[ring->depth] = cixl_monotonic_ns();
+    }
+    ++ring->depth;
+}
+
+void cixl_trace_end()
+{
+    TraceRing *ring;
+
+    if (!CIXL_ATOMIC_LOAD(&TRACE_ENABLED))
+    {
+        return;
+    }
+
+    ring = trace_thread_ring();
+    if (ring == NULL || ring->depth == 0)
+    {
+        return;
+    }
+
+    --ring->depth;
+    if (ring->depth < CIXL_TRACE_MAX_DEPTH)
+    {
+        TraceEvent *event = &ring->events[ring->count % ring->capacity];
+
+        event->name        = ring->open_names[ring->depth];
+        event->start_ns    = ring->open_starts_ns[ring->depth];
+        event->duration_ns = cixl_monotonic_ns() - event->start_ns;
+        CIXL_ATOMIC_STORE(&ring->count, ring->count + 1u);
+    }
+}
+
+void cixl_trace_thread_name(const char *name)
+{
+    TraceRing *ring;
+
+    if (!CIXL_ATOMIC_LOAD(&TRACE_ENABLED))
+    {
+        return;
+    }
+
+    ring = trace_thread_ring();
+    if (ring != NULL)
+    {
+        ring->thread_name = name;
+    }
+}
+
+/*A timestamp or duration in microseconds with nanosecond decimals, as the trace event format expects.
+ * C90 has no printf format for 64 bit values and long is 32 bits on Windows, so the digits are written by hand*/
+static void trace_print_us(FILE *file, const uint64_t ns)
+{
+    char     digits[24];
+    size_t   count = sizeof(digits);
+    uint64_t us    = ns / 1000u;
+
+    digits[--count] = '\0';
+    do
+    {
+        digits[--count] = (char) ('0' + (int) (us % 10u));
+        us /= 10u;
+    } while (us != 0);
+
+    fprintf(file, "%s.%03u", &digits[count], (unsigned int) (ns % 1000u));
+}
+
+static void trace_print_string(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for (; *str != '\0'; ++str)
+    {
+        if (*str == '"' || *str == '\\')
+        {
+            fputc('\\', file);
+        }
+        if ((unsigned char) *str >= 0x20)
+        {
+            fputc(*str, file);
+        }
+    }
+    fputc('"', file);
+}
+
+bool cixl_trace_dump(const char *file_path)
+{
+    FILE         *file;
+    unsigned int ring_count = CIXL_ATOMIC_LOAD(&TRACE_RING_COUNT);
+    unsigned int r;
+    bool         first      = true;
+
+    if (ring_count == 0)
+    {
+        return false;
+    }
+    if (ring_count > CIXL_TRACE_MAX_THREADS)
+    {
+        ring_count = CIXL_TRACE_MAX_THREADS;
+    }
+
+    file = fopen(file_path, "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    for (r = 0; r < ring_count; ++r)
+    {
+        TraceRing *ring = CIXL_ATOMIC_LOAD(&TRACE_RINGS[r]);
+        size_t    count;
+        size_t    i;
+
+        if (ring == NULL)
+        {
+            continue;
+        }
+
+        if (ring->thread_name != NULL)
+        {
+            fprintf(file, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %i, \"args\": {\"name\": ",
+                    first ? "" : ",", ring->thread_id);
+            trace_print_string(file, ring->thread_name);
+            fprintf(file, "}}");
+            first = false;
+        }
+
+        //the last capacity events, oldest first
+        count = CIXL_ATOMIC_LOAD(&ring->count);
+        for (i = count > ring->capacity ? count - ring->capacity : 0; i < count; ++i)
+        {
+            const TraceEvent *event = &ring->events[i % ring->capacity];
+
+            fprintf(file, "%s\n{\"name\": ", first ? "" : ",");
+            trace_print_string(file, event->name);
+            fprintf(file, ", \"cat\": \"cixl\", \"ph\": \"X\", \"pid\": 1, \"tid\": %i, \"ts\": ", ring->thread_id);
+            trace_print_us(file, event->start_ns >= TRACE_START_NS ? event->start_ns - TRACE_START_NS : 0);
+            fprintf(file, ", \"dur\": ");
+            trace_print_us(file, event->duration_ns);
+            fprintf(file, "}");
+            first = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    return fclose(file) == 0;
+}
+
+void cixl_trace_free()
+{
+    CIXL_ATOMIC_STORE(&TRACE_ENABLED, false);
+    trace_free_rings();
+}
@@ -0,0 +1,72 @@
+/*! \file
+ * \brief Timeline tracing. Marks the begin and end of phases (update, draw, render, terminal output, ...) on every
+ * thread, and writes them as a Chrome trace (the trace event format of chrome://tracing and https://ui.perfetto.dev),
+ * to see where the phases of the threads overlap and stall.
+ *
+ * Each thread records in its own ring buffer, without locks, which keeps the last events when it is full. The game loop
+ * (update and draw), #cixl_render, the vt device output and the asciicast writer are traced. Own phases are traced with
+ * #cixl_trace_begin and #cixl_trace_end. When tracing is stopped these only check a flag.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_TRACE_H
+#define LIBCIXL_TRACE_H
+
+#include <stddef.h>
+#include "std/cixl_stdbool.h"
+#include "config.h"
+
+/*! \brief The maximum number of threads that are traced, the events of other threads are dropped.*/
+#ifndef CIXL_TRACE_MAX_THREADS
+#define CIXL_TRACE_MAX_THREADS 32
+#endif
+
+/*! \brief The maximum nesting of phases on a thread, deeper phases are not recorded.*/
+#ifndef CIXL_TRACE_MAX_DEPTH
+#define CIXL_TRACE_MAX_DEPTH 16
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Starts tracing, clears the events of a previous trace. Start and stop the trace while the traced threads are
+ * not in a traced phase, for example between frames.
+ * \param events_per_thread the size of the ring buffer of each thread
+ * \return false when events_per_thread is 0*/
+CIXLLIB_API bool cixl_trace_start(const size_t events_per_thread);
+
+/*! \brief Stops tracing, the events are kept for #cixl_trace_dump until the next start or #cixl_trace_free.*/
+CIXLLIB_API void cixl_trace_stop();
+
+CIXLLIB_API bool cixl_trace_is_enabled();
+
+/*! \brief Marks the begin of a phase on the calling thread, phases can be nested.
+ * \param name the name on the timeline. This is not copied, it must stay valid until the trace is dumped (a literal).*/
+CIXLLIB_API void cixl_trace_begin(const char *name);
+
+/*! \brief Marks the end of the last begun phase on the calling thread.*/
+CIXLLIB_API void cixl_trace_end();
+
+/*! \brief Names the calling thread on the timeline, by default threads are numbered in the order they are first traced.
+ * \param name is not copied, like the name of #cixl_trace_begin*/
+CIXLLIB_API void cixl_trace_thread_name(const char *name);
+
+/*! \brief Writes the events as a Chrome trace (JSON). Stop tracing first, or dump while the traced threads are idle.
+ * \return false when nothing was traced or the file could not be written.*/
+CIXLLIB_API bool cixl_trace_dump(const char *file_path);
+
+/*! \brief Stops tracing and frees the ring buffers. Only call this when no thread is in a traced phase.*/
+CIXLLIB_API void cixl_trace_free();
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_TRACE_H
+
+#pragma clang diagnostic pop
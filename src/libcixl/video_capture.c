@@ -0,0 +1,548 @@
+#include <stdio.h>
+#include <string.h>
+#ifdef CIXL_WITH_PTHREADS
+#include <pthread.h>
+#endif
+#include "std/cixl_stdlib.h"
+#include "std/cixl_stdtime.h"
+#include "video_capture.h"
+#include "raster_device.h"
+#include "screen_buffer.h"
+#include "trace.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Full range BT.601 in 8 bit fixed point. The chroma sums get 32768 added before the shift, which keeps them positive
+ * so they can be computed in unsigned 16 bit lanes: the result always lies between 128 and 65408. */
+#define VIDEO_Y_R 77
+#define VIDEO_Y_G 150
+#define VIDEO_Y_B 29
+#define VIDEO_U_R (-43)
+#define VIDEO_U_G (-85)
+#define VIDEO_U_B 128
+#define VIDEO_V_R 128
+#define VIDEO_V_G (-107)
+#define VIDEO_V_B (-21)
+#define VIDEO_CHROMA_BIAS 32768
+
+/*! A rectangle of changed pixels, its rows are at offset in the queue bytes */
+typedef struct VideoPatch
+{
+    int    x;
+    int    y;
+    int    width;
+    int    height;
+    size_t offset;
+} VideoPatch;
+
+static FILE         *VIDEO_FILE            = NULL;
+static bool         VIDEO_IS_CAPTURING     = false;
+static unsigned int VIDEO_FORMAT           = CIXL_VIDEO_Y4M;
+static int          VIDEO_WIDTH            = 0;
+static int          VIDEO_HEIGHT           = 0;
+static bool         VIDEO_NEEDS_FULL_FRAME = true;
+
+/* The queue: patches in a ring of bytes, the oldest patch starts at VIDEO_READ_POS */
+static uint8_t    *VIDEO_QUEUE_BYTES   = NULL;
+static size_t     VIDEO_QUEUE_CAPACITY = 0;
+static size_t     VIDEO_READ_POS       = 0;
+static size_t     VIDEO_WRITE_POS      = 0;
+static VideoPatch VIDEO_SLOTS[CIXL_VIDEO_QUEUE_SLOTS];
+static int        VIDEO_HEAD           = 0;
+static int        VIDEO_COUNT          = 0;
+
+/* Owned by the writer: the frame with all patches applied and its Y, U and V planes */
+static uint8_t *VIDEO_CANVAS = NULL;
+static uint8_t *VIDEO_PLANES = NULL;
+
+static CIXL_VideoStats VIDEO_STATS;
+
+static void video_rgba_to_y(const uint8_t *rgba, uint8_t *y, const int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i byte_mask = _mm_set1_epi32(0xFF);
+    __m128i       low;
+    __m128i       high;
+    __m128i       red;
+    __m128i       green;
+    __m128i       blue;
+    __m128i       luma;
+
+    for (; i + 8 <= count; i += 8, rgba += 32)
+    {
+        low   = _mm_loadu_si128((const __m128i *) rgba);
+        high  = _mm_loadu_si128((const __m128i *) (rgba + 16));
+        red   = _mm_packs_epi32(_mm_and_si128(low, byte_mask), _mm_and_si128(high, byte_mask));
+        green = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(low, 8), byte_mask),
+                                _mm_and_si128(_mm_srli_epi32(high, 8), byte_mask));
+        blue  = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(low, 16), byte_mask),
+                                _mm_and_si128(_mm_srli_epi32(high, 16), byte_mask));
+        luma  = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(red, _mm_set1_epi16(VIDEO_Y_R)),
+                                            _mm_mullo_epi16(green, _mm_set1_epi16(VIDEO_Y_G))),
+                              _mm_add_epi16(_mm_mullo_epi16(blue, _mm_set1_epi16(VIDEO_Y_B)), _mm_set1_epi16(128)));
+        luma  = _mm_srli_epi16(luma, 8);
+        _mm_storel_epi64((__m128i *) (y + i), _mm_packus_epi16(luma, luma));
+    }
+#endif
+    for (; i < count; ++i, rgba += 4)
+    {
+        y[i] = (uint8_t) ((VIDEO_Y_R * rgba[0] + VIDEO_Y_G * rgba[1] + VIDEO_Y_B * rgba[2] + 128) >> 8);
+    }
+}
+
+#if defined(__SSE2__)
+/*! the averages of one channel of the 2x2 blocks of 16 pixels wide, as 8 16 bit lanes */
+static __m128i video_block_averages(const uint8_t *row0, const uint8_t *row1, const int shift)
+{
+    const __m128i byte_mask = _mm_set1_epi32(0xFF);
+    __m128i       pairs[4];
+    __m128i       sums;
+    int           i;
+
+    for (i = 0; i < 4; ++i)
+    {
+        sums = _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i *) (row0 + i * 16)), shift),
+                                           byte_mask),
+                             _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128((const __m128i *) (row1 + i * 16)), shift),
+                                           byte_mask));
+        //the sum of each pair of columns ends up in lanes 0 and 2, move those to lanes 0 and 1
+        sums     = _mm_add_epi32(sums, _mm_srli_epi64(sums, 32));
+        pairs[i] = _mm_shuffle_epi32(sums, _MM_SHUFFLE(3, 1, 2, 0));
+    }
+    sums = _mm_packs_epi32(_mm_unpacklo_epi64(pairs[0], pairs[1]), _mm_unpacklo_epi64(pairs[2], pairs[3]));
+    return _mm_srli_epi16(_mm_add_epi16(sums, _mm_set1_epi16(2)), 2);
+}
+
+static __m128i video_chroma(const __m128i red, const __m128i green, const __m128i blue, const short r, const short g,
+                            const short b)
+{
+    __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(red, _mm_set1_epi16(r)),
+                                              _mm_mullo_epi16(green, _mm_set1_epi16(g))),
+                                _mm_add_epi16(_mm_mullo_epi16(blue, _mm_set1_epi16(b)),
+                                              _mm_set1_epi16((short) VIDEO_CHROMA_BIAS)));
+    sum = _mm_srli_epi16(sum, 8);
+    return _mm_packus_epi16(sum, sum);
+}
+#endif
+
+/*! count chroma samples of the 2x2 blocks of two rows */
+static void video_rgba_to_uv(const uint8_t *row0, const uint8_t *row1, uint8_t *u, uint8_t *v, const int count)
+{
+    int i = 0;
+    int red;
+    int green;
+    int blue;
+#if defined(__SSE2__)
+    __m128i reds;
+    __m128i greens;
+    __m128i blues;
+
+    for (; i + 8 <= count; i += 8, row0 += 64, row1 += 64)
+    {
+        reds   = video_block_averages(row0, row1, 0);
+        greens = video_block_averages(row0, row1, 8);
+        blues  = video_block_averages(row0, row1, 16);
+        _mm_storel_epi64((__m128i *) (u + i), video_chroma(reds, greens, blues, VIDEO_U_R, VIDEO_U_G, VIDEO_U_B));
+        _mm_storel_epi64((__m128i *) (v + i), video_chroma(reds, greens, blues, VIDEO_V_R, VIDEO_V_G, VIDEO_V_B));
+    }
+#endif
+    for (; i < count; ++i, row0 += 8, row1 += 8)
+    {
+        red   = (row0[0] + row0[4] + row1[0] + row1[4] + 2) >> 2;
+        green = (row0[1] + row0[5] + row1[1] + row1[5] + 2) >> 2;
+        blue  = (row0[2] + row0[6] + row1[2] + row1[6] + 2) >> 2;
+        u[i]  = (uint8_t) ((VIDEO_U_R * red + VIDEO_U_G * green + VIDEO_U_B * blue + VIDEO_CHROMA_BIAS) >> 8);
+        v[i]  = (uint8_t) ((VIDEO_V_R * red + VIDEO_V_G * green + VIDEO_V_B * blue + VIDEO_CHROMA_BIAS) >> 8);
+    }
+}
+
+/*! converts a rectangle of the canvas into the planes, widened to whole 2x2 chroma blocks */
+static void video_convert(int x, int y, int width, int height)
+{
+    uint8_t *luma   = VIDEO_PLANES;
+    uint8_t *chroma = VIDEO_PLANES + (size_t) VIDEO_WIDTH * (size_t) VIDEO_HEIGHT;
+    size_t  stride  = (size_t) VIDEO_WIDTH * 4;
+    size_t  half    = (size_t) VIDEO_WIDTH / 2;
+    int     row;
+
+    width += x & 1;
+    height += y & 1;
+    x &= ~1;
+    y &= ~1;
+    width  = (width + 1) & ~1;
+    height = (height + 1) & ~1;
+
+    for (row = y; row < y + height; ++row)
+    {
+        video_rgba_to_y(VIDEO_CANVAS + (size_t) row * stride + (size_t) x * 4,
+                        luma + (size_t) row * (size_t) VIDEO_WIDTH + (size_t) x, width);
+    }
+    for (row = y / 2; row < (y + height) / 2; ++row)
+    {
+        video_rgba_to_uv(VIDEO_CANVAS + (size_t) row * 2 * stride + (size_t) x * 4,
+                         VIDEO_CANVAS + ((size_t) row * 2 + 1) * stride + (size_t) x * 4,
+                         chroma + (size_t) row * half + (size_t) x / 2,
+                         chroma + half * (size_t) (VIDEO_HEIGHT / 2) + (size_t) row * half + (size_t) x / 2,
+                         width / 2);
+    }
+}
+
+/*! applies a patch to the canvas and writes the frame */
+static void video_write_frame(const VideoPatch *patch)
+{
+    static const char frame_header[] = "FRAME\n";
+    size_t            row_size       = (size_t) patch->width * 4;
+    int               row;
+
+    cixl_trace_begin("video write");
+    for (row = 0; row < patch->height; ++row)
+    {
+        memcpy(VIDEO_CANVAS + ((size_t) (patch->y + row) * (size_t) VIDEO_WIDTH + (size_t) patch->x) * 4,
+               VIDEO_QUEUE_BYTES + patch->offset + (size_t) row * row_size, row_size);
+    }
+
+    if (VIDEO_FORMAT == CIXL_VIDEO_RAW_RGBA)
+    {
+        fwrite(VIDEO_CANVAS, 4, (size_t) VIDEO_WIDTH * (size_t) VIDEO_HEIGHT, VIDEO_FILE);
+    }
+    else
+    {
+        if (patch->width > 0 && patch->height > 0)
+        {
+            video_convert(patch->x, patch->y, patch->width, patch->height);
+        }
+        fwrite(frame_header, 1, sizeof(frame_header) - 1, VIDEO_FILE);
+        fwrite(VIDEO_PLANES, 1, (size_t) VIDEO_WIDTH * (size_t) VIDEO_HEIGHT * 3 / 2, VIDEO_FILE);
+    }
+    cixl_trace_end();
+}
+
+/*! finds room for size bytes in the queue, returns false when the queue is full */
+static bool video_reserve(const size_t size, size_t *offset)
+{
+    if (VIDEO_COUNT == 0)
+    {
+        VIDEO_READ_POS  = 0;
+        VIDEO_WRITE_POS = 0;
+    }
+    else if (VIDEO_COUNT == CIXL_VIDEO_QUEUE_SLOTS)
+    {
+        return false;
+    }
+
+    if (VIDEO_WRITE_POS > VIDEO_READ_POS || VIDEO_COUNT == 0)
+    {
+        if (VIDEO_WRITE_POS + size <= VIDEO_QUEUE_CAPACITY)
+        {
+            *offset = VIDEO_WRITE_POS;
+            return true;
+        }
+        //wrap around, the end of the ring stays unused until the reader passes it
+        if (size <= VIDEO_READ_POS)
+        {
+            *offset = 0;
+            return true;
+        }
+        return false;
+    }
+
+    if (VIDEO_WRITE_POS + size <= VIDEO_READ_POS)
+    {
+        *offset = VIDEO_WRITE_POS;
+        return true;
+    }
+    return false;
+}
+
+static void video_push(const VideoPatch *patch, const uint8_t *pixels, const int stride_px)
+{
+    VideoPatch *slot     = &VIDEO_SLOTS[(VIDEO_HEAD + VIDEO_COUNT) % CIXL_VIDEO_QUEUE_SLOTS];
+    size_t     row_size  = (size_t) patch->width * 4;
+    int        row;
+
+    *slot = *patch;
+    for (row = 0; row < patch->height; ++row)
+    {
+        memcpy(VIDEO_QUEUE_BYTES + patch->offset + (size_t) row * row_size,
+               pixels + ((size_t) (patch->y + row) * (size_t) stride_px + (size_t) patch->x) * 4, row_size);
+    }
+    VIDEO_WRITE_POS = patch->offset + row_size * (size_t) patch->height;
+    ++VIDEO_COUNT;
+}
+
+static void video_pop()
+{
+    VIDEO_HEAD     = (VIDEO_HEAD + 1) % CIXL_VIDEO_QUEUE_SLOTS;
+    --VIDEO_COUNT;
+    VIDEO_READ_POS = VIDEO_COUNT > 0 ? VIDEO_SLOTS[VIDEO_HEAD].offset : 0;
+    ++VIDEO_STATS.frames_written;
+}
+
+static void video_add_capture(const uint64_t elapsed_ns)
+{
+    ++VIDEO_STATS.frames_captured;
+    VIDEO_STATS.capture_ns_total += elapsed_ns;
+    VIDEO_STATS.capture_ns_max = elapsed_ns > VIDEO_STATS.capture_ns_max ? elapsed_ns : VIDEO_STATS.capture_ns_max;
+}
+
+#ifdef CIXL_WITH_PTHREADS
+static pthread_t       VIDEO_WRITER;
+static pthread_mutex_t VIDEO_LOCK               = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  VIDEO_WORK_AVAILABLE     = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  VIDEO_SPACE_AVAILABLE    = PTHREAD_COND_INITIALIZER;
+static bool            VIDEO_WRITER_SHOULD_STOP = false;
+
+static void *video_writer(void *unused)
+{
+    VideoPatch patch;
+
+    (void) unused;
+    cixl_trace_thread_name("video writer");
+    pthread_mutex_lock(&VIDEO_LOCK);
+    while (true)
+    {
+        while (VIDEO_COUNT == 0 && !VIDEO_WRITER_SHOULD_STOP)
+        {
+            pthread_cond_wait(&VIDEO_WORK_AVAILABLE, &VIDEO_LOCK);
+        }
+        if (VIDEO_COUNT == 0)
+        {
+            break;
+        }
+
+        //the bytes of the oldest patch are not reused until it is popped
+        patch = VIDEO_SLOTS[VIDEO_HEAD];
+        pthread_mutex_unlock(&VIDEO_LOCK);
+        video_write_frame(&patch);
+        pthread_mutex_lock(&VIDEO_LOCK);
+
+        video_pop();
+        pthread_cond_signal(&VIDEO_SPACE_AVAILABLE);
+    }
+    pthread_mutex_unlock(&VIDEO_LOCK);
+    return NULL;
+}
+
+static void video_enqueue(VideoPatch *patch, const uint8_t *pixels, const int stride_px)
+{
+    bool is_stalled = false;
+
+    pthread_mutex_lock(&VIDEO_LOCK);
+    while (!video_reserve((size_t) patch->width * (size_t) patch->height * 4, &patch->offset))
+    {
+        //Only blocks when the writer is a whole queue behind
+        is_stalled = true;
+        pthread_cond_wait(&VIDEO_SPACE_AVAILABLE, &VIDEO_LOCK);
+    }
+    video_push(patch, pixels, stride_px);
+    VIDEO_STATS.stalls += is_stalled ? 1 : 0;
+    pthread_cond_signal(&VIDEO_WORK_AVAILABLE);
+    pthread_mutex_unlock(&VIDEO_LOCK);
+}
+
+static bool video_start_writer()
+{
+    VIDEO_WRITER_SHOULD_STOP = false;
+    return pthread_create(&VIDEO_WRITER, NULL, video_writer, NULL) == 0;
+}
+
+static void video_stop_writer()
+{
+    pthread_mutex_lock(&VIDEO_LOCK);
+    VIDEO_WRITER_SHOULD_STOP = true;
+    pthread_cond_signal(&VIDEO_WORK_AVAILABLE);
+    pthread_mutex_unlock(&VIDEO_LOCK);
+    pthread_join(VIDEO_WRITER, NULL);
+}
+
+static CIXL_VideoStats video_read_stats()
+{
+    CIXL_VideoStats stats;
+
+    pthread_mutex_lock(&VIDEO_LOCK);
+    stats = VIDEO_STATS;
+    pthread_mutex_unlock(&VIDEO_LOCK);
+    return stats;
+}
+
+static void video_count_capture(const uint64_t elapsed_ns)
+{
+    pthread_mutex_lock(&VIDEO_LOCK);
+    video_add_capture(elapsed_ns);
+    pthread_mutex_unlock(&VIDEO_LOCK);
+}
+#else
+static void video_enqueue(VideoPatch *patch, const uint8_t *pixels, const int stride_px)
+{
+    video_reserve((size_t) patch->width * (size_t) patch->height * 4, &patch->offset);
+    video_push(patch, pixels, stride_px);
+    video_write_frame(&VIDEO_SLOTS[VIDEO_HEAD]);
+    video_pop();
+}
+
+static bool video_start_writer()
+{
+    return true;
+}
+
+static void video_stop_writer()
+{
+}
+
+static CIXL_VideoStats video_read_stats()
+{
+    return VIDEO_STATS;
+}
+
+static void video_count_capture(const uint64_t elapsed_ns)
+{
+    video_add_capture(elapsed_ns);
+}
+#endif
+
+static void video_free_buffers()
+{
+    cixl_mem_free(VIDEO_QUEUE_BYTES);
+    cixl_mem_free(VIDEO_CANVAS);
+    cixl_mem_free(VIDEO_PLANES);
+    VIDEO_QUEUE_BYTES = NULL;
+    VIDEO_CANVAS      = NULL;
+    VIDEO_PLANES      = NULL;
+}
+
+bool cixl_video_start(const char *file_path, const unsigned int fps, const unsigned int format)
+{
+    int    columns;
+    int    rows;
+    size_t frame_size;
+
+    cixl_screen_size(&columns, &rows);
+    if (VIDEO_IS_CAPTURING || columns <= 0 || rows <= 0 || fps == 0)
+    {
+        return false;
+    }
+
+    VIDEO_WIDTH          = columns * CIXL_RASTER_GLYPH_WIDTH;
+    VIDEO_HEIGHT         = rows * CIXL_RASTER_GLYPH_HEIGHT;
+    VIDEO_FORMAT         = format;
+    frame_size           = (size_t) VIDEO_WIDTH * (size_t) VIDEO_HEIGHT * 4;
+    VIDEO_QUEUE_CAPACITY = frame_size * CIXL_VIDEO_QUEUE_FRAMES;
+    VIDEO_QUEUE_BYTES    = cixl_mem_alloc(VIDEO_QUEUE_CAPACITY, sizeof(uint8_t));
+    VIDEO_CANVAS         = cixl_mem_alloc(frame_size, sizeof(uint8_t));
+    VIDEO_PLANES         = cixl_mem_alloc((size_t) VIDEO_WIDTH * (size_t) VIDEO_HEIGHT * 3 / 2, sizeof(uint8_t));
+    if (VIDEO_QUEUE_BYTES == NULL || VIDEO_CANVAS == NULL || VIDEO_PLANES == NULL)
+    {
+        video_free_buffers();
+        return false;
+    }
+
+    VIDEO_FILE = fopen(file_path, "wb");
+    if (VIDEO_FILE == NULL)
+    {
+        video_free_buffers();
+        return false;
+    }
+
+    //the canvas starts black like a new framebuffer, with opaque alpha
+    for (frame_size = 0; frame_size < (size_t) VIDEO_WIDTH * (size_t) VIDEO_HEIGHT; ++frame_size)
+    {
+        VIDEO_CANVAS[frame_size * 4 + 3] = 0xFF;
+    }
+    video_convert(0, 0, VIDEO_WIDTH, VIDEO_HEIGHT);
+    if (format == CIXL_VIDEO_Y4M)
+    {
+        fprintf(VIDEO_FILE, "YUV4MPEG2 W%i H%i F%u:1 Ip A1:1 C420jpeg\n", VIDEO_WIDTH, VIDEO_HEIGHT, fps);
+    }
+
+    memset(&VIDEO_STATS, 0, sizeof(VIDEO_STATS));
+    VIDEO_HEAD             = 0;
+    VIDEO_COUNT            = 0;
+    VIDEO_READ_POS         = 0;
+    VIDEO_WRITE_POS        = 0;
+    VIDEO_NEEDS_FULL_FRAME = true;
+    if (!video_start_writer())
+    {
+        fclose(VIDEO_FILE);
+        video_free_buffers();
+        return false;
+    }
+
+    VIDEO_IS_CAPTURING = true;
+    return true;
+}
+
+bool cixl_video_capture_frame()
+{
+    uint64_t      start_ns = cixl_monotonic_ns();
+    uint64_t      elapsed_ns;
+    VideoPatch    patch;
+    const uint8_t *pixels;
+    int           width_px;
+    int           height_px;
+
+    if (!VIDEO_IS_CAPTURING)
+    {
+        return false;
+    }
+
+    memset(&patch, 0, sizeof(patch));
+    pixels = cixl_raster_pixels(&width_px, &height_px);
+    if (pixels != NULL && VIDEO_NEEDS_FULL_FRAME)
+    {
+        //the framebuffer was drawn before the capture started, so take all of it once
+        cixl_raster_dirty_rect(&patch.x, &patch.y, &patch.width, &patch.height);
+        patch.x                = 0;
+        patch.y                = 0;
+        patch.width            = width_px;
+        patch.height           = height_px;
+        VIDEO_NEEDS_FULL_FRAME = false;
+    }
+    else if (pixels == NULL || !cixl_raster_dirty_rect(&patch.x, &patch.y, &patch.width, &patch.height))
+    {
+        patch.width  = 0;
+        patch.height = 0;
+    }
+
+    //the video keeps the size it started with
+    patch.width  = patch.x + patch.width > VIDEO_WIDTH ? VIDEO_WIDTH - patch.x : patch.width;
+    patch.height = patch.y + patch.height > VIDEO_HEIGHT ? VIDEO_HEIGHT - patch.y : patch.height;
+    if (patch.width <= 0 || patch.height <= 0)
+    {
+        patch.x      = 0;
+        patch.y      = 0;
+        patch.width  = 0;
+        patch.height = 0;
+    }
+
+    video_enqueue(&patch, pixels, width_px);
+
+    //under the lock, like the stats of the writer thread
+    elapsed_ns = cixl_monotonic_ns() - start_ns;
+    video_count_capture(elapsed_ns);
+    return true;
+}
+
+bool cixl_video_stop()
+{
+    bool is_closed;
+
+    if (!VIDEO_IS_CAPTURING)
+    {
+        return false;
+    }
+
+    video_stop_writer();
+    is_closed = fclose(VIDEO_FILE) == 0;
+    video_free_buffers();
+    VIDEO_FILE         = NULL;
+    VIDEO_IS_CAPTURING = false;
+    return is_closed;
+}
+
+CIXL_VideoStats cixl_video_stats()
+{
+    return video_read_stats();
+}
@@ -0,0 +1,85 @@
+/*! \file
+ * \brief Video capture of a session through the raster device (see raster_device.h). Call #cixl_video_capture_frame
+ * after each #cixl_render: it copies the part of the framebuffer that changed (#cixl_raster_dirty_rect) into a queue,
+ * and a background thread applies the changes to its own copy of the frame and writes it to the video file, as a
+ * YUV4MPEG2 (Y4M) stream that ffmpeg and most players read, or as raw RGBA frames.
+ *
+ * The game thread only copies the changed pixels, the color conversion (SSE2 when available) and the writing happen on
+ * the writer thread (when built with CIXL_WITH_PTHREADS, otherwise on the calling thread). The game thread only waits
+ * when the queue is full, which is counted as a stall in #cixl_video_stats.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_VIDEO_CAPTURE_H
+#define LIBCIXL_VIDEO_CAPTURE_H
+
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+
+/*! \brief YUV4MPEG2 with 4:2:0 chroma (C420jpeg, full range BT.601).*/
+#define CIXL_VIDEO_Y4M 0u
+
+/*! \brief Raw frames of width * height RGBA pixels without a header, for example for ffmpeg -f rawvideo.*/
+#define CIXL_VIDEO_RAW_RGBA 1u
+
+/*! \brief The size of the queue in frames of changed pixels. Frames that change little take a small part of it.*/
+#ifndef CIXL_VIDEO_QUEUE_FRAMES
+#define CIXL_VIDEO_QUEUE_FRAMES 4
+#endif
+
+/*! \brief The maximum number of captured frames in the queue.*/
+#ifndef CIXL_VIDEO_QUEUE_SLOTS
+#define CIXL_VIDEO_QUEUE_SLOTS 64
+#endif
+
+typedef struct CIXL_VideoStats
+{
+    /*! \brief Frames captured with #cixl_video_capture_frame.*/
+    uint32_t frames_captured;
+
+    /*! \brief Frames written to the file.*/
+    uint32_t frames_written;
+
+    /*! \brief Captures that waited for the writer because the queue was full.*/
+    uint32_t stalls;
+
+    /*! \brief The time #cixl_video_capture_frame took on the game thread, in total and the longest.*/
+    uint64_t capture_ns_total;
+    uint64_t capture_ns_max;
+} CIXL_VideoStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Creates the video file and starts the writer. The video has the size of the screen buffer in pixels of the
+ * raster device, so the screen buffer has to be initialized, and the given frames per second. Only one capture can be
+ * active.
+ * \param format #CIXL_VIDEO_Y4M or #CIXL_VIDEO_RAW_RGBA
+ * \return false when the file could not be created, there is no screen buffer or a capture is already active.*/
+CIXLLIB_API bool cixl_video_start(const char *file_path, const unsigned int fps, const unsigned int format);
+
+/*! \brief Adds a frame to the video: the framebuffer of the raster device as it is now. Only the pixels that changed
+ * since the previous frame are copied (this takes the #cixl_raster_dirty_rect). A frame in which nothing changed
+ * repeats the previous frame.
+ * \return false when no capture is active.*/
+CIXLLIB_API bool cixl_video_capture_frame();
+
+/*! \brief Writes all frames in the queue, stops the writer and closes the file.*/
+CIXLLIB_API bool cixl_video_stop();
+
+/*! \brief The statistics of the active or the last capture.*/
+CIXLLIB_API CIXL_VideoStats cixl_video_stats();
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_VIDEO_CAPTURE_H
+
+#pragma clang diagnostic pop
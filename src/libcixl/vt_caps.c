@@ -0,0 +1,216 @@
+#include <stdlib.h>
+#include <string.h>
+#include "vt_caps.h"
+
+#define VT_CAPS_MAX_PARAMS 16
+
+/*! DECRPM values: the mode is set or reset (and can be changed), 0 is an unknown mode, 3 and 4 are permanent */
+#define DECRPM_SET 1
+#define DECRPM_RESET 2
+
+#define VT_CAPS_SYNC_MODE 2026
+
+typedef struct VtCapsProfile
+{
+    const char   *term_prefix;
+    unsigned int caps;
+} VtCapsProfile;
+
+/*! Known terminals by the start of TERM, the first match is used so longer names go first */
+static const VtCapsProfile PROFILES[] = {
+        {"xterm-kitty",  CIXL_VT_CAP_SYNC_OUTPUT | CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE |
+                         CIXL_VT_CAP_SCROLL_MARGINS | CIXL_VT_CAP_256_COLORS | CIXL_VT_CAP_TRUECOLOR},
+        {"xterm-ghostty", CIXL_VT_CAP_SYNC_OUTPUT | CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE |
+                          CIXL_VT_CAP_SCROLL_MARGINS | CIXL_VT_CAP_256_COLORS | CIXL_VT_CAP_TRUECOLOR},
+        {"alacritty",    CIXL_VT_CAP_SYNC_OUTPUT | CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE |
+                         CIXL_VT_CAP_SCROLL_MARGINS | CIXL_VT_CAP_256_COLORS | CIXL_VT_CAP_TRUECOLOR},
+        {"wezterm",      CIXL_VT_CAP_SYNC_OUTPUT | CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE |
+                         CIXL_VT_CAP_SCROLL_MARGINS | CIXL_VT_CAP_256_COLORS | CIXL_VT_CAP_TRUECOLOR},
+        {"foot",         CIXL_VT_CAP_SYNC_OUTPUT | CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE |
+                         CIXL_VT_CAP_SCROLL_MARGINS | CIXL_VT_CAP_256_COLORS | CIXL_VT_CAP_TRUECOLOR},
+        {"contour",      CIXL_VT_CAP_SYNC_OUTPUT | CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE |
+                         CIXL_VT_CAP_SCROLL_MARGINS | CIXL_VT_CAP_256_COLORS | CIXL_VT_CAP_TRUECOLOR},
+        {"xterm-direct", CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE | CIXL_VT_CAP_SCROLL_MARGINS |
+                         CIXL_VT_CAP_256_COLORS | CIXL_VT_CAP_TRUECOLOR},
+        {"xterm-256",    CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE | CIXL_VT_CAP_SCROLL_MARGINS |
+                         CIXL_VT_CAP_256_COLORS},
+        {"xterm",        CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE | CIXL_VT_CAP_SCROLL_MARGINS},
+        {"tmux-256",     CIXL_VT_CAP_ECH | CIXL_VT_CAP_SCROLL_MARGINS | CIXL_VT_CAP_256_COLORS},
+        {"tmux",         CIXL_VT_CAP_ECH | CIXL_VT_CAP_SCROLL_MARGINS},
+        {"screen-256",   CIXL_VT_CAP_ECH | CIXL_VT_CAP_SCROLL_MARGINS | CIXL_VT_CAP_256_COLORS},
+        {"screen",       CIXL_VT_CAP_ECH | CIXL_VT_CAP_SCROLL_MARGINS},
+        {"linux",        CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE | CIXL_VT_CAP_SCROLL_MARGINS},
+        {"vt220",        CIXL_VT_CAP_ECH | CIXL_VT_CAP_SCROLL_MARGINS},
+        {"vt100",        CIXL_VT_CAP_SCROLL_MARGINS}
+};
+
+unsigned int cixl_vt_caps_profile(const char *term, const char *colorterm)
+{
+    unsigned int caps = CIXL_VT_CAPS_NONE;
+    size_t       i;
+
+    if (term != NULL)
+    {
+        for (i = 0; i < sizeof(PROFILES) / sizeof(PROFILES[0]); ++i)
+        {
+            if (strncmp(term, PROFILES[i].term_prefix, strlen(PROFILES[i].term_prefix)) == 0)
+            {
+                caps = PROFILES[i].caps;
+                break;
+            }
+        }
+    }
+
+    if (colorterm != NULL && (strcmp(colorterm, "truecolor") == 0 || strcmp(colorterm, "24bit") == 0))
+    {
+        caps |= CIXL_VT_CAP_TRUECOLOR | CIXL_VT_CAP_256_COLORS;
+    }
+    return caps;
+}
+
+unsigned int cixl_vt_caps_profile_from_env()
+{
+    return cixl_vt_caps_profile(getenv("TERM"), getenv("COLORTERM"));
+}
+
+void cixl_vt_caps_probe_init(CIXL_VtCapsProbe *probe, const unsigned int profile_caps)
+{
+    probe->caps  = profile_caps;
+    probe->done  = false;
+    probe->level = 0;
+}
+
+static void vt_caps_on_mode_report(CIXL_VtCapsProbe *probe, const int *params, const int count)
+{
+    if (count >= 2 && params[0] == VT_CAPS_SYNC_MODE)
+    {
+        if (params[1] == DECRPM_SET || params[1] == DECRPM_RESET)
+        {
+            probe->caps |= CIXL_VT_CAP_SYNC_OUTPUT;
+        }
+        else
+        {
+            probe->caps &= ~CIXL_VT_CAP_SYNC_OUTPUT;
+        }
+    }
+}
+
+static void vt_caps_on_device_attributes(CIXL_VtCapsProbe *probe, const int *params, const int count)
+{
+    probe->done  = true;
+    probe->level = count > 0 ? params[0] : 0;
+
+    //erase characters came with the VT220, scroll margins with the VT100 and every terminal that answers DA1
+    probe->caps |= CIXL_VT_CAP_SCROLL_MARGINS;
+    if (probe->level >= 62)
+    {
+        probe->caps |= CIXL_VT_CAP_ECH;
+    }
+}
+
+/*! parses CSI ? params [$] final at bytes[start], returns the size of the reply or 0 when it is not a reply */
+static size_t vt_caps_parse_one(CIXL_VtCapsProbe *probe, const char *bytes, const size_t start, const size_t size)
+{
+    int    params[VT_CAPS_MAX_PARAMS];
+    int    count      = 0;
+    bool   has_dollar = false;
+    size_t i          = start + 3;
+
+    if (start + 3 > size || bytes[start] != '\033' || bytes[start + 1] != '[' || bytes[start + 2] != '?')
+    {
+        return 0;
+    }
+
+    params[0] = 0;
+    for (; i < size; ++i)
+    {
+        char c = bytes[i];
+        if (c >= '0' && c <= '9')
+        {
+            if (count == 0)
+            {
+                count = 1;
+            }
+            params[count - 1] = params[count - 1] * 10 + (c - '0');
+        }
+        else if (c == ';')
+        {
+            if (count == 0)
+            {
+                count = 1;
+            }
+            if (count < VT_CAPS_MAX_PARAMS)
+            {
+                params[count++] = 0;
+            }
+        }
+        else if (c == '$')
+        {
+            has_dollar = true;
+        }
+        else if (c == 'y' && has_dollar)
+        {
+            vt_caps_on_mode_report(probe, params, count);
+            return i + 1 - start;
+        }
+        else if (c == 'c' && !has_dollar)
+        {
+            vt_caps_on_device_attributes(probe, params, count);
+            return i + 1 - start;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+size_t cixl_vt_caps_partial_reply(const char *bytes, const size_t size)
+{
+    static const char prefix[3] = {'\033', '[', '?'};
+    size_t            start     = size;
+    size_t            i;
+
+    while (start > 0 && bytes[start - 1] != '\033')
+    {
+        --start;
+    }
+    if (start == 0)
+    {
+        return 0;
+    }
+    --start;
+
+    //ESC [ ? followed by parameters and a $, but no final byte yet
+    for (i = start; i < size; ++i)
+    {
+        char c = bytes[i];
+        if (i - start < sizeof(prefix) ? c != prefix[i - start] : !((c >= '0' && c <= '9') || c == ';' || c == '$'))
+        {
+            return 0;
+        }
+    }
+    return size - start;
+}
+
+size_t cixl_vt_caps_parse_reply(CIXL_VtCapsProbe *probe, char *bytes, const size_t size)
+{
+    size_t i     = 0;
+    size_t other = 0;
+    size_t reply_size;
+
+    while (i < size)
+    {
+        reply_size = bytes[i] == '\033' ? vt_caps_parse_one(probe, bytes, i, size) : 0;
+        if (reply_size > 0)
+        {
+            i += reply_size;
+        }
+        else
+        {
+            bytes[other++] = bytes[i++];
+        }
+    }
+    return other;
+}
@@ -0,0 +1,93 @@
+/*! \file
+ * \brief Capabilities of the terminal that the VT render device can use (see #cixl_vt_set_capabilities). They come from
+ * a profile based on the TERM and COLORTERM environment variables (#cixl_vt_caps_profile) and can be refined by probing
+ * the terminal: write #CIXL_VT_CAPS_QUERY and parse what the terminal answers with #cixl_vt_caps_parse_reply. The query
+ * asks for the synchronized update mode (DECRQM 2026) and ends with a primary device attributes request (DA1), which
+ * every VT compatible terminal answers, so the DA1 reply marks the end of the answers.
+ * The native Linux backend does this at startup, see #cixl_linux_term_probe.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_VT_CAPS_H
+#define LIBCIXL_VT_CAPS_H
+
+#include <stddef.h>
+#include "std/cixl_stdbool.h"
+#include "config.h"
+
+/*! \brief No capabilities beyond cursor moves and the 16 color SGR codes.*/
+#define CIXL_VT_CAPS_NONE 0u
+
+/*! \brief Synchronized update mode (DEC private mode 2026): a frame is presented at once, without tearing.*/
+#define CIXL_VT_CAP_SYNC_OUTPUT 1u
+
+/*! \brief Repeat the preceding character (REP, CSI n b).*/
+#define CIXL_VT_CAP_REP 2u
+
+/*! \brief Erase characters (ECH, CSI n X).*/
+#define CIXL_VT_CAP_ECH 4u
+
+/*! \brief Scroll margins (DECSTBM, CSI top ; bottom r).*/
+#define CIXL_VT_CAP_SCROLL_MARGINS 8u
+
+/*! \brief The 256 color palette (SGR 38;5;n and 48;5;n).*/
+#define CIXL_VT_CAP_256_COLORS 16u
+
+/*! \brief 24 bit colors (SGR 38;2;r;g;b and 48;2;r;g;b).*/
+#define CIXL_VT_CAP_TRUECOLOR 32u
+
+/*! \brief Background color erase: erased cells (ECH, EL, ED) get the current background color, not the default one.*/
+#define CIXL_VT_CAP_BCE 64u
+
+/*! \brief The bytes to write to the terminal to probe it: DECRQM for mode 2026 followed by DA1.*/
+#define CIXL_VT_CAPS_QUERY "\033[?2026$p\033[c"
+
+typedef struct CIXL_VtCapsProbe
+{
+    /*! \brief The capabilities, start with the profile, the replies add and remove capabilities.*/
+    unsigned int caps;
+
+    /*! \brief The DA1 reply was seen, the terminal answered all queries.*/
+    bool done;
+
+    /*! \brief The operating level of the DA1 reply (62 for VT220 and up), 0 when not seen.*/
+    int level;
+} CIXL_VtCapsProbe;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief The capabilities of a known terminal.
+ * \param term the value of TERM, for example "xterm-256color", NULL when not set
+ * \param colorterm the value of COLORTERM, "truecolor" or "24bit" adds #CIXL_VT_CAP_TRUECOLOR, NULL when not set
+ * \return #CIXL_VT_CAPS_NONE for an unknown terminal.*/
+CIXLLIB_API unsigned int cixl_vt_caps_profile(const char *term, const char *colorterm);
+
+/*! \brief The profile of the terminal this process runs in, from the environment variables TERM and COLORTERM.*/
+CIXLLIB_API unsigned int cixl_vt_caps_profile_from_env();
+
+/*! \brief Starts a probe with the capabilities of a profile.*/
+CIXLLIB_API void cixl_vt_caps_probe_init(CIXL_VtCapsProbe *probe, const unsigned int profile_caps);
+
+/*! \brief Parses what the terminal answered on #CIXL_VT_CAPS_QUERY, can be called with the answers in parts as long as
+ * a reply is not split. The bytes that are not part of a reply (input of the user) are moved to the start of bytes.
+ * \return the number of bytes that are not part of a reply.*/
+CIXLLIB_API size_t cixl_vt_caps_parse_reply(CIXL_VtCapsProbe *probe, char *bytes, const size_t size);
+
+/*! \brief The size of the start of a reply at the end of bytes, that has to wait for the rest of the reply (the final
+ * byte) before it can be parsed with #cixl_vt_caps_parse_reply.
+ * \return 0 when bytes does not end with the start of a reply.*/
+CIXLLIB_API size_t cixl_vt_caps_partial_reply(const char *bytes, const size_t size);
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_VT_CAPS_H
+
+#pragma clang diagnostic pop
@@ -0,0 +1,522 @@
+#include <stdio.h>
+#include <string.h>
+#include "std/cixl_stdlib.h"
+#include "vt_device.h"
+#include "trace.h"
+
+#define VT_INITIAL_BUFFER_CAPACITY 4096
+
+/* The color keys of vt_color_key: the flag of a color of the 256 color palette and of a 24 bit color */
+#define VT_COLOR_COUNT 256
+#define VT_COLOR_256 0x100u
+#define VT_COLOR_RGB 0x1000000u
+
+/*! SGR parameter for each bit of #CIXL_StyleOpts, see #CIXL_Style */
+static const int STYLE_SGR_MAP[8] = {1, 2, 3, 4, 7, 9, 20, 21};
+
+/*! Synchronized update brackets (DEC private mode 2026) */
+static const char SYNC_BEGIN[] = "\033[?2026h";
+static const char SYNC_END[]   = "\033[?2026l";
+
+static CIXL_VtWrite VT_WRITE = NULL;
+static CIXL_VtWrite VT_TAP   = NULL;
+static unsigned int VT_CAPS  = CIXL_VT_CAPS_NONE;
+static bool         VT_SYNC  = false;
+
+static char   *VT_BUFFER         = NULL;
+static size_t VT_BUFFER_SIZE     = 0;
+static size_t VT_BUFFER_CAPACITY = 0;
+
+/*The state of the terminal after the written bytes, -1 is unknown*/
+static int VT_CURSOR_X = -1;
+static int VT_CURSOR_Y = -1;
+static int VT_FG       = -1;
+static int VT_BG       = -1;
+static int VT_STYLE    = -1;
+
+/*How each color of the color table is written, for the capabilities and the version of the table they were made for*/
+static uint32_t     VT_COLOR_KEYS[VT_COLOR_COUNT];
+static bool         VT_COLOR_KEYS_ARE_SET = false;
+static unsigned int VT_COLOR_KEYS_CAPS    = CIXL_VT_CAPS_NONE;
+static uint32_t     VT_COLOR_KEYS_VERSION = 0;
+
+/*Output counters of the frame that is being encoded, and of the last flushed frame*/
+static uint32_t VT_CURSOR_MOVES      = 0;
+static uint32_t VT_SGR_CHANGES       = 0;
+static uint32_t VT_LAST_BYTES        = 0;
+static uint32_t VT_LAST_CURSOR_MOVES = 0;
+static uint32_t VT_LAST_SGR_CHANGES  = 0;
+
+static size_t vt_write_stdout(const char *bytes, const size_t size)
+{
+    size_t written = fwrite(bytes, 1, size, stdout);
+    fflush(stdout);
+    return written;
+}
+
+static bool vt_reserve(const size_t size)
+{
+    if (VT_BUFFER_SIZE + size > VT_BUFFER_CAPACITY)
+    {
+        size_t capacity = VT_BUFFER_CAPACITY == 0 ? VT_INITIAL_BUFFER_CAPACITY : VT_BUFFER_CAPACITY;
+        char   *buffer;
+
+        while (VT_BUFFER_SIZE + size > capacity)
+        {
+            capacity *= 2;
+        }
+
+        buffer = cixl_mem_realloc(VT_BUFFER, capacity);
+        if (buffer == NULL)
+        {
+            return false;
+        }
+        VT_BUFFER          = buffer;
+        VT_BUFFER_CAPACITY = capacity;
+    }
+    return true;
+}
+
+/*! reserves size bytes, and when these are the first bytes of the frame starts the synchronized update */
+static bool vt_reserve_in_frame(const size_t size)
+{
+    if (!vt_reserve(sizeof(SYNC_BEGIN) - 1 + size + sizeof(SYNC_END) - 1))
+    {
+        return false;
+    }
+
+    if (VT_BUFFER_SIZE == 0 && (VT_CAPS & CIXL_VT_CAP_SYNC_OUTPUT))
+    {
+        memcpy(VT_BUFFER, SYNC_BEGIN, sizeof(SYNC_BEGIN) - 1);
+        VT_BUFFER_SIZE = sizeof(SYNC_BEGIN) - 1;
+        VT_SYNC        = true;
+    }
+    return true;
+}
+
+static inline void vt_append_char(const char c)
+{
+    VT_BUFFER[VT_BUFFER_SIZE++] = c;
+}
+
+/*! appends the decimal representation of a (small) non negative number */
+static inline void vt_append_uint(unsigned int value)
+{
+    char digits[10];
+    int  count = 0;
+
+    do
+    {
+        digits[count++] = (char) ('0' + (value % 10));
+        value /= 10;
+    } while (value > 0);
+
+    while (count > 0)
+    {
+        vt_append_char(digits[--count]);
+    }
+}
+
+/*! how a color of the color table is written for the capabilities: a basic color (below 16), a color of the 256
+ * color palette (#VT_COLOR_256 | index) or a 24 bit color (#VT_COLOR_RGB | rgb) */
+static uint32_t vt_color_key(const CIXL_Color color)
+{
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+
+    if (!cixl_color_is_custom(color))
+    {
+        if (color < 16 || (VT_CAPS & CIXL_VT_CAP_256_COLORS))
+        {
+            return color < 16 ? color : VT_COLOR_256 | color;
+        }
+        cixl_color_rgb(color, &red, &green, &blue);
+        return cixl_color_nearest(red, green, blue, 16);
+    }
+
+    cixl_color_rgb(color, &red, &green, &blue);
+    if (VT_CAPS & CIXL_VT_CAP_TRUECOLOR)
+    {
+        return VT_COLOR_RGB | ((uint32_t) red << 16) | ((uint32_t) green << 8) | blue;
+    }
+    if (VT_CAPS & CIXL_VT_CAP_256_COLORS)
+    {
+        return VT_COLOR_256 | cixl_color_nearest(red, green, blue, 256);
+    }
+    return cixl_color_nearest(red, green, blue, 16);
+}
+
+/*! renews the color keys when the capabilities or the color table changed, the current colors of the terminal are
+ * forgotten when they would be written differently now */
+static void vt_update_color_keys()
+{
+    int i;
+
+    if (VT_COLOR_KEYS_ARE_SET && VT_COLOR_KEYS_CAPS == VT_CAPS && VT_COLOR_KEYS_VERSION == colors_table_version())
+    {
+        return;
+    }
+
+    for (i = 0; i < VT_COLOR_COUNT; ++i)
+    {
+        const uint32_t key = vt_color_key((CIXL_Color) i);
+
+        if (!VT_COLOR_KEYS_ARE_SET || key != VT_COLOR_KEYS[i])
+        {
+            VT_FG = VT_FG == i ? -1 : VT_FG;
+            VT_BG = VT_BG == i ? -1 : VT_BG;
+        }
+        VT_COLOR_KEYS[i] = key;
+    }
+    VT_COLOR_KEYS_ARE_SET = true;
+    VT_COLOR_KEYS_CAPS    = VT_CAPS;
+    VT_COLOR_KEYS_VERSION = colors_table_version();
+}
+
+/*! appends the SGR parameters of a color: 30 + n, 90 + n, 38;5;n or 38;2;r;g;b for the foreground (base 30), 40
+ * and up for the background (base 40) */
+static void vt_append_color(const CIXL_Color color, const unsigned int base)
+{
+    const uint32_t key = VT_COLOR_KEYS[color];
+
+    if (key < 8)
+    {
+        vt_append_uint(base + key);
+    }
+    else if (key < 16)
+    {
+        vt_append_uint(base + 60 + (key - 8));
+    }
+    else if (key & VT_COLOR_RGB)
+    {
+        vt_append_uint(base + 8);
+        vt_append_char(';');
+        vt_append_char('2');
+        vt_append_char(';');
+        vt_append_uint((key >> 16) & 0xFF);
+        vt_append_char(';');
+        vt_append_uint((key >> 8) & 0xFF);
+        vt_append_char(';');
+        vt_append_uint(key & 0xFF);
+    }
+    else
+    {
+        vt_append_uint(base + 8);
+        vt_append_char(';');
+        vt_append_char('5');
+        vt_append_char(';');
+        vt_append_uint(key & 0xFF);
+    }
+}
+
+static void vt_move_cursor(const int x, const int y)
+{
+    if (x != VT_CURSOR_X || y != VT_CURSOR_Y)
+    {
+        /* CSI row ; column H, 1-based */
+        vt_append_char('\033');
+        vt_append_char('[');
+        vt_append_uint((unsigned int) y + 1);
+        vt_append_char(';');
+        vt_append_uint((unsigned int) x + 1);
+        vt_append_char('H');
+        VT_CURSOR_X = x;
+        VT_CURSOR_Y = y;
+        ++VT_CURSOR_MOVES;
+    }
+}
+
+static void vt_set_style(const CIXL_Color fg_color, const CIXL_Color bg_color, const CIXL_StyleOpts decoration)
+{
+    vt_update_color_keys();
+
+    if (decoration != VT_STYLE)
+    {
+        //Attributes can only be turned off one by one with codes that are not widely supported, so reset all
+        int bit;
+        vt_append_char('\033');
+        vt_append_char('[');
+        vt_append_char('0');
+        for (bit = 0; bit < 8; ++bit)
+        {
+            if (decoration & (1 << bit))
+            {
+                vt_append_char(';');
+                vt_append_uint((unsigned int) STYLE_SGR_MAP[bit]);
+            }
+        }
+        vt_append_char(';');
+        vt_append_color(fg_color, 30);
+        vt_append_char(';');
+        vt_append_color(bg_color, 40);
+        vt_append_char('m');
+        ++VT_SGR_CHANGES;
+    }
+    else if (fg_color != VT_FG || bg_color != VT_BG)
+    {
+        vt_append_char('\033');
+        vt_append_char('[');
+        if (fg_color != VT_FG)
+        {
+            vt_append_color(fg_color, 30);
+        }
+        if (fg_color != VT_FG && bg_color != VT_BG)
+        {
+            vt_append_char(';');
+        }
+        if (bg_color != VT_BG)
+        {
+            vt_append_color(bg_color, 40);
+        }
+        vt_append_char('m');
+        ++VT_SGR_CHANGES;
+    }
+
+    VT_FG    = fg_color;
+    VT_BG    = bg_color;
+    VT_STYLE = decoration;
+}
+
+/*! control characters (and the empty 0 char) would be interpreted by the terminal, print those as a space */
+static inline char vt_printable(const char c)
+{
+    return ((unsigned char) c < 0x20 || c == 0x7F) ? ' ' : c;
+}
+
+/*! Upper bound of a cursor move plus an SGR with all attributes set and two 24 bit colors */
+#define VT_MAX_CONTROL_SIZE 96
+
+/*! the number of decimal digits of a (small) non negative number */
+static inline unsigned int vt_digits(unsigned int value)
+{
+    unsigned int count = 1;
+
+    while (value >= 10)
+    {
+        value /= 10;
+        ++count;
+    }
+    return count;
+}
+
+/*! appends CSI value final */
+static inline void vt_append_csi(const unsigned int value, const char final)
+{
+    vt_append_char('\033');
+    vt_append_char('[');
+    vt_append_uint(value);
+    vt_append_char(final);
+}
+
+/*! the size of CSI value final */
+#define VT_CSI_SIZE(value) (3 + vt_digits(value))
+
+/*! Appends a run of count times the same character, the cursor is at start_x. With the capabilities of the terminal
+ * blanks are erased (EL to the end of the line, or ECH) and other characters repeated (REP), when that is shorter.
+ * Returns where the cursor ends up.*/
+static int vt_append_run(const int start_x, const char c, const unsigned int count, const bool is_last,
+                         const CIXL_StyleOpts decoration)
+{
+    unsigned int i;
+    int          width;
+    int          height;
+
+    //an erased cell has the background color, but no attributes
+    if (c == ' ' && decoration == 0 && (VT_CAPS & CIXL_VT_CAP_ECH) && (VT_CAPS & CIXL_VT_CAP_BCE))
+    {
+        cixl_screen_size(&width, &height);
+        if (is_last && start_x + (int) count == width && count > 3)
+        {
+            // CSI K
+            vt_append_char('\033');
+            vt_append_char('[');
+            vt_append_char('K');
+            return start_x;
+        }
+        if (is_last && count > VT_CSI_SIZE(count))
+        {
+            vt_append_csi(count, 'X');
+            return start_x;
+        }
+        if (count > 2 * VT_CSI_SIZE(count))
+        {
+            //erase and move over the erased cells
+            vt_append_csi(count, 'X');
+            vt_append_csi(count, 'C');
+            ++VT_CURSOR_MOVES;
+            return start_x + (int) count;
+        }
+    }
+
+    if ((VT_CAPS & CIXL_VT_CAP_REP) && count - 1 > VT_CSI_SIZE(count - 1))
+    {
+        vt_append_char(c);
+        vt_append_csi(count - 1, 'b');
+        return start_x + (int) count;
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        vt_append_char(c);
+    }
+    return start_x + (int) count;
+}
+
+static void vt_draw_horiz_s(const int start_x, const int start_y, char *str, const unsigned int size,
+                            const CIXL_Color fg_color, const CIXL_Color bg_color, const CIXL_StyleOpts decoration)
+{
+    unsigned int i;
+    unsigned int run;
+    char         c;
+
+    if (!vt_reserve_in_frame(VT_MAX_CONTROL_SIZE + size))
+    {
+        return;
+    }
+
+    vt_move_cursor(start_x, start_y);
+    vt_set_style(fg_color, bg_color, decoration);
+
+    if ((VT_CAPS & (CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH)) == 0)
+    {
+        for (i = 0; i < size; ++i)
+        {
+            vt_append_char(vt_printable(str[i]));
+        }
+        VT_CURSOR_X += (int) size;
+        return;
+    }
+
+    //runs of the same character, the encoded run is never longer than the characters themselves
+    for (i = 0; i < size; i += run)
+    {
+        c   = vt_printable(str[i]);
+        run = 1;
+        while (i + run < size && vt_printable(str[i + run]) == c)
+        {
+            ++run;
+        }
+        VT_CURSOR_X = vt_append_run(VT_CURSOR_X, c, run, i + run == size, decoration);
+    }
+}
+
+static void vt_draw_cxl(const int start_x, const int start_y, const CIXL_Cxl cxl)
+{
+    char c = cxl.char_value;
+    vt_draw_horiz_s(start_x, start_y, &c, 1, cxl.fg_color, cxl.bg_color, cxl.style_opts);
+}
+
+static void vt_erase(const int start_y, const int line_count, const CIXL_Color bg_color)
+{
+    int width;
+    int height;
+    int y;
+
+    if (!vt_reserve_in_frame(VT_MAX_CONTROL_SIZE * (size_t) (line_count + 1)))
+    {
+        return;
+    }
+
+    //the erased cells get the background color (with BCE), the foreground does not matter
+    vt_set_style((CIXL_Color) (VT_FG >= 0 ? VT_FG : CIXL_Color_Grey), bg_color, 0);
+
+    cixl_screen_size(&width, &height);
+    if (start_y == 0 && line_count >= height)
+    {
+        // CSI 2 J, the cursor does not move
+        vt_append_csi(2, 'J');
+        return;
+    }
+
+    for (y = start_y; y < start_y + line_count; ++y)
+    {
+        // CSI K from the start of the line
+        vt_move_cursor(0, y);
+        vt_append_char('\033');
+        vt_append_char('[');
+        vt_append_char('K');
+    }
+}
+
+static void vt_frame_stats(CIXL_RenderStats *stats)
+{
+    stats->bytes        = VT_LAST_BYTES;
+    stats->cursor_moves = VT_LAST_CURSOR_MOVES;
+    stats->sgr_changes  = VT_LAST_SGR_CHANGES;
+}
+
+static CIXL_RenderDevice VT_DEVICE = {vt_draw_cxl, vt_draw_horiz_s, cixl_vt_flush, vt_frame_stats, NULL};
+
+CIXL_RenderDevice *cixl_vt_device(CIXL_VtWrite f_write)
+{
+    VT_WRITE = f_write != NULL ? f_write : vt_write_stdout;
+    cixl_vt_reset_state();
+    return &VT_DEVICE;
+}
+
+void cixl_vt_set_tap(CIXL_VtWrite f_tap)
+{
+    VT_TAP = f_tap;
+}
+
+void cixl_vt_set_capabilities(const unsigned int caps)
+{
+    VT_CAPS = caps;
+
+    //without background color erase an erased cell gets the default background, which is not known
+    VT_DEVICE.f_erase = (caps & CIXL_VT_CAP_BCE) ? vt_erase : NULL;
+}
+
+unsigned int cixl_vt_capabilities()
+{
+    return VT_CAPS;
+}
+
+void cixl_vt_reset_state()
+{
+    VT_CURSOR_X = -1;
+    VT_CURSOR_Y = -1;
+    VT_FG       = -1;
+    VT_BG       = -1;
+    VT_STYLE    = -1;
+}
+
+void cixl_vt_write_raw(const char *bytes, const size_t size)
+{
+    if (vt_reserve_in_frame(size))
+    {
+        memcpy(&VT_BUFFER[VT_BUFFER_SIZE], bytes, size);
+        VT_BUFFER_SIZE += size;
+    }
+}
+
+void cixl_vt_flush()
+{
+    if (VT_SYNC)
+    {
+        //room for the end was reserved with every append
+        memcpy(&VT_BUFFER[VT_BUFFER_SIZE], SYNC_END, sizeof(SYNC_END) - 1);
+        VT_BUFFER_SIZE += sizeof(SYNC_END) - 1;
+        VT_SYNC = false;
+    }
+
+    if (VT_BUFFER_SIZE > 0 && VT_WRITE != NULL)
+    {
+        cixl_trace_begin("vt write");
+        VT_WRITE(VT_BUFFER, VT_BUFFER_SIZE);
+        cixl_trace_end();
+
+        if (VT_TAP != NULL)
+        {
+            VT_TAP(VT_BUFFER, VT_BUFFER_SIZE);
+        }
+    }
+
+    VT_LAST_BYTES        = (uint32_t) VT_BUFFER_SIZE;
+    VT_LAST_CURSOR_MOVES = VT_CURSOR_MOVES;
+    VT_LAST_SGR_CHANGES  = VT_SGR_CHANGES;
+    VT_CURSOR_MOVES      = 0;
+    VT_SGR_CHANGES       = 0;
+    VT_BUFFER_SIZE       = 0;
+}
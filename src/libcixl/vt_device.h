@@ -0,0 +1,63 @@
+/*! \file
+ * \brief VT render device. A #CIXL_RenderDevice that encodes the draw calls as ANSI / VT escape sequences.
+ * The bytes of a frame are collected in an output buffer and written at once at the end of the frame. The cursor
+ * position and the current colors and style are tracked, so cursor moves and SGR sequences are only written when needed.
+ * With #CIXL_VT_CAP_SYNC_OUTPUT each frame is wrapped in synchronized update brackets, with #CIXL_VT_CAP_REP runs of
+ * the same character are repeated (REP) and with #CIXL_VT_CAP_ECH and #CIXL_VT_CAP_BCE blank runs erased (ECH, or EL
+ * at the end of a line) when that takes fewer bytes. With #CIXL_VT_CAP_BCE the device also erases lines and the screen
+ * (EL, ED) for #cixl_render when they became mostly empty, see #cixl_vt_set_capabilities.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_VT_DEVICE_H
+#define LIBCIXL_VT_DEVICE_H
+
+#include <stddef.h>
+#include "std/cixl_stdbool.h"
+#include "config.h"
+#include "screen_buffer.h"
+#include "vt_caps.h"
+
+/*! \brief Writes the encoded bytes of a frame. Returns the number of bytes written.*/
+typedef size_t (*CIXL_VtWrite)(const char *bytes, const size_t size);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Returns the VT render device, pass it to #cixl_init_screen_buffer.
+ * \param f_write where the bytes of each frame are written to, when NULL they are written to stdout.*/
+CIXLLIB_API CIXL_RenderDevice *cixl_vt_device(CIXL_VtWrite f_write);
+
+/*! \brief Sets a tap that receives a copy of the bytes of each frame after they are written, for example
+ * #cixl_asciicast_write. NULL removes the tap.*/
+CIXLLIB_API void cixl_vt_set_tap(CIXL_VtWrite f_tap);
+
+/*! \brief Sets the capabilities of the terminal (see vt_caps.h) the device may use, the default is
+ * #CIXL_VT_CAPS_NONE. Takes effect with the next frame.*/
+CIXLLIB_API void cixl_vt_set_capabilities(const unsigned int caps);
+
+CIXLLIB_API unsigned int cixl_vt_capabilities();
+
+/*! \brief Forgets the tracked cursor position, colors and style. Call this when the terminal was written to or
+ * cleared by something else than the VT device, the next frame then starts with a cursor move and a full SGR.*/
+CIXLLIB_API void cixl_vt_reset_state();
+
+/*! \brief Writes the given bytes through the device as part of the current frame, for example to clear the screen.*/
+CIXLLIB_API void cixl_vt_write_raw(const char *bytes, const size_t size);
+
+/*! \brief Writes the bytes of the current frame that were not written yet. This is done by #cixl_render at the end
+ * of each frame.*/
+CIXLLIB_API void cixl_vt_flush();
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_VT_DEVICE_H
+
+#pragma clang diagnostic pop
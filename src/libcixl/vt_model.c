@@ -0,0 +1,623 @@
+#include "std/cixl_stdlib.h"
+#include "screen_buffer.h"
+#include "vt_model.h"
+
+#define PARSE_GROUND 0
+#define PARSE_ESCAPE 1
+#define PARSE_CSI 2
+#define PARSE_STRING 3
+#define PARSE_STRING_ESCAPE 4
+
+static inline CIXL_Cxl *model_cell(CIXL_VtModel *model, const int x, const int y)
+{
+    return &model->cells[(y * model->width) + x];
+}
+
+static void model_erase(CIXL_VtModel *model, const int from_index, const int to_index)
+{
+    CIXL_Cxl blank;
+    int      i;
+
+    blank.char_value = ' ';
+    blank.fg_color   = model->pen.fg_color;
+    blank.bg_color   = model->pen.bg_color;
+    blank.style_opts = 0;
+
+    for (i = from_index; i < to_index; ++i)
+    {
+        model->cells[i] = blank;
+    }
+}
+
+/*! scrolls the whole screen up (count > 0) or down (count < 0) */
+static void model_scroll(CIXL_VtModel *model, const int count)
+{
+    const int area  = model->width * model->height;
+    const int lines = count > 0 ? count : -count;
+    int       i;
+
+    if (lines >= model->height)
+    {
+        model_erase(model, 0, area);
+        return;
+    }
+
+    if (count > 0)
+    {
+        for (i = 0; i < area - (lines * model->width); ++i)
+        {
+            model->cells[i] = model->cells[i + (lines * model->width)];
+        }
+        model_erase(model, area - (lines * model->width), area);
+    }
+    else
+    {
+        for (i = area - 1; i >= lines * model->width; --i)
+        {
+            model->cells[i] = model->cells[i - (lines * model->width)];
+        }
+        model_erase(model, 0, lines * model->width);
+    }
+}
+
+static void model_line_feed(CIXL_VtModel *model)
+{
+    if (model->cursor_y == model->height - 1)
+    {
+        model_scroll(model, 1);
+    }
+    else
+    {
+        ++model->cursor_y;
+    }
+}
+
+static void model_print(CIXL_VtModel *model, const char c)
+{
+    CIXL_Cxl *cell;
+
+    if (model->wrap_pending)
+    {
+        model->cursor_x     = 0;
+        model->wrap_pending = false;
+        model_line_feed(model);
+    }
+
+    cell = model_cell(model, model->cursor_x, model->cursor_y);
+    *cell = model->pen;
+    cell->char_value = c;
+    model->last_printed = c;
+    ++model->stats.printed_bytes;
+
+    if (model->cursor_x == model->width - 1)
+    {
+        model->wrap_pending = true;
+    }
+    else
+    {
+        ++model->cursor_x;
+    }
+}
+
+static inline int clamp(const int value, const int min, const int max)
+{
+    return value < min ? min : (value > max ? max : value);
+}
+
+/*! \return the parameter at the index, or the default value when it is missing or 0 */
+static inline int model_param(const CIXL_VtModel *model, const int index, const int default_value)
+{
+    return (index < model->param_count && model->params[index] > 0) ? model->params[index] : default_value;
+}
+
+static void model_move_cursor(CIXL_VtModel *model, const int x, const int y)
+{
+    model->cursor_x     = clamp(x, 0, model->width - 1);
+    model->cursor_y     = clamp(y, 0, model->height - 1);
+    model->wrap_pending = false;
+    ++model->stats.cursor_moves;
+}
+
+/*! maps a 8 bit color to a cxl color */
+static inline bool model_color_256(const int color, CIXL_Color *out_color)
+{
+    if (color >= 0 && color < 256)
+    {
+        *out_color = (CIXL_Color) color;
+        return true;
+    }
+    return false;
+}
+
+/*! maps a 24 bit color to the color of the color table that has it */
+static inline bool model_color_rgb(const int red, const int green, const int blue, CIXL_Color *out_color)
+{
+    if (red < 0 || red > 255 || green < 0 || green > 255 || blue < 0 || blue > 255)
+    {
+        return false;
+    }
+    return cixl_color_find_rgb((uint8_t) red, (uint8_t) green, (uint8_t) blue, out_color);
+}
+
+static void model_sgr(CIXL_VtModel *model)
+{
+    int i;
+
+    ++model->stats.sgr_changes;
+
+    if (model->param_count == 0)
+    {
+        model->params[0]  = 0;
+        model->param_count = 1;
+    }
+
+    for (i = 0; i < model->param_count; ++i)
+    {
+        const int p = model->params[i];
+        CIXL_Color color;
+
+        if (p == 0)
+        {
+            model->pen.fg_color   = CIXL_VT_MODEL_DEFAULT_FG;
+            model->pen.bg_color   = CIXL_VT_MODEL_DEFAULT_BG;
+            model->pen.style_opts = 0;
+        }
+        else if (p == 1)
+        {
+            model->pen.style_opts |= bold;
+        }
+        else if (p == 2)
+        {
+            model->pen.style_opts |= faint;
+        }
+        else if (p == 3)
+        {
+            model->pen.style_opts |= italic;
+        }
+        else if (p == 4)
+        {
+            model->pen.style_opts |= underline;
+        }
+        else if (p == 7)
+        {
+            model->pen.style_opts |= invert;
+        }
+        else if (p == 9)
+        {
+            model->pen.style_opts |= crossed_out;
+        }
+        else if (p == 20)
+        {
+            model->pen.style_opts |= fraktur;
+        }
+        else if (p == 21)
+        {
+            model->pen.style_opts |= double_underline;
+        }
+        else if (p == 22)
+        {
+            model->pen.style_opts &= (CIXL_StyleOpts) ~(bold | faint);
+        }
+        else if (p == 23)
+        {
+            model->pen.style_opts &= (CIXL_StyleOpts) ~(italic | fraktur);
+        }
+        else if (p == 24)
+        {
+            model->pen.style_opts &= (CIXL_StyleOpts) ~(underline | double_underline);
+        }
+        else if (p == 27)
+        {
+            model->pen.style_opts &= (CIXL_StyleOpts) ~invert;
+        }
+        else if (p == 29)
+        {
+            model->pen.style_opts &= (CIXL_StyleOpts) ~crossed_out;
+        }
+        else if (p >= 30 && p <= 37)
+        {
+            model->pen.fg_color = (CIXL_Color) (p - 30);
+        }
+        else if (p == 39)
+        {
+            model->pen.fg_color = CIXL_VT_MODEL_DEFAULT_FG;
+        }
+        else if (p >= 40 && p <= 47)
+        {
+            model->pen.bg_color = (CIXL_Color) (p - 40);
+        }
+        else if (p == 49)
+        {
+            model->pen.bg_color = CIXL_VT_MODEL_DEFAULT_BG;
+        }
+        else if (p >= 90 && p <= 97)
+        {
+            model->pen.fg_color = (CIXL_Color) (p - 90 + 8);
+        }
+        else if (p >= 100 && p <= 107)
+        {
+            model->pen.bg_color = (CIXL_Color) (p - 100 + 8);
+        }
+        else if ((p == 38 || p == 48) && i + 2 < model->param_count && model->params[i + 1] == 5)
+        {
+            if (model_color_256(model->params[i + 2], &color))
+            {
+                if (p == 38)
+                {
+                    model->pen.fg_color = color;
+                }
+                else
+                {
+                    model->pen.bg_color = color;
+                }
+            }
+            else
+            {
+                ++model->stats.unknown_sequences;
+            }
+            i += 2;
+        }
+        else if ((p == 38 || p == 48) && i + 4 < model->param_count && model->params[i + 1] == 2)
+        {
+            if (model_color_rgb(model->params[i + 2], model->params[i + 3], model->params[i + 4], &color))
+            {
+                if (p == 38)
+                {
+                    model->pen.fg_color = color;
+                }
+                else
+                {
+                    model->pen.bg_color = color;
+                }
+            }
+            else
+            {
+                //a color that is not in the color table can not be represented
+                ++model->stats.unknown_sequences;
+            }
+            i += 4;
+        }
+        else
+        {
+            ++model->stats.unknown_sequences;
+        }
+    }
+}
+
+static void model_csi_dispatch(CIXL_VtModel *model, const char final)
+{
+    const int area = model->width * model->height;
+    int       index;
+    int       count;
+
+    if (model->is_private)
+    {
+        //DEC private modes (cursor visibility, alternate screen, ...) do not change the grid
+        if (final != 'h' && final != 'l')
+        {
+            ++model->stats.unknown_sequences;
+        }
+        return;
+    }
+
+    switch (final)
+    {
+        case 'H':
+        case 'f':
+            model_move_cursor(model, model_param(model, 1, 1) - 1, model_param(model, 0, 1) - 1);
+            break;
+        case 'A':
+            model_move_cursor(model, model->cursor_x, model->cursor_y - model_param(model, 0, 1));
+            break;
+        case 'B':
+            model_move_cursor(model, model->cursor_x, model->cursor_y + model_param(model, 0, 1));
+            break;
+        case 'C':
+            model_move_cursor(model, model->cursor_x + model_param(model, 0, 1), model->cursor_y);
+            break;
+        case 'D':
+            model_move_cursor(model, model->cursor_x - model_param(model, 0, 1), model->cursor_y);
+            break;
+        case 'G':
+            model_move_cursor(model, model_param(model, 0, 1) - 1, model->cursor_y);
+            break;
+        case 'd':
+            model_move_cursor(model, model->cursor_x, model_param(model, 0, 1) - 1);
+            break;
+        case 'J':
+            index = (model->cursor_y * model->width) + model->cursor_x;
+            switch (model_param(model, 0, 0))
+            {
+                case 0:
+                    model_erase(model, index, area);
+                    break;
+                case 1:
+                    model_erase(model, 0, index + 1);
+                    break;
+                default:
+                    model_erase(model, 0, area);
+                    break;
+            }
+            break;
+        case 'K':
+            index = model->cursor_y * model->width;
+            switch (model_param(model, 0, 0))
+            {
+                case 0:
+                    model_erase(model, index + model->cursor_x, index + model->width);
+                    break;
+                case 1:
+                    model_erase(model, index, index + model->cursor_x + 1);
+                    break;
+                default:
+                    model_erase(model, index, index + model->width);
+                    break;
+            }
+            break;
+        case 'X':
+            index = (model->cursor_y * model->width) + model->cursor_x;
+            count = clamp(model_param(model, 0, 1), 1, model->width - model->cursor_x);
+            model_erase(model, index, index + count);
+            break;
+        case 'b':
+            count = model_param(model, 0, 1);
+            while (count-- > 0)
+            {
+                model_print(model, model->last_printed);
+            }
+            break;
+        case 'S':
+            model_scroll(model, model_param(model, 0, 1));
+            break;
+        case 'T':
+            model_scroll(model, -model_param(model, 0, 1));
+            break;
+        case 'm':
+            model_sgr(model);
+            break;
+        default:
+            ++model->stats.unknown_sequences;
+            break;
+    }
+}
+
+static void model_control(CIXL_VtModel *model, const char c)
+{
+    ++model->stats.sequences;
+    switch (c)
+    {
+        case '\r':
+            model->cursor_x     = 0;
+            model->wrap_pending = false;
+            break;
+        case '\n':
+            model_line_feed(model);
+            break;
+        case '\b':
+            if (model->cursor_x > 0)
+            {
+                --model->cursor_x;
+            }
+            model->wrap_pending = false;
+            break;
+        default:
+            break;
+    }
+}
+
+static void model_feed_byte(CIXL_VtModel *model, const char c)
+{
+    const unsigned char b = (unsigned char) c;
+
+    switch (model->parse_state)
+    {
+        case PARSE_GROUND:
+            if (b == 0x1B)
+            {
+                model->parse_state = PARSE_ESCAPE;
+            }
+            else if (b < 0x20 || b == 0x7F)
+            {
+                model_control(model, c);
+            }
+            else
+            {
+                model_print(model, c);
+            }
+            break;
+
+        case PARSE_ESCAPE:
+            ++model->stats.sequences;
+            if (c == '[')
+            {
+                model->parse_state = PARSE_CSI;
+                model->param_count = 0;
+                model->is_private  = false;
+                model->params[0]   = 0;
+            }
+            else if (c == ']' || c == 'P' || c == '_' || c == '^')
+            {
+                //OSC, DCS, APC and PM strings are skipped until the string terminator
+                model->parse_state = PARSE_STRING;
+            }
+            else
+            {
+                ++model->stats.unknown_sequences;
+                model->parse_state = PARSE_GROUND;
+            }
+            break;
+
+        case PARSE_CSI:
+            if (c >= '0' && c <= '9')
+            {
+                if (model->param_count == 0)
+                {
+                    model->param_count = 1;
+                }
+                model->params[model->param_count - 1] = (model->params[model->param_count - 1] * 10) + (c - '0');
+            }
+            else if (c == ';' || c == ':')
+            {
+                if (model->param_count == 0)
+                {
+                    model->param_count = 1;
+                }
+                if (model->param_count < CIXL_VT_MODEL_MAX_PARAMS)
+                {
+                    model->params[model->param_count++] = 0;
+                }
+            }
+            else if (c == '?' || c == '>' || c == '<' || c == '=')
+            {
+                model->is_private = true;
+            }
+            else if (b >= 0x40 && b <= 0x7E)
+            {
+                model_csi_dispatch(model, c);
+                model->parse_state = PARSE_GROUND;
+            }
+            else if (b < 0x20 && b != 0x1B)
+            {
+                //control chars are executed in the middle of a sequence
+                model_control(model, c);
+            }
+            else if (b == 0x1B)
+            {
+                ++model->stats.unknown_sequences;
+                model->parse_state = PARSE_ESCAPE;
+            }
+            break;
+
+        case PARSE_STRING:
+            if (b == 0x07)
+            {
+                model->parse_state = PARSE_GROUND;
+            }
+            else if (b == 0x1B)
+            {
+                model->parse_state = PARSE_STRING_ESCAPE;
+            }
+            break;
+
+        case PARSE_STRING_ESCAPE:
+            model->parse_state = c == '\\' ? PARSE_GROUND : PARSE_STRING;
+            break;
+
+        default:
+            model->parse_state = PARSE_GROUND;
+            break;
+    }
+}
+
+CIXL_VtModel *cixl_vt_model_create(const int width, const int height)
+{
+    CIXL_VtModel *model;
+
+    if (width <= 0 || height <= 0)
+    {
+        return NULL;
+    }
+
+    model = cixl_mem_alloc(1, sizeof(CIXL_VtModel));
+    if (model == NULL)
+    {
+        return NULL;
+    }
+
+    model->cells = cixl_mem_alloc((size_t) width * (size_t) height, sizeof(CIXL_Cxl));
+    if (model->cells == NULL)
+    {
+        cixl_mem_free(model);
+        return NULL;
+    }
+
+    model->width          = width;
+    model->height         = height;
+    model->pen.fg_color   = CIXL_VT_MODEL_DEFAULT_FG;
+    model->pen.bg_color   = CIXL_VT_MODEL_DEFAULT_BG;
+    model->pen.style_opts = 0;
+    model->pen.char_value = ' ';
+    model->last_printed   = ' ';
+    model->parse_state    = PARSE_GROUND;
+    model_erase(model, 0, width * height);
+    return model;
+}
+
+void cixl_vt_model_free(CIXL_VtModel *model)
+{
+    if (model != NULL)
+    {
+        cixl_mem_free(model->cells);
+        cixl_mem_free(model);
+    }
+}
+
+void cixl_vt_model_feed(CIXL_VtModel *model, const char *bytes, const size_t size)
+{
+    size_t i;
+
+    model->stats.bytes += size;
+    for (i = 0; i < size; ++i)
+    {
+        model_feed_byte(model, bytes[i]);
+    }
+}
+
+CIXL_Cxl cixl_vt_model_pick(const CIXL_VtModel *model, const int x, const int y)
+{
+    if (x < 0 || y < 0 || x >= model->width || y >= model->height)
+    {
+        return CXL_EMPTY;
+    }
+    else
+    {
+        return model->cells[(y * model->width) + x];
+    }
+}
+
+static inline bool is_blank(const char c)
+{
+    return c == ' ' || c == 0;
+}
+
+bool cixl_vt_model_cxl_looks_equal(const CIXL_Cxl *left, const CIXL_Cxl *right)
+{
+    if (is_blank(left->char_value) && is_blank(right->char_value))
+    {
+        return left->bg_color == right->bg_color && left->style_opts == right->style_opts;
+    }
+
+    return left->char_value == right->char_value && left->fg_color == right->fg_color &&
+           left->bg_color == right->bg_color && left->style_opts == right->style_opts;
+}
+
+int cixl_vt_model_compare_screen(const CIXL_VtModel *model, int *out_first_index)
+{
+    int difference_count = 0;
+    int x;
+    int y;
+
+    if (out_first_index != NULL)
+    {
+        *out_first_index = -1;
+    }
+
+    for (y = 0; y < model->height; ++y)
+    {
+        for (x = 0; x < model->width; ++x)
+        {
+            const CIXL_Cxl screen = cixl_pick(x, y);
+
+            if (!cixl_vt_model_cxl_looks_equal(&model->cells[(y * model->width) + x], &screen))
+            {
+                if (difference_count == 0 && out_first_index != NULL)
+                {
+                    *out_first_index = (y * model->width) + x;
+                }
+                ++difference_count;
+            }
+        }
+    }
+
+    return difference_count;
+}
@@ -0,0 +1,111 @@
+/*! \file
+ * \brief Headless VT terminal model. Parses an ANSI / VT escape stream (like the output of the VT device) and keeps the
+ * resulting grid of cxls, the cursor and the current colors and style, like a terminal would.
+ * It is used to measure what the output really costs (bytes per frame) and to check that the rendered output produces
+ * the same screen as the screen buffer, see #cixl_vt_model_compare_screen.
+ *
+ * Supported: printable chars with deferred wrap and scrolling, CR, LF, BS, cursor movement (CUP, HVP, CUU, CUD, CUF, CUB,
+ * CHA, VPA), erase (ED, EL, ECH), repeat (REP), scroll (SU, SD) and SGR (styles, 4 bit, 8 bit colors and the
+ * 24 bit colors of the color table, see #cixl_color_find_rgb).
+ * Other sequences are parsed and counted, but have no effect.
+ * \author Dorus Verhoeckx
+ * \date 2020
+ * \copyright Dorus Verhoeckx or https://unlicense.org/ or  https://mit-license.org/
+ * */
+#pragma warning (disable : 4068 )
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "readability-avoid-const-params-in-decls"
+#ifndef LIBCIXL_VT_MODEL_H
+#define LIBCIXL_VT_MODEL_H
+
+#include <stddef.h>
+#include "std/cixl_stdint.h"
+#include "std/cixl_stdbool.h"
+#include "config.h"
+#include "cxl.h"
+
+#define CIXL_VT_MODEL_MAX_PARAMS 16
+
+/*! \brief The foreground color of the model when the color is reset to the default (SGR 39)*/
+#define CIXL_VT_MODEL_DEFAULT_FG CIXL_Color_Grey
+
+/*! \brief The background color of the model when the color is reset to the default (SGR 49)*/
+#define CIXL_VT_MODEL_DEFAULT_BG CIXL_Color_Black
+
+typedef struct CIXL_VtModelStats
+{
+    /*! \brief All bytes that were fed.*/
+    uint64_t bytes;
+
+    /*! \brief Bytes that were printed as a char.*/
+    uint64_t printed_bytes;
+
+    /*! \brief Control sequences (ESC and CSI) and control chars.*/
+    uint64_t sequences;
+
+    /*! \brief Cursor position and movement sequences.*/
+    uint64_t cursor_moves;
+
+    /*! \brief SGR sequences.*/
+    uint64_t sgr_changes;
+
+    /*! \brief Sequences that are not supported by the model.*/
+    uint64_t unknown_sequences;
+} CIXL_VtModelStats;
+
+typedef struct CIXL_VtModel
+{
+    int width;
+    int height;
+
+    /*! \brief The screen, row by row (width * height). Erased cells are spaces with the background of the pen.*/
+    CIXL_Cxl *cells;
+
+    int cursor_x;
+    int cursor_y;
+
+    /*! \brief The colors and style that new chars are written with.*/
+    CIXL_Cxl pen;
+
+    /*! \brief The cursor is at the right margin, the next printable char wraps to the next line.*/
+    bool wrap_pending;
+
+    CIXL_VtModelStats stats;
+
+    int  parse_state;
+    int  params[CIXL_VT_MODEL_MAX_PARAMS];
+    int  param_count;
+    bool is_private;
+    char last_printed;
+} CIXL_VtModel;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Creates a model of a terminal of the given size, with a blank screen and the cursor top left.*/
+CIXLLIB_API CIXL_VtModel *cixl_vt_model_create(const int width, const int height);
+
+CIXLLIB_API void cixl_vt_model_free(CIXL_VtModel *model);
+
+/*! \brief Parses the bytes and applies them to the model. Sequences can be split over multiple calls.*/
+CIXLLIB_API void cixl_vt_model_feed(CIXL_VtModel *model, const char *bytes, const size_t size);
+
+CIXLLIB_API CIXL_Cxl cixl_vt_model_pick(const CIXL_VtModel *model, const int x, const int y);
+
+/*! \brief Returns true when the cells look the same on a terminal: the same chars (0 looks like a space), colors and
+ * style. The foreground color of blank cells is not visible, so it is ignored.*/
+CIXLLIB_API bool cixl_vt_model_cxl_looks_equal(const CIXL_Cxl *left, const CIXL_Cxl *right);
+
+/*! \brief Compares the model with the screen buffer (see #cixl_pick), call this after #cixl_render.
+ * \param out_first_index the index of the first cell that differs, -1 when all are equal. Can be NULL.
+ * \return the number of cells that differ.*/
+CIXLLIB_API int cixl_vt_model_compare_screen(const CIXL_VtModel *model, int *out_first_index);
+
+#ifdef __cplusplus
+} /* End of extern "C" */
+#endif
+
+#endif //LIBCIXL_VT_MODEL_H
+
+#pragma clang diagnostic pop
@@ -13,6 +13,22 @@
 
 #include "deps/catch.hpp"
 #include "../src/libcixl.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <mutex>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#endif
 
 int move_cursor(int x, int y, FILE *output)
 {
@@ -42,12 +58,16 @@ void draw_cixl_s(const int start_x, const int start_y, char *str, const unsigned
     LAST_START_X_CALLED = start_x;
     LAST_START_Y_CALLED = start_y;
     LAST_STR_CALLED     = str;
+    (void) size;
+    (void) fg_color;
+    (void) bg_color;
+    (void) decoration;
 
     move_cursor(start_x, start_y, stdout);
     //fputs(str, stdout);
 }
 
-CIXL_RenderDevice X{draw_cixl, draw_cixl_s};
+CIXL_RenderDevice X = cixl_render_device(draw_cixl, draw_cixl_s);
 
 /*
 TEST_CASE("Size tests CIXL_Cxl", "should be valid")
@@ -72,15 +92,15 @@ TEST_CASE("Pack CIXL_Cxl all attrs", "should be valid")
 {
     CIXL_Cxl a{65, 3, 5, 4};
 
-    //0x04_5_3_41
-    REQUIRE(cixl_pack_cxl(&a) == 0x45341);
+    //0x04_05_03_41
+    REQUIRE(cixl_pack_cxl(&a) == 0x04050341);
 }
 
 TEST_CASE("Unpack CIXL_Cxl", "should be valid")
 {
     CIXL_Cxl a{65, 3, 5, 4};
     int32_t  int_value = cixl_pack_cxl(&a);
-    REQUIRE(int_value == 0x45341);
+    REQUIRE(int_value == 0x04050341);
     //int32_t  *int_ptr  = &int_value;
     //CIXL_Cxl unpacked_cxl ={};
 
@@ -93,7 +113,7 @@ TEST_CASE("Unpack CIXL_Cxl", "should be valid")
 
     int unpacked_cxl_int_value = cixl_pack_cxl(&unpacked_cxl);
 
-    REQUIRE(0x45341 == unpacked_cxl_int_value);
+    REQUIRE(0x04050341 == unpacked_cxl_int_value);
 }
 
 TEST_CASE("cixl_put and cixl_pick", "should be valid")
@@ -217,7 +237,7 @@ TEST_CASE("put and then clear should result empty cxl", "smoke test")
 {
     //Arrange
     CIXL_Cxl          b{'B', 0, 0, 0};
-    CIXL_RenderDevice x{draw_cixl, draw_cixl_s};
+    CIXL_RenderDevice x = cixl_render_device(draw_cixl, draw_cixl_s);
     cixl_init_screen_buffer(80, 25, &x);
 
     REQUIRE(cixl_put(1, 1, b));
@@ -234,7 +254,7 @@ TEST_CASE("put and then clear_area should result empty cxl", "smoke test")
 {
     //Arrange
     CIXL_Cxl          b{'B', 0, 0, 0};
-    CIXL_RenderDevice x{draw_cixl, draw_cixl_s};
+    CIXL_RenderDevice x = cixl_render_device(draw_cixl, draw_cixl_s);
     cixl_init_screen_buffer(80, 25, &x);
 
     REQUIRE(cixl_put(1, 1, b));
@@ -255,7 +275,7 @@ TEST_CASE("when A is current put A then B then A should result in NOT DIRTY", "s
     //Arrange
     CIXL_Cxl          a{'A', 0, 0, 0};
     CIXL_Cxl          b{'B', 0, 0, 0};
-    CIXL_RenderDevice x{draw_cixl, draw_cixl_s};
+    CIXL_RenderDevice x = cixl_render_device(draw_cixl, draw_cixl_s);
     cixl_init_screen_buffer(80, 25, &x);
 
     cixl_put(1, 1, a);
@@ -281,7 +301,7 @@ TEST_CASE("put and then clear should result in 0 draw calls", "smoke test")
 {
     //Arrange
     CIXL_Cxl          a{'B', 0, 0, 0};
-    CIXL_RenderDevice x{draw_cixl, draw_cixl_s};
+    CIXL_RenderDevice x = cixl_render_device(draw_cixl, draw_cixl_s);
     cixl_init_screen_buffer(80, 25, &x);
 
     REQUIRE(cixl_put(1, 1, a));
@@ -294,12 +314,44 @@ TEST_CASE("put and then clear should result in 0 draw calls", "smoke test")
     REQUIRE(draw_count == 0);
 }
 
+TEST_CASE("put the cxl of two frames ago", "should be dirty, the next buffer of a clean cxl is not compared")
+{
+    //Arrange: the next buffer of the cell still holds a, from the frame before the last one
+    CIXL_Cxl a{'A', CIXL_Color_Red, CIXL_Color_Black, 0};
+    CIXL_Cxl b{'B', CIXL_Color_Red, CIXL_Color_Black, 0};
+    cixl_init_screen_buffer(10, 2, &X);
+    cixl_put(1, 1, a);
+    cixl_render();
+    cixl_put(1, 1, b);
+    cixl_render();
+
+    //Act
+    REQUIRE(cixl_put(1, 1, a));
+
+    //Assert
+    REQUIRE(cixl_render() == 1);
+    REQUIRE(cixl_render_stats().redundant_puts == 0);
+    REQUIRE(cixl_pick(1, 1).char_value == 'A');
+
+    //the same through print
+    cixl_print(3, 0, "A", CIXL_Color_Red, CIXL_Color_Black, 0);
+    cixl_render();
+    cixl_print(3, 0, "B", CIXL_Color_Red, CIXL_Color_Black, 0);
+    cixl_render();
+    cixl_print(3, 0, "A", CIXL_Color_Red, CIXL_Color_Black, 0);
+    REQUIRE(cixl_render() == 1);
+    REQUIRE(cixl_pick(3, 0).char_value == 'A');
+
+    //putting the current cxl of a clean cell again is still redundant
+    REQUIRE_FALSE(cixl_put(1, 1, a));
+}
+
 TEST_CASE("first render ok", "smoke test")
 {
     //Arrange
     CIXL_Cxl a{'A', 0, 0, 0};
 
-    CIXL_RenderDevice x{draw_cixl, draw_cixl_s};
+    CIXL_RenderDevice x = cixl_render_device(draw_cixl, draw_cixl_s);
     cixl_init_screen_buffer(80, 25, &x);
 
     REQUIRE(cixl_put(0, 1, a));
@@ -316,7 +368,7 @@ TEST_CASE("write line buffer second render ok", "smoke test")
     //Arrange
     CIXL_Cxl          a{'A', 0, 0, 0};
     CIXL_Cxl          b{'B', 0, 0, 0};
-    CIXL_RenderDevice x{draw_cixl, draw_cixl_s};
+    CIXL_RenderDevice x = cixl_render_device(draw_cixl, draw_cixl_s);
     cixl_init_screen_buffer(80, 25, &x);
 
     cixl_render();
@@ -340,7 +392,7 @@ TEST_CASE("render calls draw_s for same cixel styles on same line..", "smoke tes
     //Arrange
     CIXL_Cxl          a{'A', 0, 0, 0};
     CIXL_Cxl          b{'B', CIXL_Color_Green, 0, 0};
-    CIXL_RenderDevice x{draw_cixl, draw_cixl_s};
+    CIXL_RenderDevice x = cixl_render_device(draw_cixl, draw_cixl_s);
     cixl_init_screen_buffer(80, 25, &x);
 
 
@@ -369,7 +421,7 @@ TEST_CASE("render calls draw_s for same cixel styles on same line..", "smoke tes
 TEST_CASE("render calls draw_s for when writing with puts", "smoke test")
 {
     //Arrange
-    CIXL_RenderDevice x{draw_cixl, draw_cixl_s};
+    CIXL_RenderDevice x = cixl_render_device(draw_cixl, draw_cixl_s);
     cixl_init_screen_buffer(80, 25, &x);
 
     //put a string block, this should result in one draw call when rendered
@@ -400,29 +452,2461 @@ TEST_CASE("game ticks_to_ms", "smoke test")
     REQUIRE(ticks_to_ms(16, 1001) == 15);
     REQUIRE(ticks_to_ms(500, 1001) == 499);
 
-    REQUIRE(ticks_to_ms(500, CLOCKS_PER_SEC) == 500);
+    REQUIRE(ticks_to_ms(CLOCKS_PER_SEC / 2, CLOCKS_PER_SEC) == 500);
+
+    //nanosecond ticks of more than 213 days do not overflow
+    REQUIRE(ticks_to_ms(20000000000000000ull, CIXL_MONOTONIC_TICKS_PER_SECOND) == 20000000000ull);
+    REQUIRE(ms_to_ticks(16, CIXL_MONOTONIC_TICKS_PER_SECOND) == 16000000ull);
 }
 
 TEST_CASE("game one tick fixed step should progress 16 ms", "smoke test")
 {
 
-    CIXL_Game *p_cixl_game = cixl_game_create(CLOCKS_PER_SEC);
+    CIXL_Game *p_cixl_game = cixl_game_create();
     REQUIRE(p_cixl_game->is_fixed_time_step);
-    REQUIRE(p_cixl_game->clocks_per_second == CLOCKS_PER_SEC);
+    REQUIRE(p_cixl_game->f_time_source == cixl_time_monotonic);
+    REQUIRE(p_cixl_game->ticks_per_second == CIXL_MONOTONIC_TICKS_PER_SECOND);
 
+    //the virtual clock only advances when the game loop waits, so the test does not depend on the real clock
     bool    should_exit   = false;
+    cixl_time_virtual_set(1000);
+    cixl_game_set_time_source(cixl_time_virtual, CIXL_VIRTUAL_TICKS_PER_SECOND);
     REQUIRE(cixl_game_init(NULL) == 1);
-    clock_t current_ticks = clock();
-    REQUIRE(current_ticks > 0);
+    CIXL_Ticks current_ticks = cixl_time_virtual();
 
     //Perform one init tick plus one
     REQUIRE(cixl_game_tick(&CURRENT_GAME_TIME, NULL, &should_exit) == 1);
     REQUIRE(cixl_game_tick(&CURRENT_GAME_TIME, NULL, &should_exit) == 1);
 
-
-    REQUIRE(CURRENT_GAME_TIME.elapsed_game_time_ticks == 16);
+    REQUIRE(cixl_time_virtual() - current_ticks == 2 * ms_to_ticks(16, CIXL_VIRTUAL_TICKS_PER_SECOND));
+    REQUIRE(CURRENT_GAME_TIME.elapsed_game_time_ticks == ms_to_ticks(16, CIXL_VIRTUAL_TICKS_PER_SECOND));
     REQUIRE(CURRENT_GAME_TIME.elapsed_game_time_ms == 16);
-    REQUIRE(CURRENT_GAME_TIME.total_game_time_ticks == 32);
+    REQUIRE(CURRENT_GAME_TIME.total_game_time_ticks == 2 * ms_to_ticks(16, CIXL_VIRTUAL_TICKS_PER_SECOND));
+
+    cixl_game_set_time_source(cixl_time_monotonic, CIXL_MONOTONIC_TICKS_PER_SECOND);
+}
+
+TEST_CASE("record and replay frames", "should reconstruct each frame")
+{
+    //Arrange
+    CIXL_Cxl          a{'A', CIXL_Color_Red, 0, 0};
+    CIXL_Cxl          b{'B', 0, CIXL_Color_Blue, 0};
+    CIXL_RenderDevice *recording_device = cixl_record_start("test_recording.cxr", 80, 25, 2, &X);
+    REQUIRE(recording_device != nullptr);
+    REQUIRE(cixl_record_start("test_recording.cxr", 80, 25, 2, &X) == nullptr);
+    cixl_init_screen_buffer(80, 25, recording_device);
+
+    cixl_put(1, 1, a); //frame 0 (keyframe)
+    cixl_render();
+    cixl_print(0, 2, "BBB", 0, CIXL_Color_Blue, 0); //frame 1
+    cixl_put(1, 1, b);
+    cixl_render();
+    cixl_clear(1, 1); //frame 2 (keyframe)
+    cixl_render();
+    cixl_put(79, 24, a); //frame 3
+    cixl_render();
+    REQUIRE(cixl_record_stop());
+
+    //Act
+    CIXL_Replay *replay = cixl_replay_open("test_recording.cxr");
+
+    //Assert
+    REQUIRE(replay != nullptr);
+    REQUIRE(replay->width == 80);
+    REQUIRE(replay->height == 25);
+    REQUIRE(replay->frame_count == 4);
+
+    REQUIRE(cixl_replay_seek(replay, 1));
+    REQUIRE(cixl_replay_pick(replay, 1, 1).char_value == 'B');
+    REQUIRE(cixl_replay_pick(replay, 2, 2).char_value == 'B');
+    REQUIRE(cixl_replay_pick(replay, 2, 2).bg_color == CIXL_Color_Blue);
+
+    REQUIRE(cixl_replay_seek(replay, 3));
+    REQUIRE(cixl_replay_pick(replay, 1, 1).char_value == 0);
+    REQUIRE(cixl_replay_pick(replay, 0, 2).char_value == 'B');
+    REQUIRE(cixl_replay_pick(replay, 79, 24).fg_color == CIXL_Color_Red);
+
+    //seek back to before the last keyframe
+    REQUIRE(cixl_replay_seek(replay, 0));
+    REQUIRE(cixl_replay_pick(replay, 1, 1).char_value == 'A');
+    REQUIRE(cixl_replay_pick(replay, 0, 2).char_value == 0);
+    REQUIRE(cixl_replay_next(replay));
+    REQUIRE(replay->current_frame == 1);
+    REQUIRE(!cixl_replay_seek(replay, 4));
+
+    cixl_replay_close(replay);
+    remove("test_recording.cxr");
+}
+
+TEST_CASE("replay put frame", "should render the recorded delta")
+{
+    //Arrange
+    CIXL_RenderDevice *recording_device = cixl_record_start("test_recording.cxr", 80, 25, 10, nullptr);
+    cixl_init_screen_buffer(80, 25, recording_device);
+    cixl_render();
+    cixl_print(0, 1, "AAAAAAAAAA", 0, 0, 0); //frame 0
+    cixl_render();
+    cixl_print(2, 3, "BB", 0, 0, 0); //frame 1
+    cixl_render();
+    REQUIRE(cixl_record_stop());
+
+    CIXL_Replay *replay = cixl_replay_open("test_recording.cxr");
+    REQUIRE(replay != nullptr);
+    cixl_init_screen_buffer(80, 25, &X);
+
+    //Act
+    REQUIRE(cixl_replay_seek(replay, 1));
+    int put_count  = cixl_replay_put_frame(replay);
+    int draw_count = cixl_render();
+
+    //Assert
+    REQUIRE(put_count == 2);
+    REQUIRE(draw_count == 1);
+    REQUIRE(LAST_STR_CALLED == std::string("BB"));
+    cixl_replay_close(replay);
+    remove("test_recording.cxr");
+}
+
+std::string VT_OUTPUT;
+
+size_t vt_write_to_string(const char *bytes, const size_t size)
+{
+    VT_OUTPUT.append(bytes, size);
+    return size;
+}
+
+TEST_CASE("vt device encodes a frame", "should move the cursor and set the colors only when needed")
+{
+    //Arrange
+    VT_OUTPUT.clear();
+    cixl_init_screen_buffer(80, 25, cixl_vt_device(vt_write_to_string));
+    cixl_print(2, 1, "AB", CIXL_Color_Red, CIXL_Color_Black, 0);
+    cixl_print(4, 1, "CD", CIXL_Color_Red_Bright, CIXL_Color_Black, bold);
+
+    //Act
+    cixl_render();
+
+    //Assert
+    REQUIRE(VT_OUTPUT == "\033[2;3H\033[0;31;40mAB\033[0;1;91;40mCD");
+
+    //the cursor and style are already where they need to be
+    VT_OUTPUT.clear();
+    cixl_print(6, 1, "E", CIXL_Color_Red_Bright, CIXL_Color_Black, bold);
+    cixl_render();
+    REQUIRE(VT_OUTPUT == "E");
+}
+
+TEST_CASE("asciicast records the vt output as events", "should be valid asciicast v2")
+{
+    //Arrange
+    REQUIRE(cixl_asciicast_start("test_recording.cast", 80, 25));
+    REQUIRE(!cixl_asciicast_start("test_recording.cast", 80, 25));
+
+    //Act
+    REQUIRE(cixl_asciicast_write("\033[1;1HA\"b\\\n", 11) == 11);
+    REQUIRE(cixl_asciicast_stop());
+
+    //Assert
+    FILE *file = fopen("test_recording.cast", "rb");
+    REQUIRE(file != nullptr);
+    char header[256];
+    char event[256];
+    REQUIRE(fgets(header, sizeof(header), file) != nullptr);
+    REQUIRE(fgets(event, sizeof(event), file) != nullptr);
+    fclose(file);
+
+    REQUIRE(std::string(header).find("{\"version\": 2, \"width\": 80, \"height\": 25,") == 0);
+    std::string event_s(event);
+    REQUIRE(event_s[0] == '[');
+    REQUIRE(event_s.find(", \"o\", \"\\u001b[1;1HA\\\"b\\\\\\n\"]\n") != std::string::npos);
+    remove("test_recording.cast");
+}
+
+TEST_CASE("counting device counts draw calls, cells and bytes", "smoke test")
+{
+    //Arrange
+    CIXL_Cxl a{'A', 0, 0, 0};
+    cixl_init_screen_buffer(80, 25, cixl_counting_device());
+    cixl_counting_device_reset();
+
+    cixl_put(0, 0, a);
+    cixl_print(0, 1, "ABCDE", 0, 0, 0);
+    cixl_print(0, 2, "FG", CIXL_Color_Red, 0, 0);
+
+    //Act
+    cixl_render();
+
+    //Assert
+    CIXL_DeviceCounters counters = cixl_counting_device_counters();
+    REQUIRE(counters.draw_cxl_calls == 1);
+    REQUIRE(counters.draw_horiz_s_calls == 2);
+    REQUIRE(counters.frames == 1);
+    REQUIRE(counters.cells == 8);
+    //8 characters, ESC[0;30;40m for the first run and ESC[31m for the red one
+    REQUIRE(counters.bytes == 8 + 10 + 5);
+}
+
+CIXL_VtModel *VT_MODEL = nullptr;
+
+size_t vt_write_to_model(const char *bytes, const size_t size)
+{
+    cixl_vt_model_feed(VT_MODEL, bytes, size);
+    return size;
+}
+
+TEST_CASE("vt model parses cursor movement, colors and erase", "should keep the grid like a terminal")
+{
+    //Arrange
+    CIXL_VtModel *model = cixl_vt_model_create(10, 3);
+    REQUIRE(model != nullptr);
+    const char *stream = "\033[2;3H\033[0;1;31;44mAB\033[3GC\033[2;10HXY\033[5b\033[1;1H\033[42m\033[2K\033[?25l";
+
+    //Act
+    cixl_vt_model_feed(model, stream, strlen(stream));
+
+    //Assert
+    REQUIRE(cixl_vt_model_pick(model, 2, 1).char_value == 'C');
+    REQUIRE(cixl_vt_model_pick(model, 2, 1).fg_color == CIXL_Color_Red);
+    REQUIRE(cixl_vt_model_pick(model, 2, 1).bg_color == CIXL_Color_Blue);
+    REQUIRE(cixl_vt_model_pick(model, 2, 1).style_opts == bold);
+    REQUIRE(cixl_vt_model_pick(model, 3, 1).char_value == 'B');
+    //X at the right margin, Y wraps to the next line and is repeated 5 times
+    REQUIRE(cixl_vt_model_pick(model, 9, 1).char_value == 'X');
+    REQUIRE(cixl_vt_model_pick(model, 0, 2).char_value == 'Y');
+    REQUIRE(cixl_vt_model_pick(model, 5, 2).char_value == 'Y');
+    REQUIRE(cixl_vt_model_pick(model, 6, 2).char_value == ' ');
+    //the erased line has the background of the pen
+    REQUIRE(cixl_vt_model_pick(model, 4, 0).char_value == ' ');
+    REQUIRE(cixl_vt_model_pick(model, 4, 0).bg_color == CIXL_Color_Green);
+    REQUIRE(model->stats.bytes == strlen(stream));
+    REQUIRE(model->stats.cursor_moves == 4);
+    REQUIRE(model->stats.sgr_changes == 2);
+    REQUIRE(model->stats.unknown_sequences == 0);
+
+    cixl_vt_model_free(model);
+}
+
+TEST_CASE("vt device output rendered by the vt model equals the screen buffer", "should be equal after every render")
+{
+    //Arrange
+    CIXL_Cxl a{'A', CIXL_Color_Yellow, CIXL_Color_Blue, underline};
+    char     full_row[81];
+    int      first_difference;
+
+    VT_MODEL = cixl_vt_model_create(80, 25);
+    REQUIRE(VT_MODEL != nullptr);
+    cixl_init_screen_buffer(80, 25, cixl_vt_device(vt_write_to_model));
+    memset(full_row, '#', 80);
+    full_row[80] = 0;
+
+    for (int frame = 0; frame < 40; ++frame)
+    {
+        //Act
+        cixl_print(frame % 7, frame % 25, "Hello, world!", (CIXL_Color) (frame % 16), (CIXL_Color) ((frame + 3) % 16),
+                   (CIXL_StyleOpts) (1u << (frame % 8)));
+        cixl_print(0, (frame * 3) % 25, full_row, CIXL_Color_White_Bright, (CIXL_Color) (frame % 16), 0);
+        cixl_put(79, 24, a);
+        cixl_put(frame % 80, 12, a);
+        if (frame % 5 == 0)
+        {
+            cixl_clear_area(10, 5, 30, 10);
+        }
+        if (frame % 13 == 0)
+        {
+            cixl_clear_area(0, 0, 80, 25);
+        }
+        cixl_render();
+
+        //Assert
+        INFO("frame " << frame);
+        REQUIRE(cixl_vt_model_compare_screen(VT_MODEL, &first_difference) == 0);
+        REQUIRE(first_difference == -1);
+    }
+
+    cixl_vt_model_free(VT_MODEL);
+    VT_MODEL = nullptr;
+}
+
+TEST_CASE("render stats are filled each frame", "should count cells, runs, device output and redundant puts")
+{
+    //Arrange
+    CIXL_Cxl         a{'A', CIXL_Color_Red, CIXL_Color_Black, 0};
+    CIXL_RenderStats history[4];
+
+    VT_OUTPUT.clear();
+    cixl_init_screen_buffer(80, 25, cixl_vt_device(vt_write_to_string));
+    REQUIRE(cixl_render_stats_history_start(2));
+    cixl_render_stats_set_detailed_timing(true);
+
+    cixl_print(2, 1, "AB", CIXL_Color_Red, CIXL_Color_Black, 0);
+    cixl_print(4, 1, "CD", CIXL_Color_Red_Bright, CIXL_Color_Black, bold);
+    cixl_render();
+    cixl_put(0, 0, a);
+    cixl_put(0, 0, a); //redundant
+    cixl_print(2, 1, "AB", CIXL_Color_Red, CIXL_Color_Black, 0); //redundant
+
+    //Act
+    cixl_render();
+    CIXL_RenderStats stats = cixl_render_stats();
+
+    //Assert
+    REQUIRE(stats.cells_scanned == 80 * 25);
+    REQUIRE(stats.cells_dirty == 1);
+    REQUIRE(stats.runs == 1);
+    REQUIRE(stats.redundant_puts == 3);
+    //"\033[1;1H\033[0;31;40mA"
+    REQUIRE(stats.bytes == 17);
+    REQUIRE(stats.cursor_moves == 1);
+    REQUIRE(stats.sgr_changes == 1);
+    REQUIRE(stats.total_ns >= stats.scan_ns + stats.encode_ns);
+
+    REQUIRE(cixl_render_stats_history(history, 4) == 2);
+    REQUIRE(history[1].frame == stats.frame);
+    REQUIRE(history[0].frame == stats.frame - 1);
+    //the frame number comes from the same counter as the frame count
+    REQUIRE(cixl_render_frame_count() == stats.frame + 1);
+    REQUIRE(history[0].cells_dirty == 4);
+    REQUIRE(history[0].runs == 2);
+    REQUIRE(history[0].bytes == VT_OUTPUT.size() - 17);
+
+    cixl_render_stats_set_detailed_timing(false);
+    cixl_render_stats_history_stop();
+    REQUIRE(cixl_render_stats_history(history, 4) == 0);
+}
+
+TEST_CASE("render stats of a frame without changes", "should record the frame with its redundant puts")
+{
+    //Arrange
+    CIXL_RenderStats history[4];
+    cixl_init_screen_buffer(80, 25, &X);
+    cixl_print(0, 0, "hud", CIXL_Color_Red, CIXL_Color_Black, 0);
+    cixl_render();
+    uint64_t frames = cixl_render_frame_count();
+    REQUIRE(cixl_render_stats_history_start(4));
+
+    //Act
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        cixl_print(0, 0, "hud", CIXL_Color_Red, CIXL_Color_Black, 0);
+        REQUIRE(cixl_render() == 0);
+    }
+
+    //Assert
+    REQUIRE(cixl_render_frame_count() == frames + 3);
+    REQUIRE(cixl_render_stats().frame == frames + 2);
+    REQUIRE(cixl_render_stats().cells_dirty == 0);
+    REQUIRE(cixl_render_stats().cells_scanned == 0);
+    REQUIRE(cixl_render_stats().redundant_puts == 3);
+    REQUIRE(cixl_render_stats_history(history, 4) == 3);
+    cixl_render_stats_history_stop();
+}
+
+TEST_CASE("overdraw counts puts, noop puts and changes per cell", "should find cells written multiple times")
+{
+    //Arrange
+    CIXL_Cxl a{'A', CIXL_Color_Red, CIXL_Color_Black, 0};
+    CIXL_Cxl b{'B', CIXL_Color_Red, CIXL_Color_Black, 0};
+    cixl_init_screen_buffer(80, 25, &X);
+    REQUIRE(cixl_overdraw_available());
+    REQUIRE(cixl_overdraw_start());
+
+    //Act
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        cixl_put(1, 1, a);
+        cixl_put(1, 1, b);
+        cixl_put(1, 1, b);
+        cixl_put(2, 2, a);
+        cixl_render();
+    }
+
+    //Assert
+    CIXL_OverdrawCell hot = cixl_overdraw_pick(1, 1);
+    REQUIRE(cixl_overdraw_frames() == 2);
+    REQUIRE(hot.puts == 6);
+    //frame 0: a, b change and b is a noop, frame 1: a, b change (back to b) and b is a noop
+    REQUIRE(hot.changes == 4);
+    REQUIRE(hot.noop_puts == 2);
+    REQUIRE(cixl_overdraw_pick(2, 2).puts == 2);
+    REQUIRE(cixl_overdraw_pick(2, 2).noop_puts == 1);
+    REQUIRE(cixl_overdraw_pick(3, 3).puts == 0);
+
+    REQUIRE(cixl_overdraw_dump("test_overdraw.txt"));
+    remove("test_overdraw.txt");
+
+    //only the cell with 3 puts per frame is tinted, and the overlay is not counted
+    cixl_overdraw_tint(3, CIXL_Color_Magenta);
+    REQUIRE(cixl_pick(1, 1).char_value == 'B');
+    REQUIRE(cixl_pick(1, 1).bg_color == CIXL_Color_Magenta);
+    REQUIRE(cixl_pick(2, 2).bg_color == CIXL_Color_Black);
+    REQUIRE(cixl_overdraw_pick(1, 1).puts == 6);
+
+    cixl_overdraw_reset();
+    REQUIRE(cixl_overdraw_pick(1, 1).puts == 0);
+    cixl_overdraw_stop();
+}
+
+TEST_CASE("overdraw counts frames with only redundant puts", "should count every rendered frame")
+{
+    //Arrange: a static hud that is written again every frame
+    cixl_init_screen_buffer(80, 25, &X);
+    cixl_print(0, 0, "score 100", CIXL_Color_White_Bright, CIXL_Color_Black, 0);
+    cixl_render();
+    REQUIRE(cixl_overdraw_start());
+
+    //Act
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        cixl_print(0, 0, "score 100", CIXL_Color_White_Bright, CIXL_Color_Black, 0);
+        REQUIRE(cixl_render() == 0);
+    }
+
+    //Assert
+    REQUIRE(cixl_overdraw_frames() == 10);
+    REQUIRE(cixl_overdraw_pick(0, 0).puts == 10);
+    REQUIRE(cixl_overdraw_pick(0, 0).noop_puts == 10);
+    cixl_overdraw_stop();
+}
+
+TEST_CASE("pacing waits until the deadline", "should not return early and should report the waits and frames")
+{
+    //Arrange
+    cixl_pacing_reset_stats();
+
+    //Act
+    for (int i = 0; i < 5; ++i)
+    {
+        uint64_t deadline = cixl_time_monotonic() + 2000000u;
+        cixl_pacing_wait_until_ns(deadline);
+        REQUIRE(cixl_time_monotonic() >= deadline);
+        cixl_pacing_frame_mark();
+    }
+
+    //Assert
+    CIXL_PacingStats stats = cixl_pacing_stats();
+    REQUIRE(stats.waits == 5);
+    REQUIRE(stats.frames == 5);
+    REQUIRE(stats.frame_interval_mean_ns >= 2000000u);
+    REQUIRE(stats.overshoot_estimate_ns <= CIXL_PACING_MAX_OVERSHOOT_NS);
+    REQUIRE(stats.sleep_ns + stats.spin_ns > 0);
+}
+
+#if defined(__unix__)
+TEST_CASE("idle wait wakes on input, timers and requested frames", "should block until there is something to do")
+{
+    //Arrange
+    int  fds[2];
+    char c;
+    cixl_idle_reset();
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(cixl_idle_wait() == 0); //nothing to wait for
+    REQUIRE(cixl_idle_watch_fd(fds[0]));
+
+    //Act & Assert
+    REQUIRE(write(fds[1], "x", 1) == 1);
+    REQUIRE(cixl_idle_wait() == CIXL_WAKE_INPUT);
+    REQUIRE(read(fds[0], &c, 1) == 1);
+
+    uint64_t start = cixl_time_monotonic();
+    cixl_idle_schedule_ms(5);
+    cixl_idle_schedule_ms(50); //the earliest is kept
+    REQUIRE(cixl_idle_wait() == CIXL_WAKE_TIMER);
+    REQUIRE(cixl_time_monotonic() - start >= 5000000u);
+
+    cixl_idle_request_frame();
+    REQUIRE(cixl_idle_wait() == CIXL_WAKE_FRAME);
+
+    CIXL_IdleStats stats = cixl_idle_stats();
+    REQUIRE(stats.wakes == 4);
+    REQUIRE(stats.blocks == 2);
+    REQUIRE(stats.blocked_ns >= 5000000u);
+
+    cixl_idle_reset();
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static int          IDLE_TEST_PIPE[2];
+static int          IDLE_TEST_UPDATES = 0;
+static unsigned int IDLE_TEST_WAKES[3];
+
+static void idle_test_update(const CIXL_GameTime *game_time, void *)
+{
+    char c;
+
+    IDLE_TEST_WAKES[IDLE_TEST_UPDATES++] = game_time->wake_events;
+    switch (IDLE_TEST_UPDATES)
+    {
+        case 1:
+            REQUIRE(write(IDLE_TEST_PIPE[1], "x", 1) == 1);
+            break;
+        case 2:
+            REQUIRE(read(IDLE_TEST_PIPE[0], &c, 1) == 1);
+            cixl_idle_schedule_ms(20);
+            break;
+        default:
+            cixl_game_exit();
+            break;
+    }
+}
+
+TEST_CASE("event driven game only updates when woken", "should update on the first frame, input and the timer")
+{
+    //Arrange
+    CIXL_Game *p_cixl_game = cixl_game_create();
+    cixl_idle_reset();
+    REQUIRE(pipe(IDLE_TEST_PIPE) == 0);
+    REQUIRE(cixl_idle_watch_fd(IDLE_TEST_PIPE[0]));
+    p_cixl_game->is_event_driven = true;
+    p_cixl_game->f_update_game   = idle_test_update;
+    REQUIRE(cixl_game_init(NULL) == 1);
+
+    //Act
+    REQUIRE(cixl_game_run() == 1);
+
+    //Assert
+    REQUIRE(IDLE_TEST_UPDATES == 3);
+    REQUIRE(IDLE_TEST_WAKES[0] == CIXL_WAKE_FRAME);
+    REQUIRE(IDLE_TEST_WAKES[1] == CIXL_WAKE_INPUT);
+    REQUIRE(IDLE_TEST_WAKES[2] == CIXL_WAKE_TIMER);
+    REQUIRE(cixl_idle_stats().blocks >= 1);
+
+    p_cixl_game->is_event_driven = false;
+    p_cixl_game->f_update_game   = NULL;
+    cixl_idle_reset();
+    close(IDLE_TEST_PIPE[0]);
+    close(IDLE_TEST_PIPE[1]);
+}
+#endif
+
+static int IDLE_PACED_TEST_UPDATES = 0;
+
+static void idle_paced_test_update(const CIXL_GameTime *game_time, void *)
+{
+    REQUIRE(game_time->elapsed_game_time_ms == 16);
+    if (++IDLE_PACED_TEST_UPDATES == 50)
+    {
+        cixl_game_exit();
+    }
+}
+
+TEST_CASE("event driven game without anything to wait for", "should be paced like a normal game")
+{
+    //Arrange: nothing is watched or scheduled, so cixl_idle_wait returns 0 at once
+    CIXL_Game *p_cixl_game = cixl_game_create();
+    cixl_idle_reset();
+    cixl_time_virtual_set(1000);
+    cixl_game_set_time_source(cixl_time_virtual, CIXL_VIRTUAL_TICKS_PER_SECOND);
+    p_cixl_game->is_event_driven = true;
+    p_cixl_game->f_update_game   = idle_paced_test_update;
+    REQUIRE(cixl_game_init(NULL) == 1);
+    IDLE_PACED_TEST_UPDATES = 0;
+
+    //Act
+    REQUIRE(cixl_game_run() == 1);
+
+    //Assert: the clock advanced a fixed step for each update after the first frame, it did not spin
+    REQUIRE(IDLE_PACED_TEST_UPDATES == 50);
+    REQUIRE(cixl_time_virtual() - 1000 >= 49 * ms_to_ticks(16, CIXL_VIRTUAL_TICKS_PER_SECOND));
+
+    p_cixl_game->is_event_driven = false;
+    p_cixl_game->f_update_game   = NULL;
+    cixl_game_set_time_source(cixl_time_monotonic, CIXL_MONOTONIC_TICKS_PER_SECOND);
+    cixl_idle_reset();
+}
+
+static CIXL_Ticks CTX_TEST_NOW = 0;
+
+static CIXL_Ticks ctx_test_time()
+{
+    return CTX_TEST_NOW;
+}
+
+static void ctx_test_update(const CIXL_GameTime *, void *shared_state)
+{
+    ++*(int *) shared_state;
+}
+
+TEST_CASE("game contexts tick independently", "should only update a context when it is due and never wait")
+{
+    //Arrange
+    CIXL_Game        game = *cixl_game_create();
+    CIXL_GameContext contexts[100];
+    int              updates[100];
+    game.f_time_source    = ctx_test_time;
+    game.ticks_per_second = 1000;
+    game.f_update_game    = ctx_test_update;
+    game.f_draw_game      = nullptr;
+
+    REQUIRE(cixl_game_init_ctx(nullptr, &game, nullptr) == -2);
+    for (int i = 0; i < 100; ++i)
+    {
+        updates[i] = 0;
+        //start the sessions at different times
+        CTX_TEST_NOW = (CIXL_Ticks) i;
+        REQUIRE(cixl_game_init_ctx(&contexts[i], &game, &updates[i]) == 1);
+    }
+
+    //Act & Assert
+    CTX_TEST_NOW = 16;
+    REQUIRE(cixl_game_next_tick_ctx(&contexts[0]) == 16);
+    REQUIRE(cixl_game_next_tick_ctx(&contexts[1]) == 17);
+    REQUIRE(cixl_game_tick_ctx(&contexts[0]) == 1);
+    REQUIRE(cixl_game_tick_ctx(&contexts[1]) == 0);
+    REQUIRE(updates[0] == 1);
+    REQUIRE(updates[1] == 0);
+
+    CTX_TEST_NOW = 200;
+    cixl_game_exit_ctx(&contexts[99]);
+    for (int i = 0; i < 100; ++i)
+    {
+        cixl_game_tick_ctx(&contexts[i]);
+    }
+    REQUIRE(updates[0] == 12); //184 ms later: 11 more fixed steps
+    REQUIRE(updates[1] == 12); //the 15 ms of the first tick were not lost
+    REQUIRE(updates[50] == 9);
+    REQUIRE(updates[99] == 0);
+    REQUIRE(contexts[1].game_time.total_game_time_ticks == 192);
+    REQUIRE(contexts[1].game_time.step_count == 12);
+}
+
+static int CTX_TEST_DRAWS = 0;
+
+static void ctx_test_draw(const CIXL_GameTime *game_time, void *)
+{
+    ++CTX_TEST_DRAWS;
+    REQUIRE(game_time->interpolation_alpha >= 0.0f);
+    REQUIRE(game_time->interpolation_alpha < 1.0f);
+}
+
+TEST_CASE("game draws at its own rate", "should update at 125 Hz and draw at 31.25 Hz with an interpolation alpha")
+{
+    //Arrange
+    CIXL_Game        game = *cixl_game_create();
+    CIXL_GameContext ctx;
+    int              updates = 0;
+    game.f_time_source              = ctx_test_time;
+    game.ticks_per_second           = 1000;
+    game.target_elapsed_time_millis = 8;
+    game.target_draw_time_millis    = 32;
+    game.f_update_game              = ctx_test_update;
+    game.f_draw_game                = ctx_test_draw;
+    CTX_TEST_NOW   = 0;
+    CTX_TEST_DRAWS = 0;
+    REQUIRE(cixl_game_init_ctx(&ctx, &game, &updates) == 1);
+
+    //Act
+    for (int i = 0; i < 40; ++i)
+    {
+        CTX_TEST_NOW += 8;
+        REQUIRE(cixl_game_tick_ctx(&ctx) == 1);
+    }
+
+    //Assert
+    REQUIRE(updates == 40);
+    REQUIRE(CTX_TEST_DRAWS == 11); //the first tick and every 32 ms
+
+    //half way the next update
+    CTX_TEST_NOW += 12;
+    REQUIRE(cixl_game_tick_ctx(&ctx) == 1);
+    REQUIRE(ctx.game_time.interpolation_alpha == 0.5f);
+}
+
+TEST_CASE("render cell budget", "should draw at most the budget per frame and continue where it stopped")
+{
+    //Arrange
+    cixl_init_screen_buffer(80, 25, &X);
+    cixl_render();
+    cixl_print(0, 0, "0123456789", CIXL_Color_Red, 0, 0);
+    cixl_print(0, 5, "0123456789", CIXL_Color_Red, 0, 0);
+    cixl_render_set_cell_budget(5);
+
+    //Act & Assert
+    REQUIRE(cixl_render() > 0);
+    REQUIRE(cixl_render_stats().cells_dirty == 5);
+    REQUIRE(LAST_START_Y_CALLED == 0);
+    REQUIRE(cixl_render() > 0);
+    REQUIRE(cixl_render_stats().cells_dirty == 5);
+    REQUIRE(cixl_render() > 0);
+    REQUIRE(cixl_render_stats().cells_dirty == 5);
+    REQUIRE(LAST_START_Y_CALLED == 5);
+    REQUIRE(cixl_render() > 0);
+    REQUIRE(cixl_render_stats().cells_dirty == 5);
+    REQUIRE(cixl_render() == 0); //all done
+
+    //a reset while a frame did not fit starts the next frame at the top again
+    cixl_print(0, 5, "abcdefghij", CIXL_Color_Red, 0, 0);
+    REQUIRE(cixl_render() > 0);
+    REQUIRE(LAST_START_Y_CALLED == 5);
+    cixl_reset();
+    cixl_print(0, 0, "0123456789", CIXL_Color_Red, 0, 0);
+    cixl_print(0, 10, "0123456789", CIXL_Color_Red, 0, 0);
+    REQUIRE(cixl_render() > 0);
+    REQUIRE(LAST_START_Y_CALLED == 0);
+
+    cixl_render_set_cell_budget(0);
+    REQUIRE(cixl_render_cell_budget() == 0);
+}
+
+static CIXL_Ticks CTX_TEST_WORK     = 0;
+static int        SLOW_TEST_CHANGES = 0;
+
+static void slow_test_update(const CIXL_GameTime *, void *)
+{
+    CTX_TEST_NOW += CTX_TEST_WORK;
+}
+
+static void slow_test_changed(const CIXL_GameTime *, void *)
+{
+    ++SLOW_TEST_CHANGES;
+}
+
+TEST_CASE("slow policy degrades on measured load", "should run slowly, draw less and recover")
+{
+    //Arrange
+    CIXL_SlowPolicy  policy = {90, 70, true, 80, 7, slow_test_changed};
+    CIXL_Game        game   = *cixl_game_create();
+    CIXL_GameContext ctx;
+    game.f_time_source              = ctx_test_time;
+    game.ticks_per_second           = 1000;
+    game.target_elapsed_time_millis = 10;
+    game.f_update_game              = slow_test_update;
+    game.f_draw_game                = ctx_test_draw;
+    game.slow_policy                = &policy;
+    CTX_TEST_NOW      = 0;
+    CTX_TEST_DRAWS    = 0;
+    SLOW_TEST_CHANGES = 0;
+    REQUIRE(cixl_game_init_ctx(&ctx, &game, nullptr) == 1);
+
+    //Act: the updates take 110% of the time step
+    CTX_TEST_WORK = 11;
+    for (int i = 0; i < 40; ++i)
+    {
+        CTX_TEST_NOW += 10;
+        cixl_game_tick_ctx(&ctx);
+    }
+
+    //Assert
+    REQUIRE(ctx.game_time.is_running_slowly);
+    REQUIRE(ctx.game_time.load_percent >= 90);
+    REQUIRE(SLOW_TEST_CHANGES == 1);
+    REQUIRE(cixl_render_cell_budget() == 7);
+    REQUIRE(ctx.draw_time_ticks > 0);
+    REQUIRE(CTX_TEST_DRAWS < 40);
+
+    //Act: no more load
+    CTX_TEST_WORK = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        CTX_TEST_NOW += 10;
+        cixl_game_tick_ctx(&ctx);
+    }
+
+    //Assert
+    REQUIRE_FALSE(ctx.game_time.is_running_slowly);
+    REQUIRE(ctx.game_time.load_percent < 70);
+    REQUIRE(SLOW_TEST_CHANGES == 2);
+    REQUIRE(cixl_render_cell_budget() == 0);
+    REQUIRE(ctx.draw_time_ticks == 0);
+}
+
+TEST_CASE("slow policy keeps skipping draws", "should skip draws while lagging, also after running a long time")
+{
+    //Arrange: no draw interval, only skip draws
+    CIXL_SlowPolicy  policy = {90, 70, true, 0, 0, NULL};
+    CIXL_Game        game   = *cixl_game_create();
+    CIXL_GameContext ctx;
+    game.f_time_source              = ctx_test_time;
+    game.ticks_per_second           = 1000;
+    game.target_elapsed_time_millis = 20;
+    game.f_update_game              = slow_test_update;
+    game.f_draw_game                = ctx_test_draw;
+    game.slow_policy                = &policy;
+    CTX_TEST_NOW   = 0;
+    CTX_TEST_WORK  = 19; //95% of the time step, a tick catches up with about 10 updates
+    REQUIRE(cixl_game_init_ctx(&ctx, &game, nullptr) == 1);
+
+    //Act: run for more than 10 seconds while lagging
+    for (int i = 0; i < 500; ++i)
+    {
+        CTX_TEST_NOW += 10;
+        cixl_game_tick_ctx(&ctx);
+    }
+    REQUIRE(CTX_TEST_NOW > 10000);
+    REQUIRE(ctx.game_time.is_running_slowly);
+    CTX_TEST_DRAWS = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        CTX_TEST_NOW += 10;
+        cixl_game_tick_ctx(&ctx);
+    }
+
+    //Assert: still skipping, but drawing at least every max elapsed time
+    REQUIRE(CTX_TEST_DRAWS < 100);
+    REQUIRE(CTX_TEST_DRAWS > 0);
+    CTX_TEST_WORK = 0;
+}
+
+TEST_CASE("game without a time source", "should use clock() with clocks_per_second, as before the time source")
+{
+    //Arrange: a game set up like before version 0.2.0, the old fields come first and there is no time source
+    CIXL_Game        game = {true, 16, 500, CLOCKS_PER_SEC, cixl_game_exit, NULL, NULL, false, 0, NULL, NULL, 0};
+    CIXL_GameContext ctx;
+
+    //Act
+    REQUIRE(cixl_game_init_ctx(&ctx, &game, nullptr) == 1);
+
+    //Assert
+    REQUIRE(game.f_time_source == cixl_time_clock);
+    REQUIRE(game.ticks_per_second == (CIXL_Ticks) CLOCKS_PER_SEC);
+    REQUIRE(ctx.target_elapsed_time_ticks == ms_to_ticks(16, CLOCKS_PER_SEC));
+
+    CIXL_Game saved = *cixl_game_create();
+    REQUIRE(cixl_game_create_with_clock(CLOCKS_PER_SEC)->f_time_source == cixl_time_clock);
+    REQUIRE(cixl_game_create()->ticks_per_second == (CIXL_Ticks) CLOCKS_PER_SEC);
+    cixl_game_set_time_source(saved.f_time_source, saved.ticks_per_second);
+}
+
+TEST_CASE("histogram percentiles", "should report percentiles within the bucket precision")
+{
+    //Arrange
+    static CIXL_Histogram histogram;
+    cixl_histogram_reset(&histogram);
+    REQUIRE(cixl_histogram_percentile(&histogram, 50.0) == 0);
+
+    //Act
+    for (uint64_t i = 1; i <= 1000000; ++i)
+    {
+        cixl_histogram_record(&histogram, i * 1000u); //1 us up to 1 s
+    }
+
+    //Assert
+    REQUIRE(histogram.total_count == 1000000);
+    REQUIRE(histogram.max == 1000000000u);
+    REQUIRE(cixl_histogram_mean(&histogram) == 500000500u);
+    uint64_t p50 = cixl_histogram_percentile(&histogram, 50.0);
+    uint64_t p99 = cixl_histogram_percentile(&histogram, 99.0);
+    REQUIRE(p50 >= 500000000u);
+    REQUIRE(p50 <= 500000000u + 500000000u / CIXL_HISTOGRAM_SUB_BUCKETS);
+    REQUIRE(p99 >= 990000000u);
+    REQUIRE(p99 <= 990000000u + 990000000u / CIXL_HISTOGRAM_SUB_BUCKETS);
+    REQUIRE(cixl_histogram_percentile(&histogram, 100.0) == 1000000000u);
+    REQUIRE(cixl_histogram_percentile(&histogram, 0.0) >= 1000u);
+    REQUIRE(cixl_histogram_percentile(&histogram, 0.0) <= 1000u + 1000u / CIXL_HISTOGRAM_SUB_BUCKETS);
+
+    //small values are exact, the largest values do not overflow
+    cixl_histogram_reset(&histogram);
+    cixl_histogram_record(&histogram, 3);
+    cixl_histogram_record(&histogram, UINT64_MAX);
+    REQUIRE(cixl_histogram_percentile(&histogram, 50.0) == 3);
+    REQUIRE(cixl_histogram_percentile(&histogram, 99.0) == UINT64_MAX);
+}
+
+TEST_CASE("histogram snapshot while recording", "should never go back or see more than was recorded")
+{
+    //Arrange
+    static CIXL_Histogram histogram;
+    static CIXL_Histogram snapshot;
+    uint64_t              previous_total = 0;
+    cixl_histogram_reset(&histogram);
+
+    //Act
+    std::thread writer([]()
+                       {
+                           for (uint64_t i = 0; i < 200000; ++i)
+                           {
+                               cixl_histogram_record(&histogram, i % 5000u);
+                           }
+                       });
+    for (int i = 0; i < 100; ++i)
+    {
+        cixl_histogram_snapshot(&histogram, &snapshot);
+
+        //Assert
+        REQUIRE(snapshot.total_count >= previous_total);
+        REQUIRE(snapshot.total_count <= 200000);
+        REQUIRE(snapshot.max < 5000);
+        previous_total = snapshot.total_count;
+    }
+    writer.join();
+    cixl_histogram_snapshot(&histogram, &snapshot);
+    REQUIRE(snapshot.total_count == 200000);
+    REQUIRE(cixl_histogram_percentile(&snapshot, 100.0) == 4999);
+}
+
+static void frame_times_test_draw(const CIXL_GameTime *, void *)
+{
+    cixl_put(1, 1, CIXL_Cxl{'A', CIXL_Color_Red, 0, 0});
+    cixl_put(1, 1, CIXL_Cxl{'B', CIXL_Color_Red, 0, 0});
+    cixl_render();
+}
+
+TEST_CASE("game frame times", "should record the durations of the updates, draws and renders")
+{
+    //Arrange
+    static CIXL_FrameTimes frame_times;
+    CIXL_Game              game = *cixl_game_create();
+    CIXL_GameContext       ctx;
+    int                    updates = 0;
+    game.f_time_source    = ctx_test_time;
+    game.ticks_per_second = 1000;
+    game.f_update_game    = ctx_test_update;
+    game.f_draw_game      = frame_times_test_draw;
+    memset(&frame_times, 0, sizeof(frame_times));
+    cixl_init_screen_buffer(80, 25, &X);
+    CTX_TEST_NOW = 0;
+    REQUIRE(cixl_game_init_ctx(&ctx, &game, &updates) == 1);
+    cixl_game_set_frame_times_ctx(&ctx, &frame_times);
+
+    //Act
+    for (int i = 0; i < 10; ++i)
+    {
+        CTX_TEST_NOW += 16;
+        REQUIRE(cixl_game_tick_ctx(&ctx) == 1);
+    }
+
+    //Assert
+    REQUIRE(frame_times.update_ns.total_count == 10);
+    REQUIRE(frame_times.draw_ns.total_count == 10);
+    REQUIRE(frame_times.render_ns.total_count == 10); //every draw changes the screen
+    REQUIRE(frame_times.draw_ns.max >= frame_times.render_ns.max);
+}
+
+static std::string read_file(const char *path)
+{
+    std::string content;
+    FILE        *file = fopen(path, "r");
+    int         c;
+    while (file != nullptr && (c = fgetc(file)) != EOF)
+    {
+        content += (char) c;
+    }
+    if (file != nullptr)
+    {
+        fclose(file);
+    }
+    return content;
+}
+
+static size_t count_occurrences(const std::string &text, const std::string &pattern)
+{
+    size_t count = 0;
+    for (size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1))
+    {
+        ++count;
+    }
+    return count;
+}
+
+static void trace_test_draw(const CIXL_GameTime *game_time, void *)
+{
+    cixl_put(1, 1, CIXL_Cxl{(char) ('A' + game_time->total_game_time_ticks / 16), CIXL_Color_Red, 0, 0});
+    cixl_render();
+}
+
+TEST_CASE("trace frame phases", "should dump the phases of all threads as a Chrome trace")
+{
+    //Arrange
+    CIXL_Game        game = *cixl_game_create();
+    CIXL_GameContext ctx;
+    int              updates = 0;
+    game.f_time_source    = ctx_test_time;
+    game.ticks_per_second = 1000;
+    game.f_update_game    = ctx_test_update;
+    game.f_draw_game      = trace_test_draw;
+    cixl_init_screen_buffer(80, 25, cixl_vt_device(vt_write_to_string));
+    CTX_TEST_NOW = 0;
+    REQUIRE(cixl_game_init_ctx(&ctx, &game, &updates) == 1);
+    REQUIRE_FALSE(cixl_trace_start(0));
+    REQUIRE(cixl_trace_start(64));
+
+    //Act
+    for (int i = 0; i < 3; ++i)
+    {
+        CTX_TEST_NOW += 16;
+        cixl_game_tick_ctx(&ctx);
+    }
+    std::thread worker([]()
+                       {
+                           cixl_trace_thread_name("worker \"1\"");
+                           for (int i = 0; i < 100; ++i) //more than fit in the ring
+                           {
+                               cixl_trace_begin("work");
+                               cixl_trace_end();
+                           }
+                       });
+    worker.join();
+    cixl_trace_stop();
+    cixl_trace_begin("not traced");
+    cixl_trace_end();
+
+    //Assert
+    REQUIRE(cixl_trace_dump("test_trace.json"));
+    std::string trace = read_file("test_trace.json");
+    REQUIRE(trace.find("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [") == 0);
+    REQUIRE(count_occurrences(trace, "\"name\": \"update\"") == 3);
+    REQUIRE(count_occurrences(trace, "\"name\": \"draw\"") == 3);
+    REQUIRE(count_occurrences(trace, "\"name\": \"render\"") == 3);
+    REQUIRE(count_occurrences(trace, "\"name\": \"vt write\"") == 3);
+    REQUIRE(count_occurrences(trace, "\"name\": \"work\"") == 64);
+    REQUIRE(count_occurrences(trace, "\"name\": \"worker \\\"1\\\"\"") == 1);
+    REQUIRE(count_occurrences(trace, "\"tid\": 2") == 65);
+    REQUIRE(trace.find("not traced") == std::string::npos);
+    size_t ts = trace.find("\"ts\": ") + 6;
+    size_t dot = trace.find_first_not_of("0123456789", ts);
+    REQUIRE(dot > ts);
+    REQUIRE(trace[dot] == '.');
+    REQUIRE(trace.find_first_not_of("0123456789", dot + 1) == dot + 4);
+
+    cixl_trace_free();
+    REQUIRE_FALSE(cixl_trace_dump("test_trace.json"));
+    remove("test_trace.json");
+}
+
+TEST_CASE("perf counters", "should count the sections when available and degrade gracefully when not")
+{
+    //Arrange
+    cixl_init_screen_buffer(80, 25, &X);
+    unsigned int available = cixl_perf_open();
+    REQUIRE(cixl_perf_available() == available);
+    REQUIRE(std::string(cixl_perf_counter_name(CIXL_PERF_BRANCH_MISSES)) == "branch_misses");
+
+    //Act
+    bool started = cixl_perf_sections_start();
+    cixl_put(1, 1, CIXL_Cxl{'A', CIXL_Color_Red, 0, 0});
+    cixl_put(2, 1, CIXL_Cxl{'B', CIXL_Color_Red, 0, 0});
+    cixl_print(0, 2, "hello", CIXL_Color_Red, 0, 0);
+    cixl_render();
+    cixl_perf_sections_stop();
+    cixl_put(3, 1, CIXL_Cxl{'C', CIXL_Color_Red, 0, 0});
+
+    //Assert
+    REQUIRE(started == (available != 0));
+    if (started)
+    {
+        REQUIRE(cixl_perf_section(CIXL_PERF_SECTION_PUT).calls == 2);
+        REQUIRE(cixl_perf_section(CIXL_PERF_SECTION_PRINT).calls == 1);
+        REQUIRE(cixl_perf_section(CIXL_PERF_SECTION_RENDER).calls == 1);
+        if (available & CIXL_PERF_BIT(CIXL_PERF_INSTRUCTIONS))
+        {
+            REQUIRE(cixl_perf_section(CIXL_PERF_SECTION_RENDER).counters.values[CIXL_PERF_INSTRUCTIONS] > 0);
+        }
+    }
+    else
+    {
+        //nothing is counted, all counters read 0
+        REQUIRE(cixl_perf_section(CIXL_PERF_SECTION_PUT).calls == 0);
+        REQUIRE(cixl_perf_read().values[CIXL_PERF_CYCLES] == 0);
+    }
+    REQUIRE(cixl_perf_section(CIXL_PERF_SECTION_COUNT).calls == 0);
+
+    cixl_perf_close();
+    REQUIRE(cixl_perf_available() == 0);
+}
+
+TEST_CASE("game on the virtual clock", "should progress exactly one fixed step per tick without waiting")
+{
+    //Arrange
+    bool should_exit = false;
+    cixl_time_virtual_set(1000);
+    cixl_game_set_time_source(cixl_time_virtual, CIXL_VIRTUAL_TICKS_PER_SECOND);
+    REQUIRE(cixl_game_init(NULL) == 1);
+    CIXL_Ticks start_ticks = CURRENT_GAME_TIME.total_game_time_ticks;
+    uint64_t   start_ns    = cixl_monotonic_ns();
+
+    //Act
+    for (int i = 0; i < 1000; ++i)
+    {
+        REQUIRE(cixl_game_tick(&CURRENT_GAME_TIME, NULL, &should_exit) == 1);
+    }
+
+    //Assert
+    REQUIRE(CURRENT_GAME_TIME.step_count == 1);
+    REQUIRE(CURRENT_GAME_TIME.total_game_time_ticks - start_ticks ==
+            1000 * ms_to_ticks(16, CIXL_VIRTUAL_TICKS_PER_SECOND));
+    REQUIRE(cixl_time_virtual() == 1000 + 1000 * ms_to_ticks(16, CIXL_VIRTUAL_TICKS_PER_SECOND));
+    //16 seconds of game time, without sleeping
+    REQUIRE(cixl_monotonic_ns() - start_ns < 1000000000u);
+
+    cixl_game_set_time_source(cixl_time_monotonic, CIXL_MONOTONIC_TICKS_PER_SECOND);
+}
+
+static void simulate_test_update(const CIXL_GameTime *game_time, void *shared_state)
+{
+    if (++*(int *) shared_state == 500)
+    {
+        cixl_game_exit();
+    }
+    REQUIRE(game_time->elapsed_game_time_ms == 16);
+}
+
+TEST_CASE("simulate a game headless", "should do the updates back to back and draw every n updates")
+{
+    //Arrange
+    CIXL_Game            game    = *cixl_game_create();
+    CIXL_GameContext     ctx;
+    CIXL_SimulationStats stats;
+    int                  updates = 0;
+    CTX_TEST_NOW          = 0;
+    CTX_TEST_DRAWS        = 0;
+    game.f_time_source    = ctx_test_time;
+    game.ticks_per_second = 1000;
+    game.f_update_game    = ctx_test_update;
+    game.f_draw_game      = ctx_test_draw;
+    REQUIRE(cixl_game_init_ctx(&ctx, &game, &updates) == 1);
+
+    //Act
+    REQUIRE(cixl_game_simulate_ctx(&ctx, 1000, 10, &stats) == 1);
+
+    //Assert
+    REQUIRE(updates == 1000);
+    REQUIRE(CTX_TEST_DRAWS == 100);
+    REQUIRE(stats.updates == 1000);
+    REQUIRE(stats.draws == 100);
+    REQUIRE(stats.updates_per_second > 0.0);
+    REQUIRE(ctx.game_time.total_game_time_ticks == 16000);
+
+    //the clock did not move, so a normal tick afterwards is not due
+    REQUIRE(cixl_game_tick_ctx(&ctx) == 0);
+    REQUIRE(cixl_game_simulate_ctx(&ctx, 5, 0, nullptr) == 1);
+    REQUIRE(updates == 1005);
+    REQUIRE(CTX_TEST_DRAWS == 100);
+
+    cixl_game_exit_ctx(&ctx);
+    REQUIRE(cixl_game_simulate_ctx(&ctx, 5, 1, &stats) == 0);
+    REQUIRE(stats.updates == 0);
+    REQUIRE(updates == 1005);
+}
+
+TEST_CASE("simulate the global game headless", "should stop when the game exits")
+{
+    //Arrange
+    CIXL_SimulationStats stats;
+    int                  updates = 0;
+    CIXL_Game            *game   = cixl_game_create();
+    game->f_update_game = simulate_test_update;
+    REQUIRE(cixl_game_init(&updates) == 1);
+    CIXL_Ticks start_ticks = CURRENT_GAME_TIME.total_game_time_ticks;
+
+    //Act
+    REQUIRE(cixl_game_simulate(1000, 0, &stats) == 0);
+
+    //Assert
+    REQUIRE(updates == 500);
+    REQUIRE(stats.updates == 500);
+    REQUIRE(stats.draws == 0);
+    REQUIRE(CURRENT_GAME_TIME.total_game_time_ticks - start_ticks == 500 * ms_to_ticks(16, CIXL_MONOTONIC_TICKS_PER_SECOND));
+    game->f_update_game = NULL;
+}
+
+typedef struct InputLogTestState
+{
+    int      updates;
+    int      draws;
+    uint64_t checksum;
+} InputLogTestState;
+
+static void input_log_test_update(const CIXL_GameTime *game_time, void *shared_state)
+{
+    InputLogTestState *state = (InputLogTestState *) shared_state;
+    CIXL_InputEvent   event;
+
+    ++state->updates;
+    while (cixl_input_poll(game_time, &event))
+    {
+        state->checksum = (state->checksum * 31u) + event.code + (uint32_t) event.x + game_time->total_game_time_ticks;
+        if (event.type == CIXL_INPUT_PASTE)
+        {
+            char   text[16];
+            size_t size = cixl_input_paste(text, sizeof(text));
+            for (size_t i = 0; i < size; ++i)
+            {
+                state->checksum = (state->checksum * 31u) + (uint8_t) text[i];
+            }
+        }
+    }
+    state->checksum = (state->checksum * 31u) + cixl_random() + (uint64_t) game_time->step_count;
+}
+
+static void input_log_test_draw(const CIXL_GameTime *, void *shared_state)
+{
+    ++((InputLogTestState *) shared_state)->draws;
+}
+
+TEST_CASE("record and replay input", "should do the same updates and draws with the same input and random numbers")
+{
+    //Arrange
+    InputLogTestState recorded = {0, 0, 0};
+    InputLogTestState replayed = {0, 0, 0};
+    bool              should_exit = false;
+    CIXL_Game         *game       = cixl_game_create();
+    game->f_update_game           = input_log_test_update;
+    game->f_draw_game             = input_log_test_draw;
+    game->target_draw_time_millis = 33;
+
+    cixl_time_virtual_set(5000);
+    cixl_game_set_time_source(cixl_time_virtual, CIXL_VIRTUAL_TICKS_PER_SECOND);
+    REQUIRE(cixl_input_record_start("test_input.cxi", 42));
+    REQUIRE_FALSE(cixl_input_record_start("test_input.cxi", 42));
+    REQUIRE(cixl_game_init(&recorded) == 1);
+
+    for (int i = 0; i < 100; ++i)
+    {
+        if (i % 7 == 0)
+        {
+            CIXL_InputEvent event{CIXL_INPUT_KEY, 0, (uint32_t) ('a' + (i % 26)), -i, i};
+            REQUIRE(cixl_input_push(&event));
+            REQUIRE(cixl_input_push(&event));
+        }
+        if (i == 50)
+        {
+            CIXL_InputEvent paste{CIXL_INPUT_PASTE, 0, 6, 0, 0};
+            REQUIRE_FALSE(cixl_input_push(&paste));
+            REQUIRE(cixl_input_push_paste("pasted", 6));
+        }
+        if (i % 10 == 0)
+        {
+            //a stall: the next tick catches up with multiple updates
+            cixl_time_virtual_advance(ms_to_ticks(50, CIXL_VIRTUAL_TICKS_PER_SECOND));
+        }
+        REQUIRE(cixl_game_tick(&CURRENT_GAME_TIME, &recorded, &should_exit) == 1);
+    }
+    REQUIRE(cixl_input_log_stats().ticks == 100);
+    REQUIRE(cixl_input_log_stats().events == 31);
+    REQUIRE(cixl_input_record_stop());
+    REQUIRE_FALSE(cixl_input_record_stop());
+    REQUIRE(recorded.updates > 100);
+
+    //Act
+    REQUIRE(cixl_input_replay_start("test_input.cxi"));
+    REQUIRE(cixl_game_init(&replayed) == 1);
+    CIXL_InputEvent live{CIXL_INPUT_KEY, 0, 'z', 0, 0};
+    REQUIRE_FALSE(cixl_input_push(&live));
+    REQUIRE_FALSE(cixl_input_push_paste("live", 4));
+    REQUIRE(cixl_game_run() == 1);
+
+    //Assert
+    REQUIRE(replayed.updates == recorded.updates);
+    REQUIRE(replayed.draws == recorded.draws);
+    REQUIRE(replayed.checksum == recorded.checksum);
+    REQUIRE(cixl_input_log_stats().ticks == 100);
+    REQUIRE(cixl_input_log_stats().events == 31);
+
+    cixl_input_replay_stop();
+    REQUIRE_FALSE(cixl_input_replay_start("does_not_exist.cxi"));
+    cixl_game_set_time_source(cixl_time_monotonic, CIXL_MONOTONIC_TICKS_PER_SECOND);
+    game->f_update_game           = NULL;
+    game->f_draw_game             = NULL;
+    game->target_draw_time_millis = 0;
+    remove("test_input.cxi");
+}
+
+TEST_CASE("random generator", "should give the same numbers for the same seed")
+{
+    uint32_t first[8];
+    cixl_random_seed(7);
+    for (int i = 0; i < 8; ++i)
+    {
+        first[i] = cixl_random();
+    }
+    cixl_random_seed(7);
+    for (int i = 0; i < 8; ++i)
+    {
+        REQUIRE(cixl_random() == first[i]);
+    }
+    REQUIRE(first[0] != first[1]);
+}
+
+static std::vector<CIXL_InputEvent> term_input_take_all()
+{
+    std::vector<CIXL_InputEvent> events;
+    CIXL_InputEvent              event;
+    while (cixl_term_input_next(&event))
+    {
+        events.push_back(event);
+    }
+    return events;
+}
+
+TEST_CASE("term input keys", "should parse characters, control keys and CSI and SS3 key sequences")
+{
+    //Arrange
+    cixl_term_input_reset();
+    const char input[] = "a\r\x01\x7f" "\033[A" "\033[1;5C" "\033OP" "\033[3~" "\033[24;2~" "\033x" "\xc3\xa9" "\033[Z";
+
+    //Act
+    size_t count = cixl_term_input_feed(input, sizeof(input) - 1);
+    auto   events = term_input_take_all();
+
+    //Assert
+    REQUIRE(count == 12);
+    REQUIRE(events.size() == 12);
+    REQUIRE(events[0].type == CIXL_INPUT_KEY);
+    REQUIRE(events[0].code == 'a');
+    REQUIRE(events[1].code == '\r');
+    REQUIRE(events[2].code == 'a');
+    REQUIRE(events[2].modifiers == CIXL_MOD_CTRL);
+    REQUIRE(events[3].code == 127);
+    REQUIRE(events[4].code == CIXL_KEY_UP);
+    REQUIRE(events[4].modifiers == 0);
+    REQUIRE(events[5].code == CIXL_KEY_RIGHT);
+    REQUIRE(events[5].modifiers == CIXL_MOD_CTRL);
+    REQUIRE(events[6].code == CIXL_KEY_F1);
+    REQUIRE(events[7].code == CIXL_KEY_DELETE);
+    REQUIRE(events[8].code == CIXL_KEY_F1 + 11);
+    REQUIRE(events[8].modifiers == CIXL_MOD_SHIFT);
+    REQUIRE(events[9].code == 'x');
+    REQUIRE(events[9].modifiers == CIXL_MOD_ALT);
+    REQUIRE(events[10].code == 0xE9);
+    REQUIRE(events[11].code == CIXL_KEY_BACK_TAB);
+}
+
+TEST_CASE("term input escape", "should take a lone escape as the escape key, and keep a split sequence")
+{
+    cixl_term_input_reset();
+    REQUIRE(cixl_term_input_feed("\033", 1) == 1);
+    REQUIRE(cixl_term_input_feed("\033\033", 2) == 2);
+
+    //a sequence that is split over two reads
+    cixl_term_input_reset();
+    REQUIRE(cixl_term_input_feed("\033[1;", 4) == 0);
+    REQUIRE(cixl_term_input_feed("2B", 2) == 1);
+    auto events = term_input_take_all();
+    REQUIRE(events.size() == 1);
+    REQUIRE(events[0].code == CIXL_KEY_DOWN);
+    REQUIRE(events[0].modifiers == CIXL_MOD_SHIFT);
+}
+
+TEST_CASE("term input mouse", "should parse SGR mouse reports")
+{
+    //Arrange
+    cixl_term_input_reset();
+    const char input[] = "\033[<0;10;5M" "\033[<32;11;5M" "\033[<0;11;5m" "\033[<65;1;1M" "\033[<18;80;25M";
+
+    //Act
+    auto count  = cixl_term_input_feed(input, sizeof(input) - 1);
+    auto events = term_input_take_all();
+
+    //Assert
+    REQUIRE(count == 5);
+    REQUIRE(events[0].type == CIXL_INPUT_MOUSE);
+    REQUIRE(events[0].code == CIXL_MOUSE_LEFT);
+    REQUIRE(events[0].x == 9);
+    REQUIRE(events[0].y == 4);
+    REQUIRE(events[1].code == (CIXL_MOUSE_LEFT | CIXL_MOUSE_MOTION));
+    REQUIRE(events[1].x == 10);
+    REQUIRE(events[2].code == (CIXL_MOUSE_LEFT | CIXL_MOUSE_RELEASED));
+    REQUIRE(events[3].code == CIXL_MOUSE_WHEEL_DOWN);
+    REQUIRE(events[4].code == CIXL_MOUSE_RIGHT);
+    REQUIRE(events[4].modifiers == CIXL_MOD_CTRL);
+    REQUIRE(events[4].x == 79);
+    REQUIRE(events[4].y == 24);
+}
+
+TEST_CASE("term input bracketed paste", "should deliver a large paste in a few events, not one per character")
+{
+    //Arrange
+    cixl_term_input_reset();
+    std::string text;
+    for (int i = 0; i < 10000; ++i)
+    {
+        text += (char) ('a' + (i % 26));
+    }
+    text += "\033[2 not the end \033[201";
+    std::string input = "x\033[200~" + text + "\033[201~y";
+
+    //Act
+    auto count = cixl_term_input_feed(input.c_str(), input.size());
+
+    //Assert
+    REQUIRE(count == 5); //x, 3 chunks and y
+    CIXL_InputEvent event;
+    REQUIRE(cixl_term_input_next(&event));
+    REQUIRE(event.code == 'x');
+    std::string pasted;
+    char        buffer[1000];
+    while (cixl_term_input_next(&event) && event.type == CIXL_INPUT_PASTE)
+    {
+        REQUIRE(event.code <= CIXL_TERM_INPUT_PASTE_CHUNK_SIZE);
+        size_t copied;
+        while ((copied = cixl_term_input_paste(buffer, sizeof(buffer))) > 0)
+        {
+            pasted.append(buffer, copied);
+        }
+    }
+    REQUIRE(pasted == text);
+    REQUIRE(event.type == CIXL_INPUT_KEY);
+    REQUIRE(event.code == 'y');
+
+    //text that is not copied is skipped
+    cixl_term_input_feed("\033[200~skipped\033[201~z", 21);
+    REQUIRE(cixl_term_input_next(&event));
+    REQUIRE(event.type == CIXL_INPUT_PASTE);
+    REQUIRE(cixl_term_input_next(&event));
+    REQUIRE(event.code == 'z');
+    REQUIRE(cixl_term_input_stats().dropped == 0);
+}
+
+TEST_CASE("term input dispatch", "should move the events and pasted text to the input queue")
+{
+    //Arrange
+    cixl_term_input_reset();
+    CIXL_GameTime game_time{};
+    CIXL_InputEvent event;
+    REQUIRE(cixl_term_input_feed("a\033[200~hello\033[201~\033[B", 21) == 3);
+
+    //Act
+    auto dispatched = cixl_term_input_dispatch();
+
+    //Assert
+    REQUIRE(dispatched == 3);
+    REQUIRE_FALSE(cixl_term_input_next(&event));
+    REQUIRE(cixl_input_poll(&game_time, &event));
+    REQUIRE(event.code == 'a');
+    REQUIRE(cixl_input_poll(&game_time, &event));
+    REQUIRE(event.type == CIXL_INPUT_PASTE);
+    REQUIRE(event.code == 5);
+    char text[8];
+    REQUIRE(cixl_input_paste(text, 3) == 3);
+    REQUIRE(cixl_input_paste(&text[3], sizeof(text) - 3) == 2);
+    REQUIRE(std::string(text, 5) == "hello");
+    REQUIRE(cixl_input_paste(text, sizeof(text)) == 0);
+    REQUIRE(cixl_input_poll(&game_time, &event));
+    REQUIRE(event.code == CIXL_KEY_DOWN);
+    REQUIRE_FALSE(cixl_input_poll(&game_time, &event));
+
+    //events that do not fit in the queue stay in the ring
+    for (int i = 0; i < CIXL_INPUT_QUEUE_SIZE + 10; ++i)
+    {
+        cixl_term_input_feed("k", 1);
+    }
+    REQUIRE(cixl_term_input_dispatch() == CIXL_INPUT_QUEUE_SIZE);
+    int polled = 0;
+    while (cixl_input_poll(&game_time, &event))
+    {
+        ++polled;
+    }
+    REQUIRE(cixl_term_input_dispatch() == 10);
+    while (cixl_input_poll(&game_time, &event))
+    {
+        ++polled;
+    }
+    REQUIRE(polled == CIXL_INPUT_QUEUE_SIZE + 10);
+}
+
+TEST_CASE("term input ring", "should hand events from a reader thread to the update thread")
+{
+    cixl_term_input_reset();
+    uint32_t    received = 0;
+    uint32_t    expected = 0;
+    std::thread producer([]()
+                         {
+                             for (int i = 0; i < 20000; ++i)
+                             {
+                                 char key = (char) ('a' + (i % 26));
+                                 while (cixl_term_input_stats().events - (uint64_t) i == 0 &&
+                                        cixl_term_input_feed(&key, 1) == 0)
+                                 {
+                                     std::this_thread::yield();
+                                 }
+                             }
+                         });
+    CIXL_InputEvent event;
+    while (received < 20000)
+    {
+        if (cixl_term_input_next(&event))
+        {
+            REQUIRE(event.code == (uint32_t) ('a' + (expected % 26)));
+            ++expected;
+            ++received;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    REQUIRE(received == 20000);
+}
+
+#if defined(__unix__)
+TEST_CASE("term input read", "should read everything that is available from a non blocking file descriptor")
+{
+    //Arrange
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    cixl_term_input_reset();
+    REQUIRE(cixl_term_input_start(fds[0], -1, CIXL_TERM_INPUT_PASTE));
+    REQUIRE_FALSE(cixl_term_input_start(fds[0], -1, 0));
+
+    //Act & Assert
+    REQUIRE(cixl_term_input_read() == 0); //does not block
+    REQUIRE(write(fds[1], "ab\033[D\033", 6) == 6);
+    REQUIRE(cixl_term_input_read() == 3);
+    REQUIRE(cixl_term_input_stats().bytes == 6);
+    auto events = term_input_take_all();
+    REQUIRE(events.size() == 3);
+    REQUIRE(events[2].code == CIXL_KEY_LEFT);
+
+    //the escape at the end is held, it can be the start of a sequence that is split over reads
+    REQUIRE(cixl_term_input_hold_ms() > 0);
+    REQUIRE(cixl_term_input_hold_ms() <= CIXL_TERM_INPUT_ESCAPE_TIMEOUT_MS);
+    REQUIRE(cixl_term_input_read() == 0);
+    REQUIRE(write(fds[1], "[A", 2) == 2);
+    REQUIRE(cixl_term_input_read() == 1);
+    REQUIRE(cixl_term_input_hold_ms() == -1);
+    events = term_input_take_all();
+    REQUIRE(events[0].code == CIXL_KEY_UP);
+    REQUIRE(events[0].modifiers == 0);
+
+    //a lone escape is the escape key after the timeout
+    REQUIRE(write(fds[1], "\033", 1) == 1);
+    REQUIRE(cixl_term_input_read() == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(CIXL_TERM_INPUT_ESCAPE_TIMEOUT_MS + 10));
+    REQUIRE(cixl_term_input_hold_ms() == 0);
+    REQUIRE(cixl_term_input_read() == 1);
+    REQUIRE(cixl_term_input_hold_ms() == -1);
+    events = term_input_take_all();
+    REQUIRE(events[0].code == 27);
+
+    cixl_term_input_stop();
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
+
+#if defined(__linux__)
+/* Reads everything the terminal backend writes to a pty, on its own thread so the backend never blocks on a full pty */
+struct PtyReader
+{
+    int               master_fd;
+    std::atomic<bool> stop{false};
+    std::string       output;
+    std::mutex        output_mutex;
+    std::thread       thread;
+
+    explicit PtyReader(int fd) : master_fd(fd)
+    {
+        thread = std::thread([this]()
+                             {
+                                 char buffer[65536];
+                                 while (!stop)
+                                 {
+                                     struct pollfd in{master_fd, POLLIN, 0};
+                                     if (poll(&in, 1, 10) > 0)
+                                     {
+                                         ssize_t count = read(master_fd, buffer, sizeof(buffer));
+                                         if (count > 0)
+                                         {
+                                             std::lock_guard<std::mutex> lock(output_mutex);
+                                             output.append(buffer, (size_t) count);
+                                         }
+                                     }
+                                 }
+                             });
+    }
+
+    size_t wait_for(const char *text)
+    {
+        for (int i = 0; i < 200; ++i)
+        {
+            {
+                std::lock_guard<std::mutex> lock(output_mutex);
+                size_t                      found = output.find(text);
+                if (found != std::string::npos)
+                {
+                    return found;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return std::string::npos;
+    }
+
+    size_t wait_for_size(size_t expected_size)
+    {
+        for (int i = 0; i < 200; ++i)
+        {
+            {
+                std::lock_guard<std::mutex> lock(output_mutex);
+                if (output.size() >= expected_size)
+                {
+                    return output.size();
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return size();
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        return output.size();
+    }
+
+    ~PtyReader()
+    {
+        stop = true;
+        thread.join();
+    }
+};
+
+static void pty_set_size(int master_fd, unsigned short width, unsigned short height)
+{
+    struct winsize size{};
+    size.ws_col = width;
+    size.ws_row = height;
+    REQUIRE(ioctl(master_fd, TIOCSWINSZ, &size) == 0);
+}
+
+TEST_CASE("linux terminal backend on a pty", "should set up and restore the terminal, render, read input and resize")
+{
+    //Arrange
+    int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    REQUIRE(master_fd >= 0);
+    REQUIRE(grantpt(master_fd) == 0);
+    REQUIRE(unlockpt(master_fd) == 0);
+    int slave_fd = open(ptsname(master_fd), O_RDWR | O_NOCTTY);
+    REQUIRE(slave_fd >= 0);
+    pty_set_size(master_fd, 100, 30);
+    struct termios before{};
+    REQUIRE(tcgetattr(slave_fd, &before) == 0);
+    cixl_term_input_reset();
+
+    {
+        PtyReader reader(master_fd);
+
+        //Act & Assert: start
+        REQUIRE(cixl_linux_term_start(slave_fd, slave_fd, CIXL_TERM_INPUT_PASTE));
+        REQUIRE_FALSE(cixl_linux_term_start(slave_fd, slave_fd, 0));
+        int width, height;
+        cixl_linux_term_size(&width, &height);
+        REQUIRE(width == 100);
+        REQUIRE(height == 30);
+        REQUIRE(reader.wait_for("\033[?1049h") != std::string::npos);
+        REQUIRE(reader.wait_for("\033[?2004h") != std::string::npos);
+        struct termios raw{};
+        REQUIRE(tcgetattr(slave_fd, &raw) == 0);
+        REQUIRE((raw.c_lflag & (ICANON | ECHO)) == 0);
+
+        //render: throughput in frames per second and bytes per frame, from the render stats
+        size_t   start_size = reader.size();
+        uint64_t bytes      = 0;
+        int      frames     = 300;
+        uint64_t start_ns   = cixl_monotonic_ns();
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            char line[32];
+            snprintf(line, sizeof(line), "frame %04d", frame);
+            cixl_print(0, frame % 30, line, CIXL_Color_Green, CIXL_Color_Black, 0);
+            cixl_put(frame % 100, 29, CIXL_Cxl{'#', CIXL_Color_Red, CIXL_Color_Blue, 0});
+            REQUIRE(cixl_render() > 0);
+            bytes += cixl_render_stats().bytes;
+        }
+        double elapsed_s        = (double) (cixl_monotonic_ns() - start_ns) / 1e9;
+        double frames_per_s     = frames / elapsed_s;
+        double bytes_per_frame  = (double) bytes / frames;
+        //the throughput depends on the machine, it is reported and not asserted
+        WARN("pty throughput: " << frames_per_s << " frames/s, " << bytes_per_frame << " bytes/frame");
+        REQUIRE(bytes_per_frame > 10.0);
+        REQUIRE(bytes_per_frame < 100.0);
+        REQUIRE(reader.wait_for("frame 0029") != std::string::npos);
+        REQUIRE(reader.wait_for_size(start_size + bytes) - start_size == bytes);
+
+        //input
+        REQUIRE(cixl_linux_term_poll(0) == 0);
+        REQUIRE(write(master_fd, "\033[Bq", 4) == 4);
+        REQUIRE(cixl_linux_term_poll(1000) == 2);
+        CIXL_GameTime   game_time{};
+        CIXL_InputEvent event;
+        REQUIRE_FALSE(cixl_term_input_next(&event));
+        REQUIRE(cixl_input_poll(&game_time, &event));
+        REQUIRE(event.code == CIXL_KEY_DOWN);
+        REQUIRE(cixl_input_poll(&game_time, &event));
+        REQUIRE(event.code == 'q');
+
+        //probe, the answers of the terminal with a key pressed in between, and the last one split over two reads
+        const char answers[] = "\033[?2026;2$yz\033";
+        REQUIRE(write(master_fd, answers, sizeof(answers) - 1) == (ssize_t) (sizeof(answers) - 1));
+        std::thread rest_of_answer([master_fd]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            REQUIRE(write(master_fd, "[?62;22c", 8) == 8);
+        });
+        unsigned int caps = cixl_linux_term_probe(1000);
+        rest_of_answer.join();
+        REQUIRE((caps & CIXL_VT_CAP_SYNC_OUTPUT) != 0);
+        REQUIRE((caps & CIXL_VT_CAP_ECH) != 0);
+        REQUIRE(cixl_vt_capabilities() == caps);
+        REQUIRE(reader.wait_for(CIXL_VT_CAPS_QUERY) != std::string::npos);
+        REQUIRE(cixl_linux_term_poll(0) == 0);
+        REQUIRE(cixl_input_poll(&game_time, &event));
+        REQUIRE(event.code == 'z');
+        REQUIRE_FALSE(cixl_input_poll(&game_time, &event));
+        REQUIRE(cixl_put(0, 0, CIXL_Cxl{'S', CIXL_Color_Red, CIXL_Color_Black, 0}));
+        REQUIRE(cixl_render() == 1);
+        size_t frame_end = reader.wait_for("S\033[?2026l");
+        REQUIRE(frame_end != std::string::npos);
+        REQUIRE(reader.wait_for("\033[?2026h") < frame_end);
+
+        //resize, the signal is only sent to the foreground process of a controlling terminal, so raise it
+        REQUIRE_FALSE(cixl_linux_term_check_resize());
+        pty_set_size(master_fd, 120, 40);
+        raise(SIGWINCH);
+        REQUIRE(cixl_linux_term_check_resize());
+        REQUIRE_FALSE(cixl_linux_term_check_resize());
+        cixl_linux_term_size(&width, &height);
+        REQUIRE(width == 120);
+        REQUIRE(height == 40);
+        REQUIRE(cixl_put(119, 39, CIXL_Cxl{'E', CIXL_Color_Red, CIXL_Color_Black, 0}));
+        REQUIRE(cixl_render() == 1);
+
+        //stop
+        cixl_linux_term_stop();
+        REQUIRE(reader.wait_for("\033[?1049l") != std::string::npos);
+        REQUIRE(reader.wait_for("\033[?2004l") != std::string::npos);
+    }
+
+    struct termios after{};
+    REQUIRE(tcgetattr(slave_fd, &after) == 0);
+    REQUIRE(after.c_lflag == before.c_lflag);
+    REQUIRE(after.c_iflag == before.c_iflag);
+    REQUIRE((fcntl(slave_fd, F_GETFL) & O_NONBLOCK) == 0);
+    close(slave_fd);
+    close(master_fd);
+}
+#endif
+TEST_CASE("vt capabilities", "should come from the profile and the answers of the terminal")
+{
+    //Arrange & Act & Assert: profiles
+    REQUIRE(cixl_vt_caps_profile(NULL, NULL) == CIXL_VT_CAPS_NONE);
+    REQUIRE(cixl_vt_caps_profile("dumb", NULL) == CIXL_VT_CAPS_NONE);
+    REQUIRE(cixl_vt_caps_profile("vt100", NULL) == CIXL_VT_CAP_SCROLL_MARGINS);
+    REQUIRE((cixl_vt_caps_profile("xterm-256color", NULL) & CIXL_VT_CAP_256_COLORS) != 0);
+    REQUIRE((cixl_vt_caps_profile("xterm-256color", NULL) & CIXL_VT_CAP_TRUECOLOR) == 0);
+    REQUIRE((cixl_vt_caps_profile("xterm-256color", "truecolor") & CIXL_VT_CAP_TRUECOLOR) != 0);
+    REQUIRE((cixl_vt_caps_profile("xterm-kitty", NULL) & CIXL_VT_CAP_SYNC_OUTPUT) != 0);
+
+    //the answers, split in parts and mixed with input
+    CIXL_VtCapsProbe probe;
+    cixl_vt_caps_probe_init(&probe, CIXL_VT_CAPS_NONE);
+    char first[] = "a\033[?2026;1$y";
+    REQUIRE(cixl_vt_caps_parse_reply(&probe, first, sizeof(first) - 1) == 1);
+    REQUIRE(first[0] == 'a');
+    REQUIRE(probe.caps == CIXL_VT_CAP_SYNC_OUTPUT);
+    REQUIRE_FALSE(probe.done);
+    char second[] = "\033[A\033[?64;1;22cb";
+    REQUIRE(cixl_vt_caps_parse_reply(&probe, second, sizeof(second) - 1) == 4);
+    REQUIRE(std::string(second, 4) == "\033[Ab");
+    REQUIRE(probe.done);
+    REQUIRE(probe.level == 64);
+    REQUIRE(probe.caps == (CIXL_VT_CAP_SYNC_OUTPUT | CIXL_VT_CAP_ECH | CIXL_VT_CAP_SCROLL_MARGINS));
+
+    //a mode the terminal does not know removes the capability of the profile
+    cixl_vt_caps_probe_init(&probe, CIXL_VT_CAP_SYNC_OUTPUT | CIXL_VT_CAP_REP);
+    char unknown[] = "\033[?2026;0$y\033[?1;2c";
+    REQUIRE(cixl_vt_caps_parse_reply(&probe, unknown, sizeof(unknown) - 1) == 0);
+    REQUIRE(probe.done);
+    REQUIRE(probe.caps == (CIXL_VT_CAP_REP | CIXL_VT_CAP_SCROLL_MARGINS));
+
+    //the start of a reply at the end has to wait for the rest
+    REQUIRE(cixl_vt_caps_partial_reply("a\033[?62;2", 8) == 7);
+    REQUIRE(cixl_vt_caps_partial_reply("\033[?2026;2$", 10) == 10);
+    REQUIRE(cixl_vt_caps_partial_reply("\033", 1) == 1);
+    REQUIRE(cixl_vt_caps_partial_reply("\033[?62;22c", 10) == 0);
+    REQUIRE(cixl_vt_caps_partial_reply("\033[A", 3) == 0);
+    REQUIRE(cixl_vt_caps_partial_reply("abc", 3) == 0);
+}
+
+TEST_CASE("vt device synchronized output", "should wrap each frame with output in synchronized update brackets")
+{
+    //Arrange
+    VT_OUTPUT.clear();
+    cixl_init_screen_buffer(80, 25, cixl_vt_device(vt_write_to_string));
+    cixl_vt_set_capabilities(CIXL_VT_CAP_SYNC_OUTPUT);
+    cixl_print(2, 1, "AB", CIXL_Color_Red, CIXL_Color_Black, 0);
+
+    //Act
+    cixl_render();
+
+    //Assert
+    REQUIRE(VT_OUTPUT == "\033[?2026h\033[2;3H\033[0;31;40mAB\033[?2026l");
+    REQUIRE(cixl_render_stats().bytes == VT_OUTPUT.size());
+
+    //a frame without changes writes nothing at all
+    VT_OUTPUT.clear();
+    cixl_render();
+    REQUIRE(VT_OUTPUT.empty());
+
+    cixl_vt_set_capabilities(CIXL_VT_CAPS_NONE);
+    cixl_print(4, 1, "C", CIXL_Color_Red, CIXL_Color_Black, 0);
+    cixl_render();
+    REQUIRE(VT_OUTPUT == "C");
+}
+TEST_CASE("vt device run compression", "should repeat runs with REP and erase blank runs with ECH and EL")
+{
+    //Arrange
+    cixl_init_screen_buffer(40, 5, cixl_vt_device(vt_write_to_string));
+    cixl_vt_set_capabilities(CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE);
+    //text at the end of the lines, so erasing the whole lines does not pay off
+    cixl_print(20, 1, "zzzzzzzzzzzzzzzzzzzz", CIXL_Color_Grey, CIXL_Color_Black, 0);
+    cixl_print(20, 2, "zzzzzzzzzzzzzzzzzzzz", CIXL_Color_Grey, CIXL_Color_Black, 0);
+    cixl_render();
+    VT_OUTPUT.clear();
+    cixl_print(0, 0, "##########..........", CIXL_Color_Yellow, CIXL_Color_Black, 0);
+    cixl_print(0, 1, "ab            cd", CIXL_Color_Grey, CIXL_Color_Black, 0);
+    cixl_print(30, 2, "          ", CIXL_Color_Grey, CIXL_Color_Blue, 0);
+
+    //Act
+    cixl_render();
+
+    //Assert: a run is only replaced when that is shorter
+    REQUIRE(VT_OUTPUT == "\033[1;1H\033[33m#\033[9b.\033[9b"
+                         "\033[2;1H\033[37mab\033[12X\033[12Ccd"
+                         "\033[3;31H\033[44m\033[K");
+
+    //short runs and blanks with attributes are written as they are
+    VT_OUTPUT.clear();
+    cixl_print(0, 3, "xxx    ", CIXL_Color_Grey, CIXL_Color_Black, underline);
+    cixl_render();
+    REQUIRE(VT_OUTPUT == "\033[4;1H\033[0;4;37;40mxxx    ");
+
+    //the same output without the capabilities
+    VT_OUTPUT.clear();
+    cixl_vt_set_capabilities(CIXL_VT_CAPS_NONE);
+    cixl_print(0, 4, "=====", CIXL_Color_Grey, CIXL_Color_Black, 0);
+    cixl_render();
+    REQUIRE(VT_OUTPUT == "\033[5;1H\033[0;37;40m=====");
+}
+
+TEST_CASE("vt device run compression rendered by the vt model equals the screen buffer", "should be equal and smaller")
+{
+    //Arrange: a map of rooms, drawn at once like a new level
+    uint64_t bytes[2];
+    int      first_difference;
+
+    for (int with_runs = 0; with_runs < 2; ++with_runs)
+    {
+        VT_MODEL = cixl_vt_model_create(80, 25);
+        REQUIRE(VT_MODEL != nullptr);
+        cixl_init_screen_buffer(80, 25, cixl_vt_device(vt_write_to_model));
+        cixl_vt_set_capabilities(with_runs ? CIXL_VT_CAP_REP | CIXL_VT_CAP_ECH | CIXL_VT_CAP_BCE : CIXL_VT_CAPS_NONE);
+        bytes[with_runs] = 0;
+
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            //Act
+            cixl_clear_area(0, 0, 80, 25);
+            for (int room = 0; room < 4; ++room)
+            {
+                int x      = (frame * 7 + room * 19) % 60;
+                int y      = (frame + room * 5) % 18;
+                int width  = 10 + (frame + room) % 10;
+                int height = 4 + room;
+                for (int row = y; row < y + height && row < 25; ++row)
+                {
+                    bool is_wall = row == y || row == y + height - 1;
+                    for (int column = x; column < x + width && column < 80; ++column)
+                    {
+                        bool     wall = is_wall || column == x || column == x + width - 1;
+                        CIXL_Cxl cell{wall ? '#' : '.', (CIXL_Color) (wall ? CIXL_Color_Yellow : CIXL_Color_Grey),
+                                      CIXL_Color_Black, 0};
+                        cixl_put(column, row, cell);
+                    }
+                }
+            }
+            cixl_print(0, 24, "HP: 10/10                                                             ",
+                       CIXL_Color_White_Bright, (CIXL_Color) (frame % 8), 0);
+            cixl_render();
+            bytes[with_runs] += cixl_render_stats().bytes;
+
+            //Assert
+            INFO("frame " << frame << " with runs " << with_runs);
+            REQUIRE(cixl_vt_model_compare_screen(VT_MODEL, &first_difference) == 0);
+            REQUIRE(first_difference == -1);
+        }
+
+        cixl_vt_model_free(VT_MODEL);
+        VT_MODEL = nullptr;
+    }
+    cixl_vt_set_capabilities(CIXL_VT_CAPS_NONE);
+
+    WARN("bytes without runs: " << bytes[0] << " with runs: " << bytes[1]);
+    REQUIRE(bytes[1] * 10 < bytes[0] * 9);
+}
+TEST_CASE("render erases the screen and lines that became empty", "should erase and only draw what is left")
+{
+    //Arrange: a full screen of text
+    int first_difference;
+
+    VT_MODEL = cixl_vt_model_create(80, 25);
+    REQUIRE(VT_MODEL != nullptr);
+    cixl_init_screen_buffer(80, 25, cixl_vt_device(vt_write_to_model));
+    cixl_vt_set_capabilities(CIXL_VT_CAP_BCE);
+    for (int y = 0; y < 25; ++y)
+    {
+        cixl_print(0, y, "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the l",
+                   CIXL_Color_Grey, CIXL_Color_Black, 0);
+    }
+    cixl_render();
+    REQUIRE(cixl_render_stats().erases == 0);
+
+    //Act: a scene change to an empty blue screen with a title
+    cixl_clear_area(0, 0, 80, 25);
+    for (int y = 0; y < 25; ++y)
+    {
+        cixl_print(0, y, "                                                                                ",
+                   CIXL_Color_Grey, CIXL_Color_Blue, 0);
+    }
+    cixl_print(35, 12, "LEVEL 2", CIXL_Color_White_Bright, CIXL_Color_Blue, 0);
+    cixl_render();
+
+    //Assert
+    CIXL_RenderStats stats = cixl_render_stats();
+    WARN("scene change: " << stats.bytes << " bytes");
+    REQUIRE(stats.erases == 1);
+    REQUIRE(stats.cells_erased == 80 * 25 - 6);
+    REQUIRE(stats.cells_dirty == 6);
+    REQUIRE(stats.bytes < 50);
+    REQUIRE(cixl_vt_model_compare_screen(VT_MODEL, &first_difference) == 0);
+
+    //Act: one line becomes empty, except for a few cells that did not change
+    cixl_print(0, 3, "#### a line with some text on it that will be removed again, but not all of it ##",
+               CIXL_Color_Yellow, CIXL_Color_Blue, 0);
+    cixl_render();
+    cixl_print(4, 3, "                                                                            ",
+               CIXL_Color_Grey, CIXL_Color_Blue, 0);
+    cixl_render();
+
+    //Assert: the line is erased, and the cells that were wiped are drawn again
+    stats = cixl_render_stats();
+    REQUIRE(stats.erases == 1);
+    REQUIRE(stats.cells_dirty == 4);
+    REQUIRE(stats.bytes < 50);
+    REQUIRE(cixl_vt_model_compare_screen(VT_MODEL, &first_difference) == 0);
+
+    //a few empty cells are drawn as they are
+    cixl_clear_area(35, 12, 2, 0);
+    cixl_render();
+    REQUIRE(cixl_render_stats().erases == 0);
+    REQUIRE(cixl_vt_model_compare_screen(VT_MODEL, &first_difference) == 0);
+
+    //without background color erase nothing is erased
+    cixl_vt_set_capabilities(CIXL_VT_CAPS_NONE);
+    cixl_clear_area(0, 0, 80, 25);
+    cixl_render();
+    REQUIRE(cixl_render_stats().erases == 0);
+    REQUIRE(cixl_render_stats().bytes > 80 * 25);
+    REQUIRE(cixl_vt_model_compare_screen(VT_MODEL, &first_difference) == 0);
+
+    cixl_vt_model_free(VT_MODEL);
+    VT_MODEL = nullptr;
+}
+
+static uint32_t read_be32(const uint8_t *bytes)
+{
+    return ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) | ((uint32_t) bytes[2] << 8) | bytes[3];
+}
+
+/* Inflates a zlib stream of fixed Huffman blocks, which is what cixl_raster_write_png writes */
+static bool inflate_fixed(const std::vector<uint8_t> &in, std::vector<uint8_t> &out)
+{
+    static const int length_base[29]    = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67,
+                                           83, 99, 115, 131, 163, 195, 227, 258};
+    static const int length_extra[29]   = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5,
+                                           5, 5, 0};
+    static const int distance_base[30]  = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513,
+                                           769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static const int distance_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10,
+                                           11, 11, 12, 12, 13, 13};
+    size_t bit = 16;
+    auto   next_bit = [&]() -> int {
+        int value = (in[bit / 8] >> (bit % 8)) & 1;
+        ++bit;
+        return value;
+    };
+    auto   bits = [&](int count) -> int {
+        int value = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            value |= next_bit() << i;
+        }
+        return value;
+    };
+    auto   code = [&](int count) -> int {
+        int value = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            value = (value << 1) | next_bit();
+        }
+        return value;
+    };
+
+    if (in.size() < 6 || in[0] != 0x78 || ((in[0] << 8) | in[1]) % 31 != 0)
+    {
+        return false;
+    }
+
+    bool is_final = false;
+    while (!is_final)
+    {
+        is_final = bits(1) == 1;
+        if (bits(2) != 1)
+        {
+            return false;
+        }
+        while (true)
+        {
+            int symbol = code(7);
+            if (symbol <= 23)
+            {
+                symbol += 256;
+            }
+            else
+            {
+                symbol = (symbol << 1) | next_bit();
+                if (symbol >= 0x30 && symbol <= 0xBF)
+                {
+                    symbol -= 0x30;
+                }
+                else if (symbol >= 0xC0 && symbol <= 0xC7)
+                {
+                    symbol = symbol - 0xC0 + 280;
+                }
+                else
+                {
+                    symbol = ((symbol << 1) | next_bit()) - 0x190 + 144;
+                }
+            }
+
+            if (symbol < 256)
+            {
+                out.push_back((uint8_t) symbol);
+                continue;
+            }
+            if (symbol == 256)
+            {
+                break;
+            }
+            int length         = length_base[symbol - 257] + bits(length_extra[symbol - 257]);
+            int distance_code  = code(5);
+            int distance       = distance_base[distance_code] + bits(distance_extra[distance_code]);
+            if ((size_t) distance > out.size())
+            {
+                return false;
+            }
+            for (int i = 0; i < length; ++i)
+            {
+                out.push_back(out[out.size() - distance]);
+            }
+        }
+    }
+
+    uint32_t adler_a = 1;
+    uint32_t adler_b = 0;
+    for (uint8_t byte : out)
+    {
+        adler_a = (adler_a + byte) % 65521;
+        adler_b = (adler_b + adler_a) % 65521;
+    }
+    return read_be32(&in[(bit + 7) / 8]) == ((adler_b << 16) | adler_a);
+}
+
+TEST_CASE("raster device draws the glyphs of the cells", "should expand the font rows into fg and bg pixels")
+{
+    //Arrange
+    int width_px;
+    int height_px;
+    cixl_init_screen_buffer(10, 4, cixl_raster_device());
+    REQUIRE(cixl_raster_pixels(&width_px, &height_px) == nullptr);
+
+    //Act
+    cixl_print(2, 1, "A", CIXL_Color_White_Bright, CIXL_Color_Blue, 0);
+    cixl_print(3, 1, "B", CIXL_Color_Red, CIXL_Color_Black, invert);
+    cixl_render();
+
+    //Assert
+    const uint8_t *pixels = cixl_raster_pixels(&width_px, &height_px);
+    REQUIRE(pixels != nullptr);
+    REQUIRE(width_px == 10 * CIXL_RASTER_GLYPH_WIDTH);
+    REQUIRE(height_px == 4 * CIXL_RASTER_GLYPH_HEIGHT);
+    for (int row = 0; row < CIXL_RASTER_GLYPH_HEIGHT; ++row)
+    {
+        for (int x = 0; x < CIXL_RASTER_GLYPH_WIDTH; ++x)
+        {
+            bool          is_fg  = (CIXL_CP437_FONT['A'][row] >> x) & 1;
+            const uint8_t *pixel = pixels + ((8 + row) * width_px + 16 + x) * 4;
+            REQUIRE(pixel[0] == (is_fg ? 0xFF : 0x00));
+            REQUIRE(pixel[1] == (is_fg ? 0xFF : 0x00));
+            REQUIRE(pixel[2] == (is_fg ? 0xFF : 0xAA));
+            REQUIRE(pixel[3] == 0xFF);
+
+            bool is_inverted_fg = (CIXL_CP437_FONT['B'][row] >> x) & 1;
+            pixel = pixels + ((8 + row) * width_px + 24 + x) * 4;
+            REQUIRE(pixel[0] == (is_inverted_fg ? 0x00 : 0xAA));
+        }
+    }
+
+    int x;
+    int y;
+    int w;
+    int h;
+    REQUIRE(cixl_raster_dirty_rect(&x, &y, &w, &h));
+    REQUIRE(x == 0);
+    REQUIRE(y == 0);
+    REQUIRE(w == width_px);
+    REQUIRE(h == height_px);
+    REQUIRE_FALSE(cixl_raster_dirty_rect(&x, &y, &w, &h));
+
+    //Act: only the changed cells are drawn again
+    cixl_print(7, 3, "Z", CIXL_Color_Green, CIXL_Color_Black, 0);
+    cixl_print(5, 2, "Y", CIXL_Color_Green, CIXL_Color_Black, 0);
+    cixl_render();
+
+    //Assert
+    REQUIRE(cixl_raster_dirty_rect(&x, &y, &w, &h));
+    REQUIRE(x == 40);
+    REQUIRE(y == 16);
+    REQUIRE(w == 24);
+    REQUIRE(h == 16);
+
+    cixl_print(2, 1, "A", CIXL_Color_White_Bright, CIXL_Color_Blue, 0);
+    cixl_render();
+    REQUIRE_FALSE(cixl_raster_dirty_rect(&x, &y, &w, &h));
+
+    cixl_raster_free();
+}
+
+TEST_CASE("raster device writes PPM and PNG", "should write the framebuffer so that it can be read back")
+{
+    //Arrange
+    int width_px;
+    int height_px;
+    cixl_init_screen_buffer(40, 6, cixl_raster_device());
+    cixl_color_set_rgb(CIXL_Color_Cyan, 0x12, 0x34, 0x56);
+    cixl_print(0, 0, "libcixl raster device", CIXL_Color_Yellow_Bright, CIXL_Color_Black, underline);
+    cixl_print(4, 3, "\xC9\xCD\xCD\xBB \xB0\xB1\xB2\xDB", CIXL_Color_Cyan, CIXL_Color_Blue, 0);
+    cixl_render();
+    const uint8_t *pixels = cixl_raster_pixels(&width_px, &height_px);
+    REQUIRE(pixels != nullptr);
+
+    //Act
+    REQUIRE(cixl_raster_write_ppm("test_raster.ppm"));
+    REQUIRE(cixl_raster_write_png("test_raster.png"));
+
+    //Assert PPM
+    std::string          ppm_file = read_file("test_raster.ppm");
+    std::vector<uint8_t> ppm(ppm_file.begin(), ppm_file.end());
+    std::string          header = "P6\n320 48\n255\n";
+    REQUIRE(ppm.size() == header.size() + 320 * 48 * 3);
+    REQUIRE(std::string(ppm.begin(), ppm.begin() + (long) header.size()) == header);
+    for (int i = 0; i < width_px * height_px; ++i)
+    {
+        REQUIRE(ppm[header.size() + i * 3] == pixels[i * 4]);
+        REQUIRE(ppm[header.size() + i * 3 + 2] == pixels[i * 4 + 2]);
+    }
+
+    //Assert PNG: the chunks, and the pixels after inflating and undoing the filters
+    std::string          png_file = read_file("test_raster.png");
+    std::vector<uint8_t> png(png_file.begin(), png_file.end());
+    REQUIRE(png.size() > 8);
+    REQUIRE(memcmp(png.data(), "\x89PNG\r\n\x1a\n", 8) == 0);
+    REQUIRE(png.size() < (size_t) width_px * height_px);
+    std::vector<uint8_t> idat;
+    std::string          chunk_types;
+    for (size_t at = 8; at + 12 <= png.size();)
+    {
+        uint32_t size = read_be32(&png[at]);
+        uint32_t crc  = 0xFFFFFFFFu;
+        for (size_t i = at + 4; i < at + 8 + size; ++i)
+        {
+            crc ^= png[i];
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 1u) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+            }
+        }
+        REQUIRE((crc ^ 0xFFFFFFFFu) == read_be32(&png[at + 8 + size]));
+        chunk_types += std::string((const char *) &png[at + 4], 4) + " ";
+        if (memcmp(&png[at + 4], "IDAT", 4) == 0)
+        {
+            idat.insert(idat.end(), png.begin() + (long) at + 8, png.begin() + (long) (at + 8 + size));
+        }
+        at += 12 + size;
+    }
+    REQUIRE(chunk_types == "IHDR IDAT IEND ");
+
+    std::vector<uint8_t> raw;
+    REQUIRE(inflate_fixed(idat, raw));
+    REQUIRE(raw.size() == (size_t) (width_px * 4 + 1) * height_px);
+    for (int y = 0; y < height_px; ++y)
+    {
+        uint8_t *row = &raw[(size_t) y * (width_px * 4 + 1)];
+        REQUIRE(row[0] == 1);
+        for (int i = 5; i <= width_px * 4; ++i)
+        {
+            row[i] = (uint8_t) (row[i] + row[i - 4]);
+        }
+        REQUIRE(memcmp(row + 1, pixels + (size_t) y * width_px * 4, (size_t) width_px * 4) == 0);
+    }
+
+    cixl_color_reset_table();
+    cixl_raster_free();
+    remove("test_raster.ppm");
+    remove("test_raster.png");
+}
+static void rgba_to_yuv420(const uint8_t *pixels, const int width, const int height, std::vector<uint8_t> &planes)
+{
+    planes.assign((size_t) width * height * 3 / 2, 0);
+    for (int i = 0; i < width * height; ++i)
+    {
+        const uint8_t *p = pixels + i * 4;
+        planes[i] = (uint8_t) ((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+    }
+    for (int y = 0; y < height / 2; ++y)
+    {
+        for (int x = 0; x < width / 2; ++x)
+        {
+            int rgb[3];
+            for (int c = 0; c < 3; ++c)
+            {
+                const uint8_t *p = pixels + ((y * 2) * width + x * 2) * 4 + c;
+                rgb[c] = (p[0] + p[4] + p[width * 4] + p[width * 4 + 4] + 2) >> 2;
+            }
+            size_t at = (size_t) width * height + (size_t) y * (width / 2) + x;
+            planes[at]                                = (uint8_t) ((-43 * rgb[0] - 85 * rgb[1] + 128 * rgb[2] + 32768) >> 8);
+            planes[at + (size_t) width * height / 4] = (uint8_t) ((128 * rgb[0] - 107 * rgb[1] - 21 * rgb[2] + 32768) >> 8);
+        }
+    }
+}
+
+TEST_CASE("video capture writes Y4M frames", "should convert each captured frame and repeat unchanged frames")
+{
+    //Arrange
+    int width_px;
+    int height_px;
+    cixl_init_screen_buffer(20, 6, cixl_raster_device());
+    for (int y = 0; y < 6; ++y)
+    {
+        cixl_print(0, y, "The quick brown fox!", (CIXL_Color) (y + 9), (CIXL_Color) y, 0);
+    }
+    cixl_render();
+
+    //Act
+    REQUIRE(cixl_video_start("test_video.y4m", 30, CIXL_VIDEO_Y4M));
+    REQUIRE(cixl_video_capture_frame());
+    std::vector<uint8_t> first_frame;
+    const uint8_t        *pixels = cixl_raster_pixels(&width_px, &height_px);
+    rgba_to_yuv420(pixels, width_px, height_px, first_frame);
+
+    cixl_print(7, 3, "\xDB", CIXL_Color_Yellow_Bright, CIXL_Color_Red, 0);
+    cixl_render();
+    REQUIRE(cixl_video_capture_frame());
+    cixl_render();
+    REQUIRE(cixl_video_capture_frame());
+    REQUIRE(cixl_video_stop());
+
+    //Assert
+    CIXL_VideoStats stats = cixl_video_stats();
+    REQUIRE(stats.frames_captured == 3);
+    REQUIRE(stats.frames_written == 3);
+
+    std::vector<uint8_t> last_frame;
+    rgba_to_yuv420(pixels, width_px, height_px, last_frame);
+    REQUIRE(first_frame != last_frame);
+
+    std::string video  = read_file("test_video.y4m");
+    std::string header = "YUV4MPEG2 W160 H48 F30:1 Ip A1:1 C420jpeg\n";
+    size_t      frame  = 6 + first_frame.size();
+    REQUIRE(video.size() == header.size() + 3 * frame);
+    REQUIRE(video.substr(0, header.size()) == header);
+    for (int f = 0; f < 3; ++f)
+    {
+        REQUIRE(video.substr(header.size() + f * frame, 6) == "FRAME\n");
+        std::vector<uint8_t> planes(video.begin() + (long) (header.size() + f * frame + 6),
+                                    video.begin() + (long) (header.size() + (f + 1) * frame));
+        REQUIRE(planes == (f == 0 ? first_frame : last_frame));
+    }
+
+    remove("test_video.y4m");
+}
+
+TEST_CASE("video capture of many frames", "should write every frame and take little time of the game thread")
+{
+    //Arrange
+    int width_px;
+    int height_px;
+    cixl_init_screen_buffer(80, 25, cixl_raster_device());
+    REQUIRE(cixl_video_start("test_video.rgba", 60, CIXL_VIDEO_RAW_RGBA));
+
+    //Act: a mix of small changes and full screen changes, at about the pace of a game
+    char line[81];
+    for (int frame = 0; frame < 120; ++frame)
+    {
+        if (frame % 10 == 0)
+        {
+            for (int y = 0; y < 25; ++y)
+            {
+                sprintf(line, "%-80d", frame * 100 + y);
+                cixl_print(0, y, line, (CIXL_Color) ((frame + y) % 16), (CIXL_Color) (frame / 10 % 8), 0);
+            }
+        }
+        sprintf(line, "frame %04d", frame);
+        cixl_print(frame % 70, frame % 25, line, CIXL_Color_White_Bright, CIXL_Color_Blue, 0);
+        cixl_render();
+        REQUIRE(cixl_video_capture_frame());
+        std::this_thread::sleep_for(std::chrono::milliseconds(4));
+    }
+    REQUIRE(cixl_video_stop());
+
+    //Assert
+    CIXL_VideoStats stats = cixl_video_stats();
+    WARN("capture on the game thread: " << stats.capture_ns_total / stats.frames_captured << " ns per frame, max "
+                                        << stats.capture_ns_max << " ns, " << stats.stalls << " stalls");
+    REQUIRE(stats.frames_captured == 120);
+    REQUIRE(stats.frames_written == 120);
+    REQUIRE(stats.capture_ns_total / stats.frames_captured < 1000000);
+
+    const uint8_t *pixels     = cixl_raster_pixels(&width_px, &height_px);
+    std::string   video       = read_file("test_video.rgba");
+    size_t        frame_bytes = (size_t) width_px * height_px * 4;
+    REQUIRE(video.size() == 120 * frame_bytes);
+    REQUIRE(memcmp(video.data() + 119 * frame_bytes, pixels, frame_bytes) == 0);
+
+    remove("test_video.rgba");
+    cixl_raster_free();
+}
+TEST_CASE("Pack CIXL_Cxl with 256 colors", "should stay 32 bits and keep the 8 bit colors")
+{
+    CIXL_Cxl a{65, 200, 17, 128};
+
+    REQUIRE(sizeof(CIXL_Cxl) == 4);
+    REQUIRE((uint32_t) cixl_pack_cxl(&a) == 0x8011C841u);
+
+    int32_t  int_value = cixl_pack_cxl(&a);
+    CIXL_Cxl unpacked  = cixl_unpack_cxl(&int_value);
+    REQUIRE(unpacked.char_value == 65);
+    REQUIRE(unpacked.fg_color == 200);
+    REQUIRE(unpacked.bg_color == 17);
+    REQUIRE(unpacked.style_opts == 128);
+}
+
+TEST_CASE("vt device writes 256 and 24 bit colors", "should pick 4 bit, 8 bit or 24 bit SGR per capability")
+{
+    //Arrange
+    cixl_init_screen_buffer(20, 5, cixl_vt_device(vt_write_to_string));
+    cixl_color_set_rgb(100, 0x12, 0x34, 0x56);
+
+    //Act: the 256 color palette
+    VT_OUTPUT.clear();
+    cixl_vt_reset_state();
+    cixl_vt_set_capabilities(CIXL_VT_CAP_256_COLORS);
+    cixl_print(0, 0, "A", 200, CIXL_Color_Black, 0);
+    cixl_render();
+    REQUIRE(VT_OUTPUT == "\033[1;1H\033[0;38;5;200;40mA");
+
+    //Act: without capabilities the nearest basic color, pure red is the VGA red
+    VT_OUTPUT.clear();
+    cixl_vt_set_capabilities(CIXL_VT_CAPS_NONE);
+    cixl_print(0, 1, "B", 196, CIXL_Color_Black, 0);
+    cixl_render();
+    REQUIRE(VT_OUTPUT == "\033[2;1H\033[31mB");
+
+    //Act: a 24 bit color
+    VT_OUTPUT.clear();
+    cixl_vt_set_capabilities(CIXL_VT_CAP_TRUECOLOR);
+    cixl_print(0, 2, "C", CIXL_Color_Grey, 100, 0);
+    cixl_render();
+    REQUIRE(VT_OUTPUT == "\033[3;1H\033[37;48;2;18;52;86mC");
+
+    //Act: the same color when the terminal only has the 256 color palette
+    VT_OUTPUT.clear();
+    cixl_vt_set_capabilities(CIXL_VT_CAP_256_COLORS);
+    cixl_print(0, 3, "D", CIXL_Color_Grey, 100, 0);
+    cixl_render();
+    REQUIRE(cixl_color_nearest(0x12, 0x34, 0x56, 256) == 237);
+    //the palette does not have the color, the nearest is a grey, the basic color stays 4 bit
+    REQUIRE(VT_OUTPUT.find("\033[48;5;237mD") != std::string::npos);
+
+    //Act: changing the color draws its cells again
+    VT_OUTPUT.clear();
+    cixl_vt_set_capabilities(CIXL_VT_CAP_TRUECOLOR);
+    cixl_color_set_rgb(100, 0xFE, 0xDC, 0xBA);
+    cixl_render();
+    REQUIRE(count_occurrences(VT_OUTPUT, "48;2;254;220;186m") == 1);
+    REQUIRE(VT_OUTPUT.find("C") != std::string::npos);
+    REQUIRE(VT_OUTPUT.find("D") != std::string::npos);
+    REQUIRE(VT_OUTPUT.find("A") == std::string::npos);
+
+    cixl_color_reset_table();
+    cixl_vt_set_capabilities(CIXL_VT_CAPS_NONE);
+}
+
+TEST_CASE("vt device 24 bit colors rendered by the vt model equal the screen buffer", "should be equal")
+{
+    //Arrange
+    int first_difference;
+
+    VT_MODEL = cixl_vt_model_create(40, 10);
+    REQUIRE(VT_MODEL != nullptr);
+    cixl_init_screen_buffer(40, 10, cixl_vt_device(vt_write_to_model));
+    cixl_vt_set_capabilities(CIXL_VT_CAP_256_COLORS | CIXL_VT_CAP_TRUECOLOR);
+    for (int color = 16; color < 24; ++color)
+    {
+        cixl_color_set_rgb((CIXL_Color) color, (uint8_t) (color * 10), 0x20, (uint8_t) (255 - color));
+    }
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        //Act
+        for (int y = 0; y < 10; ++y)
+        {
+            for (int x = 0; x < 40; ++x)
+            {
+                CIXL_Cxl cell{(char) ('a' + (x + frame) % 26), (CIXL_Color) ((x * 7 + y + frame) % 256),
+                              (CIXL_Color) (16 + (x + y + frame) % 8), 0};
+                cixl_put(x, y, cell);
+            }
+        }
+        cixl_render();
+
+        //Assert
+        REQUIRE(cixl_vt_model_compare_screen(VT_MODEL, &first_difference) == 0);
+        REQUIRE(VT_MODEL->stats.unknown_sequences == 0);
+    }
+
+    cixl_color_reset_table();
+    cixl_vt_set_capabilities(CIXL_VT_CAPS_NONE);
+    cixl_vt_model_free(VT_MODEL);
+    VT_MODEL = nullptr;
+}
+
+TEST_CASE("raster device draws 24 bit colors", "should take the colors from the color table")
+{
+    //Arrange
+    int width_px;
+    int height_px;
+    cixl_init_screen_buffer(4, 2, cixl_raster_device());
+    cixl_print(1, 1, " ", CIXL_Color_Grey, 42, 0);
+    cixl_render();
+    const uint8_t *pixel = cixl_raster_pixels(&width_px, &height_px) + ((size_t) 8 * width_px + 8) * 4;
+    //the xterm palette: 42 is 0, 215, 135 in the color cube
+    REQUIRE(pixel[0] == 0);
+    REQUIRE(pixel[1] == 215);
+    REQUIRE(pixel[2] == 135);
+
+    //Act
+    cixl_color_set_rgb(42, 0x12, 0x34, 0x56);
+    cixl_render();
+
+    //Assert
+    pixel = cixl_raster_pixels(&width_px, &height_px) + ((size_t) 8 * width_px + 8) * 4;
+    REQUIRE(pixel[0] == 0x12);
+    REQUIRE(pixel[1] == 0x34);
+    REQUIRE(pixel[2] == 0x56);
+
+    cixl_color_reset_table();
+    cixl_raster_free();
 }
 
 #pragma clang diagnostic pop
\ No newline at end of file